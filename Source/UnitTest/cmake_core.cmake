@@ -17,17 +17,29 @@
 
 if(${UNIVERSAL_BUILD})
     set(ASTC_TEST test-unit)
+    set(ASTC_CODEC_LIB astc${CODEC}-static)
 else()
     set(ASTC_TEST test-unit-${ISA_SIMD})
+    set(ASTC_CODEC_LIB astc${CODEC}-${ISA_SIMD}-static)
 endif()
 
 add_executable(${ASTC_TEST})
 
 target_sources(${ASTC_TEST}
     PRIVATE
+        test_block_stream.cpp
         test_simd.cpp
-        test_softfloat.cpp
-        ../astcenc_mathlib_softfloat.cpp)
+        test_softfloat.cpp)
+
+# The compressor API tests, and the decompressor tests which compress their input images, need a
+# library build that includes the compressor
+if(NOT ${DECOMPRESSOR})
+    target_sources(${ASTC_TEST}
+        PRIVATE
+            test_compress.cpp
+            test_compute_variance.cpp
+            test_decompress.cpp)
+endif()
 
 target_include_directories(${ASTC_TEST}
     PRIVATE
@@ -130,6 +142,7 @@ target_link_options(${ASTC_TEST}
 
 target_link_libraries(${ASTC_TEST}
     PRIVATE
+        ${ASTC_CODEC_LIB}
         gtest_main)
 
 add_test(NAME ${ASTC_TEST}
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Unit tests for the split block stream public API.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../astcenc.h"
+
+namespace astcenc
+{
+
+/** @brief The block counts to test, including zero and odd sizes. */
+static const size_t TEST_BLOCK_COUNTS[] { 0, 1, 2, 3, 7, 16, 17, 63, 64, 65, 1000 };
+
+/**
+ * @brief Create pseudo-random block data.
+ *
+ * Random bits cover valid, reserved, and void-extent block modes, with every partition count.
+ *
+ * @param block_count   The number of blocks.
+ * @param seed          The random seed.
+ *
+ * @return The block data.
+ */
+static std::vector<uint8_t> make_blocks(
+	size_t block_count,
+	unsigned int seed
+) {
+	std::vector<uint8_t> data(block_count * 16);
+	unsigned int state = seed;
+	for (uint8_t& byte : data)
+	{
+		state = state * 1103515245u + 12345u;
+		byte = static_cast<uint8_t>(state >> 16);
+	}
+
+	return data;
+}
+
+/**
+ * @brief Split and merge block data, and check that the result matches the input.
+ *
+ * @param block_x   The block x dimension.
+ * @param block_y   The block y dimension.
+ * @param block_z   The block z dimension.
+ * @param data      The block data.
+ */
+static void check_round_trip(
+	unsigned int block_x,
+	unsigned int block_y,
+	unsigned int block_z,
+	const std::vector<uint8_t>& data
+) {
+	size_t block_count = data.size() / 16;
+
+	// The API requires non-null pointers, even for empty images
+	uint8_t empty[16] { 0 };
+	const uint8_t* data_ptr = data.empty() ? empty : data.data();
+
+	size_t stream_len = ASTCENC_BLOCK_STREAM_HEADER_SIZE
+	                  + ASTCENC_BLOCK_STREAM_MAX_BLOCK_SIZE * block_count;
+	std::vector<uint8_t> stream(stream_len);
+	astcenc_error status = astcenc_block_stream_split(block_x, block_y, block_z,
+	                                                  data_ptr, data.size(),
+	                                                  stream.data(), &stream_len);
+	ASSERT_EQ(status, ASTCENC_SUCCESS);
+	EXPECT_GE(stream_len, static_cast<size_t>(ASTCENC_BLOCK_STREAM_HEADER_SIZE));
+	EXPECT_LE(stream_len, stream.size());
+
+	std::vector<uint8_t> merged(data.size() + 16, 0xAA);
+	status = astcenc_block_stream_merge(block_x, block_y, block_z,
+	                                    stream.data(), stream_len,
+	                                    merged.data(), data.size());
+	ASSERT_EQ(status, ASTCENC_SUCCESS);
+
+	merged.resize(data.size());
+	EXPECT_EQ(merged, data);
+}
+
+/** @brief Test that merge inverts split for 2D blocks. */
+TEST(block_stream, RoundTrip2D)
+{
+	for (size_t block_count : TEST_BLOCK_COUNTS)
+	{
+		SCOPED_TRACE(block_count);
+		check_round_trip(6, 6, 1, make_blocks(block_count, static_cast<unsigned int>(block_count)));
+	}
+}
+
+/** @brief Test that merge inverts split for 3D blocks. */
+TEST(block_stream, RoundTrip3D)
+{
+	for (size_t block_count : TEST_BLOCK_COUNTS)
+	{
+		SCOPED_TRACE(block_count);
+		check_round_trip(4, 4, 4, make_blocks(block_count, static_cast<unsigned int>(block_count)));
+	}
+}
+
+/** @brief Test that merge inverts split for special block encodings. */
+TEST(block_stream, RoundTripSpecialBlocks)
+{
+	// The first block is left as all zero bits, which is a reserved block mode
+	std::vector<uint8_t> data(4 * 16, 0);
+
+	// Void-extent block with an LDR constant color
+	data[16] = 0xFC;
+	data[17] = 0xFD;
+	for (unsigned int i = 18; i < 32; i++)
+	{
+		data[i] = 0xFF;
+	}
+
+	// All one bits
+	for (unsigned int i = 32; i < 48; i++)
+	{
+		data[i] = 0xFF;
+	}
+
+	// A single partition block with a 4x4 grid of 2-bit weights, and random payload bits
+	std::vector<uint8_t> payload = make_blocks(1, 7);
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		data[48 + i] = payload[i];
+	}
+
+	data[48] = 0x42;
+	data[49] = 0x00;
+
+	check_round_trip(6, 6, 1, data);
+	check_round_trip(4, 4, 4, data);
+}
+
+/** @brief Test that corrupt or mismatched streams are rejected. */
+TEST(block_stream, RejectInvalid)
+{
+	std::vector<uint8_t> data = make_blocks(17, 3);
+
+	size_t stream_len = ASTCENC_BLOCK_STREAM_HEADER_SIZE + ASTCENC_BLOCK_STREAM_MAX_BLOCK_SIZE * 17;
+	std::vector<uint8_t> stream(stream_len);
+
+	// An undersized output buffer is rejected
+	size_t short_len = ASTCENC_BLOCK_STREAM_HEADER_SIZE;
+	astcenc_error status = astcenc_block_stream_split(6, 6, 1, data.data(), data.size(),
+	                                                  stream.data(), &short_len);
+	EXPECT_EQ(status, ASTCENC_ERR_OUT_OF_MEM);
+
+	// A data length that is not a whole number of blocks is rejected
+	status = astcenc_block_stream_split(6, 6, 1, data.data(), data.size() - 1,
+	                                    stream.data(), &stream_len);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+
+	status = astcenc_block_stream_split(6, 6, 1, data.data(), data.size(),
+	                                    stream.data(), &stream_len);
+	ASSERT_EQ(status, ASTCENC_SUCCESS);
+
+	std::vector<uint8_t> merged(data.size());
+
+	// A mismatched output length is rejected
+	status = astcenc_block_stream_merge(6, 6, 1, stream.data(), stream_len,
+	                                    merged.data(), merged.size() - 16);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+
+	// A truncated stream is rejected
+	status = astcenc_block_stream_merge(6, 6, 1, stream.data(), stream_len - 1,
+	                                    merged.data(), merged.size());
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+
+	// A stream shorter than the header is rejected
+	status = astcenc_block_stream_merge(6, 6, 1, stream.data(), ASTCENC_BLOCK_STREAM_HEADER_SIZE - 1,
+	                                    merged.data(), merged.size());
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+}
+
+}
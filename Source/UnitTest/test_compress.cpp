@@ -0,0 +1,661 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Unit tests for the compressor public API.
+ */
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../astcenc.h"
+
+namespace astcenc
+{
+
+/** @brief The test image X and Y dimension, in texels. */
+static const unsigned int TEST_IMAGE_DIM { 60 };
+
+/** @brief The test block X and Y dimension, in texels. */
+static const unsigned int TEST_BLOCK_DIM { 6 };
+
+/** @brief The number of threads used by the multi-threaded tests. */
+static const unsigned int TEST_THREAD_COUNT { 4 };
+
+/** @brief The identity swizzle. */
+static const astcenc_swizzle SWIZZLE { ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+
+/**
+ * @brief A synthetic RGBA8 test image with gradients, edges, and noise.
+ */
+class TestImage
+{
+public:
+	/**
+	 * @brief Create a new test image.
+	 *
+	 * @param seed   The seed for the noise pattern.
+	 */
+	explicit TestImage(unsigned int seed = 1)
+		: texels(TEST_IMAGE_DIM * TEST_IMAGE_DIM * 4)
+	{
+		unsigned int state = seed;
+		for (unsigned int y = 0; y < TEST_IMAGE_DIM; y++)
+		{
+			for (unsigned int x = 0; x < TEST_IMAGE_DIM; x++)
+			{
+				state = state * 1103515245u + 12345u;
+				unsigned int noise = (state >> 16) & 0x1F;
+				uint8_t* texel = texels.data() + (y * TEST_IMAGE_DIM + x) * 4;
+				texel[0] = static_cast<uint8_t>(x * 4 + noise);
+				texel[1] = static_cast<uint8_t>(y * 4);
+				texel[2] = static_cast<uint8_t>(((x / 8 + y / 8) & 1) ? 220 - noise : 30 + noise);
+				texel[3] = static_cast<uint8_t>(x < y ? 255 : 128 + noise);
+			}
+		}
+
+		slice = texels.data();
+		image.dim_x = TEST_IMAGE_DIM;
+		image.dim_y = TEST_IMAGE_DIM;
+		image.dim_z = 1;
+		image.data_type = ASTCENC_TYPE_U8;
+		image.data = &slice;
+	}
+
+	/** @brief The image texel data. */
+	std::vector<uint8_t> texels;
+
+	/** @brief The single image slice pointer. */
+	void* slice;
+
+	/** @brief The codec image. */
+	astcenc_image image;
+};
+
+/**
+ * @brief Get the size of the compressed test image, in bytes.
+ *
+ * @param block_dim   The block X and Y dimension.
+ *
+ * @return The compressed data size.
+ */
+static size_t get_compressed_size(
+	unsigned int block_dim = TEST_BLOCK_DIM
+) {
+	size_t blocks = (TEST_IMAGE_DIM + block_dim - 1) / block_dim;
+	return blocks * blocks * 16;
+}
+
+/**
+ * @brief Create a compression config for the test image.
+ *
+ * @param use_statistics   Use error weighting that needs the input averages and variances.
+ * @param quality          The compression quality.
+ * @param block_dim        The block X and Y dimension.
+ *
+ * @return The config.
+ */
+static astcenc_config make_config(
+	bool use_statistics = false,
+	float quality = ASTCENC_PRE_MEDIUM,
+	unsigned int block_dim = TEST_BLOCK_DIM
+) {
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(ASTCENC_PRF_LDR, block_dim, block_dim, 1,
+	                                           quality, 0, &config);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	if (use_statistics)
+	{
+		config.v_rgba_radius = 2;
+		config.v_rgb_stdev = 1.0f;
+		config.a_scale_radius = 2;
+	}
+
+	return config;
+}
+
+/**
+ * @brief Create a codec context.
+ *
+ * @param config         The codec config.
+ * @param thread_count   The context thread count.
+ *
+ * @return The context; never @c nullptr.
+ */
+static astcenc_context* make_context(
+	const astcenc_config& config,
+	unsigned int thread_count
+) {
+	astcenc_context* context = nullptr;
+	astcenc_error status = astcenc_context_alloc(&config, thread_count, &context);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+	return context;
+}
+
+/**
+ * @brief Compress the test image using a single thread.
+ *
+ * @param image    The image to compress.
+ * @param config   The codec config.
+ *
+ * @return The compressed data.
+ */
+static std::vector<uint8_t> compress_reference(
+	TestImage& image,
+	const astcenc_config& config
+) {
+	std::vector<uint8_t> data(get_compressed_size(config.block_x));
+	astcenc_context* context = make_context(config, 1);
+	astcenc_error status = astcenc_compress_image(context, &image.image, &SWIZZLE,
+	                                              data.data(), data.size(), 0);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+	astcenc_context_free(context);
+	return data;
+}
+
+/**
+ * @brief Decompress the test image to normalized floats.
+ *
+ * @param data   The compressed data.
+ *
+ * @return The decompressed RGBA texels.
+ */
+static std::vector<float> decompress(
+	const std::vector<uint8_t>& data
+) {
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(ASTCENC_PRF_LDR, TEST_BLOCK_DIM, TEST_BLOCK_DIM, 1,
+	                                           ASTCENC_PRE_FAST, ASTCENC_FLG_DECOMPRESS_ONLY, &config);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+	astcenc_context* context = make_context(config, 1);
+
+	std::vector<float> texels(TEST_IMAGE_DIM * TEST_IMAGE_DIM * 4);
+	void* slice = texels.data();
+	astcenc_image image { TEST_IMAGE_DIM, TEST_IMAGE_DIM, 1, ASTCENC_TYPE_F32, &slice };
+
+	status = astcenc_decompress_image(context, data.data(), data.size(), &image, &SWIZZLE, 0);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+	astcenc_context_free(context);
+	return texels;
+}
+
+/**
+ * @brief Get the per-block sum of squared errors of a decompressed image.
+ *
+ * Errors are measured on the same 16-bit scale that the compressor uses.
+ *
+ * @param image     The original image.
+ * @param decoded   The decompressed texels.
+ *
+ * @return The error for each block, in raster block order.
+ */
+static std::vector<double> get_block_errors(
+	const TestImage& image,
+	const std::vector<float>& decoded
+) {
+	unsigned int row_blocks = (TEST_IMAGE_DIM + TEST_BLOCK_DIM - 1) / TEST_BLOCK_DIM;
+	std::vector<double> errors(row_blocks * row_blocks, 0.0);
+	for (unsigned int y = 0; y < TEST_IMAGE_DIM; y++)
+	{
+		for (unsigned int x = 0; x < TEST_IMAGE_DIM; x++)
+		{
+			unsigned int block = (y / TEST_BLOCK_DIM) * row_blocks + x / TEST_BLOCK_DIM;
+			for (unsigned int c = 0; c < 4; c++)
+			{
+				unsigned int i = (y * TEST_IMAGE_DIM + x) * 4 + c;
+				double diff = (static_cast<double>(decoded[i]) - image.texels[i] / 255.0) * 65535.0;
+				errors[block] += diff * diff;
+			}
+		}
+	}
+
+	return errors;
+}
+
+/** @brief Test that ending a job that was never started is rejected. */
+TEST(compress_job, EndWithoutBegin)
+{
+	astcenc_context* context = make_context(make_config(), 1);
+	EXPECT_EQ(astcenc_compress_end(context), ASTCENC_ERR_BAD_PARAM);
+
+	int job_complete = 0;
+	EXPECT_EQ(astcenc_compress_run_task(context, &job_complete), ASTCENC_SUCCESS);
+	EXPECT_EQ(job_complete, 1);
+
+	astcenc_context_free(context);
+}
+
+/** @brief Test that job based compression rejects rate-distortion optimization. */
+TEST(compress_job, RejectRDO)
+{
+	TestImage image;
+	astcenc_config config = make_config();
+	config.rdo_lambda = 1.0f;
+
+	astcenc_context* context = make_context(config, TEST_THREAD_COUNT);
+	std::vector<uint8_t> data(get_compressed_size());
+	astcenc_error status = astcenc_compress_begin(context, &image.image, &SWIZZLE,
+	                                              data.data(), data.size());
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+
+	// A rejected job is not started
+	EXPECT_EQ(astcenc_compress_end(context), ASTCENC_ERR_BAD_PARAM);
+
+	astcenc_context_free(context);
+}
+
+/**
+ * @brief Run job based compression with workers calling run_task concurrently with, and after, end.
+ *
+ * @param use_statistics   Use error weighting that needs the input averages and variances.
+ */
+static void test_concurrent_run_task_and_end(
+	bool use_statistics
+) {
+	TestImage image;
+	astcenc_config config = make_config(use_statistics);
+	std::vector<uint8_t> reference = compress_reference(image, config);
+
+	astcenc_context* context = make_context(config, TEST_THREAD_COUNT);
+	std::vector<uint8_t> data(get_compressed_size());
+
+	for (unsigned int pass = 0; pass < 4; pass++)
+	{
+		std::fill(data.begin(), data.end(), static_cast<uint8_t>(0));
+		astcenc_error status = astcenc_compress_begin(context, &image.image, &SWIZZLE,
+		                                              data.data(), data.size());
+		ASSERT_EQ(status, ASTCENC_SUCCESS);
+
+		// Workers keep calling until they see the job complete, which may be after it has ended
+		std::vector<std::thread> workers;
+		std::vector<astcenc_error> worker_status(TEST_THREAD_COUNT, ASTCENC_SUCCESS);
+		for (unsigned int i = 0; i < TEST_THREAD_COUNT; i++)
+		{
+			workers.emplace_back([context, &worker_status, i]() {
+				int job_complete = 0;
+				while (!job_complete && worker_status[i] == ASTCENC_SUCCESS)
+				{
+					worker_status[i] = astcenc_compress_run_task(context, &job_complete);
+				}
+			});
+		}
+
+		// The job is ended while the workers are still running tasks
+		EXPECT_EQ(astcenc_compress_end(context), ASTCENC_SUCCESS);
+
+		// Calls after the end of the job run nothing and report the job as complete
+		int job_complete = 0;
+		EXPECT_EQ(astcenc_compress_run_task(context, &job_complete), ASTCENC_SUCCESS);
+		EXPECT_EQ(job_complete, 1);
+
+		for (unsigned int i = 0; i < TEST_THREAD_COUNT; i++)
+		{
+			workers[i].join();
+			EXPECT_EQ(worker_status[i], ASTCENC_SUCCESS);
+		}
+
+		EXPECT_EQ(data, reference);
+	}
+
+	astcenc_context_free(context);
+}
+
+/** @brief Test that worker threads can call run_task concurrently with, and after, end. */
+TEST(compress_job, ConcurrentRunTaskAndEnd)
+{
+	test_concurrent_run_task_and_end(false);
+}
+
+/** @brief Test concurrent run_task and end with a job that computes image statistics. */
+TEST(compress_job, ConcurrentRunTaskAndEndWithStatistics)
+{
+	test_concurrent_run_task_and_end(true);
+}
+
+/** @brief The output array being compressed by the progressive tests. */
+static const std::vector<uint8_t>* progress_output { nullptr };
+
+/** @brief The copies of the output array made by the progressive test callback. */
+static std::vector<std::vector<uint8_t>> progress_snapshots;
+
+/** @brief The progress values reported to the progressive test callback. */
+static std::vector<float> progress_values;
+
+/**
+ * @brief Progress callback which copies the output array.
+ *
+ * @param value   The progress value.
+ */
+static void progress_snapshot(float value)
+{
+	progress_values.push_back(value);
+	progress_snapshots.push_back(*progress_output);
+}
+
+/**
+ * @brief Run progressive compression and check the result against the initial pass.
+ *
+ * @param thread_count   The number of compression threads.
+ */
+static void test_progressive(
+	unsigned int thread_count
+) {
+	TestImage image;
+	astcenc_config config = make_config(false, ASTCENC_PRE_THOROUGH);
+	config.progress_callback = progress_snapshot;
+
+	std::vector<uint8_t> data(get_compressed_size());
+	progress_output = &data;
+	progress_snapshots.clear();
+	progress_values.clear();
+
+	astcenc_context* context = make_context(config, thread_count);
+
+	std::vector<std::thread> workers;
+	std::vector<astcenc_error> worker_status(thread_count, ASTCENC_SUCCESS);
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers.emplace_back([context, &image, &data, &worker_status, i]() {
+			worker_status[i] = astcenc_compress_image_progressive(
+			    context, &image.image, &SWIZZLE, data.data(), data.size(), i);
+		});
+	}
+
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers[i].join();
+		EXPECT_EQ(worker_status[i], ASTCENC_SUCCESS);
+	}
+
+	astcenc_context_free(context);
+
+	// The first callback reports the initial pass, and the last reports completion
+	ASSERT_GE(progress_values.size(), 2u);
+	EXPECT_EQ(progress_values.front(), 0.0f);
+	EXPECT_EQ(progress_values.back(), 100.0f);
+	EXPECT_EQ(progress_snapshots.back(), data);
+
+	// Every image seen by the callback decodes, and no block gets worse as refinement proceeds
+	std::vector<double> initial_errors = get_block_errors(image, decompress(progress_snapshots[0]));
+	std::vector<double> previous_errors = initial_errors;
+	for (const auto& snapshot : progress_snapshots)
+	{
+		std::vector<double> errors = get_block_errors(image, decompress(snapshot));
+		for (size_t i = 0; i < errors.size(); i++)
+		{
+			EXPECT_LE(errors[i], previous_errors[i]) << "block " << i;
+		}
+
+		previous_errors = errors;
+	}
+
+	// Refinement at a higher quality should improve the image overall
+	double initial_total = 0.0;
+	double final_total = 0.0;
+	for (size_t i = 0; i < initial_errors.size(); i++)
+	{
+		initial_total += initial_errors[i];
+		final_total += previous_errors[i];
+	}
+
+	EXPECT_LT(final_total, initial_total);
+}
+
+/** @brief Test single threaded progressive compression. */
+TEST(compress_progressive, SingleThread)
+{
+	test_progressive(1);
+}
+
+/** @brief Test multi-threaded progressive compression. */
+TEST(compress_progressive, MultiThread)
+{
+	test_progressive(TEST_THREAD_COUNT);
+}
+
+/** @brief Test that progressive compression does not refine blocks that can not improve. */
+TEST(compress_progressive, NothingToRefine)
+{
+	// A constant color image is encoded exactly by the initial pass
+	TestImage image;
+	std::fill(image.texels.begin(), image.texels.end(), static_cast<uint8_t>(96));
+
+	astcenc_config config = make_config(false, ASTCENC_PRE_THOROUGH);
+	config.progress_callback = progress_snapshot;
+
+	std::vector<uint8_t> data(get_compressed_size());
+	progress_output = &data;
+	progress_snapshots.clear();
+	progress_values.clear();
+
+	astcenc_context* context = make_context(config, 1);
+	astcenc_error status = astcenc_compress_image_progressive(
+	    context, &image.image, &SWIZZLE, data.data(), data.size(), 0);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+	astcenc_context_free(context);
+
+	// Completion is reported straight after the initial pass
+	std::vector<float> expected { 0.0f, 100.0f };
+	EXPECT_EQ(progress_values, expected);
+	EXPECT_EQ(data, compress_reference(image, make_config(false, ASTCENC_PRE_THOROUGH)));
+}
+
+/**
+ * @brief Test that multi-block-size compression matches separate compressions.
+ *
+ * @param use_statistics   Use error weighting that needs the input averages and variances.
+ * @param thread_count     The number of compression threads.
+ */
+static void test_compress_multi(
+	bool use_statistics,
+	unsigned int thread_count
+) {
+	static const unsigned int block_dims[] { 4, 6, 8, 12 };
+	static const unsigned int block_dim_count = sizeof(block_dims) / sizeof(block_dims[0]);
+
+	TestImage image;
+	std::vector<astcenc_context*> contexts;
+	std::vector<std::vector<uint8_t>> data;
+	std::vector<std::vector<uint8_t>> references;
+	for (unsigned int block_dim : block_dims)
+	{
+		astcenc_config config = make_config(use_statistics, ASTCENC_PRE_MEDIUM, block_dim);
+		contexts.push_back(make_context(config, thread_count));
+		data.emplace_back(get_compressed_size(block_dim));
+		references.push_back(compress_reference(image, config));
+	}
+
+	uint8_t* data_out[block_dim_count];
+	size_t data_len[block_dim_count];
+	for (unsigned int i = 0; i < block_dim_count; i++)
+	{
+		data_out[i] = data[i].data();
+		data_len[i] = data[i].size();
+	}
+
+	std::vector<std::thread> workers;
+	std::vector<astcenc_error> worker_status(thread_count, ASTCENC_SUCCESS);
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers.emplace_back([&contexts, &image, &data_out, &data_len, &worker_status, i]() {
+			worker_status[i] = astcenc_compress_image_multi(
+			    contexts.data(), block_dim_count, &image.image, &SWIZZLE, data_out, data_len, i);
+		});
+	}
+
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers[i].join();
+		EXPECT_EQ(worker_status[i], ASTCENC_SUCCESS);
+	}
+
+	for (unsigned int i = 0; i < block_dim_count; i++)
+	{
+		EXPECT_EQ(data[i], references[i]) << "block size " << block_dims[i];
+		astcenc_context_free(contexts[i]);
+	}
+}
+
+/** @brief Test single threaded multi-block-size compression. */
+TEST(compress_multi, SingleThread)
+{
+	test_compress_multi(false, 1);
+}
+
+/** @brief Test single threaded multi-block-size compression with shared image statistics. */
+TEST(compress_multi, SingleThreadWithStatistics)
+{
+	test_compress_multi(true, 1);
+}
+
+/** @brief Test multi-threaded multi-block-size compression with shared image statistics. */
+TEST(compress_multi, MultiThreadWithStatistics)
+{
+	test_compress_multi(true, TEST_THREAD_COUNT);
+}
+
+/**
+ * @brief Test the candidate encodings returned for each block.
+ *
+ * @param candidate_limit   The number of candidates to request per block.
+ */
+static void test_candidates(
+	unsigned int candidate_limit
+) {
+	TestImage image;
+	astcenc_config config = make_config();
+	std::vector<uint8_t> reference = compress_reference(image, config);
+	size_t block_count = reference.size() / 16;
+
+	// Add an extra block of candidates to check that nothing is written past the limit
+	astcenc_block_candidate sentinel;
+	std::fill(sentinel.data, sentinel.data + 16, static_cast<uint8_t>(0xA5));
+	sentinel.error = 12345.0f;
+	size_t candidates_len = block_count * candidate_limit;
+	std::vector<astcenc_block_candidate> candidates(candidates_len + ASTCENC_MAX_BLOCK_CANDIDATES,
+	                                                sentinel);
+
+	std::vector<uint8_t> data(reference.size());
+	astcenc_context* context = make_context(config, 1);
+	astcenc_error status = astcenc_compress_image_candidates(
+	    context, &image.image, &SWIZZLE, data.data(), data.size(),
+	    candidates.data(), candidates_len, candidate_limit, 0);
+	ASSERT_EQ(status, ASTCENC_SUCCESS);
+	astcenc_context_free(context);
+
+	// The compressed output is the same as a normal compression
+	EXPECT_EQ(data, reference);
+
+	size_t multi_candidate_blocks = 0;
+	for (size_t i = 0; i < block_count; i++)
+	{
+		const astcenc_block_candidate* block = candidates.data() + i * candidate_limit;
+
+		// The first candidate is the encoding chosen by the compressor
+		ASSERT_GE(block[0].error, 0.0f) << "block " << i;
+		EXPECT_TRUE(std::equal(block[0].data, block[0].data + 16, reference.data() + i * 16))
+		    << "block " << i;
+
+		// Used candidates are distinct and sorted by error, followed by any unused entries
+		unsigned int used = 1;
+		while (used < candidate_limit && block[used].error >= 0.0f)
+		{
+			EXPECT_LE(block[used - 1].error, block[used].error) << "block " << i;
+			for (unsigned int j = 0; j < used; j++)
+			{
+				EXPECT_FALSE(std::equal(block[j].data, block[j].data + 16, block[used].data))
+				    << "block " << i;
+			}
+
+			used++;
+		}
+
+		for (unsigned int j = used; j < candidate_limit; j++)
+		{
+			EXPECT_LT(block[j].error, 0.0f) << "block " << i;
+		}
+
+		if (used > 1)
+		{
+			multi_candidate_blocks++;
+		}
+	}
+
+	if (candidate_limit > 1)
+	{
+		EXPECT_GT(multi_candidate_blocks, 0u);
+	}
+
+	// Entries after the requested candidates are not modified
+	for (size_t i = candidates_len; i < candidates.size(); i++)
+	{
+		EXPECT_EQ(candidates[i].error, sentinel.error);
+		EXPECT_TRUE(std::equal(sentinel.data, sentinel.data + 16, candidates[i].data));
+	}
+}
+
+/** @brief Test returning a single candidate per block. */
+TEST(compress_candidates, SingleCandidate)
+{
+	test_candidates(1);
+}
+
+/** @brief Test returning several candidates per block. */
+TEST(compress_candidates, SeveralCandidates)
+{
+	test_candidates(4);
+}
+
+/** @brief Test returning the maximum number of candidates per block. */
+TEST(compress_candidates, MaxCandidates)
+{
+	test_candidates(ASTCENC_MAX_BLOCK_CANDIDATES);
+}
+
+/** @brief Test that invalid candidate limits and buffer sizes are rejected. */
+TEST(compress_candidates, RejectInvalid)
+{
+	TestImage image;
+	astcenc_config config = make_config();
+	std::vector<uint8_t> data(get_compressed_size());
+	size_t block_count = data.size() / 16;
+	std::vector<astcenc_block_candidate> candidates(block_count * (ASTCENC_MAX_BLOCK_CANDIDATES + 1));
+	astcenc_context* context = make_context(config, 1);
+
+	astcenc_error status = astcenc_compress_image_candidates(
+	    context, &image.image, &SWIZZLE, data.data(), data.size(),
+	    candidates.data(), candidates.size(), ASTCENC_MAX_BLOCK_CANDIDATES + 1, 0);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+
+	status = astcenc_compress_image_candidates(
+	    context, &image.image, &SWIZZLE, data.data(), data.size(),
+	    candidates.data(), block_count * 2 - 1, 2, 0);
+	EXPECT_EQ(status, ASTCENC_ERR_OUT_OF_MEM);
+
+	status = astcenc_compress_image_candidates(
+	    context, &image.image, &SWIZZLE, data.data(), data.size(),
+	    nullptr, 0, 2, 0);
+	EXPECT_EQ(status, ASTCENC_ERR_OUT_OF_MEM);
+
+	astcenc_context_free(context);
+}
+
+}
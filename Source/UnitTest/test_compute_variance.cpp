@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Unit tests for the input image averages and variances computation.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../astcenc.h"
+#include "../astcenc_internal.h"
+
+namespace astcenc
+{
+
+/** @brief The test image X dimension, in texels; not a multiple of the task size. */
+static const unsigned int TEST_IMAGE_DIM_X { 75 };
+
+/** @brief The test image Y dimension, in texels; not a multiple of the task size. */
+static const unsigned int TEST_IMAGE_DIM_Y { 70 };
+
+/**
+ * @brief The allowed absolute difference between the integer and float path results.
+ *
+ * The integer path is exact, so this covers the rounding of the float summed-area tables.
+ */
+static const float TEST_TOLERANCE { 5e-4f };
+
+/**
+ * @brief The averages and variances computed for an image.
+ */
+struct image_statistics
+{
+	/** @brief The per-texel averages. */
+	std::vector<vfloat4> averages;
+
+	/** @brief The per-texel variances. */
+	std::vector<vfloat4> variances;
+
+	/** @brief The per-texel alpha averages. */
+	std::vector<float> alpha_averages;
+};
+
+/**
+ * @brief Create a pseudo-random RGBA8 test image with gradients and noise.
+ *
+ * @return The texel data.
+ */
+static std::vector<uint8_t> make_texels()
+{
+	std::vector<uint8_t> texels(TEST_IMAGE_DIM_X * TEST_IMAGE_DIM_Y * 4);
+	unsigned int state = 1;
+	for (unsigned int y = 0; y < TEST_IMAGE_DIM_Y; y++)
+	{
+		for (unsigned int x = 0; x < TEST_IMAGE_DIM_X; x++)
+		{
+			state = state * 1103515245u + 12345u;
+			unsigned int noise = state >> 16;
+
+			uint8_t* texel = texels.data() + 4 * (y * TEST_IMAGE_DIM_X + x);
+			texel[0] = static_cast<uint8_t>(x * 3);
+			texel[1] = static_cast<uint8_t>(noise);
+			texel[2] = static_cast<uint8_t>((x < 40) ? 0 : 255);
+			texel[3] = static_cast<uint8_t>(y * 3 + (noise & 15));
+		}
+	}
+
+	return texels;
+}
+
+/**
+ * @brief Compute the averages and variances for an image.
+ *
+ * @param      ctx              The compressor context.
+ * @param      image            The input image.
+ * @param      swizzle          The input swizzle.
+ * @param      radius           The kernel radius for averages, variances, and alpha.
+ * @param      use_int_path     The expected choice of integer or float path.
+ * @param[out] stats            The computed statistics.
+ */
+static void compute_statistics(
+	astcenc_context& ctx,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle,
+	unsigned int radius,
+	bool use_int_path,
+	image_statistics& stats
+) {
+	size_t texel_count = static_cast<size_t>(image.dim_x) * image.dim_y * image.dim_z;
+	stats.averages.assign(texel_count, vfloat4::zero());
+	stats.variances.assign(texel_count, vfloat4::zero());
+	stats.alpha_averages.assign(texel_count, 0.0f);
+
+	avg_var_args ag;
+	unsigned int task_count = init_compute_averages_and_variances(
+	    image, 1.0f, 1.0f, radius, radius, swizzle, ag);
+	ASSERT_EQ(ag.use_int_path, use_int_path);
+
+	ctx.input_averages = stats.averages.data();
+	ctx.input_variances = stats.variances.data();
+	ctx.input_alpha_averages = stats.alpha_averages.data();
+
+	ctx.manage_avg_var.reset();
+	ctx.manage_avg_var.init(task_count);
+	compute_averages_and_variances(ctx, ag);
+	ctx.manage_avg_var.reset();
+
+	ctx.input_averages = nullptr;
+	ctx.input_variances = nullptr;
+	ctx.input_alpha_averages = nullptr;
+}
+
+/**
+ * @brief Check that the integer U8 path matches the float path for a swizzle.
+ *
+ * The float path is run on an F32 copy of the image, which holds the same normalized values.
+ *
+ * @param swizzle   The input swizzle.
+ * @param radius    The kernel radius.
+ */
+static void check_int_path(
+	const astcenc_swizzle& swizzle,
+	unsigned int radius
+) {
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(ASTCENC_PRF_LDR, 4, 4, 1, ASTCENC_PRE_FASTEST, 0, &config);
+	ASSERT_EQ(status, ASTCENC_SUCCESS);
+
+	astcenc_context* context = nullptr;
+	status = astcenc_context_alloc(&config, 1, &context);
+	ASSERT_EQ(status, ASTCENC_SUCCESS);
+
+	std::vector<uint8_t> texels = make_texels();
+	std::vector<float> texels_f32(texels.size());
+	for (size_t i = 0; i < texels.size(); i++)
+	{
+		texels_f32[i] = static_cast<float>(texels[i]) / 255.0f;
+	}
+
+	void* data_u8 = texels.data();
+	astcenc_image image_u8 { TEST_IMAGE_DIM_X, TEST_IMAGE_DIM_Y, 1, ASTCENC_TYPE_U8, &data_u8 };
+
+	void* data_f32 = texels_f32.data();
+	astcenc_image image_f32 { TEST_IMAGE_DIM_X, TEST_IMAGE_DIM_Y, 1, ASTCENC_TYPE_F32, &data_f32 };
+
+	image_statistics stats_int;
+	compute_statistics(*context, image_u8, swizzle, radius, true, stats_int);
+
+	image_statistics stats_float;
+	compute_statistics(*context, image_f32, swizzle, radius, false, stats_float);
+
+	astcenc_context_free(context);
+
+	for (size_t i = 0; i < stats_int.averages.size(); i++)
+	{
+		vfloat4 avg_diff = abs(stats_int.averages[i] - stats_float.averages[i]);
+		vfloat4 var_diff = abs(stats_int.variances[i] - stats_float.variances[i]);
+		float alpha_diff = std::fabs(stats_int.alpha_averages[i] - stats_float.alpha_averages[i]);
+
+		ASSERT_LE(hmax_s(avg_diff), TEST_TOLERANCE) << "texel " << i;
+		ASSERT_LE(hmax_s(var_diff), TEST_TOLERANCE) << "texel " << i;
+		ASSERT_LE(alpha_diff, TEST_TOLERANCE) << "texel " << i;
+	}
+}
+
+/** @brief Test that the integer U8 path matches the float path for all supported radii. */
+TEST(compute_variance, IntPathMatchesFloat)
+{
+	astcenc_swizzle swizzle { ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+	for (unsigned int radius = 0; radius <= INT_PATH_MAX_RADIUS; radius++)
+	{
+		SCOPED_TRACE(radius);
+		check_int_path(swizzle, radius);
+	}
+}
+
+/** @brief Test that the integer U8 path matches the float path for constant swizzle inputs. */
+TEST(compute_variance, IntPathMatchesFloatSwizzled)
+{
+	astcenc_swizzle swizzle { ASTCENC_SWZ_G, ASTCENC_SWZ_0, ASTCENC_SWZ_R, ASTCENC_SWZ_1 };
+	for (unsigned int radius : { 1u, 2u, 7u, INT_PATH_MAX_RADIUS })
+	{
+		SCOPED_TRACE(radius);
+		check_int_path(swizzle, radius);
+	}
+}
+
+/** @brief Test that radii above the integer path limit use the float path. */
+TEST(compute_variance, LargeRadiusUsesFloat)
+{
+	std::vector<uint8_t> texels = make_texels();
+	void* data_u8 = texels.data();
+	astcenc_image image_u8 { TEST_IMAGE_DIM_X, TEST_IMAGE_DIM_Y, 1, ASTCENC_TYPE_U8, &data_u8 };
+	astcenc_swizzle swizzle { ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+
+	avg_var_args ag;
+	init_compute_averages_and_variances(image_u8, 1.0f, 1.0f, INT_PATH_MAX_RADIUS,
+	                                    INT_PATH_MAX_RADIUS, swizzle, ag);
+	EXPECT_TRUE(ag.use_int_path);
+
+	init_compute_averages_and_variances(image_u8, 1.0f, 1.0f, INT_PATH_MAX_RADIUS + 1,
+	                                    INT_PATH_MAX_RADIUS + 1, swizzle, ag);
+	EXPECT_FALSE(ag.use_int_path);
+}
+
+}
@@ -0,0 +1,838 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Unit tests for the decompressor public API and lazy partition tables.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../astcenc.h"
+#include "../astcenc_internal.h"
+
+namespace astcenc
+{
+
+/** @brief The test image X and Y dimension, in texels; not a multiple of the block size. */
+static const unsigned int TEST_IMAGE_DIM { 100 };
+
+/** @brief The test block X and Y dimension, in texels. */
+static const unsigned int TEST_BLOCK_DIM { 6 };
+
+/** @brief The number of threads used by the multi-threaded tests. */
+static const unsigned int TEST_THREAD_COUNT { 4 };
+
+/**
+ * @brief Compress a synthetic RGBA8 test image with many repeated blocks.
+ *
+ * The left half of the image is a pattern which repeats every block, the top right quarter is a
+ * constant color, and the bottom right quarter is noise.
+ *
+ * @return The compressed data.
+ */
+static std::vector<uint8_t> make_compressed_image()
+{
+	std::vector<uint8_t> texels(TEST_IMAGE_DIM * TEST_IMAGE_DIM * 4);
+	unsigned int state = 1;
+	for (unsigned int y = 0; y < TEST_IMAGE_DIM; y++)
+	{
+		for (unsigned int x = 0; x < TEST_IMAGE_DIM; x++)
+		{
+			state = state * 1103515245u + 12345u;
+			uint8_t* texel = texels.data() + (y * TEST_IMAGE_DIM + x) * 4;
+			unsigned int bx = x % TEST_BLOCK_DIM;
+			unsigned int by = y % TEST_BLOCK_DIM;
+			if (x < TEST_IMAGE_DIM / 2)
+			{
+				texel[0] = static_cast<uint8_t>(bx * 40);
+				texel[1] = static_cast<uint8_t>(by * 40);
+				texel[2] = static_cast<uint8_t>(bx * by * 7);
+				texel[3] = static_cast<uint8_t>(bx < by ? 255 : 64);
+			}
+			else if (y < TEST_IMAGE_DIM / 2)
+			{
+				texel[0] = 200;
+				texel[1] = 100;
+				texel[2] = 50;
+				texel[3] = 255;
+			}
+			else
+			{
+				for (unsigned int c = 0; c < 4; c++)
+				{
+					texel[c] = static_cast<uint8_t>(state >> (8 + 4 * c));
+				}
+			}
+		}
+	}
+
+	void* slice = texels.data();
+	astcenc_image image { TEST_IMAGE_DIM, TEST_IMAGE_DIM, 1, ASTCENC_TYPE_U8, &slice };
+	astcenc_swizzle swizzle { ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(ASTCENC_PRF_LDR, TEST_BLOCK_DIM, TEST_BLOCK_DIM, 1,
+	                                           ASTCENC_PRE_FAST, 0, &config);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	astcenc_context* context = nullptr;
+	status = astcenc_context_alloc(&config, 1, &context);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	size_t blocks = (TEST_IMAGE_DIM + TEST_BLOCK_DIM - 1) / TEST_BLOCK_DIM;
+	std::vector<uint8_t> data(blocks * blocks * 16);
+	status = astcenc_compress_image(context, &image, &swizzle, data.data(), data.size(), 0);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	astcenc_context_free(context);
+	return data;
+}
+
+/**
+ * @brief Decompress an image.
+ *
+ * @param data           The compressed data.
+ * @param data_type      The output data type.
+ * @param swizzle        The output swizzle.
+ * @param flags          The codec config flags.
+ * @param thread_count   The number of decompression threads.
+ *
+ * @return The decompressed image bytes.
+ */
+static std::vector<uint8_t> decompress(
+	const std::vector<uint8_t>& data,
+	astcenc_type data_type,
+	const astcenc_swizzle& swizzle,
+	unsigned int flags,
+	unsigned int thread_count
+) {
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(ASTCENC_PRF_LDR, TEST_BLOCK_DIM, TEST_BLOCK_DIM, 1,
+	                                           ASTCENC_PRE_FAST, flags, &config);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	astcenc_context* context = nullptr;
+	status = astcenc_context_alloc(&config, thread_count, &context);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	size_t texel_size = data_type == ASTCENC_TYPE_U8 ? 4 : (data_type == ASTCENC_TYPE_F16 ? 8 : 16);
+
+	// Fill with a non-zero pattern so texels that are not written are detected
+	std::vector<uint8_t> texels(TEST_IMAGE_DIM * TEST_IMAGE_DIM * texel_size, 0x5A);
+	void* slice = texels.data();
+	astcenc_image image { TEST_IMAGE_DIM, TEST_IMAGE_DIM, 1, data_type, &slice };
+
+	std::vector<std::thread> workers;
+	std::vector<astcenc_error> worker_status(thread_count, ASTCENC_SUCCESS);
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers.emplace_back([context, &data, &image, &swizzle, &worker_status, i]() {
+			worker_status[i] = astcenc_decompress_image(
+			    context, data.data(), data.size(), &image, &swizzle, i);
+		});
+	}
+
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers[i].join();
+		EXPECT_EQ(worker_status[i], ASTCENC_SUCCESS);
+	}
+
+	astcenc_context_free(context);
+	return texels;
+}
+
+/**
+ * @brief Get the index of the first byte that differs between two buffers.
+ *
+ * @param a   The first buffer.
+ * @param b   The second buffer, the same size as @c a.
+ *
+ * @return The index of the first difference, or -1 if the buffers are identical.
+ */
+static long long get_first_difference(
+	const std::vector<uint8_t>& a,
+	const std::vector<uint8_t>& b
+) {
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (a[i] != b[i])
+		{
+			return static_cast<long long>(i);
+		}
+	}
+
+	return -1;
+}
+
+/** @brief Test that decompressing with the decode cache gives bit-identical output. */
+TEST(decompress, DecodeCacheBitIdentical)
+{
+	std::vector<uint8_t> data = make_compressed_image();
+
+	// Check that the image has repeated blocks, so the cache is actually used
+	std::set<std::vector<uint8_t>> unique_blocks;
+	for (size_t i = 0; i < data.size(); i += 16)
+	{
+		unique_blocks.emplace(data.begin() + i, data.begin() + i + 16);
+	}
+
+	EXPECT_LT(unique_blocks.size() * 2, data.size() / 16);
+
+	const astcenc_type data_types[] { ASTCENC_TYPE_U8, ASTCENC_TYPE_F16, ASTCENC_TYPE_F32 };
+	const astcenc_swizzle swizzles[] {
+		{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A },
+		{ ASTCENC_SWZ_A, ASTCENC_SWZ_0, ASTCENC_SWZ_R, ASTCENC_SWZ_1 }
+	};
+
+	for (astcenc_type data_type : data_types)
+	{
+		for (const astcenc_swizzle& swizzle : swizzles)
+		{
+			std::vector<uint8_t> reference = decompress(data, data_type, swizzle, 0, 1);
+			for (unsigned int thread_count : { 1u, TEST_THREAD_COUNT })
+			{
+				SCOPED_TRACE(thread_count);
+				SCOPED_TRACE(static_cast<int>(data_type));
+				std::vector<uint8_t> cached = decompress(data, data_type, swizzle,
+				                                         ASTCENC_FLG_USE_DECODE_CACHE, thread_count);
+				ASSERT_EQ(cached.size(), reference.size());
+				EXPECT_EQ(get_first_difference(cached, reference), -1);
+			}
+		}
+	}
+}
+
+/** @brief Test that decompression only contexts, which use lazy partition tables, match. */
+TEST(decompress, DecompressOnlyBitIdentical)
+{
+	std::vector<uint8_t> data = make_compressed_image();
+	astcenc_swizzle swizzle { ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A };
+
+	std::vector<uint8_t> reference = decompress(data, ASTCENC_TYPE_F32, swizzle, 0, 1);
+	for (unsigned int thread_count : { 1u, TEST_THREAD_COUNT })
+	{
+		SCOPED_TRACE(thread_count);
+		std::vector<uint8_t> lazy = decompress(data, ASTCENC_TYPE_F32, swizzle,
+		                                       ASTCENC_FLG_DECOMPRESS_ONLY, thread_count);
+		ASSERT_EQ(lazy.size(), reference.size());
+		EXPECT_EQ(get_first_difference(lazy, reference), -1);
+	}
+}
+
+/**
+ * @brief Check that lazily built partition tables match eagerly built tables.
+ *
+ * @param x_texels   The block X dimension.
+ * @param y_texels   The block Y dimension.
+ * @param z_texels   The block Z dimension.
+ */
+static void test_lazy_partition_tables(
+	unsigned int x_texels,
+	unsigned int y_texels,
+	unsigned int z_texels
+) {
+	std::unique_ptr<block_size_descriptor> eager(new block_size_descriptor);
+	std::unique_ptr<block_size_descriptor> lazy(new block_size_descriptor);
+	init_block_size_descriptor(x_texels, y_texels, z_texels, false, 1.0f, false, *eager);
+	init_block_size_descriptor(x_texels, y_texels, z_texels, false, 1.0f, true, *lazy);
+
+	// Threads build the entries concurrently, visiting them in different orders
+	unsigned int entry_count = 3 * BLOCK_MAX_PARTITIONINGS;
+	std::vector<std::thread> workers;
+	for (unsigned int t = 0; t < TEST_THREAD_COUNT; t++)
+	{
+		workers.emplace_back([&lazy, entry_count, t]() {
+			for (unsigned int i = 0; i < entry_count; i++)
+			{
+				unsigned int entry = (t & 1) ? entry_count - 1 - i : (i * 7 + t * 131) % entry_count;
+				get_lazy_partition_info(*lazy, entry / BLOCK_MAX_PARTITIONINGS + 2,
+				                        entry % BLOCK_MAX_PARTITIONINGS);
+			}
+		});
+	}
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	unsigned int texel_count = eager->texel_count;
+	for (unsigned int partition_count = 1; partition_count <= BLOCK_MAX_PARTITIONS; partition_count++)
+	{
+		unsigned int index_count = partition_count == 1 ? 1 : BLOCK_MAX_PARTITIONINGS;
+		for (unsigned int index = 0; index < index_count; index++)
+		{
+			SCOPED_TRACE(partition_count);
+			SCOPED_TRACE(index);
+
+			const partition_info& epi = eager->get_partition_info(partition_count, index);
+			const partition_info& lpi = get_lazy_partition_info(*lazy, partition_count, index);
+
+			// Eager tables mark duplicate partitionings as unused, which lazy tables do not
+			if (epi.partition_count != 0)
+			{
+				EXPECT_EQ(lpi.partition_count, epi.partition_count);
+			}
+
+			EXPECT_EQ(std::memcmp(lpi.partition_of_texel, epi.partition_of_texel, texel_count), 0);
+
+			for (unsigned int p = 0; p < BLOCK_MAX_PARTITIONS; p++)
+			{
+				unsigned int count = epi.partition_texel_count[p];
+				ASSERT_EQ(lpi.partition_texel_count[p], count);
+				EXPECT_EQ(std::memcmp(lpi.texels_of_partition[p], epi.texels_of_partition[p], count), 0);
+				EXPECT_EQ(lpi.coverage_bitmaps[p], epi.coverage_bitmaps[p]);
+			}
+		}
+	}
+
+	term_block_size_descriptor(*eager);
+	term_block_size_descriptor(*lazy);
+}
+
+/** @brief Test lazy partition tables for a small 2D block size. */
+TEST(decompress, LazyPartitionTables4x4)
+{
+	test_lazy_partition_tables(4, 4, 1);
+}
+
+/** @brief Test lazy partition tables for a non-square 2D block size. */
+TEST(decompress, LazyPartitionTables10x6)
+{
+	test_lazy_partition_tables(10, 6, 1);
+}
+
+/** @brief Test lazy partition tables for a large 2D block size. */
+TEST(decompress, LazyPartitionTables12x12)
+{
+	test_lazy_partition_tables(12, 12, 1);
+}
+
+/** @brief Test lazy partition tables for a 3D block size. */
+TEST(decompress, LazyPartitionTables4x4x4)
+{
+	test_lazy_partition_tables(4, 4, 4);
+}
+
+/**
+ * @brief Known block encodings for a 2D block size.
+ */
+struct KnownBlocks
+{
+	/** @brief An LDR constant color block. */
+	uint8_t const_ldr[16] {
+		0xFC, 0xFD, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0x00, 0x80, 0x00, 0x40, 0xFF, 0xFF, 0x00, 0x00 };
+
+	/** @brief An HDR constant color block. */
+	uint8_t const_hdr[16] {
+		0xFC, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0x00, 0x3C, 0x00, 0x38, 0x00, 0x00, 0x00, 0x3C };
+
+	/** @brief An illegal block using a reserved block mode. */
+	uint8_t reserved_mode[16] { 0 };
+
+	/** @brief An illegal constant color block with an empty extent. */
+	uint8_t empty_extent[16] {
+		0xFC, 0xFD, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x80, 0x00, 0x40, 0xFF, 0xFF, 0x00, 0x00 };
+
+	/** @brief An illegal constant color block with the reserved bits cleared. */
+	uint8_t reserved_extent[16] {
+		0xFC, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0x00, 0x80, 0x00, 0x40, 0xFF, 0xFF, 0x00, 0x00 };
+
+	/** @brief An illegal dual plane block with four partitions. */
+	uint8_t dual_plane_4_partitions[16] {
+		0x42, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	/** @brief A single partition block using the LDR RGB endpoint mode. */
+	uint8_t ldr_endpoints[16] {
+		0x42, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	/** @brief A single partition block using the HDR RGB endpoint mode. */
+	uint8_t hdr_endpoints[16] {
+		0x42, 0x60, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+};
+
+/**
+ * @brief Create a codec context for block queries.
+ *
+ * @param flags          The codec config flags.
+ * @param thread_count   The context thread count.
+ * @param profile        The color profile.
+ *
+ * @return The context; never @c nullptr.
+ */
+static astcenc_context* make_query_context(
+	unsigned int flags,
+	unsigned int thread_count,
+	astcenc_profile profile = ASTCENC_PRF_LDR
+) {
+	astcenc_config config;
+	astcenc_error status = astcenc_config_init(profile, TEST_BLOCK_DIM, TEST_BLOCK_DIM, 1,
+	                                           ASTCENC_PRE_FAST, flags, &config);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+	astcenc_context* context = nullptr;
+	status = astcenc_context_alloc(&config, thread_count, &context);
+	EXPECT_EQ(status, ASTCENC_SUCCESS);
+	return context;
+}
+
+/**
+ * @brief Overwrite a block in compressed data.
+ *
+ * @param[in,out] data    The compressed data.
+ * @param         index   The block index.
+ * @param         block   The new block encoding.
+ */
+static void set_block(
+	std::vector<uint8_t>& data,
+	size_t index,
+	const uint8_t block[16]
+) {
+	std::copy(block, block + 16, data.begin() + index * 16);
+}
+
+/**
+ * @brief Validate compressed data using several threads.
+ *
+ * @param      context            The codec context.
+ * @param      thread_count       The number of threads, which must match the context.
+ * @param      data               The compressed data.
+ * @param[out] error_blocks       The indices of error blocks, sorted in increasing order.
+ * @param      error_blocks_len   The number of error block indices to request.
+ *
+ * @return The total number of error blocks.
+ */
+static size_t validate(
+	astcenc_context* context,
+	unsigned int thread_count,
+	const std::vector<uint8_t>& data,
+	std::vector<size_t>& error_blocks,
+	size_t error_blocks_len
+) {
+	error_blocks.assign(error_blocks_len, 0);
+
+	std::vector<std::thread> workers;
+	std::vector<astcenc_error> worker_status(thread_count, ASTCENC_SUCCESS);
+	std::vector<size_t> error_counts(thread_count, 0);
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers.emplace_back([=, &data, &error_blocks, &worker_status, &error_counts]() {
+			worker_status[i] = astcenc_validate_blocks(
+			    context, data.data(), data.size(),
+			    error_blocks.data(), error_blocks_len, &error_counts[i], i);
+		});
+	}
+
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers[i].join();
+		EXPECT_EQ(worker_status[i], ASTCENC_SUCCESS);
+
+		// Every thread returns the total error count
+		EXPECT_EQ(error_counts[i], error_counts[0]);
+	}
+
+	error_blocks.resize(std::min(error_counts[0], error_blocks_len));
+	std::sort(error_blocks.begin(), error_blocks.end());
+	return error_counts[0];
+}
+
+/**
+ * @brief Test block validation with known valid, constant color, and illegal blocks.
+ *
+ * @param flags          The codec config flags.
+ * @param thread_count   The number of validation threads.
+ */
+static void test_validate_blocks(
+	unsigned int flags,
+	unsigned int thread_count
+) {
+	KnownBlocks known;
+	std::vector<uint8_t> data = make_compressed_image();
+	size_t block_count = data.size() / 16;
+	astcenc_context* context = make_query_context(flags, thread_count);
+
+	// Compressor output only contains legal blocks
+	std::vector<size_t> error_blocks;
+	EXPECT_EQ(validate(context, thread_count, data, error_blocks, block_count), 0u);
+	EXPECT_TRUE(error_blocks.empty());
+
+	// LDR constant color blocks are legal, and the illegal blocks are all found, including the
+	// HDR blocks that an LDR profile can not decode
+	set_block(data, 0, known.reserved_mode);
+	set_block(data, 1, known.const_ldr);
+	set_block(data, 2, known.const_hdr);
+	set_block(data, 3, known.ldr_endpoints);
+	set_block(data, 4, known.hdr_endpoints);
+	set_block(data, 17, known.empty_extent);
+	set_block(data, 100, known.reserved_extent);
+	set_block(data, block_count - 1, known.dual_plane_4_partitions);
+	std::vector<size_t> expected { 0, 2, 4, 17, 100, block_count - 1 };
+
+	// Reset between validations, even though this is implicit for single threaded contexts
+	astcenc_validate_reset(context);
+	EXPECT_EQ(validate(context, thread_count, data, error_blocks, block_count), expected.size());
+	EXPECT_EQ(error_blocks, expected);
+
+	// The error count is the total, even if the index array is too small
+	astcenc_validate_reset(context);
+	EXPECT_EQ(validate(context, thread_count, data, error_blocks, 2), expected.size());
+	ASSERT_EQ(error_blocks.size(), 2u);
+	for (size_t index : error_blocks)
+	{
+		EXPECT_NE(std::find(expected.begin(), expected.end(), index), expected.end());
+	}
+
+	// Empty data is valid
+	astcenc_validate_reset(context);
+	std::vector<uint8_t> empty;
+	EXPECT_EQ(validate(context, thread_count, empty, error_blocks, 0), 0u);
+
+	astcenc_context_free(context);
+}
+
+/** @brief Test single threaded block validation. */
+TEST(validate_blocks, SingleThread)
+{
+	test_validate_blocks(0, 1);
+}
+
+/** @brief Test multi-threaded block validation. */
+TEST(validate_blocks, MultiThread)
+{
+	test_validate_blocks(0, TEST_THREAD_COUNT);
+}
+
+/** @brief Test block validation with a decompression only context. */
+TEST(validate_blocks, DecompressOnly)
+{
+	test_validate_blocks(ASTCENC_FLG_DECOMPRESS_ONLY, TEST_THREAD_COUNT);
+}
+
+/** @brief Test that HDR blocks are only legal when using an HDR profile. */
+TEST(validate_blocks, HDRBlocks)
+{
+	KnownBlocks known;
+	std::vector<uint8_t> data(4 * 16);
+	set_block(data, 0, known.const_ldr);
+	set_block(data, 1, known.const_hdr);
+	set_block(data, 2, known.ldr_endpoints);
+	set_block(data, 3, known.hdr_endpoints);
+
+	std::vector<size_t> error_blocks;
+	for (astcenc_profile profile : { ASTCENC_PRF_HDR, ASTCENC_PRF_HDR_RGB_LDR_A })
+	{
+		astcenc_context* context = make_query_context(0, 1, profile);
+		EXPECT_EQ(validate(context, 1, data, error_blocks, 4), 0u);
+		astcenc_context_free(context);
+	}
+
+	std::vector<size_t> expected { 1, 3 };
+	for (astcenc_profile profile : { ASTCENC_PRF_LDR, ASTCENC_PRF_LDR_SRGB })
+	{
+		astcenc_context* context = make_query_context(0, 1, profile);
+		EXPECT_EQ(validate(context, 1, data, error_blocks, 4), expected.size());
+		EXPECT_EQ(error_blocks, expected);
+		astcenc_context_free(context);
+	}
+}
+
+/** @brief Test that invalid block validation requests are rejected. */
+TEST(validate_blocks, RejectInvalid)
+{
+	std::vector<uint8_t> data(32, 0);
+	size_t error_count = 0;
+
+	astcenc_context* context = make_query_context(0, 1);
+	astcenc_error status = astcenc_validate_blocks(context, data.data(), data.size() - 1,
+	                                               nullptr, 0, &error_count, 0);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+
+	status = astcenc_validate_blocks(context, data.data(), data.size(),
+	                                 nullptr, 0, &error_count, 1);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+	astcenc_context_free(context);
+
+	// Self decompress only contexts omit legal block modes
+	context = make_query_context(ASTCENC_FLG_SELF_DECOMPRESS_ONLY, 1);
+	status = astcenc_validate_blocks(context, data.data(), data.size(),
+	                                 nullptr, 0, &error_count, 0);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_CONTEXT);
+	astcenc_context_free(context);
+}
+
+/**
+ * @brief Get the quantization mode index of a quantization level count.
+ *
+ * @param level_count   The number of quantization levels.
+ *
+ * @return The quantization mode index.
+ */
+static unsigned int get_quant_mode_index(
+	unsigned int level_count
+) {
+	static const unsigned int level_counts[] {
+		2, 3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192, 256 };
+
+	const unsigned int* end = level_counts + sizeof(level_counts) / sizeof(level_counts[0]);
+	const unsigned int* level = std::find(level_counts, end, level_count);
+	EXPECT_NE(level, end);
+	return static_cast<unsigned int>(level - level_counts);
+}
+
+/**
+ * @brief Compute the expected statistics of compressed data from per-block queries.
+ *
+ * @param      data       The compressed data.
+ * @param[out] expected   The expected statistics.
+ */
+static void get_expected_block_stats(
+	const std::vector<uint8_t>& data,
+	astcenc_block_stats& expected
+) {
+	std::memset(&expected, 0, sizeof(expected));
+	astcenc_context* context = make_query_context(0, 1);
+
+	for (size_t i = 0; i < data.size(); i += 16)
+	{
+		const uint8_t* block = data.data() + i;
+		astcenc_block_info info;
+		astcenc_error status = astcenc_get_block_info(context, block, &info);
+		EXPECT_EQ(status, ASTCENC_SUCCESS);
+
+		expected.block_count++;
+		if (info.is_error_block)
+		{
+			expected.error_block_count++;
+			continue;
+		}
+
+		// Block info does not report the constant color format, so read it from the header
+		if (info.is_constant_block)
+		{
+			if (block[1] & 0x02)
+			{
+				expected.constant_hdr_block_count++;
+			}
+			else
+			{
+				expected.constant_block_count++;
+			}
+
+			continue;
+		}
+
+		expected.block_modes[(block[0] | (block[1] << 8)) & 0x7FF]++;
+		expected.partition_counts[info.partition_count - 1]++;
+		expected.color_quant_modes[get_quant_mode_index(info.color_level_count)]++;
+		expected.weight_quant_modes[get_quant_mode_index(info.weight_level_count)]++;
+		expected.weight_grid_sizes[info.weight_z - 1][info.weight_y - 1][info.weight_x - 1]++;
+
+		for (unsigned int j = 0; j < info.partition_count; j++)
+		{
+			expected.color_endpoint_modes[info.color_endpoint_modes[j]]++;
+		}
+
+		if (info.is_dual_plane_block)
+		{
+			expected.dual_plane_block_count++;
+			expected.dual_plane_components[info.dual_plane_component]++;
+		}
+	}
+
+	astcenc_context_free(context);
+}
+
+/**
+ * @brief Get the statistics of compressed data using several threads.
+ *
+ * @param      context        The codec context.
+ * @param      thread_count   The number of threads, which must match the context.
+ * @param      data           The compressed data.
+ * @param[out] stats          The statistics.
+ */
+static void get_block_stats(
+	astcenc_context* context,
+	unsigned int thread_count,
+	const std::vector<uint8_t>& data,
+	astcenc_block_stats& stats
+) {
+	// Fill with a non-zero pattern to check that the result is cleared first
+	std::memset(&stats, 0x5A, sizeof(stats));
+
+	std::vector<std::thread> workers;
+	std::vector<astcenc_error> worker_status(thread_count, ASTCENC_SUCCESS);
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers.emplace_back([=, &data, &stats, &worker_status]() {
+			worker_status[i] = astcenc_get_block_stats(
+			    context, data.data(), data.size(), &stats, i);
+		});
+	}
+
+	for (unsigned int i = 0; i < thread_count; i++)
+	{
+		workers[i].join();
+		EXPECT_EQ(worker_status[i], ASTCENC_SUCCESS);
+	}
+}
+
+/**
+ * @brief Check that two block statistics structures are identical.
+ *
+ * @param stats      The statistics to check.
+ * @param expected   The expected statistics.
+ */
+static void check_block_stats(
+	const astcenc_block_stats& stats,
+	const astcenc_block_stats& expected
+) {
+	EXPECT_EQ(stats.block_count, expected.block_count);
+	EXPECT_EQ(stats.error_block_count, expected.error_block_count);
+	EXPECT_EQ(stats.constant_block_count, expected.constant_block_count);
+	EXPECT_EQ(stats.constant_hdr_block_count, expected.constant_hdr_block_count);
+	EXPECT_EQ(stats.dual_plane_block_count, expected.dual_plane_block_count);
+
+	// Histograms are compared as a whole, as a mismatch could be in any entry
+	EXPECT_EQ(std::memcmp(&stats, &expected, sizeof(stats)), 0);
+}
+
+/**
+ * @brief Test block statistics with known valid, constant color, and illegal blocks.
+ *
+ * @param flags          The codec config flags.
+ * @param thread_count   The number of threads.
+ */
+static void test_block_stats(
+	unsigned int flags,
+	unsigned int thread_count
+) {
+	KnownBlocks known;
+	std::vector<uint8_t> data = make_compressed_image();
+	size_t block_count = data.size() / 16;
+	astcenc_context* context = make_query_context(flags, thread_count);
+
+	std::unique_ptr<astcenc_block_stats> stats(new astcenc_block_stats);
+	std::unique_ptr<astcenc_block_stats> expected(new astcenc_block_stats);
+
+	// Statistics of compressor output match the per-block queries
+	get_block_stats(context, thread_count, data, *stats);
+	get_expected_block_stats(data, *expected);
+	check_block_stats(*stats, *expected);
+	EXPECT_EQ(stats->block_count, block_count);
+	EXPECT_EQ(stats->error_block_count, 0u);
+
+	uint64_t nonconst_count = block_count - stats->constant_block_count - stats->constant_hdr_block_count;
+	uint64_t partition_total = 0;
+	for (uint64_t count : stats->partition_counts)
+	{
+		partition_total += count;
+	}
+
+	EXPECT_EQ(partition_total, nonconst_count);
+
+	// Replace blocks in the noise region at the end of the image with known encodings
+	uint64_t base_const_count = stats->constant_block_count;
+	uint64_t base_const_hdr_count = stats->constant_hdr_block_count;
+	for (size_t i = block_count - 6; i < block_count; i++)
+	{
+		const uint8_t* block = data.data() + i * 16;
+		ASSERT_NE((block[0] | (block[1] << 8)) & 0x1FF, 0x1FC) << "block " << i;
+	}
+
+	set_block(data, block_count - 6, known.const_ldr);
+	set_block(data, block_count - 5, known.const_hdr);
+	set_block(data, block_count - 4, known.reserved_mode);
+	set_block(data, block_count - 3, known.empty_extent);
+	set_block(data, block_count - 2, known.reserved_extent);
+	set_block(data, block_count - 1, known.dual_plane_4_partitions);
+
+	astcenc_get_block_stats_reset(context);
+	get_block_stats(context, thread_count, data, *stats);
+	get_expected_block_stats(data, *expected);
+	check_block_stats(*stats, *expected);
+	EXPECT_EQ(stats->block_count, block_count);
+	EXPECT_EQ(stats->error_block_count, 4u);
+	EXPECT_EQ(stats->constant_block_count, base_const_count + 1);
+	EXPECT_EQ(stats->constant_hdr_block_count, base_const_hdr_count + 1);
+
+	// Empty data has no blocks
+	astcenc_get_block_stats_reset(context);
+	std::vector<uint8_t> empty;
+	get_block_stats(context, thread_count, empty, *stats);
+	get_expected_block_stats(empty, *expected);
+	check_block_stats(*stats, *expected);
+
+	astcenc_context_free(context);
+}
+
+/** @brief Test single threaded block statistics. */
+TEST(block_stats, SingleThread)
+{
+	test_block_stats(0, 1);
+}
+
+/** @brief Test multi-threaded block statistics. */
+TEST(block_stats, MultiThread)
+{
+	test_block_stats(0, TEST_THREAD_COUNT);
+}
+
+/** @brief Test block statistics with a decompression only context. */
+TEST(block_stats, DecompressOnly)
+{
+	test_block_stats(ASTCENC_FLG_DECOMPRESS_ONLY, TEST_THREAD_COUNT);
+}
+
+/** @brief Test that invalid block statistics requests are rejected. */
+TEST(block_stats, RejectInvalid)
+{
+	std::vector<uint8_t> data(32, 0);
+	std::unique_ptr<astcenc_block_stats> stats(new astcenc_block_stats);
+
+	astcenc_context* context = make_query_context(0, 1);
+	astcenc_error status = astcenc_get_block_stats(context, data.data(), data.size() - 1,
+	                                               stats.get(), 0);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+
+	status = astcenc_get_block_stats(context, data.data(), data.size(), stats.get(), 1);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_PARAM);
+	astcenc_context_free(context);
+
+	// Self decompress only contexts omit legal block modes
+	context = make_query_context(ASTCENC_FLG_SELF_DECOMPRESS_ONLY, 1);
+	status = astcenc_get_block_stats(context, data.data(), data.size(), stats.get(), 0);
+	EXPECT_EQ(status, ASTCENC_ERR_BAD_CONTEXT);
+	astcenc_context_free(context);
+}
+
+}
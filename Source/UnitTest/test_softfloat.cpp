@@ -19,6 +19,8 @@
  * @brief Unit tests for the software half-float library.
  */
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 #include "../astcenc_internal.h"
@@ -63,6 +65,80 @@ TEST(softfloat, FP16NaN)
 	EXPECT_TRUE(std::isnan(result));
 }
 
+/** @brief Get the bit pattern of a float. */
+static uint32_t float_bits(float val)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &val, sizeof(bits));
+	return bits;
+}
+
+/** @brief Test the vector FP16 to float conversion against softfloat for all FP16 values. */
+TEST(softfloat, FP16ToFloatVectorExhaustive)
+{
+	for (int i = 0; i < 65536; i += 4)
+	{
+		vfloat4 result = float16_to_float(vint4(i, i + 1, i + 2, i + 3));
+
+		uint32_t lanes[4] {
+			float_bits(result.lane<0>()),
+			float_bits(result.lane<1>()),
+			float_bits(result.lane<2>()),
+			float_bits(result.lane<3>())
+		};
+
+		for (int j = 0; j < 4; j++)
+		{
+			uint16_t val = static_cast<uint16_t>(i + j);
+			uint32_t expect = float_bits(sf16_to_float(val));
+			EXPECT_EQ(lanes[j], expect) << "fp16 " << std::hex << val;
+			EXPECT_EQ(float_bits(float16_to_float(val)), expect) << "fp16 " << std::hex << val;
+		}
+	}
+}
+
+/**
+ * @brief Test the vector float to FP16 conversion against softfloat.
+ *
+ * This tests every value of the 19 float bits that can survive into an FP16 value, combined with
+ * low mantissa bits either side of the round-to-nearest-even tie point.
+ */
+TEST(softfloat, FloatToFP16VectorExhaustive)
+{
+	static const uint32_t low_bits[8] {
+		0x0000, 0x0001, 0x0FFF, 0x1000, 0x1001, 0x1FFF, 0x0800, 0x1800
+	};
+
+	for (uint32_t i = 0; i < (1u << 19); i++)
+	{
+		for (int j = 0; j < 8; j += 4)
+		{
+			float vals[4];
+			for (int k = 0; k < 4; k++)
+			{
+				uint32_t bits = (i << 13) | low_bits[j + k];
+				std::memcpy(&vals[k], &bits, sizeof(bits));
+			}
+
+			vint4 result = float_to_float16(vfloat4(vals[0], vals[1], vals[2], vals[3]));
+
+			int lanes[4] {
+				result.lane<0>(),
+				result.lane<1>(),
+				result.lane<2>(),
+				result.lane<3>()
+			};
+
+			for (int k = 0; k < 4; k++)
+			{
+				int expect = float_to_sf16(vals[k]);
+				EXPECT_EQ(lanes[k], expect) << "fp32 " << std::hex << float_bits(vals[k]);
+				EXPECT_EQ(float_to_float16(vals[k]), expect) << "fp32 " << std::hex << float_bits(vals[k]);
+			}
+		}
+	}
+}
+
 #endif
 
 }
@@ -34,7 +34,7 @@
  * overheads to be amortized over multiple images, which is particularly important when images are
  * small.
  *
- * Multi-threading can be used two ways.
+ * Multi-threading can be used three ways.
  *
  *     * An application wishing to process multiple images in parallel can allocate multiple
  *       contexts and assign each context to a thread.
@@ -42,6 +42,9 @@
  *       contexts for multi-threaded use, and invoke astcenc_compress/decompress() once per thread
  *       for faster processing. The caller is responsible for creating the worker threads, and
  *       synchronizing between images.
+ *     * An application with its own job system can start a compression job, and let any number of
+ *       its threads call astcenc_compress_run_task() until the job completes. See
+ *       astcenc_compress_begin() for details.
  *
  * Threading
  * =========
@@ -366,6 +369,16 @@ static const unsigned int ASTCENC_FLG_DECOMPRESS_ONLY      = 1 << 4;
  */
 static const unsigned int ASTCENC_FLG_SELF_DECOMPRESS_ONLY = 1 << 5;
 
+/**
+ * @brief Enable the decompressor repeated block cache.
+ *
+ * Images such as texture atlases and tiled textures often contain many identical blocks. This mode
+ * gives each decompression thread a small cache of recently decoded blocks, keyed on the encoded
+ * block data, so repeated blocks are copied rather than decoded again. This uses additional memory
+ * per thread, so it is only worth enabling if the images are expected to contain repeated blocks.
+ */
+static const unsigned int ASTCENC_FLG_USE_DECODE_CACHE     = 1 << 7;
+
 /**
  * @brief The bit mask of all valid flags.
  */
@@ -376,7 +389,17 @@ static const unsigned int ASTCENC_ALL_FLAGS =
                               ASTCENC_FLG_USE_ALPHA_WEIGHT |
                               ASTCENC_FLG_USE_PERCEPTUAL |
                               ASTCENC_FLG_DECOMPRESS_ONLY |
-                              ASTCENC_FLG_SELF_DECOMPRESS_ONLY;
+                              ASTCENC_FLG_SELF_DECOMPRESS_ONLY |
+                              ASTCENC_FLG_USE_DECODE_CACHE;
+
+/**
+ * @brief A callback function pointer type for reporting compression progress.
+ *
+ * The callback is passed the percentage of the current task which has been completed [0-100]. It
+ * may be called from any of the threads taking part in the compression, but calls are serialized
+ * so the callback does not need to be thread-safe.
+ */
+typedef void (*astcenc_progress_callback)(float);
 
 /**
  * @brief The config structure.
@@ -556,6 +579,22 @@ struct astcenc_config
 	 */
 	unsigned int tune_low_weight_count_limit;
 
+	/**
+	 * @brief The rate-distortion optimization lambda (-rdolambda).
+	 *
+	 * When non-zero the compressor trades image quality for better compressibility of the output
+	 * when it is packed with an LZ-style lossless compressor, such as zlib or zstd. Larger values
+	 * give smaller packed sizes and lower image quality. Zero, the default, disables RDO.
+	 */
+	float rdo_lambda;
+
+	/**
+	 * @brief The optional progress callback for progressive compression.
+	 *
+	 * See @c astcenc_compress_image_progressive() for details of when this is called.
+	 */
+	astcenc_progress_callback progress_callback;
+
 #if defined(ASTCENC_DIAGNOSTICS)
 	/**
 	 * @brief The path to save the diagnostic trace data to.
@@ -591,6 +630,42 @@ struct astcenc_image
 	void** data;
 };
 
+/**
+ * @brief The maximum number of candidate encodings that can be returned per block.
+ */
+static const unsigned int ASTCENC_MAX_BLOCK_CANDIDATES = 16;
+
+/**
+ * @brief The size of the header at the start of a split block stream, in bytes.
+ */
+static const unsigned int ASTCENC_BLOCK_STREAM_HEADER_SIZE = 16;
+
+/**
+ * @brief The worst case size of a single block in a split block stream, in bytes.
+ */
+static const unsigned int ASTCENC_BLOCK_STREAM_MAX_BLOCK_SIZE = 20;
+
+/**
+ * @brief A candidate encoding for a single block.
+ *
+ * Candidates are returned by @c astcenc_compress_image_candidates(), and allow an external tool to
+ * pick an alternative encoding for a block without re-running the compressor search.
+ */
+struct astcenc_block_candidate
+{
+	/** @brief The physical ASTC encoded data for the block. */
+	uint8_t data[16];
+
+	/**
+	 * @brief The error of the encoding, or a negative value if this entry is unused.
+	 *
+	 * This is the weighted sum of squared errors used by the compressor search, so it respects the
+	 * error weighting configured in the context. It is only comparable between candidates for the
+	 * same block.
+	 */
+	float error;
+};
+
 /**
  * @brief A block encoding metadata query result.
  *
@@ -666,6 +741,52 @@ struct astcenc_block_info
 	uint8_t partition_assignment[216];
 };
 
+/**
+ * @brief An aggregated block encoding statistics query result.
+ *
+ * Quantization histograms are indexed by the ASTC quantization method index, where index 0 is 2
+ * levels and index 20 is 256 levels, in the same order as the ASTC specification quantization
+ * tables. Histograms for non-constant blocks do not include error or constant color blocks.
+ */
+struct astcenc_block_stats
+{
+	/** @brief The number of blocks. */
+	uint64_t block_count;
+
+	/** @brief The number of error blocks. */
+	uint64_t error_block_count;
+
+	/** @brief The number of UNORM16 constant color blocks. */
+	uint64_t constant_block_count;
+
+	/** @brief The number of FP16 constant color blocks. */
+	uint64_t constant_hdr_block_count;
+
+	/** @brief The number of blocks using two weight planes. */
+	uint64_t dual_plane_block_count;
+
+	/** @brief The block mode histogram, indexed by the 11-bit block mode field. */
+	uint64_t block_modes[2048];
+
+	/** @brief The partition count histogram, indexed by partition count - 1. */
+	uint64_t partition_counts[4];
+
+	/** @brief The color endpoint mode histogram, counting one use per partition. */
+	uint64_t color_endpoint_modes[16];
+
+	/** @brief The color endpoint quantization histogram. */
+	uint64_t color_quant_modes[21];
+
+	/** @brief The weight quantization histogram. */
+	uint64_t weight_quant_modes[12];
+
+	/** @brief The weight grid size histogram, indexed by [z - 1][y - 1][x - 1] grid size. */
+	uint64_t weight_grid_sizes[6][12][12];
+
+	/** @brief The dual plane component histogram. */
+	uint64_t dual_plane_components[4];
+};
+
 /**
  * Populate a codec config based on default settings.
  *
@@ -743,6 +864,191 @@ ASTCENC_PUBLIC astcenc_error astcenc_compress_image(
 	size_t data_len,
 	unsigned int thread_index);
 
+/**
+ * @brief Compress an image, and return the best candidate encodings for each block.
+ *
+ * This behaves like @c astcenc_compress_image(), but also stores the @c candidate_limit lowest
+ * error distinct encodings that the compressor evaluated for each block. Candidates for each block
+ * are stored contiguously in raster block order, sorted by increasing error. Unless rate-distortion
+ * optimization is enabled the first candidate for each block is the encoding written to
+ * @c data_out. Blocks with fewer candidates than @c candidate_limit have their remaining entries
+ * marked as unused.
+ *
+ * Note that the compressor search exits early once a block is good enough, so the number of
+ * candidates available for each block depends on the quality preset and the block content.
+ *
+ * @param         context           Codec context.
+ * @param[in,out] image             An input image, in 2D slices.
+ * @param         swizzle           Compression data swizzle, applied before compression.
+ * @param[out]    data_out          Pointer to output data array.
+ * @param         data_len          Length of the output data array.
+ * @param[out]    candidates_out    Pointer to output candidate array.
+ * @param         candidates_len    Length of the output candidate array, in entries.
+ * @param         candidate_limit   The number of candidates per block [1..ASTCENC_MAX_BLOCK_CANDIDATES].
+ * @param         thread_index      Thread index [0..N-1] of calling thread.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_compress_image_candidates(
+	astcenc_context* context,
+	astcenc_image* image,
+	const astcenc_swizzle* swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	astcenc_block_candidate* candidates_out,
+	size_t candidates_len,
+	unsigned int candidate_limit,
+	unsigned int thread_index);
+
+/**
+ * @brief Compress an image progressively.
+ *
+ * This is intended for interactive use, where a usable result is needed quickly. Compression is
+ * split into two passes:
+ *
+ *     * An initial pass encodes every block using the search effort of the fastest preset.
+ *     * A refinement pass re-encodes blocks using the search effort of the context config, in
+ *       order of decreasing initial error, and replaces the initial encoding if it improved.
+ *       Blocks whose initial encoding already meets the quality target of the context config are
+ *       not re-encoded.
+ *
+ * If a progress callback is set in the context config, it is called with a value of zero once the
+ * initial pass is complete and the output array holds a usable image. It is then called as the
+ * refinement pass proceeds, ending with a value of 100 once compression is complete.
+ *
+ * Refined blocks are written to the output array in batches, and never while the progress callback
+ * is running. The callback may therefore read the output array, for example to copy it for
+ * display, and will see a valid image in which each block holds either its initial or its refined
+ * encoding. The output array must not be read by other threads while this function is running,
+ * as that is a data race with the refinement pass.
+ *
+ * Multi-threaded use follows the same model as @c astcenc_compress_image(), and the context must
+ * be reset with @c astcenc_compress_reset() between images. Rate-distortion optimization is not
+ * applied by this function.
+ *
+ * @param         context        Codec context.
+ * @param[in,out] image          An input image, in 2D slices.
+ * @param         swizzle        Compression data swizzle, applied before compression.
+ * @param[out]    data_out       Pointer to output data array.
+ * @param         data_len       Length of the output data array.
+ * @param         thread_index   Thread index [0..N-1] of calling thread.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_compress_image_progressive(
+	astcenc_context* context,
+	astcenc_image* image,
+	const astcenc_swizzle* swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index);
+
+/**
+ * @brief Compress an image to several block sizes in a single job.
+ *
+ * This behaves like calling @c astcenc_compress_image() once per context, but the input image
+ * averages and variances needed by the error weighting configuration are computed once and shared
+ * by all contexts, and the calling threads stay in the function until all outputs are complete.
+ *
+ * Each context is typically configured with a different block size. All contexts must have the
+ * same thread count and must use the same averages and variances configuration; the
+ * @c v_rgba_radius, @c v_rgb_power, @c v_a_power, and @c a_scale_radius settings must match,
+ * and either all or none of the contexts must use the mean and standard deviation weights.
+ *
+ * Multi-threaded use follows the same model as @c astcenc_compress_image(), and every context must
+ * be reset with @c astcenc_compress_reset() between images.
+ *
+ * @param         contexts        Codec contexts, one per output.
+ * @param         context_count   The number of contexts.
+ * @param[in,out] image           An input image, in 2D slices.
+ * @param         swizzle         Compression data swizzle, applied before compression.
+ * @param[out]    data_out        Pointers to output data arrays, one per context.
+ * @param         data_len        Lengths of the output data arrays, one per context.
+ * @param         thread_index    Thread index [0..N-1] of calling thread.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if compression failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_compress_image_multi(
+	astcenc_context** contexts,
+	unsigned int context_count,
+	astcenc_image* image,
+	const astcenc_swizzle* swizzle,
+	uint8_t** data_out,
+	const size_t* data_len,
+	unsigned int thread_index);
+
+/**
+ * @brief Start a job based compression of an image.
+ *
+ * Job based compression is an alternative to @c astcenc_compress_image() for hosts with their own
+ * task scheduler, such as a job system or fiber scheduler. It does not need a fixed set of threads
+ * with unique thread indices. After this call any number of threads may call
+ * @c astcenc_compress_run_task() repeatedly, joining and leaving the job at any time. Each call
+ * runs a single small task, using a scratch buffer checked out from a pool owned by the context.
+ * The context thread count sets the pool size, which bounds the number of threads that can run
+ * tasks concurrently.
+ *
+ * This must be called by a single thread, and the caller must then call @c astcenc_compress_end()
+ * once. The context must not be used for any other compression until the job has ended. The image
+ * and output array must remain valid until the job has ended.
+ *
+ * Job based compression does not support rate-distortion optimization. Each RDO task waits for
+ * the tasks of the previous block row to complete, which can deadlock a scheduler that suspends
+ * tasks, so configs with a non-zero @c rdo_lambda are rejected.
+ *
+ * @param         context    Codec context.
+ * @param[in]     image      An input image, in 2D slices.
+ * @param         swizzle    Compression data swizzle, applied before compression.
+ * @param[out]    data_out   Pointer to output data array.
+ * @param         data_len   Length of the output data array.
+ *
+ * @return @c ASTCENC_SUCCESS on success, @c ASTCENC_ERR_BAD_PARAM if the config uses RDO, or an
+ *         error if the job could not be started.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_compress_begin(
+	astcenc_context* context,
+	const astcenc_image* image,
+	const astcenc_swizzle* swizzle,
+	uint8_t* data_out,
+	size_t data_len);
+
+/**
+ * @brief Run one task of a job based compression.
+ *
+ * This can be called by any thread, at any time between @c astcenc_compress_begin() and
+ * @c astcenc_compress_end(). A call may run no task if all of the scratch buffers are in use, or
+ * if the tasks that are available are waiting on tasks still running on other threads.
+ *
+ * Calls may also run concurrently with @c astcenc_compress_end(), which waits for all calls that
+ * are in flight to return before it frees the job state. A call that starts after the job has
+ * ended runs no task and reports the job as complete, so worker threads can stop calling this as
+ * soon as it sets @c job_complete, without further synchronization with the thread that ends the
+ * job. Calls must not overlap with the @c astcenc_compress_begin() of the next job.
+ *
+ * @param         context        Codec context.
+ * @param[out]    job_complete   Set to 1 if all tasks in the job have completed, 0 otherwise.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if the task failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_compress_run_task(
+	astcenc_context* context,
+	int* job_complete);
+
+/**
+ * @brief End a job based compression of an image.
+ *
+ * This must be called by a single thread. The calling thread runs any tasks that remain, and then
+ * waits for all @c astcenc_compress_run_task() calls still in flight on other threads to return
+ * before freeing the job state. The output array holds the compressed image once this returns.
+ *
+ * @param context   Codec context.
+ *
+ * @return @c ASTCENC_SUCCESS on success, @c ASTCENC_ERR_BAD_PARAM if no job is active, or an error
+ *         if compression failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_compress_end(
+	astcenc_context* context);
+
 /**
  * @brief Reset the codec state for a new compression.
  *
@@ -822,6 +1128,162 @@ ASTCENC_PUBLIC astcenc_error astcenc_get_block_info(
 	const uint8_t data[16],
 	astcenc_block_info* info);
 
+/**
+ * @brief Validate compressed data without decompressing it.
+ *
+ * This checks that every block is a legal encoding for the context block size, which includes the
+ * block mode, the partition and color endpoint mode combination, and the bit budget for the color
+ * endpoints. Contexts using an LDR profile also reject FLOAT16 constant color blocks and blocks
+ * using HDR color endpoint modes, which LDR decoders do not support. Only the block headers are
+ * decoded, so this is much faster than a full decompression. Blocks that fail validation would
+ * decode as the error color.
+ *
+ * This can be called from multiple threads, in the same way as @c astcenc_decompress_image(). Each
+ * call returns after all threads have finished, so the error count is the total for the data. The
+ * indices of error blocks are stored in no particular order when using multiple threads.
+ *
+ * Contexts created with @c ASTCENC_FLG_SELF_DECOMPRESS_ONLY do not support validation, as they
+ * omit block modes that are legal but which are not used by this compressor.
+ *
+ * @param         context            Codec context.
+ * @param[in]     data               Pointer to compressed data.
+ * @param         data_len           Length of the compressed data, in bytes; must be a multiple
+ *                                   of 16.
+ * @param[out]    error_blocks       Optional output array for the indices of error blocks.
+ * @param         error_blocks_len   The number of entries in @c error_blocks.
+ * @param[out]    error_count        The total number of error blocks found.
+ * @param         thread_index       Thread index [0..N-1] of calling thread.
+ *
+ * @return @c ASTCENC_SUCCESS if validation ran, or an error if validation failed. Note that this
+ *         returns success even if error blocks were found.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_validate_blocks(
+	astcenc_context* context,
+	const uint8_t* data,
+	size_t data_len,
+	size_t* error_blocks,
+	size_t error_blocks_len,
+	size_t* error_count,
+	unsigned int thread_index);
+
+/**
+ * @brief Reset the codec state for a new validation.
+ *
+ * The caller is responsible for synchronizing threads in the worker thread pool. This function must
+ * only be called when all threads have exited the @c astcenc_validate_blocks() function for data
+ * N, but before any thread enters it for data N + 1.
+ *
+ * Calling this is not required (but won't hurt), if the context is created for single threaded use.
+ *
+ * @param context   Codec context.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if reset failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_validate_reset(
+	astcenc_context* context);
+
+/**
+ * @brief Provide aggregated statistics of the block encodings in compressed data.
+ *
+ * Only the block headers are decoded, so this is much faster than calling
+ * @c astcenc_get_block_info() for each block.
+ *
+ * This can be called from multiple threads, in the same way as @c astcenc_decompress_image(). All
+ * threads must pass the same @c stats structure. Each call returns after all threads have
+ * finished, so the statistics are complete for the data.
+ *
+ * Contexts created with @c ASTCENC_FLG_SELF_DECOMPRESS_ONLY do not support statistics queries, as
+ * they omit block modes that are legal but which are not used by this compressor.
+ *
+ * @param      context        Codec context.
+ * @param[in]  data           Pointer to compressed data.
+ * @param      data_len       Length of the compressed data, in bytes; must be a multiple of 16.
+ * @param[out] stats          The output statistics structure to populate.
+ * @param      thread_index   Thread index [0..N-1] of calling thread.
+ *
+ * @return @c ASTCENC_SUCCESS if the statistics were gathered, or an error otherwise.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_get_block_stats(
+	astcenc_context* context,
+	const uint8_t* data,
+	size_t data_len,
+	astcenc_block_stats* stats,
+	unsigned int thread_index);
+
+/**
+ * @brief Reset the codec state for a new statistics query.
+ *
+ * The caller is responsible for synchronizing threads in the worker thread pool. This function must
+ * only be called when all threads have exited the @c astcenc_get_block_stats() function for data
+ * N, but before any thread enters it for data N + 1.
+ *
+ * Calling this is not required (but won't hurt), if the context is created for single threaded use.
+ *
+ * @param context   Codec context.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if reset failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_get_block_stats_reset(
+	astcenc_context* context);
+
+/**
+ * @brief Split compressed image data into separate streams for each block field.
+ *
+ * ASTC blocks interleave the block mode, partition index, endpoint, and weight fields in a single
+ * 128-bit word, which compresses poorly with general purpose lossless compressors. This function
+ * applies a reversible transform which splits the blocks into a stream per field. The result is
+ * typically a few percent smaller after compression with LZ77-style compressors such as deflate,
+ * but may be larger with compressors that model the 16 byte block structure, such as LZMA. The
+ * original data can be restored bit-exactly by calling @c astcenc_block_stream_merge().
+ *
+ * This function does not need a codec context, and can be called from any thread.
+ *
+ * @param         block_x      The block x dimension of the compressed data.
+ * @param         block_y      The block y dimension of the compressed data.
+ * @param         block_z      The block z dimension of the compressed data.
+ * @param         data         The compressed image data.
+ * @param         data_len     The length of the compressed image data, in bytes.
+ * @param[out]    stream_out   The output stream buffer.
+ * @param[in,out] stream_len   On input the length of the output buffer, on output the number of
+ *                             bytes written. A buffer of @c ASTCENC_BLOCK_STREAM_HEADER_SIZE bytes
+ *                             plus @c ASTCENC_BLOCK_STREAM_MAX_BLOCK_SIZE bytes per block is always
+ *                             sufficient.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if the transform failed.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_block_stream_split(
+	unsigned int block_x,
+	unsigned int block_y,
+	unsigned int block_z,
+	const uint8_t* data,
+	size_t data_len,
+	uint8_t* stream_out,
+	size_t* stream_len);
+
+/**
+ * @brief Restore compressed image data from a split block stream.
+ *
+ * @param      block_x      The block x dimension of the compressed data.
+ * @param      block_y      The block y dimension of the compressed data.
+ * @param      block_z      The block z dimension of the compressed data.
+ * @param      stream       The split block stream, as created by @c astcenc_block_stream_split().
+ * @param      stream_len   The length of the split block stream, in bytes.
+ * @param[out] data_out     The output compressed image data.
+ * @param      data_len     The length of the output data array, which must be the same as the
+ *                          length of the original compressed image data.
+ *
+ * @return @c ASTCENC_SUCCESS on success, or an error if the stream is corrupt or does not match
+ *         the output data length.
+ */
+ASTCENC_PUBLIC astcenc_error astcenc_block_stream_merge(
+	unsigned int block_x,
+	unsigned int block_y,
+	unsigned int block_z,
+	const uint8_t* stream,
+	size_t stream_len,
+	uint8_t* data_out,
+	size_t data_len);
+
 /**
  * @brief Get a printable string for specific status code.
  *
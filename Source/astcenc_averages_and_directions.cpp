@@ -24,21 +24,23 @@
 
 #include <cassert>
 
-/* See header for documentation. */
-void compute_avgs_and_dirs_4_comp(
+/**
+ * @brief Compute the averages and dominant directions for each partition in a 4 component texture.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
+ * See @c compute_avgs_and_dirs_4_comp() for the parameter documentation.
+ */
+template<unsigned int PARTITION_COUNT>
+static void compute_avgs_and_dirs_4_comp_partitions(
 	const partition_info& pi,
 	const image_block& blk,
 	const error_weight_block& ewb,
 	partition_metrics pm[BLOCK_MAX_PARTITIONS]
 ) {
 	// TODO: Candidate for 4-group counting
-	int partition_count = pi.partition_count;
-	promise(partition_count > 0);
-
-	for (int partition = 0; partition < partition_count; partition++)
+	for (unsigned int partition = 0; partition < PARTITION_COUNT; partition++)
 	{
-		const uint8_t *texel_indexes = pi.texels_of_partition[partition];
-
 		vfloat4 error_sum = vfloat4::zero();
 		vfloat4 base_sum = vfloat4::zero();
 		float partition_weight = 0.0f;
@@ -48,7 +50,7 @@ void compute_avgs_and_dirs_4_comp(
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = ewb.texel_weight[iwt];
 			vfloat4 texel_datum = blk.texel(iwt);
 			vfloat4 error_weight = ewb.error_weights[iwt];
@@ -75,7 +77,7 @@ void compute_avgs_and_dirs_4_comp(
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			unsigned int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = ewb.texel_weight[iwt];
 			vfloat4 texel_datum = blk.texel(iwt);
 			texel_datum = (texel_datum - average) * weight;
@@ -125,7 +127,39 @@ void compute_avgs_and_dirs_4_comp(
 }
 
 /* See header for documentation. */
-void compute_avgs_and_dirs_3_comp(
+void compute_avgs_and_dirs_4_comp(
+	const partition_info& pi,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	partition_metrics pm[BLOCK_MAX_PARTITIONS]
+) {
+	switch (pi.partition_count)
+	{
+	case 1:
+		compute_avgs_and_dirs_4_comp_partitions<1>(pi, blk, ewb, pm);
+		break;
+	case 2:
+		compute_avgs_and_dirs_4_comp_partitions<2>(pi, blk, ewb, pm);
+		break;
+	case 3:
+		compute_avgs_and_dirs_4_comp_partitions<3>(pi, blk, ewb, pm);
+		break;
+	default:
+		assert(pi.partition_count == 4);
+		compute_avgs_and_dirs_4_comp_partitions<4>(pi, blk, ewb, pm);
+		break;
+	}
+}
+
+/**
+ * @brief Compute the averages and dominant directions for each partition in a 3 component texture.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
+ * See @c compute_avgs_and_dirs_3_comp() for the parameter documentation.
+ */
+template<unsigned int PARTITION_COUNT>
+static void compute_avgs_and_dirs_3_comp_partitions(
 	const partition_info& pi,
 	const image_block& blk,
 	const error_weight_block& ewb,
@@ -174,13 +208,8 @@ void compute_avgs_and_dirs_3_comp(
 		error_vb = ewb.texel_weight_a;
 	}
 
-	unsigned int partition_count = pi.partition_count;
-	promise(partition_count > 0);
-
-	for (unsigned int partition = 0; partition < partition_count; partition++)
+	for (unsigned int partition = 0; partition < PARTITION_COUNT; partition++)
 	{
-		const uint8_t *texel_indexes = pi.texels_of_partition[partition];
-
 		vfloat4 error_sum = vfloat4::zero();
 		vfloat4 base_sum = vfloat4::zero();
 		float partition_weight = 0.0f;
@@ -190,7 +219,7 @@ void compute_avgs_and_dirs_3_comp(
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			unsigned int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = texel_weights[iwt];
 
 			vfloat4 texel_datum(data_vr[iwt],
@@ -224,7 +253,7 @@ void compute_avgs_and_dirs_3_comp(
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			unsigned int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = texel_weights[iwt];
 
 			vfloat4 texel_datum = vfloat3(data_vr[iwt],
@@ -268,20 +297,48 @@ void compute_avgs_and_dirs_3_comp(
 }
 
 /* See header for documentation. */
-void compute_avgs_and_dirs_3_comp_rgb(
+void compute_avgs_and_dirs_3_comp(
 	const partition_info& pi,
 	const image_block& blk,
 	const error_weight_block& ewb,
+	unsigned int omitted_component,
 	partition_metrics pm[BLOCK_MAX_PARTITIONS]
 ) {
-	// TODO: Candidate for 4-group counting
-	unsigned int partition_count = pi.partition_count;
-	promise(partition_count > 0);
-
-	for (unsigned int partition = 0; partition < partition_count; partition++)
+	switch (pi.partition_count)
 	{
-		const uint8_t *texel_indexes = pi.texels_of_partition[partition];
+	case 1:
+		compute_avgs_and_dirs_3_comp_partitions<1>(pi, blk, ewb, omitted_component, pm);
+		break;
+	case 2:
+		compute_avgs_and_dirs_3_comp_partitions<2>(pi, blk, ewb, omitted_component, pm);
+		break;
+	case 3:
+		compute_avgs_and_dirs_3_comp_partitions<3>(pi, blk, ewb, omitted_component, pm);
+		break;
+	default:
+		assert(pi.partition_count == 4);
+		compute_avgs_and_dirs_3_comp_partitions<4>(pi, blk, ewb, omitted_component, pm);
+		break;
+	}
+}
 
+/**
+ * @brief Compute the averages and dominant directions for each partition in an RGB texture.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
+ * See @c compute_avgs_and_dirs_3_comp_rgb() for the parameter documentation.
+ */
+template<unsigned int PARTITION_COUNT>
+static void compute_avgs_and_dirs_3_comp_rgb_partitions(
+	const partition_info& pi,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	partition_metrics pm[BLOCK_MAX_PARTITIONS]
+) {
+	// TODO: Candidate for 4-group counting
+	for (unsigned int partition = 0; partition < PARTITION_COUNT; partition++)
+	{
 		vfloat4 error_sum = vfloat4::zero();
 		vfloat4 base_sum = vfloat4::zero();
 		float partition_weight = 0.0f;
@@ -291,7 +348,7 @@ void compute_avgs_and_dirs_3_comp_rgb(
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			unsigned int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = ewb.texel_weight_rgb[iwt];
 
 			vfloat4 texel_datum = blk.texel3(iwt);
@@ -322,7 +379,7 @@ void compute_avgs_and_dirs_3_comp_rgb(
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			unsigned int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = ewb.texel_weight_rgb[iwt];
 
 			vfloat4 texel_datum = blk.texel3(iwt);
@@ -364,8 +421,40 @@ void compute_avgs_and_dirs_3_comp_rgb(
 }
 
 /* See header for documentation. */
-void compute_avgs_and_dirs_2_comp(
-	const partition_info& pt,
+void compute_avgs_and_dirs_3_comp_rgb(
+	const partition_info& pi,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	partition_metrics pm[BLOCK_MAX_PARTITIONS]
+) {
+	switch (pi.partition_count)
+	{
+	case 1:
+		compute_avgs_and_dirs_3_comp_rgb_partitions<1>(pi, blk, ewb, pm);
+		break;
+	case 2:
+		compute_avgs_and_dirs_3_comp_rgb_partitions<2>(pi, blk, ewb, pm);
+		break;
+	case 3:
+		compute_avgs_and_dirs_3_comp_rgb_partitions<3>(pi, blk, ewb, pm);
+		break;
+	default:
+		assert(pi.partition_count == 4);
+		compute_avgs_and_dirs_3_comp_rgb_partitions<4>(pi, blk, ewb, pm);
+		break;
+	}
+}
+
+/**
+ * @brief Compute the averages and dominant directions for each partition in a 2 component texture.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
+ * See @c compute_avgs_and_dirs_2_comp() for the parameter documentation.
+ */
+template<unsigned int PARTITION_COUNT>
+static void compute_avgs_and_dirs_2_comp_partitions(
+	const partition_info& pi,
 	const image_block& blk,
 	const error_weight_block& ewb,
 	unsigned int component1,
@@ -380,7 +469,27 @@ void compute_avgs_and_dirs_2_comp(
 	const float* error_vr = nullptr;
 	const float* error_vg = nullptr;
 
-	if (component1 == 0 && component2 == 1)
+	vfloat4 error_scale(1.0f);
+	float color_scale_length = 1.41421356f;
+	bool scale_dir = false;
+
+	if (component1 == 0 && component2 == 3)
+	{
+		// Luminance-alpha, using red as the luminance channel. Luminance error applies to all three
+		// RGB channels, so scale the color space as if all four components were present
+		texel_weights = ewb.texel_weight;
+
+		data_vr = blk.data_r;
+		data_vg = blk.data_a;
+
+		error_vr = ewb.texel_weight_rgb;
+		error_vg = ewb.texel_weight_a;
+
+		error_scale = vfloat2(3.0f, 1.0f);
+		color_scale_length = 2.0f;
+		scale_dir = true;
+	}
+	else if (component1 == 0 && component2 == 1)
 	{
 		texel_weights = ewb.texel_weight_rg;
 
@@ -412,23 +521,18 @@ void compute_avgs_and_dirs_2_comp(
 		error_vg = ewb.texel_weight_b;
 	}
 
-	unsigned int partition_count = pt.partition_count;
-	promise(partition_count > 0);
-
-	for (unsigned int partition = 0; partition < partition_count; partition++)
+	for (unsigned int partition = 0; partition < PARTITION_COUNT; partition++)
 	{
-		const uint8_t *texel_indexes = pt.texels_of_partition[partition];
-
 		vfloat4 error_sum = vfloat4::zero();
 		vfloat4 base_sum = vfloat4::zero();
 		float partition_weight = 0.0f;
 
-		unsigned int texel_count = pt.partition_texel_count[partition];
+		unsigned int texel_count = pi.partition_texel_count[partition];
 		promise(texel_count > 0);
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			unsigned int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = texel_weights[iwt];
 			vfloat4 texel_datum = vfloat2(data_vr[iwt], data_vg[iwt]) * weight;
 
@@ -439,8 +543,8 @@ void compute_avgs_and_dirs_2_comp(
 			error_sum += error_weight;
 		}
 
-		error_sum = error_sum / static_cast<float>(texel_count);
-		vfloat4 csf = normalize(sqrt(error_sum)) * 1.41421356f;
+		error_sum = (error_sum * error_scale) / static_cast<float>(texel_count);
+		vfloat4 csf = normalize(sqrt(error_sum)) * color_scale_length;
 		vfloat4 average = base_sum * (1.0f / astc::max(partition_weight, 1e-7f));
 
 
@@ -448,13 +552,14 @@ void compute_avgs_and_dirs_2_comp(
 		pm[partition].avg = average * csf;
 		pm[partition].color_scale = csf;
 		pm[partition].icolor_scale = 1.0f / max(csf, 1e-7f);
+		vfloat4 dir_scale = scale_dir ? csf : vfloat4(1.0f);
 
 		vfloat4 sum_xp = vfloat4::zero();
 		vfloat4 sum_yp = vfloat4::zero();
 
 		for (unsigned int i = 0; i < texel_count; i++)
 		{
-			unsigned int iwt = texel_indexes[i];
+			unsigned int iwt = get_partition_texel<PARTITION_COUNT>(pi, partition, i);
 			float weight = texel_weights[iwt];
 			vfloat4 texel_datum = vfloat2(data_vr[iwt], data_vg[iwt]);
 			texel_datum = (texel_datum - average) * weight;
@@ -479,7 +584,34 @@ void compute_avgs_and_dirs_2_comp(
 			best_vector = sum_yp;
 		}
 
-		pm[partition].dir = best_vector;
+		pm[partition].dir = best_vector * dir_scale;
+	}
+}
+
+/* See header for documentation. */
+void compute_avgs_and_dirs_2_comp(
+	const partition_info& pi,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	unsigned int component1,
+	unsigned int component2,
+	partition_metrics pm[BLOCK_MAX_PARTITIONS]
+) {
+	switch (pi.partition_count)
+	{
+	case 1:
+		compute_avgs_and_dirs_2_comp_partitions<1>(pi, blk, ewb, component1, component2, pm);
+		break;
+	case 2:
+		compute_avgs_and_dirs_2_comp_partitions<2>(pi, blk, ewb, component1, component2, pm);
+		break;
+	case 3:
+		compute_avgs_and_dirs_2_comp_partitions<3>(pi, blk, ewb, component1, component2, pm);
+		break;
+	default:
+		assert(pi.partition_count == 4);
+		compute_avgs_and_dirs_2_comp_partitions<4>(pi, blk, ewb, component1, component2, pm);
+		break;
 	}
 }
 
@@ -492,6 +624,8 @@ void compute_error_squared_rgba(
 	const processed_line4 samec_plines[BLOCK_MAX_PARTITIONS],
 	float uncor_lengths[BLOCK_MAX_PARTITIONS],
 	float samec_lengths[BLOCK_MAX_PARTITIONS],
+	float uncor_limit,
+	float samec_limit,
 	float& uncor_error,
 	float& samec_error
 ) {
@@ -553,6 +687,13 @@ void compute_error_squared_rgba(
 		vfloat samec_hiparamv(-1e10f);
 		vfloat4 samec_errorsumv = vfloat4::zero();
 
+		// Uniform weighted blocks can skip the per-texel error weight gathers
+		bool is_uniform = ewb.is_uniform;
+		vfloat uniform_ew_r(ewb.uniform_error_weight.lane<0>());
+		vfloat uniform_ew_g(ewb.uniform_error_weight.lane<1>());
+		vfloat uniform_ew_b(ewb.uniform_error_weight.lane<2>());
+		vfloat uniform_ew_a(ewb.uniform_error_weight.lane<3>());
+
 		// This implementation over-shoots, but this is safe as we initialize the texel_indexes
 		// array to extend the last value. This means min/max are not impacted, but we need to mask
 		// out the dummy values when we compute the line weighting.
@@ -567,10 +708,18 @@ void compute_error_squared_rgba(
 			vfloat data_b = gatherf(blk.data_b, texel_idxs);
 			vfloat data_a = gatherf(blk.data_a, texel_idxs);
 
-			vfloat ew_r = gatherf(ewb.texel_weight_r, texel_idxs);
-			vfloat ew_g = gatherf(ewb.texel_weight_g, texel_idxs);
-			vfloat ew_b = gatherf(ewb.texel_weight_b, texel_idxs);
-			vfloat ew_a = gatherf(ewb.texel_weight_a, texel_idxs);
+			vfloat ew_r = uniform_ew_r;
+			vfloat ew_g = uniform_ew_g;
+			vfloat ew_b = uniform_ew_b;
+			vfloat ew_a = uniform_ew_a;
+
+			if (!is_uniform)
+			{
+				ew_r = gatherf(ewb.texel_weight_r, texel_idxs);
+				ew_g = gatherf(ewb.texel_weight_g, texel_idxs);
+				ew_b = gatherf(ewb.texel_weight_b, texel_idxs);
+				ew_a = gatherf(ewb.texel_weight_a, texel_idxs);
+			}
 
 			vfloat uncor_param  = (data_r * l_uncor_bs0)
 			                    + (data_g * l_uncor_bs1)
@@ -638,6 +787,12 @@ void compute_error_squared_rgba(
 		// Turn very small numbers and NaNs into a small number
 		uncor_lengths[partition] = astc::max(uncor_linelen, 1e-7f);
 		samec_lengths[partition] = astc::max(samec_linelen, 1e-7f);
+
+		// The errors only grow, so stop once this partitioning cannot be selected
+		if (uncor_error >= uncor_limit && samec_error >= samec_limit)
+		{
+			break;
+		}
 	}
 }
 
@@ -647,6 +802,8 @@ void compute_error_squared_rgb(
 	const image_block& blk,
 	const error_weight_block& ewb,
 	partition_lines3 plines[BLOCK_MAX_PARTITIONS],
+	float uncor_limit,
+	float samec_limit,
 	float& uncor_error,
 	float& samec_error
 ) {
@@ -707,6 +864,12 @@ void compute_error_squared_rgb(
 		vfloat samec_hiparamv(-1e10f);
 		vfloat4 samec_errorsumv = vfloat4::zero();
 
+		// Uniform weighted blocks can skip the per-texel error weight gathers
+		bool is_uniform = ewb.is_uniform;
+		vfloat uniform_ew_r(ewb.uniform_error_weight.lane<0>());
+		vfloat uniform_ew_g(ewb.uniform_error_weight.lane<1>());
+		vfloat uniform_ew_b(ewb.uniform_error_weight.lane<2>());
+
 		// This implementation over-shoots, but this is safe as we initialize the weights array
 		// to extend the last value. This means min/max are not impacted, but we need to mask
 		// out the dummy values when we compute the line weighting.
@@ -720,9 +883,16 @@ void compute_error_squared_rgb(
 			vfloat data_g = gatherf(blk.data_g, texel_idxs);
 			vfloat data_b = gatherf(blk.data_b, texel_idxs);
 
-			vfloat ew_r = gatherf(ewb.texel_weight_r, texel_idxs);
-			vfloat ew_g = gatherf(ewb.texel_weight_g, texel_idxs);
-			vfloat ew_b = gatherf(ewb.texel_weight_b, texel_idxs);
+			vfloat ew_r = uniform_ew_r;
+			vfloat ew_g = uniform_ew_g;
+			vfloat ew_b = uniform_ew_b;
+
+			if (!is_uniform)
+			{
+				ew_r = gatherf(ewb.texel_weight_r, texel_idxs);
+				ew_g = gatherf(ewb.texel_weight_g, texel_idxs);
+				ew_b = gatherf(ewb.texel_weight_b, texel_idxs);
+			}
 
 			vfloat uncor_param  = (data_r * l_uncor_bs0)
 			                    + (data_g * l_uncor_bs1)
@@ -784,6 +954,12 @@ void compute_error_squared_rgb(
 		// Turn very small numbers and NaNs into a small number
 		pl.uncor_line_len = astc::max(uncor_linelen, 1e-7f);
 		pl.samec_line_len = astc::max(samec_linelen, 1e-7f);
+
+		// The errors only grow, so stop once this partitioning cannot be selected
+		if (uncor_error >= uncor_limit && samec_error >= samec_limit)
+		{
+			break;
+		}
 	}
 }
 
@@ -235,6 +235,36 @@ static bool decode_block_mode_3d(
 	        weight_bits <= BLOCK_MAX_WEIGHT_BITS);
 }
 
+/* See header for documentation. */
+unsigned int get_block_mode_weight_bits(
+	bool is_3d,
+	unsigned int block_mode
+) {
+	unsigned int x_weights;
+	unsigned int y_weights;
+	unsigned int z_weights = 1;
+	bool is_dual_plane;
+	unsigned int quant_mode;
+
+	bool valid;
+	if (is_3d)
+	{
+		valid = decode_block_mode_3d(block_mode, x_weights, y_weights, z_weights, is_dual_plane, quant_mode);
+	}
+	else
+	{
+		valid = decode_block_mode_2d(block_mode, x_weights, y_weights, is_dual_plane, quant_mode);
+	}
+
+	if (!valid)
+	{
+		return 0;
+	}
+
+	unsigned int weight_count = x_weights * y_weights * z_weights * (is_dual_plane ? 2 : 1);
+	return get_ise_sequence_bitcount(weight_count, static_cast<quant_method>(quant_mode));
+}
+
 /**
  * @brief Create a 2D decimation entry for a block-size and weight-decimation pair.
  *
@@ -1121,6 +1151,7 @@ void init_block_size_descriptor(
 	unsigned int z_texels,
 	bool can_omit_modes,
 	float mode_cutoff,
+	bool lazy_partitions,
 	block_size_descriptor& bsd
 ) {
 	if (z_texels > 1)
@@ -1132,7 +1163,7 @@ void init_block_size_descriptor(
 		construct_block_size_descriptor_2d(x_texels, y_texels, can_omit_modes, mode_cutoff, bsd);
 	}
 
-	init_partition_tables(bsd);
+	init_partition_tables(bsd, lazy_partitions);
 }
 
 /* See header for documentation. */
@@ -1143,4 +1174,6 @@ void term_block_size_descriptor(
 	{
 		aligned_free<const decimation_info>(bsd.decimation_tables[i]);
 	}
+
+	delete[] bsd.partition_build_state;
 }
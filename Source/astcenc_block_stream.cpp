@@ -0,0 +1,504 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Functions for the lossless split block stream transform.
+ *
+ * Each block is split into four fields, which are written to separate streams:
+ *
+ *     * Mode: bits [0, 13), the block mode and partition count, stored as 2 bytes.
+ *     * Partition: bits [13, 23), the partition index, stored as 2 bytes. Only present for valid
+ *       block modes with more than one partition.
+ *     * Endpoint: the bits between the mode or partition field and the weight field, which store
+ *       the color endpoint modes and endpoint colors. Stored as a whole number of bytes.
+ *     * Weight: the weight bits at the top of the block, bit reversed back into stream order and
+ *       stored as a whole number of bytes.
+ *
+ * The field layout of a block only depends on the mode field, so the inverse transform can
+ * recover the layout of each block as it goes. Void-extent blocks and blocks with reserved block
+ * modes have no partition or weight field, so their bits are stored in the endpoint stream. The
+ * transform is therefore lossless for arbitrary input data, including invalid encodings.
+ *
+ * Note that the endpoints are not delta coded against neighboring blocks. The endpoint colors are
+ * stored using bit-packed integer sequence encoding, so neither XOR coding of the packed bits or
+ * delta coding of the unpacked color values improved the size after lossless compression.
+ */
+
+#include "astcenc_internal.h"
+
+#include <cstring>
+
+/**
+ * @brief The number of bits in the mode field.
+ */
+static constexpr unsigned int MODE_FIELD_BITS { 13 };
+
+/**
+ * @brief The number of bits in the mode field and the partition field.
+ */
+static constexpr unsigned int PARTITION_FIELD_END { 23 };
+
+/**
+ * @brief The number of streams in a split block stream.
+ */
+static constexpr unsigned int STREAM_COUNT { 4 };
+
+/**
+ * @brief A 128-bit physical block, stored as two 64-bit halves.
+ */
+struct block_bits
+{
+	/** @brief Bits [0, 64) of the block. */
+	uint64_t lo;
+
+	/** @brief Bits [64, 128) of the block. */
+	uint64_t hi;
+};
+
+/**
+ * @brief The field layout of a single block.
+ */
+struct block_layout
+{
+	/** @brief The first bit of the endpoint field. */
+	unsigned int endpoint_start;
+
+	/** @brief The number of bits in the endpoint field. */
+	unsigned int endpoint_bits;
+
+	/** @brief The number of bits in the weight field. */
+	unsigned int weight_bits;
+};
+
+/**
+ * @brief Load a physical block from memory.
+ *
+ * @param data   The 16 bytes of block data.
+ *
+ * @return The loaded block.
+ */
+static block_bits load_block(
+	const uint8_t* data
+) {
+	block_bits bits { 0, 0 };
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		bits.lo |= static_cast<uint64_t>(data[i]) << (8 * i);
+		bits.hi |= static_cast<uint64_t>(data[i + 8]) << (8 * i);
+	}
+
+	return bits;
+}
+
+/**
+ * @brief Store a physical block to memory.
+ *
+ * @param      bits   The block to store.
+ * @param[out] data   The 16 bytes of block data.
+ */
+static void store_block(
+	block_bits bits,
+	uint8_t* data
+) {
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		data[i] = static_cast<uint8_t>(bits.lo >> (8 * i));
+		data[i + 8] = static_cast<uint8_t>(bits.hi >> (8 * i));
+	}
+}
+
+/**
+ * @brief Shift a 128-bit value right.
+ *
+ * @param bits    The value to shift.
+ * @param shift   The shift amount [0, 127].
+ *
+ * @return The shifted value.
+ */
+static block_bits shift_right(
+	block_bits bits,
+	unsigned int shift
+) {
+	if (shift >= 64)
+	{
+		return { bits.hi >> (shift - 64), 0 };
+	}
+
+	if (shift == 0)
+	{
+		return bits;
+	}
+
+	return { (bits.lo >> shift) | (bits.hi << (64 - shift)), bits.hi >> shift };
+}
+
+/**
+ * @brief Shift a 128-bit value left.
+ *
+ * @param bits    The value to shift.
+ * @param shift   The shift amount [0, 127].
+ *
+ * @return The shifted value.
+ */
+static block_bits shift_left(
+	block_bits bits,
+	unsigned int shift
+) {
+	if (shift >= 64)
+	{
+		return { 0, bits.lo << (shift - 64) };
+	}
+
+	if (shift == 0)
+	{
+		return bits;
+	}
+
+	return { bits.lo << shift, (bits.hi << shift) | (bits.lo >> (64 - shift)) };
+}
+
+/**
+ * @brief Reverse the bits in a 64-bit value.
+ *
+ * @param v   The value to reverse.
+ *
+ * @return The reversed value.
+ */
+static uint64_t bit_reverse_u64(
+	uint64_t v
+) {
+	v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+	v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+	v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+	v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+	v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+	return (v >> 32) | (v << 32);
+}
+
+/**
+ * @brief Reverse the bits in a 128-bit value.
+ *
+ * @param bits   The value to reverse.
+ *
+ * @return The reversed value.
+ */
+static block_bits bit_reverse(
+	block_bits bits
+) {
+	return { bit_reverse_u64(bits.hi), bit_reverse_u64(bits.lo) };
+}
+
+/**
+ * @brief Get the number of bytes needed to store a bit field.
+ *
+ * @param bit_count   The number of bits.
+ *
+ * @return The number of bytes.
+ */
+static unsigned int field_bytes(
+	unsigned int bit_count
+) {
+	return (bit_count + 7) / 8;
+}
+
+/**
+ * @brief Write the low bits of a 128-bit value to a byte stream.
+ *
+ * Padding bits in the last byte are written as zero.
+ *
+ * @param      bits        The value to write.
+ * @param      bit_count   The number of bits to write.
+ * @param[out] stream      The output stream.
+ */
+static void write_field(
+	block_bits bits,
+	unsigned int bit_count,
+	uint8_t* stream
+) {
+	uint8_t bytes[16];
+	store_block(bits, bytes);
+
+	unsigned int byte_count = field_bytes(bit_count);
+	std::memcpy(stream, bytes, byte_count);
+
+	if (bit_count & 7)
+	{
+		stream[byte_count - 1] &= static_cast<uint8_t>((1 << (bit_count & 7)) - 1);
+	}
+}
+
+/**
+ * @brief Read a bit field from a byte stream into the low bits of a 128-bit value.
+ *
+ * @param stream      The input stream.
+ * @param bit_count   The number of bits to read.
+ *
+ * @return The read value; bits above @c bit_count are zero.
+ */
+static block_bits read_field(
+	const uint8_t* stream,
+	unsigned int bit_count
+) {
+	uint8_t bytes[16] { 0 };
+
+	unsigned int byte_count = field_bytes(bit_count);
+	std::memcpy(bytes, stream, byte_count);
+
+	if (bit_count & 7)
+	{
+		bytes[byte_count - 1] &= static_cast<uint8_t>((1 << (bit_count & 7)) - 1);
+	}
+
+	return load_block(bytes);
+}
+
+/**
+ * @brief Compute the field layout of a block from its mode field.
+ *
+ * @param is_3d   True if the block uses a 3D block size.
+ * @param mode    The 13-bit mode field.
+ *
+ * @return The field layout.
+ */
+static block_layout get_block_layout(
+	bool is_3d,
+	unsigned int mode
+) {
+	block_layout layout;
+	layout.weight_bits = get_block_mode_weight_bits(is_3d, mode & 0x7FF);
+
+	unsigned int partition_count_minus_one = (mode >> 11) & 3;
+	if (layout.weight_bits && partition_count_minus_one)
+	{
+		layout.endpoint_start = PARTITION_FIELD_END;
+	}
+	else
+	{
+		layout.endpoint_start = MODE_FIELD_BITS;
+	}
+
+	layout.endpoint_bits = 128 - layout.endpoint_start - layout.weight_bits;
+	return layout;
+}
+
+/**
+ * @brief Write a 32-bit value as little-endian bytes.
+ *
+ * @param      value    The value to write.
+ * @param[out] stream   The output stream.
+ */
+static void write_u32(
+	uint32_t value,
+	uint8_t* stream
+) {
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		stream[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+}
+
+/**
+ * @brief Read a 32-bit value from little-endian bytes.
+ *
+ * @param stream   The input stream.
+ *
+ * @return The read value.
+ */
+static uint32_t read_u32(
+	const uint8_t* stream
+) {
+	uint32_t value = 0;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		value |= static_cast<uint32_t>(stream[i]) << (8 * i);
+	}
+
+	return value;
+}
+
+/* See header for documentation. */
+size_t block_stream_split(
+	bool is_3d,
+	const uint8_t* data,
+	size_t block_count,
+	uint8_t* stream
+) {
+	// Size the streams up front so they can be written in place
+	size_t stream_sizes[STREAM_COUNT] { 0 };
+	for (size_t i = 0; i < block_count; i++)
+	{
+		const uint8_t* block = data + 16 * i;
+		unsigned int mode = (block[0] | (block[1] << 8)) & 0x1FFF;
+		block_layout layout = get_block_layout(is_3d, mode);
+
+		stream_sizes[0] += 2;
+		stream_sizes[1] += layout.endpoint_start == PARTITION_FIELD_END ? 2 : 0;
+		stream_sizes[2] += field_bytes(layout.endpoint_bits);
+		stream_sizes[3] += field_bytes(layout.weight_bits);
+	}
+
+	for (unsigned int i = 0; i < STREAM_COUNT; i++)
+	{
+		write_u32(static_cast<uint32_t>(stream_sizes[i]), stream + 4 * i);
+	}
+
+	uint8_t* mode_stream = stream + ASTCENC_BLOCK_STREAM_HEADER_SIZE;
+	uint8_t* partition_stream = mode_stream + stream_sizes[0];
+	uint8_t* endpoint_stream = partition_stream + stream_sizes[1];
+	uint8_t* weight_stream = endpoint_stream + stream_sizes[2];
+
+	size_t lengths[STREAM_COUNT] { 0 };
+
+	for (size_t i = 0; i < block_count; i++)
+	{
+		block_bits bits = load_block(data + 16 * i);
+
+		unsigned int mode = static_cast<unsigned int>(bits.lo) & 0x1FFF;
+		block_layout layout = get_block_layout(is_3d, mode);
+
+		mode_stream[lengths[0]] = static_cast<uint8_t>(mode);
+		mode_stream[lengths[0] + 1] = static_cast<uint8_t>(mode >> 8);
+		lengths[0] += 2;
+
+		if (layout.endpoint_start == PARTITION_FIELD_END)
+		{
+			unsigned int partition = static_cast<unsigned int>(bits.lo >> MODE_FIELD_BITS) & 0x3FF;
+			partition_stream[lengths[1]] = static_cast<uint8_t>(partition);
+			partition_stream[lengths[1] + 1] = static_cast<uint8_t>(partition >> 8);
+			lengths[1] += 2;
+		}
+
+		write_field(shift_right(bits, layout.endpoint_start), layout.endpoint_bits, endpoint_stream + lengths[2]);
+		lengths[2] += field_bytes(layout.endpoint_bits);
+
+		// Weight field, bit reversed so the first weight is in the low bits
+		if (layout.weight_bits)
+		{
+			write_field(bit_reverse(bits), layout.weight_bits, weight_stream + lengths[3]);
+			lengths[3] += field_bytes(layout.weight_bits);
+		}
+	}
+
+	return ASTCENC_BLOCK_STREAM_HEADER_SIZE + lengths[0] + lengths[1] + lengths[2] + lengths[3];
+}
+
+/* See header for documentation. */
+bool block_stream_merge(
+	bool is_3d,
+	const uint8_t* stream,
+	size_t stream_len,
+	size_t block_count,
+	uint8_t* data
+) {
+	if (stream_len < ASTCENC_BLOCK_STREAM_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	// Locate the start and end of each stream
+	const uint8_t* starts[STREAM_COUNT];
+	const uint8_t* ends[STREAM_COUNT];
+
+	size_t offset = ASTCENC_BLOCK_STREAM_HEADER_SIZE;
+	for (unsigned int i = 0; i < STREAM_COUNT; i++)
+	{
+		size_t length = read_u32(stream + 4 * i);
+		if (length > stream_len - offset)
+		{
+			return false;
+		}
+
+		starts[i] = stream + offset;
+		ends[i] = starts[i] + length;
+		offset += length;
+	}
+
+	if (offset != stream_len)
+	{
+		return false;
+	}
+
+	const uint8_t* mode_stream = starts[0];
+	const uint8_t* partition_stream = starts[1];
+	const uint8_t* endpoint_stream = starts[2];
+	const uint8_t* weight_stream = starts[3];
+
+	for (size_t i = 0; i < block_count; i++)
+	{
+		if (ends[0] - mode_stream < 2)
+		{
+			return false;
+		}
+
+		unsigned int mode = mode_stream[0] | (mode_stream[1] << 8);
+		mode_stream += 2;
+
+		// Reject non-canonical mode fields, as they could not have been written by the split
+		if (mode > 0x1FFF)
+		{
+			return false;
+		}
+
+		block_layout layout = get_block_layout(is_3d, mode);
+		block_bits bits { mode, 0 };
+
+		if (layout.endpoint_start == PARTITION_FIELD_END)
+		{
+			if (ends[1] - partition_stream < 2)
+			{
+				return false;
+			}
+
+			uint64_t partition = (partition_stream[0] | (partition_stream[1] << 8)) & 0x3FF;
+			partition_stream += 2;
+			bits.lo |= partition << MODE_FIELD_BITS;
+		}
+
+		unsigned int endpoint_bytes = field_bytes(layout.endpoint_bits);
+		if (static_cast<size_t>(ends[2] - endpoint_stream) < endpoint_bytes)
+		{
+			return false;
+		}
+
+		block_bits endpoint_field = shift_left(read_field(endpoint_stream, layout.endpoint_bits), layout.endpoint_start);
+		endpoint_stream += endpoint_bytes;
+		bits.lo |= endpoint_field.lo;
+		bits.hi |= endpoint_field.hi;
+
+		if (layout.weight_bits)
+		{
+			unsigned int weight_bytes = field_bytes(layout.weight_bits);
+			if (static_cast<size_t>(ends[3] - weight_stream) < weight_bytes)
+			{
+				return false;
+			}
+
+			block_bits weight_field = bit_reverse(read_field(weight_stream, layout.weight_bits));
+			weight_stream += weight_bytes;
+			bits.lo |= weight_field.lo;
+			bits.hi |= weight_field.hi;
+		}
+
+		store_block(bits, data + 16 * i);
+	}
+
+	// Every stream must be fully consumed
+	return mode_stream == ends[0] &&
+	       partition_stream == ends[1] &&
+	       endpoint_stream == ends[2] &&
+	       weight_stream == ends[3];
+}
@@ -25,6 +25,97 @@
 #include "astcenc_diagnostic_trace.h"
 
 #include <cassert>
+#include <cstring>
+
+/**
+ * @brief Record an evaluated encoding in the candidate list for the current block.
+ *
+ * The list keeps the lowest error distinct physical encodings, sorted by increasing error. This is
+ * a no-op if candidate collection is disabled.
+ *
+ * @param         bsd        The block size information.
+ * @param         scb        The symbolic encoding that was evaluated.
+ * @param         errorval   The error of the encoding.
+ * @param[in,out] list       The candidate list to update.
+ */
+static void record_block_candidate(
+	const block_size_descriptor& bsd,
+	const symbolic_compressed_block& scb,
+	float errorval,
+	block_candidate_list& list
+) {
+	if (list.limit == 0 || scb.block_type == SYM_BTYPE_ERROR)
+	{
+		return;
+	}
+
+	// Early out if the list is full and this is no better than the worst entry
+	if (list.count == list.limit && errorval >= list.candidates[list.count - 1].error)
+	{
+		return;
+	}
+
+	physical_compressed_block pcb;
+	symbolic_to_physical(bsd, scb, pcb);
+
+	// Identical encodings have identical errors, so only keep the first
+	for (unsigned int i = 0; i < list.count; i++)
+	{
+		if (memcmp(list.candidates[i].data, pcb.data, 16) == 0)
+		{
+			return;
+		}
+	}
+
+	// Insertion sort, dropping the worst entry if the list is full
+	unsigned int idx = astc::min(list.count, list.limit - 1);
+	while (idx > 0 && list.candidates[idx - 1].error > errorval)
+	{
+		list.candidates[idx] = list.candidates[idx - 1];
+		idx--;
+	}
+
+	memcpy(list.candidates[idx].data, pcb.data, 16);
+	list.candidates[idx].error = errorval;
+	list.count = astc::min(list.count + 1, list.limit);
+}
+
+/**
+ * @brief Get the error limit above which a candidate encoding error need not be computed exactly.
+ *
+ * A candidate is rejected by the refinement loop once its error exceeds the trial threshold, and
+ * does not change the best error in the mode once it exceeds that error, so the error computation
+ * can stop as soon as the running total exceeds both. Exact errors are always needed when building
+ * a candidate list for rate-distortion optimization, or when tracing diagnostics.
+ *
+ * @param tmpbuf                  The compression working buffers.
+ * @param threshold               The trial threshold multiplier.
+ * @param best_errorval_in_scb    The best error found so far for the block.
+ * @param best_errorval_in_mode   The best error found so far for the block mode.
+ *
+ * @return The error limit to pass to @c compute_symbolic_block_difference().
+ */
+static float get_candidate_error_limit(
+	const compression_working_buffers& tmpbuf,
+	float threshold,
+	float best_errorval_in_scb,
+	float best_errorval_in_mode
+) {
+#if defined(ASTCENC_DIAGNOSTICS)
+	(void)tmpbuf;
+	(void)threshold;
+	(void)best_errorval_in_scb;
+	(void)best_errorval_in_mode;
+	return ERROR_CALC_DEFAULT;
+#else
+	if (tmpbuf.candidates.limit != 0)
+	{
+		return ERROR_CALC_DEFAULT;
+	}
+
+	return astc::max(threshold * best_errorval_in_scb, best_errorval_in_mode);
+#endif
+}
 
 /**
  * @brief Merge two planes of endpoints into a single vector.
@@ -57,6 +148,11 @@ static void merge_endpoints(
  * partition and per plane) and attempt to improve image quality by moving each weight up by one or
  * down by one quantization step.
  *
+ * The interpolated weight of every texel is cached for the current plane, so evaluating a weight
+ * does not need to re-interpolate the neighboring weights, and accepting an adjustment only updates
+ * the cache entries of the texels that the adjusted weight influences. Texel weight contributions
+ * are multiples of 1/16 and unquantized weights are integers, so the cached sums are exact.
+ *
  * @param      decode_mode                       The decode mode (LDR, HDR).
  * @param      bsd                               The block size information.
  * @param      blk                               The image block color data to compress.
@@ -86,6 +182,7 @@ static bool realign_weights(
 	// Get the decimation table
 	const decimation_info& di = bsd.get_decimation_info(bm.decimation_mode);
 	unsigned int weight_count = di.weight_count;
+	unsigned int texel_count = bsd.texel_count;
 
 	unsigned int max_plane = bm.is_dual_plane;
 	int plane2_component = bm.is_dual_plane ? scb.plane2_component : -1;
@@ -101,6 +198,7 @@ static bool realign_weights(
 
 	promise(partition_count > 0);
 	promise(weight_count > 0);
+	promise(texel_count > 0);
 
 	for (unsigned int pa_idx = 0; pa_idx < partition_count; pa_idx++)
 	{
@@ -113,10 +211,13 @@ static bool realign_weights(
 		                       endpnt1[pa_idx]);
 	}
 
-	uint8_t uq_pl_weights[BLOCK_MAX_WEIGHTS];
+	alignas(ASTCENC_VECALIGN) int uq_pl_weights[BLOCK_MAX_WEIGHTS];
 	uint8_t* dec_weights_quant_pvalue = dec_weights_quant_pvalue_plane1;
 	bool adjustments = false;
 
+	// Per-texel cache of the interpolated weight, biased by 0.5 ready for rounding
+	alignas(ASTCENC_VECALIGN) float texel_weight_base[BLOCK_MAX_TEXELS];
+
 	// For each plane and partition ...
 	for (unsigned int pl_idx = 0; pl_idx <= max_plane; pl_idx++)
 	{
@@ -136,6 +237,20 @@ static bool realign_weights(
 			uq_pl_weights[we_idx] = qat->unquantized_value[dec_weights_quant_pvalue[we_idx]];
 		}
 
+		// Populate the texel weight cache, N texels at a time
+		for (unsigned int i = 0; i < texel_count; i += ASTCENC_SIMD_WIDTH)
+		{
+			vfloat weight_base(0.5f);
+			for (unsigned int j = 0; j < 4; j++)
+			{
+				vint weight_idx(di.texel_weights_4t[j] + i);
+				vfloat weight_uq = int_to_float(gatheri(uq_pl_weights, weight_idx));
+				weight_base += weight_uq * loada(di.texel_weights_float_4t[j] + i);
+			}
+
+			storea(weight_base, texel_weight_base + i);
+		}
+
 		// For each weight compute previous, current, and next errors
 		for (unsigned int we_idx = 0; we_idx < weight_count; we_idx++)
 		{
@@ -152,64 +267,84 @@ static bool realign_weights(
 			float up_error = 0.0f;
 			float down_error = 0.0f;
 
+			vfloat4 current_errorv = vfloat4::zero();
+			vfloat4 up_errorv = vfloat4::zero();
+			vfloat4 down_errorv = vfloat4::zero();
+
 			// Interpolate the colors to create the diffs
 			unsigned int texels_to_evaluate = di.weight_texel_count[we_idx];
 			promise(texels_to_evaluate > 0);
 			for (unsigned int te_idx = 0; te_idx < texels_to_evaluate; te_idx++)
 			{
 				unsigned int texel = di.weight_texel[te_idx][we_idx];
-				const uint8_t *texel_weights = di.texel_weights_texel[we_idx][te_idx];
-				const float *texel_weights_float = di.texel_weights_float_texel[we_idx][te_idx];
-				float twf0 = texel_weights_float[0];
-
-				float weight_base = static_cast<float>(uqw) * twf0;
+				float twf0 = di.texel_weights_float_texel[we_idx][te_idx][0];
 
-				// Don't interpolate filtered weights for a 1:1 weight grid
-				if (weight_count != bsd.texel_count)
-				{
-					weight_base =
-						(( weight_base
-						+ static_cast<float>(uq_pl_weights[texel_weights[1]])  * texel_weights_float[1])
-						+ (static_cast<float>(uq_pl_weights[texel_weights[2]]) * texel_weights_float[2]
-						+ static_cast<float>(uq_pl_weights[texel_weights[3]]) * texel_weights_float[3]));
-				}
-
-				unsigned int partition = pi.partition_of_texel[texel];
-
-				weight_base = weight_base + 0.5f;
+				float weight_base = texel_weight_base[texel];
 				float plane_weight = astc::flt_rd(weight_base);
 				float plane_up_weight = astc::flt_rd(weight_base + static_cast<float>(uqw_next_dif) * twf0) - plane_weight;
 				float plane_down_weight = astc::flt_rd(weight_base + static_cast<float>(uqw_prev_dif) * twf0) - plane_weight;
 
+				unsigned int partition = pi.partition_of_texel[texel];
 				vfloat4 color_offset = offset[partition];
 				vfloat4 color_base   = endpnt0f[partition];
 
 				vfloat4 color = color_base + color_offset * plane_weight;
 
 				vfloat4 origcolor    = blk.texel(texel);
-				vfloat4 error_weight = ewb.error_weights[texel];
 
 				vfloat4 colordiff       = color - origcolor;
 				vfloat4 color_up_diff   = colordiff + color_offset * plane_up_weight;
 				vfloat4 color_down_diff = colordiff + color_offset * plane_down_weight;
-				current_error += dot_s(colordiff       * colordiff,       error_weight);
-				up_error      += dot_s(color_up_diff   * color_up_diff,   error_weight);
-				down_error    += dot_s(color_down_diff * color_down_diff, error_weight);
+
+				// Uniform weighting is applied once per weight after the texel loop
+				if (ewb.is_uniform)
+				{
+					current_errorv += colordiff       * colordiff;
+					up_errorv      += color_up_diff   * color_up_diff;
+					down_errorv    += color_down_diff * color_down_diff;
+				}
+				else
+				{
+					vfloat4 error_weight = ewb.error_weights[texel];
+					current_error += dot_s(colordiff       * colordiff,       error_weight);
+					up_error      += dot_s(color_up_diff   * color_up_diff,   error_weight);
+					down_error    += dot_s(color_down_diff * color_down_diff, error_weight);
+				}
+			}
+
+			if (ewb.is_uniform)
+			{
+				current_error = dot_s(current_errorv, ewb.uniform_error_weight);
+				up_error      = dot_s(up_errorv,      ewb.uniform_error_weight);
+				down_error    = dot_s(down_errorv,    ewb.uniform_error_weight);
 			}
 
 			// Check if the prev or next error is better, and if so use it
 			if ((up_error < current_error) && (up_error < down_error))
 			{
-				uq_pl_weights[we_idx] = static_cast<uint8_t>(next_wt_uq);
+				uq_pl_weights[we_idx] = static_cast<int>(next_wt_uq);
 				dec_weights_quant_pvalue[we_idx] = (uint8_t)((prev_and_next >> 24) & 0xFF);
 				adjustments = true;
 			}
 			else if (down_error < current_error)
 			{
-				uq_pl_weights[we_idx] = static_cast<uint8_t>(prev_wt_uq);
+				uq_pl_weights[we_idx] = static_cast<int>(prev_wt_uq);
 				dec_weights_quant_pvalue[we_idx] = (uint8_t)((prev_and_next >> 16) & 0xFF);
 				adjustments = true;
 			}
+			else
+			{
+				continue;
+			}
+
+			// Update the cache for the texels influenced by the adjusted weight
+			int uqw_dif = uq_pl_weights[we_idx] - static_cast<int>(uqw);
+			for (unsigned int te_idx = 0; te_idx < texels_to_evaluate; te_idx++)
+			{
+				unsigned int texel = di.weight_texel[te_idx][we_idx];
+				float twf0 = di.texel_weights_float_texel[we_idx][te_idx][0];
+				texel_weight_base[texel] += static_cast<float>(uqw_dif) * twf0;
+			}
 		}
 
 		// Prepare iteration for plane 2
@@ -321,6 +456,11 @@ static float compress_symbolic_block_for_partition_1plane(
 	int qwt_bitcounts[WEIGHTS_MAX_BLOCK_MODES];
 	float qwt_errors[WEIGHTS_MAX_BLOCK_MODES];
 
+	// Block modes grouped by decimation, so the errors of all quantization levels that share a
+	// decimation can be computed in a single pass over the decimation tables
+	unsigned int dm_block_mode_counts[WEIGHTS_MAX_DECIMATION_MODES] { 0 };
+	uint16_t dm_block_modes[WEIGHTS_MAX_DECIMATION_MODES][WEIGHTS_QUANT_LEVELS];
+
 	for (unsigned int i = 0; i < bsd.block_mode_count; ++i)
 	{
 		qwt_errors[i] = 1e38f;
@@ -367,11 +507,37 @@ static float compress_symbolic_block_for_partition_1plane(
 		    dec_weights_quant_pvalue + BLOCK_MAX_WEIGHTS * i,
 		    bm.get_weight_quant_mode());
 
-		// Compute weight quantization errors for the block mode
-		qwt_errors[i] = compute_error_of_weight_set_1plane(
-		    eix[decimation_mode],
-		    di,
-		    dec_weights_quant_uvalue + BLOCK_MAX_WEIGHTS * i);
+		// Defer the weight quantization errors so they can be batched per decimation
+		unsigned int dm_index = dm_block_mode_counts[decimation_mode]++;
+		assert(dm_index < WEIGHTS_QUANT_LEVELS);
+		dm_block_modes[decimation_mode][dm_index] = static_cast<uint16_t>(i);
+	}
+
+	// Compute weight quantization errors for all block modes sharing each decimation
+	for (unsigned int i = 0; i < max_decimation_modes; i++)
+	{
+		unsigned int mode_count = dm_block_mode_counts[i];
+		if (mode_count == 0)
+		{
+			continue;
+		}
+
+		const float* weight_sets[WEIGHTS_QUANT_LEVELS];
+		for (unsigned int j = 0; j < mode_count; j++)
+		{
+			weight_sets[j] = dec_weights_quant_uvalue + BLOCK_MAX_WEIGHTS * dm_block_modes[i][j];
+		}
+
+		float errors[WEIGHTS_QUANT_LEVELS];
+		compute_error_of_weight_sets_1plane(
+		    eix[i],
+		    bsd.get_decimation_info(i),
+		    mode_count, weight_sets, errors);
+
+		for (unsigned int j = 0; j < mode_count; j++)
+		{
+			qwt_errors[dm_block_modes[i][j]] = errors[j];
+		}
 	}
 
 	// Decide the optimal combination of color endpoint encodings and weight encodings
@@ -383,7 +549,8 @@ static float compress_symbolic_block_for_partition_1plane(
 
 	unsigned int candidate_count = compute_ideal_endpoint_formats(
 	    bsd, pi, blk, ewb, ei.ep, qwt_bitcounts, qwt_errors,
-	    config.tune_candidate_limit, partition_format_specifiers, block_mode_index,
+	    config.tune_candidate_limit, (config.flags & ASTCENC_FLG_MAP_NORMAL) != 0,
+	    partition_format_specifiers, block_mode_index,
 	    color_quant_level, color_quant_level_mod);
 
 	// Iterate over the N believed-to-be-best modes to find out which one is actually best
@@ -498,7 +665,18 @@ static float compress_symbolic_block_for_partition_1plane(
 			// Pre-realign test
 			if (l == 0)
 			{
-				float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb);
+				// Average refinement improvement is 3.5% per iteration (allow 5%), but the first
+				// iteration can help more so we give it a extra 10% leeway. Use this knowledge to
+				// drive a heuristic to skip blocks that are unlikely to catch up with the best
+				// block we have already.
+				unsigned int iters_remaining = config.tune_refinement_limit - l;
+				float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.1f;
+				float error_limit = get_candidate_error_limit(tmpbuf, threshold,
+				                                              best_errorval_in_scb,
+				                                              best_errorval_in_mode);
+
+				float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb,
+				                                                   error_limit);
 				if (errorval == -ERROR_CALC_DEFAULT)
 				{
 					errorval = -errorval;
@@ -507,13 +685,8 @@ static float compress_symbolic_block_for_partition_1plane(
 
 				trace_add_data("error_prerealign", errorval);
 				best_errorval_in_mode = astc::min(errorval, best_errorval_in_mode);
+				record_block_candidate(bsd, workscb, errorval, tmpbuf.candidates);
 
-				// Average refinement improvement is 3.5% per iteration (allow 5%), but the first
-				// iteration can help more so we give it a extra 10% leeway. Use this knowledge to
-				// drive a heuristic to skip blocks that are unlikely to catch up with the best
-				// block we have already.
-				unsigned int iters_remaining = config.tune_refinement_limit - l;
-				float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.1f;
 				if (errorval > (threshold * best_errorval_in_scb))
 				{
 					break;
@@ -540,7 +713,17 @@ static float compress_symbolic_block_for_partition_1plane(
 			    workscb.weights, nullptr);
 
 			// Post-realign test
-			float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb);
+			// Average refinement improvement is 3.5% per iteration, so skip blocks that are
+			// unlikely to catch up with the best block we have already. Assume a 5% per step to
+			// give benefit of the doubt ...
+			unsigned int iters_remaining = config.tune_refinement_limit - 1 - l;
+			float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.0f;
+			float error_limit = get_candidate_error_limit(tmpbuf, threshold,
+			                                              best_errorval_in_scb,
+			                                              best_errorval_in_mode);
+
+			float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb,
+			                                                   error_limit);
 			if (errorval == -ERROR_CALC_DEFAULT)
 			{
 				errorval = -errorval;
@@ -549,12 +732,8 @@ static float compress_symbolic_block_for_partition_1plane(
 
 			trace_add_data("error_postrealign", errorval);
 			best_errorval_in_mode = astc::min(errorval, best_errorval_in_mode);
+			record_block_candidate(bsd, workscb, errorval, tmpbuf.candidates);
 
-			// Average refinement improvement is 3.5% per iteration, so skip blocks that are
-			// unlikely to catch up with the best block we have already. Assume a 5% per step to
-			// give benefit of the doubt ...
-			unsigned int iters_remaining = config.tune_refinement_limit - 1 - l;
-			float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.0f;
 			if (errorval > (threshold * best_errorval_in_scb))
 			{
 				break;
@@ -767,7 +946,8 @@ static float compress_symbolic_block_for_partition_2planes(
 	const auto& pi = bsd.get_partition_info(1, 0);
 	unsigned int candidate_count = compute_ideal_endpoint_formats(
 	    bsd, pi, blk, ewb, epm, qwt_bitcounts, qwt_errors,
-	    config.tune_candidate_limit, partition_format_specifiers, block_mode_index,
+	    config.tune_candidate_limit, (config.flags & ASTCENC_FLG_MAP_NORMAL) != 0,
+	    partition_format_specifiers, block_mode_index,
 	    color_quant_level, color_quant_level_mod);
 
 	// Iterate over the N believed-to-be-best modes to find out which one is actually best
@@ -842,7 +1022,18 @@ static float compress_symbolic_block_for_partition_2planes(
 			// Pre-realign test
 			if (l == 0)
 			{
-				float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb);
+				// Average refinement improvement is 3.5% per iteration (allow 5%), but the first
+				// iteration can help more so we give it a extra 10% leeway. Use this knowledge to
+				// drive a heuristic to skip blocks that are unlikely to catch up with the best
+				// block we have already.
+				unsigned int iters_remaining = config.tune_refinement_limit - l;
+				float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.1f;
+				float error_limit = get_candidate_error_limit(tmpbuf, threshold,
+				                                              best_errorval_in_scb,
+				                                              best_errorval_in_mode);
+
+				float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb,
+				                                                   error_limit);
 				if (errorval == -ERROR_CALC_DEFAULT)
 				{
 					errorval = -errorval;
@@ -851,13 +1042,8 @@ static float compress_symbolic_block_for_partition_2planes(
 
 				trace_add_data("error_prerealign", errorval);
 				best_errorval_in_mode = astc::min(errorval, best_errorval_in_mode);
+				record_block_candidate(bsd, workscb, errorval, tmpbuf.candidates);
 
-				// Average refinement improvement is 3.5% per iteration (allow 5%), but the first
-				// iteration can help more so we give it a extra 10% leeway. Use this knowledge to
-				// drive a heuristic to skip blocks that are unlikely to catch up with the best
-				// block we have already.
-				unsigned int iters_remaining = config.tune_refinement_limit - l;
-				float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.1f;
 				if (errorval > (threshold * best_errorval_in_scb))
 				{
 					break;
@@ -884,7 +1070,17 @@ static float compress_symbolic_block_for_partition_2planes(
 			    workscb.weights, workscb.weights + WEIGHTS_PLANE2_OFFSET);
 
 			// Post-realign test
-			float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb);
+			// Average refinement improvement is 3.5% per iteration, so skip blocks that are
+			// unlikely to catch up with the best block we have already. Assume a 5% per step to
+			// give benefit of the doubt ...
+			unsigned int iters_remaining = config.tune_refinement_limit - 1 - l;
+			float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.0f;
+			float error_limit = get_candidate_error_limit(tmpbuf, threshold,
+			                                              best_errorval_in_scb,
+			                                              best_errorval_in_mode);
+
+			float errorval = compute_symbolic_block_difference(config, bsd, workscb, blk, ewb,
+			                                                   error_limit);
 			if (errorval == -ERROR_CALC_DEFAULT)
 			{
 				errorval = -errorval;
@@ -893,12 +1089,8 @@ static float compress_symbolic_block_for_partition_2planes(
 
 			trace_add_data("error_postrealign", errorval);
 			best_errorval_in_mode = astc::min(errorval, best_errorval_in_mode);
+			record_block_candidate(bsd, workscb, errorval, tmpbuf.candidates);
 
-			// Average refinement improvement is 3.5% per iteration, so skip blocks that are
-			// unlikely to catch up with the best block we have already. Assume a 5% per step to
-			// give benefit of the doubt ...
-			unsigned int iters_remaining = config.tune_refinement_limit - 1 - l;
-			float threshold = (0.05f * static_cast<float>(iters_remaining)) + 1.0f;
 			if (errorval > (threshold * best_errorval_in_scb))
 			{
 				break;
@@ -968,12 +1160,133 @@ void expand_deblock_weights(
 	}
 }
 
+/**
+ * @brief Create the error weights for a block where all texels share the same weight.
+ *
+ * The per-texel arrays are still populated for the kernels without a uniform weight fast path,
+ * but this is a simple broadcast with no per-texel weight arithmetic.
+ *
+ * @param      ctx     The compressor context and configuration.
+ * @param      bsd     The block size information.
+ * @param      blk     The image block color data to compress.
+ * @param[out] ewb     The image block weighted error data.
+ *
+ * @return Return the total error weight sum for all texels and channels.
+ */
+static float prepare_uniform_error_weight_block(
+	const astcenc_context& ctx,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	error_weight_block& ewb
+) {
+	vfloat4 color_weights(ctx.config.cw_r_weight,
+	                      ctx.config.cw_g_weight,
+	                      ctx.config.cw_b_weight,
+	                      ctx.config.cw_a_weight);
+
+	vfloat4 error_weight(ctx.config.v_rgb_base,
+	                     ctx.config.v_rgb_base,
+	                     ctx.config.v_rgb_base,
+	                     ctx.config.v_a_base);
+
+	// Uniform weighting is LDR only, so the transfer function derivative is fixed
+	vfloat4 derv(65535.0f);
+	error_weight = error_weight * color_weights;
+	error_weight = error_weight / (derv * derv * 1e-10f);
+
+	float wr = error_weight.lane<0>();
+	float wg = error_weight.lane<1>();
+	float wb = error_weight.lane<2>();
+	float wa = error_weight.lane<3>();
+
+	float wrg = (wr + wg) * 0.5f;
+	float wrb = (wr + wb) * 0.5f;
+	float wgb = (wg + wb) * 0.5f;
+
+	float wgba = (wg + wb + wa) * 0.333333f;
+	float wrba = (wr + wb + wa) * 0.333333f;
+	float wrga = (wr + wg + wa) * 0.333333f;
+	float wrgb = (wr + wg + wb) * 0.333333f;
+
+	float w = (wr + wg + wb + wa) * 0.25f;
+
+	vfloat4 texel_sum = vfloat4::zero();
+
+	unsigned int texel_count = bsd.texel_count;
+	promise(texel_count > 0);
+
+	for (unsigned int i = 0; i < texel_count; i++)
+	{
+		texel_sum += blk.texel(i);
+
+		ewb.error_weights[i] = error_weight;
+
+		ewb.texel_weight_r[i] = wr;
+		ewb.texel_weight_g[i] = wg;
+		ewb.texel_weight_b[i] = wb;
+		ewb.texel_weight_a[i] = wa;
+
+		ewb.texel_weight_rg[i] = wrg;
+		ewb.texel_weight_rb[i] = wrb;
+		ewb.texel_weight_gb[i] = wgb;
+
+		ewb.texel_weight_gba[i] = wgba;
+		ewb.texel_weight_rba[i] = wrba;
+		ewb.texel_weight_rga[i] = wrga;
+		ewb.texel_weight_rgb[i] = wrgb;
+
+		ewb.texel_weight[i] = w;
+	}
+
+	// Small bias to avoid divide by zeros and NaN propagation later
+	vfloat4 error_weight_sum = vfloat4(1e-17f) + error_weight * static_cast<float>(texel_count);
+
+	ewb.uniform_error_weight = error_weight;
+	ewb.block_error_weighted_rgba_sum = vfloat4(1e-17f) + texel_sum * error_weight;
+	ewb.block_error_weight_sum = error_weight_sum;
+
+	return hadd_s(error_weight_sum);
+}
+
+/**
+ * @brief Compute the derivative of the LNS transfer function for four texels of one component.
+ *
+ * @param data   The LNS encoded component values.
+ *
+ * @return The derivative, clamped between 1/32 and 2^25.
+ */
+static inline vfloat4 compute_lns_derivative(
+	vfloat4 data
+) {
+	vint4 datai = lns_to_sf16(float_to_int(data));
+
+	vfloat4 dataf = float16_to_float(datai);
+	dataf = max(dataf, 6e-5f);
+
+	vfloat4 data_lns1 = dataf * 1.05f;
+	data_lns1 = float_to_lns(data_lns1);
+
+	vfloat4 data_lns2 = dataf;
+	data_lns2 = float_to_lns(data_lns2);
+
+	vfloat4 divisor_lns = dataf * 0.05f;
+
+	// Clamp derivatives between 1/32 and 2^25
+	float lo = 1.0f / 32.0f;
+	float hi = 33554432.0f;
+	return clamp(lo, hi, (data_lns1 - data_lns2) / divisor_lns);
+}
+
 /**
  * @brief Create a per-texel and per-channel expansion of the error weights.
  *
  * This approach creates relatively large error block tables, but it allows a very flexible level of
  * control over how specific texels and channels are prioritized by the compressor.
  *
+ * Error weights are computed N (SIMD width) texels at a time using an SoA layout. Padding texels
+ * outside of the image are handled with a lane mask, which interior blocks that do not use the
+ * image averages can skip entirely.
+ *
  * @param      ctx     The compressor context and configuration.
  * @param      image   The input image information.
  * @param      bsd     The block size information.
@@ -989,180 +1302,335 @@ static float prepare_error_weight_block(
 	const image_block& blk,
 	error_weight_block& ewb
 ) {
-	unsigned int idx = 0;
+	// Fast path for uniform weighting, which only needs a single weight for the whole block. This
+	// can only be used for blocks fully inside the image, as padding texels get a tiny weight.
+	bool is_interior = (blk.xpos + bsd.xdim <= image.dim_x) &&
+	                   (blk.ypos + bsd.ydim <= image.dim_y) &&
+	                   (blk.zpos + bsd.zdim <= image.dim_z);
+
+	ewb.is_uniform = ctx.uniform_error_weights && is_interior;
+	if (ewb.is_uniform)
+	{
+		return prepare_uniform_error_weight_block(ctx, bsd, blk, ewb);
+	}
+
+	ewb.uniform_error_weight = vfloat4::zero();
+
+	const astcenc_config& config = ctx.config;
+
 	bool any_mean_stdev_weight =
-	    ctx.config.v_rgb_mean != 0.0f || ctx.config.v_rgb_stdev != 0.0f || \
-	    ctx.config.v_a_mean != 0.0f || ctx.config.v_a_stdev != 0.0f;
+	    config.v_rgb_mean != 0.0f || config.v_rgb_stdev != 0.0f || \
+	    config.v_a_mean != 0.0f || config.v_a_stdev != 0.0f;
 
-	vfloat4 color_weights(ctx.config.cw_r_weight,
-	                      ctx.config.cw_g_weight,
-	                      ctx.config.cw_b_weight,
-	                      ctx.config.cw_a_weight);
+	bool use_alpha_weight = (config.flags & ASTCENC_FLG_USE_ALPHA_WEIGHT) != 0;
+	bool use_alpha_averages = use_alpha_weight && config.a_scale_radius != 0;
 
 	// This works because HDR is imposed globally at compression time
-	unsigned int rgb_lns = blk.rgb_lns[0];
-	unsigned int a_lns = blk.alpha_lns[0];
-	vint4 use_lns(rgb_lns, rgb_lns, rgb_lns, a_lns);
-	vmask4 lns_mask = use_lns != vint4::zero();
+	bool rgb_lns = blk.rgb_lns[0] != 0;
+	bool a_lns = blk.alpha_lns[0] != 0;
+
+	unsigned int texel_count = bsd.texel_count;
+	unsigned int texel_count_simd = round_up_to_simd_multiple_vla(texel_count);
 
 	promise(bsd.xdim > 0);
 	promise(bsd.ydim > 0);
 	promise(bsd.zdim > 0);
+	promise(texel_count > 0);
 
-	for (unsigned int z = 0; z < bsd.zdim; z++)
+	// Compute the LNS transfer function derivatives, four texels at a time as the LNS conversion
+	// functions are only available for 4-wide vectors
+	alignas(ASTCENC_VECALIGN) float derv_r[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float derv_g[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float derv_b[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float derv_a[BLOCK_MAX_TEXELS];
+
+	for (unsigned int i = 0; i < texel_count && (rgb_lns || a_lns); i += 4)
 	{
-		for (unsigned int y = 0; y < bsd.ydim; y++)
+		if (rgb_lns)
 		{
-			for (unsigned int x = 0; x < bsd.xdim; x++)
-			{
-				unsigned int xpos = x + blk.xpos;
-				unsigned int ypos = y + blk.ypos;
-				unsigned int zpos = z + blk.zpos;
-
-				if (xpos >= image.dim_x || ypos >= image.dim_y || zpos >= image.dim_z)
-				{
-					ewb.error_weights[idx] = vfloat4(1e-11f);
-				}
-				else
-				{
-					vfloat4 derv(65535.0f);
+			store(compute_lns_derivative(vfloat4(blk.data_r + i)), derv_r + i);
+			store(compute_lns_derivative(vfloat4(blk.data_g + i)), derv_g + i);
+			store(compute_lns_derivative(vfloat4(blk.data_b + i)), derv_b + i);
+		}
 
-					// Compute derivative if we have any use of LNS
-					if (any(lns_mask))
-					{
-						vfloat4 data = blk.texel(idx);
-						vint4 datai = lns_to_sf16(float_to_int(data));
+		if (a_lns)
+		{
+			store(compute_lns_derivative(vfloat4(blk.data_a + i)), derv_a + i);
+		}
+	}
 
-						vfloat4 dataf = float16_to_float(datai);
-						dataf = max(dataf, 6e-5f);
+	// Gather the regional statistics of each texel into SoA arrays, and flag padding texels that
+	// are outside of the image. Image offsets can exceed 32 bits for very large images, so this
+	// uses scalar size_t indexing rather than vector gathers.
+	bool use_offsets = !is_interior || any_mean_stdev_weight || use_alpha_averages;
+	alignas(ASTCENC_VECALIGN) int texel_valid[BLOCK_MAX_TEXELS];
 
-						vfloat4 data_lns1 = dataf * 1.05f;
-						data_lns1 = float_to_lns(data_lns1);
+	alignas(ASTCENC_VECALIGN) float input_avg_r[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float input_avg_g[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float input_avg_b[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float input_avg_a[BLOCK_MAX_TEXELS];
 
-						vfloat4 data_lns2 = dataf;
-						data_lns2 = float_to_lns(data_lns2);
+	alignas(ASTCENC_VECALIGN) float input_var_r[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float input_var_g[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float input_var_b[BLOCK_MAX_TEXELS];
+	alignas(ASTCENC_VECALIGN) float input_var_a[BLOCK_MAX_TEXELS];
 
-						vfloat4 divisor_lns = dataf * 0.05f;
+	alignas(ASTCENC_VECALIGN) float input_alpha_avg[BLOCK_MAX_TEXELS];
 
-						// Clamp derivatives between 1/32 and 2^25
-						float lo = 1.0f / 32.0f;
-						float hi = 33554432.0f;
-						vfloat4 derv_lns = clamp(lo, hi, (data_lns1 - data_lns2) / divisor_lns);
-						derv = select(derv, derv_lns, lns_mask);
-					}
+	if (use_offsets)
+	{
+		size_t ydt = image.dim_x;
+		size_t zdt = static_cast<size_t>(image.dim_x) * image.dim_y;
+		unsigned int x_count = astc::min(static_cast<unsigned int>(bsd.xdim), image.dim_x - blk.xpos);
 
-					// Compute error weight
-					vfloat4 error_weight(ctx.config.v_rgb_base,
-					                     ctx.config.v_rgb_base,
-					                     ctx.config.v_rgb_base,
-					                     ctx.config.v_a_base);
+		unsigned int idx = 0;
+		for (unsigned int z = 0; z < bsd.zdim; z++)
+		{
+			unsigned int zpos = z + blk.zpos;
+			for (unsigned int y = 0; y < bsd.ydim; y++)
+			{
+				unsigned int ypos = y + blk.ypos;
+				bool row_valid = (ypos < image.dim_y) && (zpos < image.dim_z);
+				size_t row_offset = zpos * zdt + ypos * ydt + blk.xpos;
 
-					unsigned int ydt = image.dim_x;
-					unsigned int zdt = image.dim_x * image.dim_y;
+				for (unsigned int x = 0; x < bsd.xdim; x++)
+				{
+					bool valid = row_valid && (x < x_count);
+					texel_valid[idx] = valid ? 1 : 0;
+					size_t offset = row_offset + x;
 
 					if (any_mean_stdev_weight)
 					{
-						vfloat4 avg = ctx.input_averages[zpos * zdt + ypos * ydt + xpos];
-						avg = max(avg, 6e-5f);
-						avg = avg * avg;
+						vfloat4 avg = valid ? ctx.input_averages[offset] : vfloat4::zero();
+						input_avg_r[idx] = avg.lane<0>();
+						input_avg_g[idx] = avg.lane<1>();
+						input_avg_b[idx] = avg.lane<2>();
+						input_avg_a[idx] = avg.lane<3>();
+
+						vfloat4 var = valid ? ctx.input_variances[offset] : vfloat4::zero();
+						input_var_r[idx] = var.lane<0>();
+						input_var_g[idx] = var.lane<1>();
+						input_var_b[idx] = var.lane<2>();
+						input_var_a[idx] = var.lane<3>();
+					}
 
-						vfloat4 variance = ctx.input_variances[zpos * zdt + ypos * ydt + xpos];
-						variance = variance * variance;
+					if (use_alpha_averages)
+					{
+						input_alpha_avg[idx] = valid ? ctx.input_alpha_averages[offset] : 0.0f;
+					}
 
-						float favg = hadd_rgb_s(avg) * (1.0f / 3.0f);
-						float fvar = hadd_rgb_s(variance) * (1.0f / 3.0f);
+					idx++;
+				}
+			}
+		}
 
-						float mixing = ctx.config.v_rgba_mean_stdev_mix;
-						avg.set_lane<0>(favg * mixing + avg.lane<0>() * (1.0f - mixing));
-						avg.set_lane<1>(favg * mixing + avg.lane<1>() * (1.0f - mixing));
-						avg.set_lane<2>(favg * mixing + avg.lane<2>() * (1.0f - mixing));
+		for (unsigned int i = texel_count; i < texel_count_simd; i++)
+		{
+			texel_valid[i] = 0;
 
-						variance.set_lane<0>(fvar * mixing + variance.lane<0>() * (1.0f - mixing));
-						variance.set_lane<1>(fvar * mixing + variance.lane<1>() * (1.0f - mixing));
-						variance.set_lane<2>(fvar * mixing + variance.lane<2>() * (1.0f - mixing));
+			input_avg_r[i] = 0.0f;
+			input_avg_g[i] = 0.0f;
+			input_avg_b[i] = 0.0f;
+			input_avg_a[i] = 0.0f;
 
-						vfloat4 stdev = sqrt(max(variance, 0.0f));
+			input_var_r[i] = 0.0f;
+			input_var_g[i] = 0.0f;
+			input_var_b[i] = 0.0f;
+			input_var_a[i] = 0.0f;
 
-						vfloat4 scalea(ctx.config.v_rgb_mean, ctx.config.v_rgb_mean, ctx.config.v_rgb_mean, ctx.config.v_a_mean);
-						avg = avg * scalea;
+			input_alpha_avg[i] = 0.0f;
+		}
+	}
 
-						vfloat4 scales(ctx.config.v_rgb_stdev, ctx.config.v_rgb_stdev, ctx.config.v_rgb_stdev, ctx.config.v_a_stdev);
-						stdev = stdev * scales;
+	float mixing = config.v_rgba_mean_stdev_mix;
+	vfloat mixing_v(mixing);
+	vfloat mixing_inv_v(1.0f - mixing);
 
-						error_weight = error_weight + avg + stdev;
-						error_weight = 1.0f / error_weight;
-					}
+	vfloat texel_sum_r = vfloat::zero();
+	vfloat texel_sum_g = vfloat::zero();
+	vfloat texel_sum_b = vfloat::zero();
+	vfloat texel_sum_a = vfloat::zero();
 
-					if (ctx.config.flags & ASTCENC_FLG_USE_ALPHA_WEIGHT)
-					{
-						float alpha_scale;
-						if (ctx.config.a_scale_radius != 0)
-						{
-							alpha_scale = ctx.input_alpha_averages[zpos * zdt + ypos * ydt + xpos];
-						}
-						else
-						{
-							alpha_scale = blk.data_a[idx] * (1.0f / 65535.0f);
-						}
+	vfloat weight_sum_r = vfloat::zero();
+	vfloat weight_sum_g = vfloat::zero();
+	vfloat weight_sum_b = vfloat::zero();
+	vfloat weight_sum_a = vfloat::zero();
 
-						alpha_scale = astc::max(alpha_scale, 0.0001f);
+	vint lane_ids = vint::lane_id();
+	for (unsigned int i = 0; i < texel_count; i += ASTCENC_SIMD_WIDTH)
+	{
+		vmask active = lane_ids < vint(texel_count);
+		vmask valid = active;
 
-						alpha_scale *= alpha_scale;
-						error_weight.set_lane<0>(error_weight.lane<0>() * alpha_scale);
-						error_weight.set_lane<1>(error_weight.lane<1>() * alpha_scale);
-						error_weight.set_lane<2>(error_weight.lane<2>() * alpha_scale);
-					}
+		if (use_offsets)
+		{
+			valid = valid & (vint(texel_valid + i) != vint::zero());
+		}
 
-					error_weight = error_weight * color_weights;
-					error_weight = error_weight * ctx.deblock_weights[idx];
+		vfloat data_r = select(vfloat::zero(), vfloat(blk.data_r + i), active);
+		vfloat data_g = select(vfloat::zero(), vfloat(blk.data_g + i), active);
+		vfloat data_b = select(vfloat::zero(), vfloat(blk.data_b + i), active);
+		vfloat data_a = select(vfloat::zero(), vfloat(blk.data_a + i), active);
 
-					// When we loaded the block to begin with, we applied a transfer function and
-					// computed the derivative of the transfer function. However, the error-weight
-					// computation so far is based on the original color values, not the
-					// transfer-function values. As such, we must multiply the error weights by the
-					// derivative of the inverse of the transfer function, which is equivalent to
-					// dividing by the derivative of the transfer function.
+		// Compute error weight
+		vfloat ew_r(config.v_rgb_base);
+		vfloat ew_g(config.v_rgb_base);
+		vfloat ew_b(config.v_rgb_base);
+		vfloat ew_a(config.v_a_base);
 
-					error_weight = error_weight / (derv * derv * 1e-10f);
-					ewb.error_weights[idx] = error_weight;
-				}
-				idx++;
-			}
+		if (any_mean_stdev_weight)
+		{
+			vfloat avg_r = max(vfloat(input_avg_r + i), vfloat(6e-5f));
+			vfloat avg_g = max(vfloat(input_avg_g + i), vfloat(6e-5f));
+			vfloat avg_b = max(vfloat(input_avg_b + i), vfloat(6e-5f));
+			vfloat avg_a = max(vfloat(input_avg_a + i), vfloat(6e-5f));
+
+			avg_r = avg_r * avg_r;
+			avg_g = avg_g * avg_g;
+			avg_b = avg_b * avg_b;
+			avg_a = avg_a * avg_a;
+
+			vfloat var_r(input_var_r + i);
+			vfloat var_g(input_var_g + i);
+			vfloat var_b(input_var_b + i);
+			vfloat var_a(input_var_a + i);
+
+			var_r = var_r * var_r;
+			var_g = var_g * var_g;
+			var_b = var_b * var_b;
+			var_a = var_a * var_a;
+
+			vfloat favg = (avg_r + avg_g + avg_b) * (1.0f / 3.0f);
+			vfloat fvar = (var_r + var_g + var_b) * (1.0f / 3.0f);
+
+			avg_r = favg * mixing_v + avg_r * mixing_inv_v;
+			avg_g = favg * mixing_v + avg_g * mixing_inv_v;
+			avg_b = favg * mixing_v + avg_b * mixing_inv_v;
+
+			var_r = fvar * mixing_v + var_r * mixing_inv_v;
+			var_g = fvar * mixing_v + var_g * mixing_inv_v;
+			var_b = fvar * mixing_v + var_b * mixing_inv_v;
+
+			vfloat stdev_r = sqrt(max(var_r, vfloat::zero())) * config.v_rgb_stdev;
+			vfloat stdev_g = sqrt(max(var_g, vfloat::zero())) * config.v_rgb_stdev;
+			vfloat stdev_b = sqrt(max(var_b, vfloat::zero())) * config.v_rgb_stdev;
+			vfloat stdev_a = sqrt(max(var_a, vfloat::zero())) * config.v_a_stdev;
+
+			ew_r = 1.0f / (ew_r + avg_r * config.v_rgb_mean + stdev_r);
+			ew_g = 1.0f / (ew_g + avg_g * config.v_rgb_mean + stdev_g);
+			ew_b = 1.0f / (ew_b + avg_b * config.v_rgb_mean + stdev_b);
+			ew_a = 1.0f / (ew_a + avg_a * config.v_a_mean + stdev_a);
 		}
-	}
 
-	// Small bias to avoid divide by zeros and NaN propagation later
-	vfloat4 texel_weight_sum(1e-17f);
-	vfloat4 error_weight_sum(1e-17f);
+		if (use_alpha_weight)
+		{
+			vfloat alpha_scale;
+			if (use_alpha_averages)
+			{
+				alpha_scale = vfloat(input_alpha_avg + i);
+			}
+			else
+			{
+				alpha_scale = data_a * (1.0f / 65535.0f);
+			}
 
-	int texels_per_block = bsd.texel_count;
-	for (int i = 0; i < texels_per_block; i++)
-	{
-		texel_weight_sum += ewb.error_weights[i] * blk.texel(i);
-		error_weight_sum += ewb.error_weights[i];
+			alpha_scale = max(alpha_scale, vfloat(0.0001f));
+			alpha_scale = alpha_scale * alpha_scale;
 
-		float wr = ewb.error_weights[i].lane<0>();
-		float wg = ewb.error_weights[i].lane<1>();
-		float wb = ewb.error_weights[i].lane<2>();
-		float wa = ewb.error_weights[i].lane<3>();
+			ew_r = ew_r * alpha_scale;
+			ew_g = ew_g * alpha_scale;
+			ew_b = ew_b * alpha_scale;
+		}
 
-		ewb.texel_weight_r[i] = wr;
-		ewb.texel_weight_g[i] = wg;
-		ewb.texel_weight_b[i] = wb;
-		ewb.texel_weight_a[i] = wa;
+		vfloat deblock(ctx.deblock_weights + i);
+		ew_r = (ew_r * config.cw_r_weight) * deblock;
+		ew_g = (ew_g * config.cw_g_weight) * deblock;
+		ew_b = (ew_b * config.cw_b_weight) * deblock;
+		ew_a = (ew_a * config.cw_a_weight) * deblock;
+
+		// When we loaded the block to begin with, we applied a transfer function and computed the
+		// derivative of the transfer function. However, the error-weight computation so far is
+		// based on the original color values, not the transfer-function values. As such, we must
+		// multiply the error weights by the derivative of the inverse of the transfer function,
+		// which is equivalent to dividing by the derivative of the transfer function.
+		vfloat derv_rgb_r(65535.0f);
+		vfloat derv_rgb_g(65535.0f);
+		vfloat derv_rgb_b(65535.0f);
+		vfloat derv_alpha(65535.0f);
+
+		if (rgb_lns)
+		{
+			derv_rgb_r = vfloat(derv_r + i);
+			derv_rgb_g = vfloat(derv_g + i);
+			derv_rgb_b = vfloat(derv_b + i);
+		}
 
-		ewb.texel_weight_rg[i] = (wr + wg) * 0.5f;
-		ewb.texel_weight_rb[i] = (wr + wb) * 0.5f;
-		ewb.texel_weight_gb[i] = (wg + wb) * 0.5f;
+		if (a_lns)
+		{
+			derv_alpha = vfloat(derv_a + i);
+		}
 
-		ewb.texel_weight_gba[i] = (wg + wb + wa) * 0.333333f;
-		ewb.texel_weight_rba[i] = (wr + wb + wa) * 0.333333f;
-		ewb.texel_weight_rga[i] = (wr + wg + wa) * 0.333333f;
-		ewb.texel_weight_rgb[i] = (wr + wg + wb) * 0.333333f;
+		ew_r = ew_r / (derv_rgb_r * derv_rgb_r * 1e-10f);
+		ew_g = ew_g / (derv_rgb_g * derv_rgb_g * 1e-10f);
+		ew_b = ew_b / (derv_rgb_b * derv_rgb_b * 1e-10f);
+		ew_a = ew_a / (derv_alpha * derv_alpha * 1e-10f);
+
+		// Padding texels outside of the image get a tiny weight, and the SIMD tail gets none
+		vfloat padding_weight = select(vfloat::zero(), vfloat(1e-11f), active);
+		ew_r = select(padding_weight, ew_r, valid);
+		ew_g = select(padding_weight, ew_g, valid);
+		ew_b = select(padding_weight, ew_b, valid);
+		ew_a = select(padding_weight, ew_a, valid);
+
+		texel_sum_r += ew_r * data_r;
+		texel_sum_g += ew_g * data_g;
+		texel_sum_b += ew_b * data_b;
+		texel_sum_a += ew_a * data_a;
+
+		weight_sum_r += ew_r;
+		weight_sum_g += ew_g;
+		weight_sum_b += ew_b;
+		weight_sum_a += ew_a;
+
+		store(ew_r, ewb.texel_weight_r + i);
+		store(ew_g, ewb.texel_weight_g + i);
+		store(ew_b, ewb.texel_weight_b + i);
+		store(ew_a, ewb.texel_weight_a + i);
+
+		store((ew_r + ew_g) * 0.5f, ewb.texel_weight_rg + i);
+		store((ew_r + ew_b) * 0.5f, ewb.texel_weight_rb + i);
+		store((ew_g + ew_b) * 0.5f, ewb.texel_weight_gb + i);
+
+		store((ew_g + ew_b + ew_a) * 0.333333f, ewb.texel_weight_gba + i);
+		store((ew_r + ew_b + ew_a) * 0.333333f, ewb.texel_weight_rba + i);
+		store((ew_r + ew_g + ew_a) * 0.333333f, ewb.texel_weight_rga + i);
+		store((ew_r + ew_g + ew_b) * 0.333333f, ewb.texel_weight_rgb + i);
+
+		store((ew_r + ew_g + ew_b + ew_a) * 0.25f, ewb.texel_weight + i);
+
+		lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
+	}
 
-		ewb.texel_weight[i] = (wr + wg + wb + wa) * 0.25f;
+	// Populate the AoS view of the error weights
+	for (unsigned int i = 0; i < texel_count; i++)
+	{
+		ewb.error_weights[i] = vfloat4(ewb.texel_weight_r[i],
+		                               ewb.texel_weight_g[i],
+		                               ewb.texel_weight_b[i],
+		                               ewb.texel_weight_a[i]);
 	}
 
+	// Small bias to avoid divide by zeros and NaN propagation later
+	vfloat4 texel_weight_sum = vfloat4(1e-17f) + vfloat4(hadd_s(texel_sum_r),
+	                                                     hadd_s(texel_sum_g),
+	                                                     hadd_s(texel_sum_b),
+	                                                     hadd_s(texel_sum_a));
+
+	vfloat4 error_weight_sum = vfloat4(1e-17f) + vfloat4(hadd_s(weight_sum_r),
+	                                                     hadd_s(weight_sum_g),
+	                                                     hadd_s(weight_sum_b),
+	                                                     hadd_s(weight_sum_a));
+
 	ewb.block_error_weighted_rgba_sum = texel_weight_sum;
 	ewb.block_error_weight_sum = error_weight_sum;
 
@@ -1172,6 +1640,8 @@ static float prepare_error_weight_block(
 /**
  * @brief Determine the lowest cross-channel correlation factor.
  *
+ * The weighted covariance matrix is accumulated N (SIMD width) texels at a time.
+ *
  * @param texels_per_block   The number of texels in a block.
  * @param blk                The image block color data to compress.
  * @param ewb                The image block weighted error data.
@@ -1185,58 +1655,81 @@ static float prepare_block_statistics(
 ) {
 	// Compute covariance matrix, as a collection of 10 scalars that form the upper-triangular row
 	// of the matrix. The matrix is symmetric, so this is all we need for this use case.
-	float rs = 0.0f;
-	float gs = 0.0f;
-	float bs = 0.0f;
-	float as = 0.0f;
-	float rr_var = 0.0f;
-	float gg_var = 0.0f;
-	float bb_var = 0.0f;
-	float aa_var = 0.0f;
-	float rg_cov = 0.0f;
-	float rb_cov = 0.0f;
-	float ra_cov = 0.0f;
-	float gb_cov = 0.0f;
-	float ga_cov = 0.0f;
-	float ba_cov = 0.0f;
-
-	float weight_sum = 0.0f;
+	vfloat rs_v = vfloat::zero();
+	vfloat gs_v = vfloat::zero();
+	vfloat bs_v = vfloat::zero();
+	vfloat as_v = vfloat::zero();
+	vfloat rr_var_v = vfloat::zero();
+	vfloat gg_var_v = vfloat::zero();
+	vfloat bb_var_v = vfloat::zero();
+	vfloat aa_var_v = vfloat::zero();
+	vfloat rg_cov_v = vfloat::zero();
+	vfloat rb_cov_v = vfloat::zero();
+	vfloat ra_cov_v = vfloat::zero();
+	vfloat gb_cov_v = vfloat::zero();
+	vfloat ga_cov_v = vfloat::zero();
+	vfloat ba_cov_v = vfloat::zero();
+
+	vfloat weight_sum_v = vfloat::zero();
 
 	promise(texels_per_block > 0);
-	for (int i = 0; i < texels_per_block; i++)
+
+	vint lane_ids = vint::lane_id();
+	for (int i = 0; i < texels_per_block; i += ASTCENC_SIMD_WIDTH)
 	{
-		float weight = ewb.texel_weight[i];
-		assert(weight >= 0.0f);
-		weight_sum += weight;
-
-		float r = blk.data_r[i];
-		float g = blk.data_g[i];
-		float b = blk.data_b[i];
-		float a = blk.data_a[i];
-
-		float rw = r * weight;
-		rs += rw;
-		rr_var += r * rw;
-		rg_cov += g * rw;
-		rb_cov += b * rw;
-		ra_cov += a * rw;
-
-		float gw = g * weight;
-		gs += gw;
-		gg_var += g * gw;
-		gb_cov += b * gw;
-		ga_cov += a * gw;
-
-		float bw = b * weight;
-		bs += bw;
-		bb_var += b * bw;
-		ba_cov += a * bw;
-
-		float aw = a * weight;
-		as += aw;
-		aa_var += a * aw;
+		// Mask out the SIMD tail, which may contain stale data
+		vmask active = lane_ids < vint(texels_per_block);
+
+		vfloat weight = select(vfloat::zero(), vfloat(ewb.texel_weight + i), active);
+		weight_sum_v += weight;
+
+		vfloat r = select(vfloat::zero(), vfloat(blk.data_r + i), active);
+		vfloat g = select(vfloat::zero(), vfloat(blk.data_g + i), active);
+		vfloat b = select(vfloat::zero(), vfloat(blk.data_b + i), active);
+		vfloat a = select(vfloat::zero(), vfloat(blk.data_a + i), active);
+
+		vfloat rw = r * weight;
+		rs_v += rw;
+		rr_var_v += r * rw;
+		rg_cov_v += g * rw;
+		rb_cov_v += b * rw;
+		ra_cov_v += a * rw;
+
+		vfloat gw = g * weight;
+		gs_v += gw;
+		gg_var_v += g * gw;
+		gb_cov_v += b * gw;
+		ga_cov_v += a * gw;
+
+		vfloat bw = b * weight;
+		bs_v += bw;
+		bb_var_v += b * bw;
+		ba_cov_v += a * bw;
+
+		vfloat aw = a * weight;
+		as_v += aw;
+		aa_var_v += a * aw;
+
+		lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
 	}
 
+	float rs = hadd_s(rs_v);
+	float gs = hadd_s(gs_v);
+	float bs = hadd_s(bs_v);
+	float as = hadd_s(as_v);
+	float rr_var = hadd_s(rr_var_v);
+	float gg_var = hadd_s(gg_var_v);
+	float bb_var = hadd_s(bb_var_v);
+	float aa_var = hadd_s(aa_var_v);
+	float rg_cov = hadd_s(rg_cov_v);
+	float rb_cov = hadd_s(rb_cov_v);
+	float ra_cov = hadd_s(ra_cov_v);
+	float gb_cov = hadd_s(gb_cov_v);
+	float ga_cov = hadd_s(ga_cov_v);
+	float ba_cov = hadd_s(ba_cov_v);
+
+	float weight_sum = hadd_s(weight_sum_v);
+
 	float rpt = 1.0f / astc::max(weight_sum, 1e-7f);
 
 	rr_var -= rs * (rs * rpt);
@@ -1292,112 +1785,211 @@ static float prepare_block_statistics(
 	return lowest_correlation;
 }
 
-/* See header for documentation. */
-void compress_block(
-	const astcenc_context& ctx,
-	const astcenc_image& input_image,
-	const image_block& blk,
-	physical_compressed_block& pcb,
-	compression_working_buffers& tmpbuf)
-{
-	astcenc_profile decode_mode = ctx.config.profile;
-	symbolic_compressed_block scb;
-	error_weight_block& ewb = tmpbuf.ewb;
-	const block_size_descriptor* bsd = ctx.bsd;
-	float lowest_correl;
+/**
+ * @brief Get the maximum partition count to trial for a block.
+ *
+ * @param config   The compressor configuration.
+ * @param blk      The image block color data to compress.
+ *
+ * @return The maximum partition count.
+ */
+static int get_block_max_partitions(
+	const astcenc_config& config,
+	const image_block& blk
+) {
+	// Default max partition, but +1 if only have 1 or 2 active components
+	int max_partitions = config.tune_partition_count_limit;
+	if (blk.is_luminance() || blk.is_luminancealpha())
+	{
+		max_partitions = astc::min(max_partitions + 1, 4);
+	}
 
-	TRACE_NODE(node0, "block");
-	trace_add_data("pos_x", blk.xpos);
-	trace_add_data("pos_y", blk.ypos);
-	trace_add_data("pos_z", blk.zpos);
+	return max_partitions;
+}
 
+/* See header for documentation. */
+float get_block_error_threshold(
+	const astcenc_config& config,
+	const image_block& blk,
+	float error_weight_sum
+) {
 	// Set stricter block targets for luminance data as we have more bits to play with
-	bool block_is_l = blk.is_luminance();
-	float block_is_l_scale = block_is_l ? 1.0f / 1.5f : 1.0f;
+	float block_is_l_scale = blk.is_luminance() ? 1.0f / 1.5f : 1.0f;
 
 	// Set slightly stricter block targets for lumalpha data as we have more bits to play with
-	bool block_is_la = blk.is_luminancealpha();
-	float block_is_la_scale = block_is_la ? 1.0f / 1.05f : 1.0f;
+	float block_is_la_scale = blk.is_luminancealpha() ? 1.0f / 1.05f : 1.0f;
 
-	bool block_skip_two_plane = false;
+	return config.tune_db_limit
+	     * error_weight_sum
+	     * block_is_l_scale
+	     * block_is_la_scale;
+}
 
-	// Default max partition, but +1 if only have 1 or 2 active components
-	int max_partitions = ctx.config.tune_partition_count_limit;
-	if (block_is_l || block_is_la)
+/**
+ * @brief Encode a constant color block.
+ *
+ * @param      decode_mode   The decode mode (LDR, HDR, etc).
+ * @param      blk           The image block color data to compress.
+ * @param[out] scb           The symbolic compressed block output.
+ */
+static void encode_constant_block(
+	astcenc_profile decode_mode,
+	const image_block& blk,
+	symbolic_compressed_block& scb
+) {
+	scb.partition_count = 0;
+
+	// Encode as FP16 if using HDR
+	if ((decode_mode == ASTCENC_PRF_HDR) ||
+	    (decode_mode == ASTCENC_PRF_HDR_RGB_LDR_A))
 	{
-		max_partitions = astc::min(max_partitions + 1, 4);
+		scb.block_type = SYM_BTYPE_CONST_F16;
+		vint4 color_f16 = float_to_float16(blk.origin_texel);
+		store(color_f16, scb.constant_color);
 	}
+	// Encode as UNORM16 if NOT using HDR
+	else
+	{
+		scb.block_type = SYM_BTYPE_CONST_U16;
+		vfloat4 color_f32 = clamp(0.0f, 1.0f, blk.origin_texel) * 65535.0f;
+		vint4 color_u16 = float_to_int_rtn(color_f32);
+		store(color_u16, scb.constant_color);
+	}
+}
 
-
-#if defined(ASTCENC_DIAGNOSTICS)
-	// Do this early in diagnostic builds so we can dump uniform metrics
-	// for every block. Do it later in release builds to avoid redundant work!
-	float error_weight_sum = prepare_error_weight_block(ctx, input_image, *bsd, blk, ewb);
-	float error_threshold = ctx.config.tune_db_limit
-	                      * error_weight_sum
-	                      * block_is_l_scale
-	                      * block_is_la_scale;
-
-	lowest_correl = prepare_block_statistics(bsd->texel_count, blk, ewb);
-	trace_add_data("lowest_correl", lowest_correl);
-	trace_add_data("tune_error_threshold", error_threshold);
+/**
+ * @brief Convert a block with no valid encoding into something we can encode.
+ *
+ * @param      blk   The image block color data to compress.
+ * @param[out] scb   The symbolic compressed block output.
+ */
+static void encode_fallback_block(
+	const image_block& blk,
+	symbolic_compressed_block& scb
+) {
+	// TODO: Do something more sensible here, such as average color block
+#if !defined(NDEBUG)
+	static bool printed_once = false;
+	if (!printed_once)
+	{
+		printed_once = true;
+		printf("WARN: At least one block failed to find a valid encoding.\n"
+		       "      Try increasing compression quality settings.\n\n");
+	}
 #endif
 
-	// Detected a constant-color block
-	if (all(blk.data_min == blk.data_max))
-	{
-		TRACE_NODE(node1, "pass");
-		trace_add_data("partition_count", 0);
-		trace_add_data("plane_count", 1);
+	scb.block_type = SYM_BTYPE_CONST_U16;
+	scb.block_mode = -2;
+	vfloat4 color_f32 = clamp(0.0f, 1.0f, blk.origin_texel) * 65535.0f;
+	vint4 color_u16 = float_to_int_rtn(color_f32);
+	store(color_u16, scb.constant_color);
+}
 
-		scb.partition_count = 0;
+/**
+ * @brief Get the last trial group that the single-threaded search order runs for a block.
+ *
+ * This replays the quality target and partition count early-outs of @c compress_block() over the
+ * results of the completed trial groups.
+ *
+ * @param config        The compressor configuration.
+ * @param blk           The image block color data to compress.
+ * @param state         The shared search state for this block.
+ * @param group_count   The number of groups, starting from group 0, to replay.
+ *
+ * @return The last group run, or @c BLOCK_SEARCH_GROUPS if the replayed groups do not end the
+ *         search or have not all completed.
+ */
+static unsigned int get_last_search_group(
+	const astcenc_config& config,
+	const image_block& blk,
+	const block_search_state& state,
+	unsigned int group_count
+) {
+	unsigned int max_partitions = static_cast<unsigned int>(get_block_max_partitions(config, blk));
+
+	float exit_thresholds_for_pcount[BLOCK_MAX_PARTITIONS] {
+		0.0f,
+		config.tune_2_partition_early_out_limit_factor,
+		config.tune_3_partition_early_out_limit_factor,
+		0.0f
+	};
 
-		// Encode as FP16 if using HDR
-		if ((decode_mode == ASTCENC_PRF_HDR) ||
-		    (decode_mode == ASTCENC_PRF_HDR_RGB_LDR_A))
+	for (unsigned int i = 0; i < group_count; i++)
+	{
+		if (!state.group_done[i].load(std::memory_order_acquire))
 		{
-			scb.block_type = SYM_BTYPE_CONST_F16;
-			vint4 color_f16 = float_to_float16(blk.origin_texel);
-			store(color_f16, scb.constant_color);
+			return BLOCK_SEARCH_GROUPS;
 		}
-		// Encode as UNORM16 if NOT using HDR
-		else
+
+		if (state.group_hit[i] || (i + 1 >= max_partitions))
 		{
-			scb.block_type = SYM_BTYPE_CONST_U16;
-			vfloat4 color_f32 = clamp(0.0f, 1.0f, blk.origin_texel) * 65535.0f;
-			vint4 color_u16 = float_to_int_rtn(color_f32);
-			store(color_u16, scb.constant_color);
+			return i;
 		}
 
-		trace_add_data("exit", "quality hit");
-
-		symbolic_to_physical(*bsd, scb, pcb);
-		return;
+		// If using N partitions doesn't improve much over using N-1 partitions then skip trying N+1
+		if ((i > 0) && (state.group_best_errorval[i] >
+		                (state.group_best_errorval[i - 1] * exit_thresholds_for_pcount[i])))
+		{
+			return i;
+		}
 	}
 
-#if !defined(ASTCENC_DIAGNOSTICS)
-	float error_weight_sum = prepare_error_weight_block(ctx, input_image, *bsd, blk, ewb);
-	float error_threshold = ctx.config.tune_db_limit
-	                      * error_weight_sum
-	                      * block_is_l_scale
-	                      * block_is_la_scale;
-#endif
-
-	// Set SCB and mode errors to a very high error value
-	scb.errorval = ERROR_CALC_DEFAULT;
-	scb.block_type = SYM_BTYPE_ERROR;
+	return BLOCK_SEARCH_GROUPS;
+}
 
-	float best_errorvals_for_pcount[BLOCK_MAX_PARTITIONS] {
-		ERROR_CALC_DEFAULT, ERROR_CALC_DEFAULT, ERROR_CALC_DEFAULT, ERROR_CALC_DEFAULT
-	};
+/**
+ * @brief Test if the single-threaded search order will never reach a trial group.
+ *
+ * @param config   The compressor configuration.
+ * @param blk      The image block color data to compress.
+ * @param state    The shared search state for this block, or @c nullptr for a sequential search.
+ * @param group    The trial group index.
+ *
+ * @return Return @c true if the group results will not be used, @c false otherwise.
+ */
+static bool is_search_group_unreachable(
+	const astcenc_config& config,
+	const image_block& blk,
+	const block_search_state* state,
+	unsigned int group
+) {
+	if (!state)
+	{
+		return false;
+	}
 
-	float exit_thresholds_for_pcount[BLOCK_MAX_PARTITIONS] {
-		0.0f,
-		ctx.config.tune_2_partition_early_out_limit_factor,
-		ctx.config.tune_3_partition_early_out_limit_factor,
-		0.0f
-	};
+	return (state->first_hit_group.load(std::memory_order_relaxed) < group) ||
+	       (get_last_search_group(config, blk, *state, group) < group);
+}
 
+/**
+ * @brief Run the trials for a block using 1 partition and 1 plane of weights.
+ *
+ * @param      config            The compressor configuration.
+ * @param      bsd               The block size information.
+ * @param      blk               The image block color data to compress.
+ * @param      ewb               The error weight block data.
+ * @param      error_threshold   The error below which the search can stop.
+ * @param[out] best_errorval     The best error found.
+ * @param[out] scb               The best symbolic compressed block found so far.
+ * @param[out] tmpbuf            Preallocated scratch buffers for the compressor.
+ * @param      state             The shared search state, or @c nullptr for a sequential search.
+ * @param      group             The trial group index, if @c state is not @c nullptr.
+ *
+ * @return Return @c true if the quality target was hit, @c false otherwise.
+ */
+static bool compress_block_1partition_1plane(
+	const astcenc_config& config,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	float error_threshold,
+	float& best_errorval,
+	symbolic_compressed_block& scb,
+	compression_working_buffers& tmpbuf,
+	const block_search_state* state,
+	unsigned int group
+) {
 	// Trial using 1 plane of weights and 1 partition.
 
 	// Most of the time we test it twice, first with a mode cutoff of 0 and then with the specified
@@ -1406,49 +1998,90 @@ void compress_block(
 	// compression and slightly reduces image quality.
 
 	float errorval_mult[2] {
-		1.0f / ctx.config.tune_mode0_mse_overshoot,
+		1.0f / config.tune_mode0_mse_overshoot,
 		1.0f
 	};
 
-	static const float errorval_overshoot = 1.0f / ctx.config.tune_refinement_mse_overshoot;
+	float errorval_overshoot = 1.0f / config.tune_refinement_mse_overshoot;
 
 	// Only enable MODE0 fast path (trial 0) if 2D and more than 25 texels
 	int start_trial = 1;
-	if ((bsd->texel_count >= TUNE_MIN_TEXELS_MODE0_FASTPATH) && (bsd->zdim == 1))
+	if ((bsd.texel_count >= TUNE_MIN_TEXELS_MODE0_FASTPATH) && (bsd.zdim == 1))
 	{
 		start_trial = 0;
 	}
 
 	for (int i = start_trial; i < 2; i++)
 	{
+		if (is_search_group_unreachable(config, blk, state, group))
+		{
+			return false;
+		}
+
 		TRACE_NODE(node1, "pass");
 		trace_add_data("partition_count", 1);
 		trace_add_data("plane_count", 1);
 		trace_add_data("search_mode", i);
 
 		float errorval = compress_symbolic_block_for_partition_1plane(
-		    ctx.config, *bsd, blk, ewb, i == 0,
+		    config, bsd, blk, ewb, i == 0,
 		    error_threshold * errorval_mult[i] * errorval_overshoot,
 		    1, 0,  scb, tmpbuf);
 
-		best_errorvals_for_pcount[0] = astc::min(best_errorvals_for_pcount[0], errorval);
+		best_errorval = astc::min(best_errorval, errorval);
 		if (errorval < (error_threshold * errorval_mult[i]))
 		{
 			trace_add_data("exit", "quality hit");
-			goto END_OF_TESTS;
+			return true;
 		}
 	}
 
-#if !defined(ASTCENC_DIAGNOSTICS)
-	lowest_correl = prepare_block_statistics(bsd->texel_count, blk, ewb);
-#endif
+	return false;
+}
+
+/**
+ * @brief Run the trials for a block using 1 partition and 2 planes of weights.
+ *
+ * @param      config            The compressor configuration.
+ * @param      bsd               The block size information.
+ * @param      blk               The image block color data to compress.
+ * @param      ewb               The error weight block data.
+ * @param      lowest_correl     The lowest correlation between any two color components.
+ * @param      error_threshold   The error below which the search can stop.
+ * @param      best_errorval     The best 1 plane error found.
+ * @param[out] scb               The best symbolic compressed block found so far.
+ * @param[out] tmpbuf            Preallocated scratch buffers for the compressor.
+ * @param      state             The shared search state, or @c nullptr for a sequential search.
+ * @param      group             The trial group index, if @c state is not @c nullptr.
+ *
+ * @return Return @c true if the quality target was hit, @c false otherwise.
+ */
+static bool compress_block_1partition_2planes(
+	const astcenc_config& config,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	float lowest_correl,
+	float error_threshold,
+	float best_errorval,
+	symbolic_compressed_block& scb,
+	compression_working_buffers& tmpbuf,
+	const block_search_state* state,
+	unsigned int group
+) {
+	float errorval_overshoot = 1.0f / config.tune_refinement_mse_overshoot;
 
-	block_skip_two_plane = lowest_correl > ctx.config.tune_2_plane_early_out_limit_correlation;
+	bool block_skip_two_plane = lowest_correl > config.tune_2_plane_early_out_limit_correlation;
 
 	// Test the four possible 1-partition, 2-planes modes. Do this in reverse, as
 	// alpha is the most likely to be non-correlated if it is present in the data.
 	for (int i = BLOCK_MAX_COMPONENTS - 1; i >= 0; i--)
 	{
+		if (is_search_group_unreachable(config, blk, state, group))
+		{
+			return false;
+		}
+
 		TRACE_NODE(node1, "pass");
 		trace_add_data("partition_count", 1);
 		trace_add_data("plane_count", 2);
@@ -1473,13 +2106,13 @@ void compress_block(
 		}
 
 		float errorval = compress_symbolic_block_for_partition_2planes(
-		    ctx.config, *bsd, blk, ewb,
+		    config, bsd, blk, ewb,
 		    error_threshold * errorval_overshoot,
 		    i, scb, tmpbuf);
 
 		// If attempting two planes is much worse than the best one plane result
 		// then further two plane searches are unlikely to help so move on ...
-		if (errorval > (best_errorvals_for_pcount[0] * 2.0f))
+		if (errorval > (best_errorval * 2.0f))
 		{
 			break;
 		}
@@ -1487,40 +2120,197 @@ void compress_block(
 		if (errorval < error_threshold)
 		{
 			trace_add_data("exit", "quality hit");
-			goto END_OF_TESTS;
+			return true;
 		}
 	}
 
-	// Find best blocks for 2, 3 and 4 partitions
-	for (int partition_count = 2; partition_count <= max_partitions; partition_count++)
+	return false;
+}
+
+/**
+ * @brief Run the trials for a block using 2 or more partitions and 1 plane of weights.
+ *
+ * @param      config            The compressor configuration.
+ * @param      bsd               The block size information.
+ * @param      blk               The image block color data to compress.
+ * @param      ewb               The error weight block data.
+ * @param      partition_count   The partition count to trial.
+ * @param      error_threshold   The error below which the search can stop.
+ * @param[out] best_errorval     The best error found for this partition count.
+ * @param[out] scb               The best symbolic compressed block found so far.
+ * @param[out] tmpbuf            Preallocated scratch buffers for the compressor.
+ * @param      state             The shared search state, or @c nullptr for a sequential search.
+ * @param      group             The trial group index, if @c state is not @c nullptr.
+ *
+ * @return Return @c true if the quality target was hit, @c false otherwise.
+ */
+static bool compress_block_npartitions(
+	const astcenc_config& config,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	int partition_count,
+	float error_threshold,
+	float& best_errorval,
+	symbolic_compressed_block& scb,
+	compression_working_buffers& tmpbuf,
+	const block_search_state* state,
+	unsigned int group
+) {
+	float errorval_overshoot = 1.0f / config.tune_refinement_mse_overshoot;
+
+	unsigned int partition_indices_1plane[2] { 0, 0 };
+	float partition_bounds_1plane[2] { 0.0f, 0.0f };
+
+	find_best_partition_candidates(bsd, blk, ewb, partition_count,
+	                               config.tune_partition_index_limit,
+	                               partition_indices_1plane[0],
+	                               partition_indices_1plane[1],
+	                               partition_bounds_1plane[0],
+	                               partition_bounds_1plane[1]);
+
+	// The bounds are in the same units as the LDR block error, but not the HDR or RGBM errors
+	bool use_bounds = ((config.profile == ASTCENC_PRF_LDR) ||
+	                   (config.profile == ASTCENC_PRF_LDR_SRGB)) &&
+	                  !(config.flags & ASTCENC_FLG_MAP_RGBM);
+
+	for (int i = 0; i < 2; i++)
 	{
-		unsigned int partition_indices_1plane[2] { 0, 0 };
+		if (is_search_group_unreachable(config, blk, state, group))
+		{
+			return false;
+		}
 
-		find_best_partition_candidates(*bsd, blk, ewb, partition_count,
-		                               ctx.config.tune_partition_index_limit,
-		                               partition_indices_1plane[0],
-		                               partition_indices_1plane[1]);
+		TRACE_NODE(node1, "pass");
+		trace_add_data("partition_count", partition_count);
+		trace_add_data("partition_index", partition_indices_1plane[i]);
+		trace_add_data("plane_count", 1);
+		trace_add_data("search_mode", i);
 
-		for (int i = 0; i < 2; i++)
+		// Skip the full trial if its error estimate cannot improve on the best encoding so far
+		if (use_bounds && (partition_bounds_1plane[i] > scb.errorval))
 		{
-			TRACE_NODE(node1, "pass");
-			trace_add_data("partition_count", partition_count);
-			trace_add_data("partition_index", partition_indices_1plane[i]);
-			trace_add_data("plane_count", 1);
-			trace_add_data("search_mode", i);
-
-			float errorval = compress_symbolic_block_for_partition_1plane(
-			    ctx.config, *bsd, blk, ewb, false,
-			    error_threshold * errorval_overshoot,
-			    partition_count, partition_indices_1plane[i],
-			    scb, tmpbuf);
-
-			best_errorvals_for_pcount[partition_count - 1] = astc::min(best_errorvals_for_pcount[partition_count - 1], errorval);
-			if (errorval < error_threshold)
-			{
-				trace_add_data("exit", "quality hit");
-				goto END_OF_TESTS;
-			}
+			trace_add_data("skip", "error bound");
+
+			// Use the estimate as the trial error, so the partition count early-out still works
+			best_errorval = astc::min(best_errorval, partition_bounds_1plane[i]);
+			continue;
+		}
+
+		float errorval = compress_symbolic_block_for_partition_1plane(
+		    config, bsd, blk, ewb, false,
+		    error_threshold * errorval_overshoot,
+		    partition_count, partition_indices_1plane[i],
+		    scb, tmpbuf);
+
+		best_errorval = astc::min(best_errorval, errorval);
+		if (errorval < error_threshold)
+		{
+			trace_add_data("exit", "quality hit");
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* See header for documentation. */
+void compress_block(
+	const astcenc_context& ctx,
+	const astcenc_config& config,
+	const astcenc_image& input_image,
+	const image_block& blk,
+	physical_compressed_block& pcb,
+	compression_working_buffers& tmpbuf)
+{
+	symbolic_compressed_block scb;
+	error_weight_block& ewb = tmpbuf.ewb;
+	const block_size_descriptor* bsd = ctx.bsd;
+	float lowest_correl;
+
+	tmpbuf.candidates.count = 0;
+
+	TRACE_NODE(node0, "block");
+	trace_add_data("pos_x", blk.xpos);
+	trace_add_data("pos_y", blk.ypos);
+	trace_add_data("pos_z", blk.zpos);
+
+	int max_partitions = get_block_max_partitions(config, blk);
+
+#if defined(ASTCENC_DIAGNOSTICS)
+	// Do this early in diagnostic builds so we can dump uniform metrics
+	// for every block. Do it later in release builds to avoid redundant work!
+	float error_weight_sum = prepare_error_weight_block(ctx, input_image, *bsd, blk, ewb);
+	float error_threshold = get_block_error_threshold(config, blk, error_weight_sum);
+
+	lowest_correl = prepare_block_statistics(bsd->texel_count, blk, ewb);
+	trace_add_data("lowest_correl", lowest_correl);
+	trace_add_data("tune_error_threshold", error_threshold);
+#endif
+
+	// Detected a constant-color block
+	if (all(blk.data_min == blk.data_max))
+	{
+		TRACE_NODE(node1, "pass");
+		trace_add_data("partition_count", 0);
+		trace_add_data("plane_count", 1);
+
+		encode_constant_block(config.profile, blk, scb);
+
+		trace_add_data("exit", "quality hit");
+
+		symbolic_to_physical(*bsd, scb, pcb);
+		record_block_candidate(*bsd, scb, 0.0f, tmpbuf.candidates);
+		tmpbuf.error_weight_sum = 0.0f;
+		return;
+	}
+
+#if !defined(ASTCENC_DIAGNOSTICS)
+	float error_weight_sum = prepare_error_weight_block(ctx, input_image, *bsd, blk, ewb);
+	float error_threshold = get_block_error_threshold(config, blk, error_weight_sum);
+#endif
+
+	tmpbuf.error_weight_sum = error_weight_sum;
+
+	// Set SCB and mode errors to a very high error value
+	scb.errorval = ERROR_CALC_DEFAULT;
+	scb.block_type = SYM_BTYPE_ERROR;
+
+	float best_errorvals_for_pcount[BLOCK_MAX_PARTITIONS] {
+		ERROR_CALC_DEFAULT, ERROR_CALC_DEFAULT, ERROR_CALC_DEFAULT, ERROR_CALC_DEFAULT
+	};
+
+	float exit_thresholds_for_pcount[BLOCK_MAX_PARTITIONS] {
+		0.0f,
+		config.tune_2_partition_early_out_limit_factor,
+		config.tune_3_partition_early_out_limit_factor,
+		0.0f
+	};
+
+	if (compress_block_1partition_1plane(config, *bsd, blk, ewb, error_threshold,
+	                                     best_errorvals_for_pcount[0], scb, tmpbuf, nullptr, 0))
+	{
+		goto END_OF_TESTS;
+	}
+
+#if !defined(ASTCENC_DIAGNOSTICS)
+	lowest_correl = prepare_block_statistics(bsd->texel_count, blk, ewb);
+#endif
+
+	if (compress_block_1partition_2planes(config, *bsd, blk, ewb, lowest_correl, error_threshold,
+	                                      best_errorvals_for_pcount[0], scb, tmpbuf, nullptr, 0))
+	{
+		goto END_OF_TESTS;
+	}
+
+	// Find best blocks for 2, 3 and 4 partitions
+	for (int partition_count = 2; partition_count <= max_partitions; partition_count++)
+	{
+		if (compress_block_npartitions(config, *bsd, blk, ewb, partition_count, error_threshold,
+		                               best_errorvals_for_pcount[partition_count - 1], scb, tmpbuf,
+		                               nullptr, 0))
+		{
+			goto END_OF_TESTS;
 		}
 
 		// If using N partitions doesn't improve much over using N-1 partitions then skip trying N+1
@@ -1538,28 +2328,137 @@ void compress_block(
 
 END_OF_TESTS:
 	// If we still have an error block then convert to something we can encode
-	// TODO: Do something more sensible here, such as average color block
 	if (scb.block_type == SYM_BTYPE_ERROR)
 	{
-#if !defined(NDEBUG)
-		static bool printed_once = false;
-		if (!printed_once)
+		encode_fallback_block(blk, scb);
+	}
+
+	// Compress to a physical block
+	symbolic_to_physical(*bsd, scb, pcb);
+
+	// The fallback encoding for a failed search is not in the candidate list, so add it
+	if (tmpbuf.candidates.count == 0)
+	{
+		record_block_candidate(*bsd, scb, scb.errorval, tmpbuf.candidates);
+	}
+}
+
+/* See header for documentation. */
+void compress_block_trial_group(
+	const astcenc_context& ctx,
+	const astcenc_config& config,
+	const astcenc_image& input_image,
+	const image_block& blk,
+	unsigned int group,
+	block_search_state& state,
+	compression_working_buffers& tmpbuf
+) {
+	const block_size_descriptor& bsd = *ctx.bsd;
+	const error_weight_block& ewb = state.ewb;
+	symbolic_compressed_block& scb = state.group_scb[group];
+
+	tmpbuf.candidates.count = 0;
+
+	scb.errorval = ERROR_CALC_DEFAULT;
+	scb.block_type = SYM_BTYPE_ERROR;
+
+	bool hit = false;
+	float best_errorval = ERROR_CALC_DEFAULT;
+
+	// Skip the group if the search order will never reach it, as the result of this group will
+	// not be used. This is only a work saving; the final result does not depend on it.
+	int partition_count = static_cast<int>(group) + 1;
+	if (is_search_group_unreachable(config, blk, &state, group) ||
+	    (partition_count > get_block_max_partitions(config, blk)))
+	{
+		// Do nothing
+	}
+	// Constant color blocks are handled by the first group
+	else if (all(blk.data_min == blk.data_max))
+	{
+		if (group == 0)
 		{
-			printed_once = true;
-			printf("WARN: At least one block failed to find a valid encoding.\n"
-			       "      Try increasing compression quality settings.\n\n");
+			encode_constant_block(config.profile, blk, scb);
+			scb.errorval = 0.0f;
+			hit = true;
+		}
+	}
+	else
+	{
+		// The first group to run prepares the error weights, and later groups reuse them
+		{
+			std::lock_guard<std::mutex> lock(state.prepare_lock);
+			if (!state.prepared)
+			{
+				float error_weight_sum = prepare_error_weight_block(ctx, input_image, bsd, blk, state.ewb);
+				state.error_threshold = get_block_error_threshold(config, blk, error_weight_sum);
+				state.prepared = true;
+			}
 		}
-#endif
 
-		scb.block_type = SYM_BTYPE_CONST_U16;
-		scb.block_mode = -2;
-		vfloat4 color_f32 = clamp(0.0f, 1.0f, blk.origin_texel) * 65535.0f;
-		vint4 color_u16 = float_to_int_rtn(color_f32);
-		store(color_u16, scb.constant_color);
+		float error_threshold = state.error_threshold;
+		if (group == 0)
+		{
+			hit = compress_block_1partition_1plane(config, bsd, blk, ewb, error_threshold,
+			                                       best_errorval, scb, tmpbuf, &state, group);
+			if (!hit)
+			{
+				float lowest_correl = prepare_block_statistics(bsd.texel_count, blk, ewb);
+				hit = compress_block_1partition_2planes(config, bsd, blk, ewb, lowest_correl,
+				                                        error_threshold, best_errorval, scb, tmpbuf,
+				                                        &state, group);
+			}
+		}
+		else
+		{
+			hit = compress_block_npartitions(config, bsd, blk, ewb, partition_count,
+			                                 error_threshold, best_errorval, scb, tmpbuf,
+			                                 &state, group);
+		}
 	}
 
-	// Compress to a physical block
-	symbolic_to_physical(*bsd, scb, pcb);
+	state.group_best_errorval[group] = best_errorval;
+	state.group_hit[group] = hit;
+	state.group_done[group].store(true, std::memory_order_release);
+
+	if (hit)
+	{
+		unsigned int first_hit = state.first_hit_group.load(std::memory_order_relaxed);
+		while (group < first_hit &&
+		       !state.first_hit_group.compare_exchange_weak(first_hit, group, std::memory_order_relaxed))
+		{
+		}
+	}
+}
+
+/* See header for documentation. */
+void finish_block_search(
+	const astcenc_config& config,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const block_search_state& state,
+	physical_compressed_block& pcb
+) {
+	// Only the groups that the single-threaded search order runs contribute, and ties keep the
+	// encoding found first in that order
+	unsigned int last_group = astc::min(get_last_search_group(config, blk, state, BLOCK_SEARCH_GROUPS),
+	                                    BLOCK_SEARCH_GROUPS - 1);
+
+	symbolic_compressed_block scb = state.group_scb[0];
+	for (unsigned int i = 1; i <= last_group; i++)
+	{
+		if (state.group_scb[i].errorval < scb.errorval)
+		{
+			scb = state.group_scb[i];
+		}
+	}
+
+	if (scb.block_type == SYM_BTYPE_ERROR)
+	{
+		encode_fallback_block(blk, scb);
+	}
+
+	symbolic_to_physical(bsd, scb, pcb);
 }
 
 #endif
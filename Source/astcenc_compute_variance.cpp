@@ -27,6 +27,10 @@
  * perform a binary reduction, and then distributes the results. This method means that there is no
  * serial dependency between a given element and the next one, and also significantly improves
  * numerical stability allowing us to use floats rather than doubles.
+ *
+ * 2D U8 images with unit power adjustments use an exact integer path instead. This processes a
+ * whole row of tasks at a time, using running box sums rather than a full summed-area table so
+ * the sums never exceed the kernel footprint and fit in 32-bit lanes.
  */
 
 #include "astcenc_internal.h"
@@ -515,13 +519,173 @@ static void compute_pixel_region_variance(
 	}
 }
 
-void compute_averages_and_variances(
+/**
+ * @brief Load a swizzled U8 texel as integers.
+ *
+ * @param row   The image row data.
+ * @param x     The texel X coordinate.
+ * @param swz   The component swizzle pattern.
+ *
+ * @return The swizzled texel, in the range 0-255.
+ */
+static inline vint4 load_u8_texel(
+	const uint8_t* row,
+	int x,
+	const astcenc_swizzle& swz
+) {
+	// Swizzle data structure 4 = ZERO, 5 = ONE
+	int data[6] {
+		row[4 * x    ],
+		row[4 * x + 1],
+		row[4 * x + 2],
+		row[4 * x + 3],
+		0,
+		255
+	};
+
+	return vint4(data[swz.r], data[swz.g], data[swz.b], data[swz.a]);
+}
+
+/**
+ * @brief Compute averages and variances for a row of U8 pixel regions using integer sums.
+ *
+ * This computes the same result as @c compute_pixel_region_variance() for 2D U8 images with unit
+ * power adjustments, but accumulates exact integer sums and processes the full width of the image
+ * in one pass so the kernel apron is loaded once per row rather than once per region.
+ *
+ * The column sums for the current output row are maintained incrementally by adding the row
+ * entering the kernel and removing the row leaving it, and each output texel is then a running
+ * horizontal sum of the column sums.
+ *
+ * @param[out] ctx   The compressor context storing the output data.
+ * @param      arg   The input parameter structure.
+ */
+static void compute_pixel_region_variance_u8(
 	astcenc_context& ctx,
-	const avg_var_args &ag
+	const pixel_region_variance_args& arg
 ) {
-	pixel_region_variance_args arg = ag.arg;
-	arg.work_memory = new vfloat4[ag.work_memory_size];
+	const astcenc_image* img = arg.img;
+	const astcenc_swizzle& swz = arg.swz;
+
+	int dim_x = img->dim_x;
+	int dim_y = img->dim_y;
+
+	int size_y = arg.size_y;
+	int offset_y = arg.offset_y;
+
+	// Lookups use the alpha kernel for all outputs, matching the floating-point path
+	int radius = arg.alpha_kernel_radius;
+	int kdim = 2 * radius + 1;
+	int padsize_x = dim_x + 2 * radius;
+
+	float*   input_alpha_averages = ctx.input_alpha_averages;
+	vfloat4* input_averages = ctx.input_averages;
+	vfloat4* input_variances = ctx.input_variances;
+
+	vint4* col_sum = arg.int_work_memory;
+	vint4* col_sum_sq = arg.int_work_memory + padsize_x;
+
+	const uint8_t* data8 = static_cast<const uint8_t*>(img->data[0]);
+	int row_stride = 4 * dim_x;
+
+	// Compute a few constants used in the variance-calculation.
+	int avg_var_kdim = 2 * arg.avg_var_kernel_radius + 1;
+	float avg_var_samples = static_cast<float>(avg_var_kdim * avg_var_kdim);
+	float avg_var_rsamples = 1.0f / avg_var_samples;
+	float alpha_rsamples = 1.0f / static_cast<float>(kdim * kdim);
+
+	float mul1 = 1.0f;
+	if (avg_var_samples != 1.0f)
+	{
+		mul1 = 1.0f / (avg_var_samples * (avg_var_samples - 1.0f));
+	}
+
+	float mul2 = avg_var_samples * mul1;
+
+	// Populate the column sums for the first output row
+	for (int x = 0; x < padsize_x; x++)
+	{
+		col_sum[x] = vint4::zero();
+		col_sum_sq[x] = vint4::zero();
+	}
+
+	for (int y = offset_y - radius; y <= offset_y + radius; y++)
+	{
+		const uint8_t* row = data8 + row_stride * astc::clamp(y, 0, dim_y - 1);
+		for (int x = 0; x < padsize_x; x++)
+		{
+			vint4 d = load_u8_texel(row, astc::clamp(x - radius, 0, dim_x - 1), swz);
+			col_sum[x] += d;
+			col_sum_sq[x] += d * d;
+		}
+	}
+
+	for (int y = 0; y < size_y; y++)
+	{
+		int y_dst = y + offset_y;
+
+		// Slide the column sums down to this output row
+		if (y != 0)
+		{
+			int y_add = astc::clamp(y_dst + radius, 0, dim_y - 1);
+			int y_sub = astc::clamp(y_dst - radius - 1, 0, dim_y - 1);
+			const uint8_t* row_add = data8 + row_stride * y_add;
+			const uint8_t* row_sub = data8 + row_stride * y_sub;
+
+			for (int x = 0; x < padsize_x; x++)
+			{
+				int x_src = astc::clamp(x - radius, 0, dim_x - 1);
+				vint4 da = load_u8_texel(row_add, x_src, swz);
+				vint4 ds = load_u8_texel(row_sub, x_src, swz);
+				col_sum[x] += da - ds;
+				col_sum_sq[x] += da * da - ds * ds;
+			}
+		}
 
+		// Slide the kernel along the row using the column sums
+		vint4 sum = vint4::zero();
+		vint4 sum_sq = vint4::zero();
+		for (int x = 0; x < kdim - 1; x++)
+		{
+			sum += col_sum[x];
+			sum_sq += col_sum_sq[x];
+		}
+
+		for (int x = 0; x < dim_x; x++)
+		{
+			sum += col_sum[x + kdim - 1];
+			sum_sq += col_sum_sq[x + kdim - 1];
+
+			vfloat4 v1sum = int_to_float(sum) * (1.0f / 255.0f);
+			vfloat4 v2sum = int_to_float(sum_sq) * (1.0f / (255.0f * 255.0f));
+
+			int out_index = y_dst * dim_x + x;
+			input_alpha_averages[out_index] = v1sum.lane<3>() * alpha_rsamples;
+			input_averages[out_index] = v1sum * avg_var_rsamples;
+			input_variances[out_index] = mul2 * v2sum - mul1 * (v1sum * v1sum);
+
+			sum = sum - col_sum[x];
+			sum_sq = sum_sq - col_sum_sq[x];
+		}
+	}
+}
+
+/**
+ * @brief Compute regional averages and variances for a range of tasks.
+ *
+ * @param[out] ctx     The context.
+ * @param      ag      The average and variance arguments created during setup.
+ * @param      arg     The region arguments, with allocated working memory.
+ * @param      base    The first task index.
+ * @param      count   The number of tasks.
+ */
+static void compute_averages_and_variances_range(
+	astcenc_context& ctx,
+	const avg_var_args &ag,
+	pixel_region_variance_args& arg,
+	unsigned int base,
+	unsigned int count
+) {
 	int size_x = ag.img_size_x;
 	int size_y = ag.img_size_y;
 	int size_z = ag.img_size_z;
@@ -531,6 +695,43 @@ void compute_averages_and_variances(
 
 	int y_tasks = (size_y + step_xy - 1) / step_xy;
 
+	for (unsigned int i = base; i < base + count; i++)
+	{
+		int z = (i / (y_tasks)) * step_z;
+		int y = (i - (z * y_tasks)) * step_xy;
+
+		arg.size_z = astc::min(step_z, size_z - z);
+		arg.offset_z = z;
+
+		arg.size_y = astc::min(step_xy, size_y - y);
+		arg.offset_y = y;
+
+		if (ag.use_int_path)
+		{
+			arg.size_x = size_x;
+			arg.offset_x = 0;
+			compute_pixel_region_variance_u8(ctx, arg);
+			continue;
+		}
+
+		for (int x = 0; x < size_x; x += step_xy)
+		{
+			arg.size_x = astc::min(step_xy, size_x - x);
+			arg.offset_x = x;
+			compute_pixel_region_variance(ctx, arg);
+		}
+	}
+}
+
+/* See header for documentation. */
+void compute_averages_and_variances(
+	astcenc_context& ctx,
+	const avg_var_args &ag
+) {
+	pixel_region_variance_args arg = ag.arg;
+	arg.work_memory = new vfloat4[ag.work_memory_size];
+	arg.int_work_memory = new vint4[ag.int_work_memory_size];
+
 	// All threads run this processing loop until there is no work remaining
 	while (true)
 	{
@@ -541,29 +742,35 @@ void compute_averages_and_variances(
 			break;
 		}
 
-		for (unsigned int i = base; i < base + count; i++)
-		{
-			int z = (i / (y_tasks)) * step_z;
-			int y = (i - (z * y_tasks)) * step_xy;
-
-			arg.size_z = astc::min(step_z, size_z - z);
-			arg.offset_z = z;
-
-			arg.size_y = astc::min(step_xy, size_y - y);
-			arg.offset_y = y;
-
-			for (int x = 0; x < size_x; x += step_xy)
-			{
-				arg.size_x = astc::min(step_xy, size_x - x);
-				arg.offset_x = x;
-				compute_pixel_region_variance(ctx, arg);
-			}
-		}
-
+		compute_averages_and_variances_range(ctx, ag, arg, base, count);
 		ctx.manage_avg_var.complete_task_assignment(count);
 	}
 
 	delete[] arg.work_memory;
+	delete[] arg.int_work_memory;
+}
+
+/* See header for documentation. */
+bool compute_averages_and_variances_task(
+	astcenc_context& ctx,
+	const avg_var_args &ag,
+	vfloat4* work_memory,
+	vint4* int_work_memory
+) {
+	unsigned int count;
+	unsigned int base = ctx.manage_avg_var.get_task_assignment(16, count);
+	if (!count)
+	{
+		return false;
+	}
+
+	pixel_region_variance_args arg = ag.arg;
+	arg.work_memory = work_memory;
+	arg.int_work_memory = int_work_memory;
+
+	compute_averages_and_variances_range(ctx, ag, arg, base, count);
+	ctx.manage_avg_var.complete_task_assignment(count);
+	return true;
 }
 
 /* See header for documentation. */
@@ -600,6 +807,7 @@ unsigned int init_compute_averages_and_variances(
 	ag.arg.offset_y = 0;
 	ag.arg.offset_z = 0;
 	ag.arg.work_memory = nullptr;
+	ag.arg.int_work_memory = nullptr;
 
 	ag.arg.img = &img;
 	ag.arg.rgb_power = rgb_power;
@@ -616,6 +824,18 @@ unsigned int init_compute_averages_and_variances(
 	ag.blk_size_z = max_blk_size_z;
 	ag.work_memory_size = 2 * max_padsize_xy * max_padsize_xy * max_padsize_z;
 
+	// 2D U8 images without power adjustment can use exact integer sums
+	ag.use_int_path = (img.data_type == ASTCENC_TYPE_U8) && !have_z &&
+	                  (rgb_power == 1.0f) && (alpha_power == 1.0f) &&
+	                  (alpha_kernel_radius <= INT_PATH_MAX_RADIUS);
+
+	ag.int_work_memory_size = 0;
+	if (ag.use_int_path)
+	{
+		ag.work_memory_size = 0;
+		ag.int_work_memory_size = 2 * (size_x + 2 * alpha_kernel_radius);
+	}
+
 	// The parallel task count
 	unsigned int z_tasks = (size_z + max_blk_size_z - 1) / max_blk_size_z;
 	unsigned int y_tasks = (size_y + max_blk_size_xy - 1) / max_blk_size_xy;
@@ -57,12 +57,13 @@ static vint compute_value_of_texel_weight_int_vla(
 /**
  * @brief Compute the integer linear interpolation of two color endpoints.
  *
+ * The interpolation is lane-wise, so this can interpolate either the components of a texel or the
+ * same component of several texels.
+ *
  * @param decode_mode   The ASTC profile (linear or sRGB)
  * @param color0        The endpoint0 color.
  * @param color1        The endpoint1 color.
- * @param weight_plane1 The interpolation weight (between 0 and 64) for plane 1.
- * @param weight_plane2 The interpolation weight (between 0 and 64) for plane 2.
- * @param plane2_mask   The mask pattern for the plane assignment (set = plane 2).
+ * @param weight1       The interpolation weight (between 0 and 64) of endpoint1.
  *
  * @return The interpolated color.
  */
@@ -70,11 +71,8 @@ static vint4 lerp_color_int(
 	astcenc_profile decode_mode,
 	vint4 color0,
 	vint4 color1,
-	int weight_plane1,
-	int weight_plane2,
-	vmask4 plane2_mask
+	vint4 weight1
 ) {
-	vint4 weight1 = select(vint4(weight_plane1), vint4(weight_plane2), plane2_mask);
 	vint4 weight0 = vint4(64) - weight1;
 
 	if (decode_mode == ASTCENC_PRF_LDR_SRGB)
@@ -95,12 +93,12 @@ static vint4 lerp_color_int(
 }
 
 /**
- * @brief Convert integer color value into a float value for the decoder.
+ * @brief Convert integer color values into float values for the decoder.
  *
- * @param data       The integer color value post-interpolation.
+ * @param data       The integer color values post-interpolation.
  * @param lns_mask   If set treat lane as HDR (LNS) else LDR (unorm16).
  *
- * @return The float color value.
+ * @return The float color values.
  */
 static inline vfloat4 decode_texel(
 	vint4 data,
@@ -121,7 +119,7 @@ static inline vfloat4 decode_texel(
 
 	// Pick components and then convert to FP16
 	vint4 datai = select(color_unorm, color_lns, lns_mask);
-	return float16_to_float(datai);
+	return finite_float16_to_float(datai);
 }
 
 /* See header for documentation. */
@@ -171,6 +169,42 @@ void unpack_weights(
 	}
 }
 
+/* See header for documentation. */
+vfloat4 decode_constant_block_color(
+	astcenc_profile decode_mode,
+	const symbolic_compressed_block& scb
+) {
+	// UNORM16 constant color block
+	if (scb.block_type == SYM_BTYPE_CONST_U16)
+	{
+		vint4 colori(scb.constant_color);
+
+		// For sRGB decoding a real decoder would just use the top 8 bits for color conversion.
+		// We don't color convert, so rescale the top 8 bits into the full 16 bit dynamic range.
+		if (decode_mode == ASTCENC_PRF_LDR_SRGB)
+		{
+			colori = asr<8>(colori) * 257;
+		}
+
+		vint4 colorf16 = unorm16_to_sf16(colori);
+		return finite_float16_to_float(colorf16);
+	}
+
+	// FLOAT16 constant color block
+	assert(scb.block_type == SYM_BTYPE_CONST_F16);
+	switch (decode_mode)
+	{
+	case ASTCENC_PRF_LDR_SRGB:
+	case ASTCENC_PRF_LDR:
+		return vfloat4(std::numeric_limits<float>::quiet_NaN());
+	case ASTCENC_PRF_HDR_RGB_LDR_A:
+	case ASTCENC_PRF_HDR:
+	default:
+		// Constant-color block; unpack from FP16 to FP32.
+		return float16_to_float(vint4(scb.constant_color));
+	}
+}
+
 /* See header for documentation. */
 void decompress_symbolic_block(
 	astcenc_profile decode_mode,
@@ -208,40 +242,14 @@ void decompress_symbolic_block(
 	if ((scb.block_type == SYM_BTYPE_CONST_F16) ||
 	    (scb.block_type == SYM_BTYPE_CONST_U16))
 	{
-		vfloat4 color;
-		uint8_t use_lns = 0;
-
-		// UNORM16 constant color block
-		if (scb.block_type == SYM_BTYPE_CONST_U16)
-		{
-			vint4 colori(scb.constant_color);
-
-			// For sRGB decoding a real decoder would just use the top 8 bits for color conversion.
-			// We don't color convert, so rescale the top 8 bits into the full 16 bit dynamic range.
-			if (decode_mode == ASTCENC_PRF_LDR_SRGB)
-			{
-				colori = asr<8>(colori) * 257;
-			}
+		vfloat4 color = decode_constant_block_color(decode_mode, scb);
 
-			vint4 colorf16 = unorm16_to_sf16(colori);
-			color = float16_to_float(colorf16);
-		}
-		// FLOAT16 constant color block
-		else
+		// Only FLOAT16 constant color blocks in HDR profiles use LNS
+		uint8_t use_lns = 0;
+		if ((scb.block_type == SYM_BTYPE_CONST_F16) &&
+		    (decode_mode == ASTCENC_PRF_HDR_RGB_LDR_A || decode_mode == ASTCENC_PRF_HDR))
 		{
-			switch (decode_mode)
-			{
-			case ASTCENC_PRF_LDR_SRGB:
-			case ASTCENC_PRF_LDR:
-				color = vfloat4(std::numeric_limits<float>::quiet_NaN());
-				break;
-			case ASTCENC_PRF_HDR_RGB_LDR_A:
-			case ASTCENC_PRF_HDR:
-				// Constant-color block; unpack from FP16 to FP32.
-				color = float16_to_float(vint4(scb.constant_color));
-				use_lns = 1;
-				break;
-			}
+			use_lns = 1;
 		}
 
 		for (unsigned int i = 0; i < bsd.texel_count; i++)
@@ -259,7 +267,7 @@ void decompress_symbolic_block(
 
 	// Get the appropriate partition-table entry
 	int partition_count = scb.partition_count;
-	const auto& pi = bsd.get_partition_info(partition_count, scb.partition_index);
+	const auto& pi = get_lazy_partition_info(bsd, partition_count, scb.partition_index);
 
 	// Get the appropriate block descriptors
 	const auto& bm = bsd.get_block_mode(scb.block_mode);
@@ -274,7 +282,10 @@ void decompress_symbolic_block(
 
 	// Now that we have endpoint colors and weights, we can unpack texel colors
 	int plane2_component = is_dual_plane ? scb.plane2_component : -1;
-	vmask4 plane2_mask = vint4::lane_id() == vint4(plane2_component);
+
+	int endpoint0[BLOCK_MAX_PARTITIONS][4];
+	int endpoint1[BLOCK_MAX_PARTITIONS][4];
+	bool endpoint_lns[BLOCK_MAX_PARTITIONS][4];
 
 	for (int i = 0; i < partition_count; i++)
 	{
@@ -291,47 +302,85 @@ void decompress_symbolic_block(
 		                       rgb_lns, a_lns,
 		                       ep0, ep1);
 
-		vmask4 lns_mask(rgb_lns, rgb_lns, rgb_lns, a_lns);
+		store(ep0, endpoint0[i]);
+		store(ep1, endpoint1[i]);
 
-		int texel_count = pi.partition_texel_count[i];
-		for (int j = 0; j < texel_count; j++)
+		endpoint_lns[i][0] = rgb_lns;
+		endpoint_lns[i][1] = rgb_lns;
+		endpoint_lns[i][2] = rgb_lns;
+		endpoint_lns[i][3] = a_lns;
+	}
+
+	// Decode one component of 4 texels at a time, which writes the SoA block data directly and
+	// needs no per-texel lane extraction. Safe to overshoot as all arrays are allocated to full size.
+	float* data[4] { blk.data_r, blk.data_g, blk.data_b, blk.data_a };
+
+	for (unsigned int i = 0; i < bsd.texel_count; i += 4)
+	{
+		vint4 texel_partition = vint4::zero();
+		if (partition_count > 1)
 		{
-			int tix = pi.texels_of_partition[i][j];
-			vint4 color = lerp_color_int(decode_mode,
-			                             ep0,
-			                             ep1,
-			                             weights[tix],
-			                             plane2_weights[tix],
-			                             plane2_mask);
-
-			vfloat4 colorf = decode_texel(color, lns_mask);
-
-			blk.data_r[tix] = colorf.lane<0>();
-			blk.data_g[tix] = colorf.lane<1>();
-			blk.data_b[tix] = colorf.lane<2>();
-			blk.data_a[tix] = colorf.lane<3>();
+			texel_partition = vint4(pi.partition_of_texel + i);
+		}
+
+		for (int c = 0; c < 4; c++)
+		{
+			vint4 color0(endpoint0[0][c]);
+			vint4 color1(endpoint1[0][c]);
+			vmask4 lns_mask(endpoint_lns[0][c]);
+
+			// Select the endpoints of the partition each texel belongs to
+			for (int j = 1; j < partition_count; j++)
+			{
+				vmask4 in_partition = texel_partition == vint4(j);
+				color0 = select(color0, vint4(endpoint0[j][c]), in_partition);
+				color1 = select(color1, vint4(endpoint1[j][c]), in_partition);
+
+				if (endpoint_lns[j][c])
+				{
+					lns_mask = lns_mask | in_partition;
+				}
+				else
+				{
+					lns_mask = lns_mask & ~in_partition;
+				}
+			}
+
+			const int* component_weights = (c == plane2_component) ? plane2_weights : weights;
+			vint4 color = lerp_color_int(decode_mode, color0, color1, vint4(component_weights + i));
+			store(decode_texel(color, lns_mask), data[c] + i);
 		}
 	}
 }
 
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
 
-/* See header for documentation. */
-float compute_symbolic_block_difference(
+/**
+ * @brief Compute the error of a symbolic block, for a specific config.
+ *
+ * This processes N (SIMD width) texels of each partition per step, using an SoA layout.
+ *
+ * @tparam is_rgbm       True if the config uses RGBM error evaluation.
+ *
+ * @param config         The compressor config.
+ * @param bsd            The block size information.
+ * @param scb            The symbolic compressed encoding; must not be an error block.
+ * @param blk            The original image block color data.
+ * @param ewb            The error weight block data.
+ * @param error_limit    The error limit, above which the computation may abort early.
+ *
+ * @return The block error, a partial block error greater than @c error_limit if aborted early, or
+ *         @c -ERROR_CALC_DEFAULT if the block is an RGBM block with a zero M value.
+ */
+template<bool is_rgbm>
+static float compute_symbolic_block_difference_vla(
 	const astcenc_config& config,
 	const block_size_descriptor& bsd,
 	const symbolic_compressed_block& scb,
 	const image_block& blk,
-	const error_weight_block& ewb
+	const error_weight_block& ewb,
+	float error_limit
 ) {
-	// If we detected an error-block, blow up immediately.
-	if (scb.block_type == SYM_BTYPE_ERROR)
-	{
-		return ERROR_CALC_DEFAULT;
-	}
-
-	assert(scb.block_mode >= 0);
-
 	// Get the appropriate partition-table entry
 	int partition_count = scb.partition_count;
 	const auto& pi = bsd.get_partition_info(partition_count, scb.partition_index);
@@ -341,6 +390,7 @@ float compute_symbolic_block_difference(
 	const decimation_info& di = *(bsd.decimation_tables[bm.decimation_mode]);
 
 	bool is_dual_plane = bm.is_dual_plane != 0;
+	bool is_contiguous = partition_count == 1;
 
 	// Unquantize and undecimate the weights
 	int weights[BLOCK_MAX_TEXELS];
@@ -348,9 +398,16 @@ float compute_symbolic_block_difference(
 	unpack_weights(bsd, scb, di, is_dual_plane, bm.get_weight_quant_mode(), weights, plane2_weights);
 
 	int plane2_component = is_dual_plane ? scb.plane2_component : -1;
-	vmask4 plane2_mask = vint4::lane_id() == vint4(plane2_component);
+	bool is_srgb = config.profile == ASTCENC_PRF_LDR_SRGB;
+
+	vfloat ew_r(ewb.uniform_error_weight.lane<0>());
+	vfloat ew_g(ewb.uniform_error_weight.lane<1>());
+	vfloat ew_b(ewb.uniform_error_weight.lane<2>());
+	vfloat ew_a(ewb.uniform_error_weight.lane<3>());
+
+	vfloat rgbm_scale(config.rgbm_m_scale);
 
-	float summa = 0.0f;
+	vfloat summav = vfloat::zero();
 	for (int i = 0; i < partition_count; i++)
 	{
 		// Decode the color endpoints for this partition
@@ -366,23 +423,87 @@ float compute_symbolic_block_difference(
 		                       rgb_lns, a_lns,
 		                       ep0, ep1);
 
-		vmask4 lns_mask(rgb_lns, rgb_lns, rgb_lns, a_lns);
+		// For sRGB decoding a real decoder would just use the top 8 bits for color conversion
+		if (is_srgb)
+		{
+			ep0 = asr<8>(ep0);
+			ep1 = asr<8>(ep1);
+		}
+
+		vint ep0_r(ep0.lane<0>());
+		vint ep0_g(ep0.lane<1>());
+		vint ep0_b(ep0.lane<2>());
+		vint ep0_a(ep0.lane<3>());
+
+		vint ep1_r(ep1.lane<0>());
+		vint ep1_g(ep1.lane<1>());
+		vint ep1_b(ep1.lane<2>());
+		vint ep1_a(ep1.lane<3>());
 
-		// Unpack and compute error for each texel in the partition
+		// Texel lists are padded by repeating the last texel, so mask out the padding
 		int texel_count = pi.partition_texel_count[i];
-		for (int j = 0; j < texel_count; j++)
+		const uint8_t* texel_indexes = pi.texels_of_partition[i];
+
+		vint lane_ids = vint::lane_id();
+		for (int j = 0; j < texel_count; j += ASTCENC_SIMD_WIDTH)
 		{
-			int tix = pi.texels_of_partition[i][j];
-			vint4 colori = lerp_color_int(config.profile,
-			                              ep0, ep1,
-			                              weights[tix],
-			                              plane2_weights[tix], plane2_mask);
+			vmask mask = lane_ids < vint(texel_count);
+			vint tix(texel_indexes + j);
+
+			// Single partition texel lists are the identity, so can use contiguous loads
+			vint w1;
+			vint w2;
+			vfloat data_r;
+			vfloat data_g;
+			vfloat data_b;
+			vfloat data_a;
+
+			if (is_contiguous)
+			{
+				w1 = vint(weights + j);
+				w2 = is_dual_plane ? vint(plane2_weights + j) : w1;
+
+				data_r = vfloat(blk.data_r + j);
+				data_g = vfloat(blk.data_g + j);
+				data_b = vfloat(blk.data_b + j);
+				data_a = vfloat(blk.data_a + j);
+			}
+			else
+			{
+				w1 = gatheri(weights, tix);
+				w2 = is_dual_plane ? gatheri(plane2_weights, tix) : w1;
+
+				data_r = gatherf(blk.data_r, tix);
+				data_g = gatherf(blk.data_g, tix);
+				data_b = gatherf(blk.data_b, tix);
+				data_a = gatherf(blk.data_a, tix);
+			}
+
+			vint w_r = plane2_component == 0 ? w2 : w1;
+			vint w_g = plane2_component == 1 ? w2 : w1;
+			vint w_b = plane2_component == 2 ? w2 : w1;
+			vint w_a = plane2_component == 3 ? w2 : w1;
+
+			vint color_r = asr<6>(ep0_r * (vint(64) - w_r) + ep1_r * w_r + vint(32));
+			vint color_g = asr<6>(ep0_g * (vint(64) - w_g) + ep1_g * w_g + vint(32));
+			vint color_b = asr<6>(ep0_b * (vint(64) - w_b) + ep1_b * w_b + vint(32));
+			vint color_a = asr<6>(ep0_a * (vint(64) - w_a) + ep1_a * w_a + vint(32));
+
+			if (is_srgb)
+			{
+				color_r = color_r * vint(257);
+				color_g = color_g * vint(257);
+				color_b = color_b * vint(257);
+				color_a = color_a * vint(257);
+			}
 
-			vfloat4 color = int_to_float(colori);
-			vfloat4 oldColor = blk.texel(tix);
+			vfloat dec_r = int_to_float(color_r);
+			vfloat dec_g = int_to_float(color_g);
+			vfloat dec_b = int_to_float(color_b);
+			vfloat dec_a = int_to_float(color_a);
 
 			// Compare error using a perceptual decode metric for RGBM textures
-			if (config.flags & ASTCENC_FLG_MAP_RGBM)
+			if (is_rgbm)
 			{
 				// Fail encodings that result in zero weight M pixels. Note that this can cause
 				// "interesting" artifacts if we reject all useful encodings - we typically get max
@@ -390,37 +511,94 @@ float compute_symbolic_block_difference(
 				// bias to their stored M value, limiting the lower value to 16 or 32 to avoid
 				// getting small M values post-quantization, but we can't prove it would never
 				// happen, especially at low bit rates ...
-				if (color.lane<3>() == 0.0f)
+				if (any(mask & (dec_a == vfloat::zero())))
 				{
 					return -ERROR_CALC_DEFAULT;
 				}
 
 				// Compute error based on decoded RGBM color
-				color = vfloat4(
-					color.lane<0>() * color.lane<3>() * config.rgbm_m_scale,
-					color.lane<1>() * color.lane<3>() * config.rgbm_m_scale,
-					color.lane<2>() * color.lane<3>() * config.rgbm_m_scale,
-					1.0f
-				);
-
-				oldColor = vfloat4(
-					oldColor.lane<0>() * oldColor.lane<3>() * config.rgbm_m_scale,
-					oldColor.lane<1>() * oldColor.lane<3>() * config.rgbm_m_scale,
-					oldColor.lane<2>() * oldColor.lane<3>() * config.rgbm_m_scale,
-					1.0f
-				);
+				vfloat dec_m = dec_a * rgbm_scale;
+				dec_r = dec_r * dec_m;
+				dec_g = dec_g * dec_m;
+				dec_b = dec_b * dec_m;
+				dec_a = vfloat(1.0f);
+
+				vfloat data_m = data_a * rgbm_scale;
+				data_r = data_r * data_m;
+				data_g = data_g * data_m;
+				data_b = data_b * data_m;
+				data_a = vfloat(1.0f);
 			}
 
-			vfloat4 error = oldColor - color;
-			error = min(abs(error), 1e15f);
-			error = error * error;
+			vfloat err_r = min(abs(data_r - dec_r), vfloat(1e15f));
+			vfloat err_g = min(abs(data_g - dec_g), vfloat(1e15f));
+			vfloat err_b = min(abs(data_b - dec_b), vfloat(1e15f));
+			vfloat err_a = min(abs(data_a - dec_a), vfloat(1e15f));
 
-			float metric = dot_s(error, ewb.error_weights[tix]);
-			summa += astc::min(metric, ERROR_CALC_DEFAULT);
+			// Uniform weighted blocks can skip the per-texel error weight gathers
+			if (ewb.is_uniform)
+			{
+				// Nothing to do
+			}
+			else if (is_contiguous)
+			{
+				ew_r = vfloat(ewb.texel_weight_r + j);
+				ew_g = vfloat(ewb.texel_weight_g + j);
+				ew_b = vfloat(ewb.texel_weight_b + j);
+				ew_a = vfloat(ewb.texel_weight_a + j);
+			}
+			else
+			{
+				ew_r = gatherf(ewb.texel_weight_r, tix);
+				ew_g = gatherf(ewb.texel_weight_g, tix);
+				ew_b = gatherf(ewb.texel_weight_b, tix);
+				ew_a = gatherf(ewb.texel_weight_a, tix);
+			}
+
+			vfloat metric = (ew_r * err_r * err_r)
+			              + (ew_g * err_g * err_g)
+			              + (ew_b * err_b * err_b)
+			              + (ew_a * err_a * err_a);
+
+			metric = min(metric, vfloat(ERROR_CALC_DEFAULT));
+			summav += select(vfloat::zero(), metric, mask);
+
+			// The running sum only increases, so stop once it is known to exceed the limit
+			if (hadd_s(summav) > error_limit)
+			{
+				return hadd_s(summav);
+			}
+
+			lane_ids = lane_ids + vint(ASTCENC_SIMD_WIDTH);
 		}
 	}
 
-	return summa;
+	return astc::min(hadd_s(summav), ERROR_CALC_DEFAULT);
+}
+
+/* See header for documentation. */
+float compute_symbolic_block_difference(
+	const astcenc_config& config,
+	const block_size_descriptor& bsd,
+	const symbolic_compressed_block& scb,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	float error_limit
+) {
+	// If we detected an error-block, blow up immediately.
+	if (scb.block_type == SYM_BTYPE_ERROR)
+	{
+		return ERROR_CALC_DEFAULT;
+	}
+
+	assert(scb.block_mode >= 0);
+
+	if (config.flags & ASTCENC_FLG_MAP_RGBM)
+	{
+		return compute_symbolic_block_difference_vla<true>(config, bsd, scb, blk, ewb, error_limit);
+	}
+
+	return compute_symbolic_block_difference_vla<false>(config, bsd, scb, blk, ewb, error_limit);
 }
 
 #endif
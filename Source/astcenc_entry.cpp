@@ -19,9 +19,12 @@
  * @brief Functions for the library entrypoint.
  */
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <limits>
 #include <new>
+#include <thread>
 
 #include "astcenc.h"
 #include "astcenc_internal.h"
@@ -436,6 +439,7 @@ static astcenc_error validate_config(
 	config.tune_2_partition_early_out_limit_factor = astc::max(config.tune_2_partition_early_out_limit_factor, 0.0f);
 	config.tune_3_partition_early_out_limit_factor = astc::max(config.tune_3_partition_early_out_limit_factor, 0.0f);
 	config.tune_2_plane_early_out_limit_correlation = astc::max(config.tune_2_plane_early_out_limit_correlation, 0.0f);
+	config.rdo_lambda = astc::max(config.rdo_lambda, 0.0f);
 
 	// Specifying a zero weight color component is not allowed; force to small value
 	float max_weight = astc::max(astc::max(config.cw_r_weight, config.cw_g_weight),
@@ -714,6 +718,49 @@ astcenc_error astcenc_config_init(
 	return ASTCENC_SUCCESS;
 }
 
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+
+/**
+ * @brief Populate the config used for the initial pass of progressive compression.
+ *
+ * This is a copy of the context config, with the search tuning replaced by the tuning of the
+ * fastest preset. The block mode limit is not changed, as that is baked into the context block
+ * size descriptor.
+ *
+ * @param      config   The validated context config.
+ * @param[out] fast     The config to populate.
+ */
+static void init_progressive_config(
+	const astcenc_config& config,
+	astcenc_config& fast
+) {
+	fast = config;
+	fast.rdo_lambda = 0.0f;
+
+	astcenc_config preset;
+	astcenc_error status = astcenc_config_init(config.profile, config.block_x, config.block_y,
+	                                           config.block_z, ASTCENC_PRE_FASTEST, config.flags,
+	                                           &preset);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return;
+	}
+
+	fast.tune_partition_count_limit = preset.tune_partition_count_limit;
+	fast.tune_partition_index_limit = preset.tune_partition_index_limit;
+	fast.tune_refinement_limit = preset.tune_refinement_limit;
+	fast.tune_candidate_limit = preset.tune_candidate_limit;
+	fast.tune_db_limit = preset.tune_db_limit;
+	fast.tune_mode0_mse_overshoot = preset.tune_mode0_mse_overshoot;
+	fast.tune_refinement_mse_overshoot = preset.tune_refinement_mse_overshoot;
+	fast.tune_2_partition_early_out_limit_factor = preset.tune_2_partition_early_out_limit_factor;
+	fast.tune_3_partition_early_out_limit_factor = preset.tune_3_partition_early_out_limit_factor;
+	fast.tune_2_plane_early_out_limit_correlation = preset.tune_2_plane_early_out_limit_correlation;
+	fast.tune_low_weight_count_limit = preset.tune_low_weight_count_limit;
+}
+
+#endif
+
 /* See header for documentation. */
 astcenc_error astcenc_context_alloc(
 	const astcenc_config* configp,
@@ -754,11 +801,25 @@ astcenc_error astcenc_context_alloc(
 	ctx->thread_count = thread_count;
 	ctx->config = config;
 	ctx->working_buffers = nullptr;
+	ctx->decode_caches = nullptr;
 
 	// These are allocated per-compress, as they depend on image size
 	ctx->input_averages = nullptr;
 	ctx->input_variances = nullptr;
 	ctx->input_alpha_averages = nullptr;
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+	ctx->progressive_errors = nullptr;
+	ctx->progressive_targets = nullptr;
+	ctx->progressive_order = nullptr;
+	ctx->block_search = nullptr;
+	ctx->rdo_row_progress = nullptr;
+	ctx->rdo_row_capacity = 0;
+	ctx->job_image.store(nullptr);
+	ctx->job_active_calls.store(0);
+	ctx->job_data_out = nullptr;
+	ctx->job_work_memory = nullptr;
+	ctx->job_int_work_memory = nullptr;
+#endif
 
 	// Copy the config first and validate the copy (we may modify it)
 	status = validate_config(ctx->config);
@@ -770,25 +831,55 @@ astcenc_error astcenc_context_alloc(
 
 	bsd = new block_size_descriptor;
 	bool can_omit_modes = config.flags & ASTCENC_FLG_SELF_DECOMPRESS_ONLY;
+	bool lazy_partitions = config.flags & ASTCENC_FLG_DECOMPRESS_ONLY;
 	init_block_size_descriptor(config.block_x, config.block_y, config.block_z,
-	                           can_omit_modes, static_cast<float>(config.tune_block_mode_limit) / 100.0f, *bsd);
+	                           can_omit_modes, static_cast<float>(config.tune_block_mode_limit) / 100.0f,
+	                           lazy_partitions, *bsd);
 	ctx->bsd = bsd;
 
+	if (config.flags & ASTCENC_FLG_USE_DECODE_CACHE)
+	{
+		ctx->decode_caches = new decode_cache[thread_count];
+		for (unsigned int i = 0; i < thread_count; i++)
+		{
+			decode_cache& cache = ctx->decode_caches[i];
+			cache.texels_stride = bsd->texel_count * sizeof(float) * 4;
+			cache.texels = new uint8_t[DECODE_CACHE_ENTRIES * cache.texels_stride];
+			std::fill_n(cache.valid, DECODE_CACHE_ENTRIES, false);
+		}
+	}
+
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
 	// Do setup only needed by compression
-	if (!(status & ASTCENC_FLG_DECOMPRESS_ONLY))
+	if (!(config.flags & ASTCENC_FLG_DECOMPRESS_ONLY))
 	{
 		// Expand deblock supression into a weight scale per texel in the block
 		expand_deblock_weights(*ctx);
 
+		// Detect configs where all texels share the same error weight, allowing fast paths
+		bool any_mean_stdev_weight =
+		    ctx->config.v_rgb_mean != 0.0f || ctx->config.v_rgb_stdev != 0.0f ||
+		    ctx->config.v_a_mean != 0.0f || ctx->config.v_a_stdev != 0.0f;
+
+		bool is_ldr = (ctx->config.profile == ASTCENC_PRF_LDR) ||
+		              (ctx->config.profile == ASTCENC_PRF_LDR_SRGB);
+
+		ctx->uniform_error_weights = is_ldr && !any_mean_stdev_weight &&
+		                             !(ctx->config.flags & ASTCENC_FLG_USE_ALPHA_WEIGHT) &&
+		                             (ctx->config.b_deblock_weight == 0.0f);
+
+		init_progressive_config(ctx->config, ctx->progressive_config);
+
 		// Turn a dB limit into a per-texel error for faster use later
 		if ((ctx->config.profile == ASTCENC_PRF_LDR) || (ctx->config.profile == ASTCENC_PRF_LDR_SRGB))
 		{
 			ctx->config.tune_db_limit = astc::pow(0.1f, ctx->config.tune_db_limit * 0.1f) * 65535.0f * 65535.0f;
+			ctx->progressive_config.tune_db_limit = astc::pow(0.1f, ctx->progressive_config.tune_db_limit * 0.1f) * 65535.0f * 65535.0f;
 		}
 		else
 		{
 			ctx->config.tune_db_limit = 0.0f;
+			ctx->progressive_config.tune_db_limit = 0.0f;
 		}
 
 		size_t worksize = sizeof(compression_working_buffers) * thread_count;
@@ -803,6 +894,15 @@ astcenc_error astcenc_context_alloc(
 			*context = nullptr;
 			return ASTCENC_ERR_OUT_OF_MEM;
 		}
+
+		ctx->scratch_pool.init(thread_count);
+
+		// Images small enough to use intra-block parallelism have a bounded block count, and
+		// intra-block parallelism is only used with more than one thread
+		if (thread_count > 1)
+		{
+			ctx->block_search = new block_search_state[INTRA_BLOCK_MAX_BLOCKS];
+		}
 	}
 #endif
 
@@ -834,6 +934,19 @@ void astcenc_context_free(
 	if (ctx)
 	{
 		aligned_free<compression_working_buffers>(ctx->working_buffers);
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+		delete[] ctx->block_search;
+		delete[] ctx->rdo_row_progress;
+#endif
+		if (ctx->decode_caches)
+		{
+			for (unsigned int i = 0; i < ctx->thread_count; i++)
+			{
+				delete[] ctx->decode_caches[i].texels;
+			}
+
+			delete[] ctx->decode_caches;
+		}
 		term_block_size_descriptor(*(ctx->bsd));
 #if defined(ASTCENC_DIAGNOSTICS)
 		delete ctx->trace_log;
@@ -846,24 +959,30 @@ void astcenc_context_free(
 #if !defined(ASTCENC_DECOMPRESS_ONLY)
 
 /**
- * @brief Compress an image, after any preflight has completed.
+ * @brief Fetch an image block for compression.
  *
- * @param[out] ctx            The compressor context.
- * @param      thread_index   The thread index.
- * @param      image          The intput image.
- * @param      swizzle        The input swizzle.
- * @param[out] buffer         The output array for the compressed data.
+ * This applies the alpha-scale RDO, which replaces blocks with no significant alpha in the
+ * surrounding footprint with a constant transparent block.
+ *
+ * @param      ctx       The compressor context.
+ * @param      image     The intput image.
+ * @param      swizzle   The input swizzle.
+ * @param      x         The block X coordinate, in blocks.
+ * @param      y         The block Y coordinate, in blocks.
+ * @param      z         The block Z coordinate, in blocks.
+ * @param[out] blk       The image block to populate.
  */
-static void compress_image(
-	astcenc_context& ctx,
-	unsigned int thread_index,
+static void fetch_compress_block(
+	const astcenc_context& ctx,
 	const astcenc_image& image,
 	const astcenc_swizzle& swizzle,
-	uint8_t* buffer
+	int x,
+	int y,
+	int z,
+	image_block& blk
 ) {
 	const block_size_descriptor *bsd = ctx.bsd;
 	astcenc_profile decode_mode = ctx.config.profile;
-	image_block blk;
 
 	int block_x = bsd->xdim;
 	int block_y = bsd->ydim;
@@ -871,207 +990,1174 @@ static void compress_image(
 
 	int dim_x = image.dim_x;
 	int dim_y = image.dim_y;
-	int dim_z = image.dim_z;
 
-	int xblocks = (dim_x + block_x - 1) / block_x;
-	int yblocks = (dim_y + block_y - 1) / block_y;
-	int zblocks = (dim_z + block_z - 1) / block_z;
+	// Test if we can apply some basic alpha-scale RDO
+	bool use_full_block = true;
+	if (ctx.config.a_scale_radius != 0 && block_z == 1)
+	{
+		int start_x = x * block_x;
+		int end_x = astc::min(dim_x, start_x + block_x);
 
-	int row_blocks = xblocks;
-	int plane_blocks = xblocks * yblocks;
+		int start_y = y * block_y;
+		int end_y = astc::min(dim_y, start_y + block_y);
 
-	// Use preallocated scratch buffer
-	auto& temp_buffers = ctx.working_buffers[thread_index];
+		// SATs accumulate error, so don't test exactly zero. Test for
+		// less than 1 alpha in the expanded block footprint that
+		// includes the alpha radius.
+		int x_footprint = block_x + 2 * (ctx.config.a_scale_radius - 1);
 
-	// Only the first thread actually runs the initializer
-	ctx.manage_compress.init(zblocks * yblocks * xblocks);
+		int y_footprint = block_y + 2 * (ctx.config.a_scale_radius - 1);
 
-	// All threads run this processing loop until there is no work remaining
-	while (true)
-	{
-		unsigned int count;
-		unsigned int base = ctx.manage_compress.get_task_assignment(16, count);
-		if (!count)
+		float footprint = (float)(x_footprint * y_footprint);
+		float threshold = 0.9f / (255.0f * footprint);
+
+		// Do we have any alpha values?
+		use_full_block = false;
+		for (int ay = start_y; ay < end_y; ay++)
 		{
-			break;
+			for (int ax = start_x; ax < end_x; ax++)
+			{
+				float a_avg = ctx.input_alpha_averages[ay * dim_x + ax];
+				if (a_avg > threshold)
+				{
+					use_full_block = true;
+					ax = end_x;
+					ay = end_y;
+				}
+			}
 		}
+	}
 
-		for (unsigned int i = base; i < base + count; i++)
-		{
-			// Decode i into x, y, z block indices
-			int z = i / plane_blocks;
-			unsigned int rem = i - (z * plane_blocks);
-			int y = rem / row_blocks;
-			int x = rem - (y * row_blocks);
+	// Fetch the full block for compression
+	if (use_full_block)
+	{
+		fetch_image_block(decode_mode, image, blk, *bsd, x * block_x, y * block_y, z * block_z, swizzle);
+	}
+	// Apply alpha scale RDO - substitute constant color block
+	else
+	{
+		blk.origin_texel = vfloat4::zero();
+		blk.data_min = vfloat4::zero();
+		blk.data_max = blk.data_min;
+		blk.grayscale = false;
+	}
+}
 
-			// Test if we can apply some basic alpha-scale RDO
-			bool use_full_block = true;
-			if (ctx.config.a_scale_radius != 0 && block_z == 1)
-			{
-				int start_x = x * block_x;
-				int end_x = astc::min(dim_x, start_x + block_x);
+/**
+ * @brief Run one task compressing a small image, splitting each block search across threads.
+ *
+ * Each block search is split into @c BLOCK_SEARCH_GROUPS trial groups which are scheduled as
+ * separate tasks, and the thread that completes the last group of a block stores the best
+ * encoding. The quality target and partition count early-outs are replayed over the group results,
+ * but each group starts its trials without the best error of the lower groups, so the output may
+ * differ slightly from sequential compression. It does not depend on thread timing.
+ *
+ * @param[out] ctx            The compressor context.
+ * @param      config         The compressor configuration to use for the search.
+ * @param[out] temp_buffers   The scratch buffers to use for this task.
+ * @param      image          The intput image.
+ * @param      swizzle        The input swizzle.
+ * @param[out] buffer         The output array for the compressed data.
+ *
+ * @return Return @c true if a task was run, @c false if there are no tasks remaining.
+ */
+static bool compress_image_intra_block_task(
+	astcenc_context& ctx,
+	const astcenc_config& config,
+	compression_working_buffers& temp_buffers,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle,
+	uint8_t* buffer
+) {
+	const block_size_descriptor *bsd = ctx.bsd;
+	image_block blk;
 
-				int start_y = y * block_y;
-				int end_y = astc::min(dim_y, start_y + block_y);
+	unsigned int xblocks = (image.dim_x + bsd->xdim - 1) / bsd->xdim;
+	unsigned int yblocks = (image.dim_y + bsd->ydim - 1) / bsd->ydim;
+	unsigned int zblocks = (image.dim_z + bsd->zdim - 1) / bsd->zdim;
+	unsigned int block_count = xblocks * yblocks * zblocks;
 
-				// SATs accumulate error, so don't test exactly zero. Test for
-				// less than 1 alpha in the expanded block footprint that
-				// includes the alpha radius.
-				int x_footprint = block_x + 2 * (ctx.config.a_scale_radius - 1);
+	unsigned int row_blocks = xblocks;
+	unsigned int plane_blocks = xblocks * yblocks;
 
-				int y_footprint = block_y + 2 * (ctx.config.a_scale_radius - 1);
+	// Only the first thread actually runs the initializer
+	auto init_intra_block = [&ctx, block_count]() {
+		for (unsigned int i = 0; i < block_count; i++)
+		{
+			ctx.block_search[i].reset();
+		}
 
-				float footprint = (float)(x_footprint * y_footprint);
-				float threshold = 0.9f / (255.0f * footprint);
+		return block_count * BLOCK_SEARCH_GROUPS;
+	};
 
-				// Do we have any alpha values?
-				use_full_block = false;
-				for (int ay = start_y; ay < end_y; ay++)
-				{
-					for (int ax = start_x; ax < end_x; ax++)
-					{
-						float a_avg = ctx.input_alpha_averages[ay * dim_x + ax];
-						if (a_avg > threshold)
-						{
-							use_full_block = true;
-							ax = end_x;
-							ay = end_y;
-						}
-					}
-				}
-			}
+	ctx.manage_compress.init(init_intra_block);
 
-			// Fetch the full block for compression
-			if (use_full_block)
-			{
-				fetch_image_block(decode_mode, image, blk, *bsd, x * block_x, y * block_y, z * block_z, swizzle);
-			}
-			// Apply alpha scale RDO - substitute constant color block
-			else
-			{
-				blk.origin_texel = vfloat4::zero();
-				blk.data_min = vfloat4::zero();
-				blk.data_max = blk.data_min;
-				blk.grayscale = false;
-			}
+	// Tasks are ordered by group, so the cheap 1 partition trials are dispatched first and have
+	// the best chance of letting the other groups of a block skip
+	unsigned int count;
+	unsigned int task = ctx.manage_compress.get_task_assignment(1, count);
+	if (!count)
+	{
+		return false;
+	}
 
-			int offset = ((z * yblocks + y) * xblocks + x) * 16;
-			uint8_t *bp = buffer + offset;
-			physical_compressed_block* pcb = reinterpret_cast<physical_compressed_block*>(bp);
-			compress_block(ctx, image, blk, *pcb, temp_buffers);
-		}
+	unsigned int group = task / block_count;
+	unsigned int i = task - group * block_count;
+
+	// Decode i into x, y, z block indices
+	unsigned int z = i / plane_blocks;
+	unsigned int rem = i - (z * plane_blocks);
+	unsigned int y = rem / row_blocks;
+	unsigned int x = rem - (y * row_blocks);
+
+	fetch_compress_block(ctx, image, swizzle, x, y, z, blk);
+
+	block_search_state& state = ctx.block_search[i];
+	compress_block_trial_group(ctx, config, image, blk, group, state, temp_buffers);
 
-		ctx.manage_compress.complete_task_assignment(count);
+	// The last group to complete stores the best encoding
+	if (state.groups_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		uint8_t *bp = buffer + i * 16;
+		physical_compressed_block* pcb = reinterpret_cast<physical_compressed_block*>(bp);
+		finish_block_search(config, *bsd, blk, state, *pcb);
 	}
-}
 
-#endif
+	ctx.manage_compress.complete_task_assignment(count);
+	return true;
+}
 
-/* See header for documentation. */
-astcenc_error astcenc_compress_image(
-	astcenc_context* ctx,
-	astcenc_image* imagep,
-	const astcenc_swizzle* swizzle,
-	uint8_t* data_out,
-	size_t data_len,
-	unsigned int thread_index
+/**
+ * @brief Select the RDO encoding of a block, using its final neighbors as context.
+ *
+ * The blocks to the left in the same row and the nearest blocks in the row above are used as
+ * context, so the result only depends on the block position and not on the task scheduling. This
+ * sleeps until those blocks are finalized by other threads. Blocks are always assigned in raster
+ * order, so the blocks waited on are always assigned and making progress.
+ *
+ * @param[in,out] ctx            The compressor context.
+ * @param         temp_buffers   The scratch buffers used to compress this block.
+ * @param         blk            The image block color data to compress.
+ * @param         buffer         The output array for the compressed data.
+ * @param         xblocks        The number of blocks in each row.
+ * @param         x              The block x index.
+ * @param         y              The block y index.
+ * @param         row            The index of the block row in the image.
+ * @param[in,out] pcb            The encoding found by the search, replaced by the RDO encoding.
+ */
+static void rate_distortion_select_image_block(
+	astcenc_context& ctx,
+	const compression_working_buffers& temp_buffers,
+	const image_block& blk,
+	const uint8_t* buffer,
+	unsigned int xblocks,
+	unsigned int x,
+	unsigned int y,
+	unsigned int row,
+	physical_compressed_block& pcb
 ) {
-#if defined(ASTCENC_DECOMPRESS_ONLY)
-	(void)ctx;
-	(void)imagep;
-	(void)swizzle;
-	(void)data_out;
-	(void)data_len;
-	(void)thread_index;
-	return ASTCENC_ERR_BAD_CONTEXT;
-#else
-	astcenc_error status;
-	astcenc_image& image = *imagep;
+	// Wait for the neighbors used as context to be final
+	unsigned int above_done = astc::min(x + 2, xblocks);
+	auto is_context_final = [&ctx, x, y, row, above_done]() {
+		return (ctx.rdo_row_progress[row].load(std::memory_order_acquire) >= x) &&
+		       ((y == 0) || (ctx.rdo_row_progress[row - 1].load(std::memory_order_acquire) >= above_done));
+	};
 
-	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	if (!is_context_final())
 	{
-		return ASTCENC_ERR_BAD_CONTEXT;
+		std::unique_lock<std::mutex> lck(ctx.rdo_row_lock);
+		ctx.rdo_row_updated.wait(lck, is_context_final);
 	}
 
-	status = validate_compression_swizzle(*swizzle);
-	if (status != ASTCENC_SUCCESS)
+	// The direct neighbors come first, as they are also candidates for endpoint and weight reuse
+	const uint8_t* row_data = buffer + static_cast<size_t>(row) * xblocks * 16;
+	const uint8_t* above_data = row_data - xblocks * 16;
+
+	uint8_t history[RDO_MAX_HISTORY_BLOCKS * 16];
+	unsigned int history_count = 0;
+	auto add_history = [&history, &history_count](const uint8_t* block) {
+		std::memcpy(history + history_count * 16, block, 16);
+		history_count++;
+	};
+
+	if (x > 0)
 	{
-		return status;
+		add_history(row_data + (x - 1) * 16);
 	}
 
-	if (thread_index >= ctx->thread_count)
+	if (y > 0)
 	{
-		return ASTCENC_ERR_BAD_PARAM;
+		add_history(above_data + x * 16);
 	}
 
-	unsigned int block_x = ctx->config.block_x;
-	unsigned int block_y = ctx->config.block_y;
-	unsigned int block_z = ctx->config.block_z;
+	unsigned int neighbor_count = history_count;
 
-	unsigned int xblocks = (image.dim_x + block_x - 1) / block_x;
-	unsigned int yblocks = (image.dim_y + block_y - 1) / block_y;
-	unsigned int zblocks = (image.dim_z + block_z - 1) / block_z;
+	if (y > 0 && x > 0)
+	{
+		add_history(above_data + (x - 1) * 16);
+	}
 
-	// Check we have enough output space (16 bytes per block)
-	size_t size_needed = xblocks * yblocks * zblocks * 16;
-	if (data_len < size_needed)
+	if (y > 0 && x + 1 < xblocks)
 	{
-		return ASTCENC_ERR_OUT_OF_MEM;
+		add_history(above_data + (x + 1) * 16);
 	}
 
-	// If context thread count is one then implicitly reset
-	if (ctx->thread_count == 1)
+	for (unsigned int i = 2; i <= RDO_MAX_LEFT_BLOCKS && i <= x; i++)
 	{
-		astcenc_compress_reset(ctx);
+		add_history(row_data + (x - i) * 16);
+	}
+
+	rate_distortion_select_block(ctx, blk, temp_buffers, history, history_count, neighbor_count, pcb);
+}
+
+/**
+ * @brief Run one task compressing an image, after any preflight has completed.
+ *
+ * @param[out] ctx               The compressor context.
+ * @param      config            The compressor configuration to use for the search.
+ * @param[out] temp_buffers      The scratch buffers to use for this task.
+ * @param      image             The intput image.
+ * @param      swizzle           The input swizzle.
+ * @param[out] buffer            The output array for the compressed data.
+ * @param[out] candidates        The output array for the candidate encodings, or @c nullptr.
+ * @param      candidate_limit   The number of candidate encodings to store per block, or zero.
+ * @param[out] block_errors      The output array for the per-block error, or @c nullptr.
+ * @param[out] block_targets     The output array for the per-block error target of the context
+ *                               config, or @c nullptr. Only valid if @c block_errors is set.
+ *
+ * @return Return @c true if a task was run, @c false if there are no tasks remaining.
+ */
+static bool compress_image_task(
+	astcenc_context& ctx,
+	const astcenc_config& config,
+	compression_working_buffers& temp_buffers,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle,
+	uint8_t* buffer,
+	astcenc_block_candidate* candidates,
+	unsigned int candidate_limit,
+	float* block_errors,
+	float* block_targets
+) {
+	const block_size_descriptor *bsd = ctx.bsd;
+	image_block blk;
+
+	int block_x = bsd->xdim;
+	int block_y = bsd->ydim;
+	int block_z = bsd->zdim;
+
+	int dim_x = image.dim_x;
+	int dim_y = image.dim_y;
+	int dim_z = image.dim_z;
+
+	int xblocks = (dim_x + block_x - 1) / block_x;
+	int yblocks = (dim_y + block_y - 1) / block_y;
+	int zblocks = (dim_z + block_z - 1) / block_z;
+
+	int row_blocks = xblocks;
+	int plane_blocks = xblocks * yblocks;
+
+	// RDO selects from the candidate list, so needs more candidates than the caller may request,
+	// and the block error is the error of the best candidate
+	bool use_rdo = config.rdo_lambda > 0.0f;
+	if (use_rdo)
+	{
+		temp_buffers.candidates.limit = astc::max(candidate_limit, RDO_CANDIDATE_LIMIT);
+	}
+	else if (block_errors)
+	{
+		temp_buffers.candidates.limit = astc::max(candidate_limit, 1u);
+	}
+	else
+	{
+		temp_buffers.candidates.limit = candidate_limit;
 	}
 
-	if (ctx->config.v_rgb_mean != 0.0f || ctx->config.v_rgb_stdev != 0.0f ||
-	    ctx->config.v_a_mean != 0.0f || ctx->config.v_a_stdev != 0.0f ||
-	    ctx->config.a_scale_radius != 0)
+	// Small images split each block search across threads. The choice of path changes the output,
+	// so a single thread always uses sequential compression.
+	unsigned int block_count = zblocks * yblocks * xblocks;
+	if (!use_rdo && !block_errors && !candidate_limit && (ctx.thread_count > 1) &&
+	    (block_count <= INTRA_BLOCK_MAX_BLOCKS))
 	{
-		// First thread to enter will do setup, other threads will subsequently
-		// enter the critical section but simply skip over the initialization
-		auto init_avg_var = [ctx, &image, swizzle]() {
-			// Perform memory allocations for the destination buffers
-			size_t texel_count = image.dim_x * image.dim_y * image.dim_z;
-			ctx->input_averages = new vfloat4[texel_count];
-			ctx->input_variances = new vfloat4[texel_count];
-			ctx->input_alpha_averages = new float[texel_count];
-
-			return init_compute_averages_and_variances(
-				image, ctx->config.v_rgb_power, ctx->config.v_a_power,
-				ctx->config.v_rgba_radius, ctx->config.a_scale_radius, *swizzle,
-				ctx->avg_var_preprocess_args);
+		return compress_image_intra_block_task(ctx, config, temp_buffers, image, swizzle, buffer);
+	}
+
+	// Without RDO pick the granule so that all threads get some work. RDO output does not depend
+	// on the granule, but each RDO task is one block row. A block only waits for the blocks before
+	// it in its own row, which are in the same task, and for the row above, which runs two blocks
+	// ahead. Tasks that span or split rows would instead wait for whole tasks on other threads.
+	unsigned int granule = static_cast<unsigned int>(xblocks);
+	if (!use_rdo)
+	{
+		granule = astc::clamp(block_count / (ctx.thread_count * 4), 1u, 16u);
+	}
+
+	// Only the first thread actually runs the initializer
+	unsigned int row_count = zblocks * yblocks;
+	if (use_rdo)
+	{
+		auto init_rdo = [&ctx, row_count, block_count]() {
+			if (ctx.rdo_row_capacity < row_count)
+			{
+				delete[] ctx.rdo_row_progress;
+				ctx.rdo_row_progress = new std::atomic<unsigned int>[row_count];
+				ctx.rdo_row_capacity = row_count;
+			}
+
+			for (unsigned int i = 0; i < row_count; i++)
+			{
+				ctx.rdo_row_progress[i].store(0, std::memory_order_relaxed);
+			}
+
+			return block_count;
 		};
 
-		// Only the first thread actually runs the initializer
-		ctx->manage_avg_var.init(init_avg_var);
+		ctx.manage_compress.init(init_rdo);
+	}
+	else
+	{
+		ctx.manage_compress.init(block_count);
+	}
 
-		// All threads will enter this function and dynamically grab work
-		compute_averages_and_variances(*ctx, ctx->avg_var_preprocess_args);
+	unsigned int count;
+	unsigned int base = ctx.manage_compress.get_task_assignment(granule, count);
+	if (!count)
+	{
+		return false;
 	}
 
-	// Wait for compute_averages_and_variances to complete before compressing
-	ctx->manage_avg_var.wait();
+	for (unsigned int i = base; i < base + count; i++)
+	{
+		// Decode i into x, y, z block indices
+		int z = i / plane_blocks;
+		unsigned int rem = i - (z * plane_blocks);
+		int y = rem / row_blocks;
+		int x = rem - (y * row_blocks);
+
+		fetch_compress_block(ctx, image, swizzle, x, y, z, blk);
+
+		int offset = ((z * yblocks + y) * xblocks + x) * 16;
+		uint8_t *bp = buffer + offset;
+		physical_compressed_block* pcb = reinterpret_cast<physical_compressed_block*>(bp);
+
+		if (!use_rdo)
+		{
+			compress_block(ctx, config, image, blk, *pcb, temp_buffers);
+		}
+		else
+		{
+			physical_compressed_block rdo_pcb;
+			compress_block(ctx, config, image, blk, rdo_pcb, temp_buffers);
+			rate_distortion_select_image_block(ctx, temp_buffers, blk, buffer, xblocks, x, y,
+			                                   z * yblocks + y, rdo_pcb);
+			*pcb = rdo_pcb;
+
+			// Publish the final encoding to the blocks to the right and below. The store is made
+			// under the lock so that a waiter cannot miss the notification.
+			{
+				std::lock_guard<std::mutex> lck(ctx.rdo_row_lock);
+				ctx.rdo_row_progress[z * yblocks + y].store(x + 1, std::memory_order_release);
+			}
+
+			ctx.rdo_row_updated.notify_all();
+		}
+
+		if (block_errors)
+		{
+			block_errors[i] = temp_buffers.candidates.candidates[0].error;
+		}
+
+		if (block_targets)
+		{
+			block_targets[i] = get_block_error_threshold(ctx.config, blk, temp_buffers.error_weight_sum);
+		}
 
-	compress_image(*ctx, thread_index, image, *swizzle, data_out);
+		if (candidate_limit)
+		{
+			const block_candidate_list& list = temp_buffers.candidates;
+			astcenc_block_candidate* block_candidates = candidates + (offset / 16) * candidate_limit;
+			for (unsigned int j = 0; j < candidate_limit; j++)
+			{
+				if (j < list.count)
+				{
+					block_candidates[j] = list.candidates[j];
+				}
+				else
+				{
+					block_candidates[j] = astcenc_block_candidate {};
+					block_candidates[j].error = -1.0f;
+				}
+			}
+		}
+	}
+
+	ctx.manage_compress.complete_task_assignment(count);
+	return true;
+}
+
+/**
+ * @brief Compress an image, after any preflight has completed.
+ *
+ * @param[out] ctx               The compressor context.
+ * @param      config            The compressor configuration to use for the search.
+ * @param      thread_index      The thread index.
+ * @param      image             The intput image.
+ * @param      swizzle           The input swizzle.
+ * @param[out] buffer            The output array for the compressed data.
+ * @param[out] candidates        The output array for the candidate encodings, or @c nullptr.
+ * @param      candidate_limit   The number of candidate encodings to store per block, or zero.
+ * @param[out] block_errors      The output array for the per-block error, or @c nullptr.
+ * @param[out] block_targets     The output array for the per-block error target of the context
+ *                               config, or @c nullptr. Only valid if @c block_errors is set.
+ */
+static void compress_image(
+	astcenc_context& ctx,
+	const astcenc_config& config,
+	unsigned int thread_index,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle,
+	uint8_t* buffer,
+	astcenc_block_candidate* candidates,
+	unsigned int candidate_limit,
+	float* block_errors,
+	float* block_targets
+) {
+	// Use preallocated scratch buffer
+	auto& temp_buffers = ctx.working_buffers[thread_index];
+
+	// All threads run this processing loop until there is no work remaining
+	while (compress_image_task(ctx, config, temp_buffers, image, swizzle, buffer,
+	                           candidates, candidate_limit, block_errors, block_targets))
+	{
+	}
+}
+
+/**
+ * @brief Refine a progressively compressed image, after the initial pass has completed.
+ *
+ * Blocks are recompressed using the context config, in order of decreasing initial error, and the
+ * output is only updated if the new encoding has a lower error. Blocks with no error, or which
+ * already meet the error target of the context config, are not recompressed, as the context config
+ * search treats any encoding meeting the target as good enough. Updates are written to the output
+ * while holding the refinement progress lock, so the progress callback always sees a stable image.
+ *
+ * @param[out] ctx            The compressor context.
+ * @param      thread_index   The thread index.
+ * @param      image          The intput image.
+ * @param      swizzle        The input swizzle.
+ * @param[out] buffer         The output array for the compressed data.
+ */
+static void refine_image(
+	astcenc_context& ctx,
+	unsigned int thread_index,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle,
+	uint8_t* buffer
+) {
+	const block_size_descriptor *bsd = ctx.bsd;
+	image_block blk;
+
+	int xblocks = (image.dim_x + bsd->xdim - 1) / bsd->xdim;
+	int yblocks = (image.dim_y + bsd->ydim - 1) / bsd->ydim;
+	int zblocks = (image.dim_z + bsd->zdim - 1) / bsd->zdim;
+
+	unsigned int row_blocks = xblocks;
+	unsigned int plane_blocks = xblocks * yblocks;
+	unsigned int block_count = zblocks * yblocks * xblocks;
+
+	auto& temp_buffers = ctx.working_buffers[thread_index];
+	temp_buffers.candidates.limit = 1;
+
+	// Only the first thread actually runs the initializer, which orders the blocks that can still
+	// improve worst first and signals that the initial pass is complete
+	auto init_refine = [&ctx, block_count]() {
+		unsigned int* order = ctx.progressive_order;
+		const float* errors = ctx.progressive_errors;
+		const float* targets = ctx.progressive_targets;
+
+		unsigned int refine_count = 0;
+		for (unsigned int i = 0; i < block_count; i++)
+		{
+			if ((errors[i] > 0.0f) && (errors[i] >= targets[i]))
+			{
+				order[refine_count] = i;
+				refine_count++;
+			}
+		}
+
+		std::sort(order, order + refine_count, [errors](unsigned int a, unsigned int b) {
+			return errors[a] > errors[b] || (errors[a] == errors[b] && a < b);
+		});
+
+		if (ctx.config.progress_callback)
+		{
+			ctx.config.progress_callback(0.0f);
+
+			// With no blocks to refine the initial pass is the final image
+			if (refine_count == 0)
+			{
+				ctx.config.progress_callback(100.0f);
+			}
+		}
+
+		return refine_count;
+	};
+
+	ctx.manage_refine.init(init_refine, ctx.config.progress_callback);
+
+	// Improved blocks are buffered for each task, and written to the output when it completes
+	static const unsigned int granule { 16 };
+	unsigned int refined_index[granule];
+	physical_compressed_block refined_pcb[granule];
+	unsigned int refined_count = 0;
+
+	auto commit_refined = [buffer, &refined_index, &refined_pcb, &refined_count]() {
+		for (unsigned int j = 0; j < refined_count; j++)
+		{
+			std::memcpy(buffer + refined_index[j] * 16, refined_pcb[j].data, 16);
+		}
+	};
+
+	// All threads run this processing loop until there is no work remaining
+	while (true)
+	{
+		unsigned int count;
+		unsigned int base = ctx.manage_refine.get_task_assignment(granule, count);
+		if (!count)
+		{
+			break;
+		}
+
+		refined_count = 0;
+		for (unsigned int i = base; i < base + count; i++)
+		{
+			unsigned int block_index = ctx.progressive_order[i];
+
+			// Decode the block index into x, y, z block indices
+			unsigned int z = block_index / plane_blocks;
+			unsigned int rem = block_index - (z * plane_blocks);
+			unsigned int y = rem / row_blocks;
+			unsigned int x = rem - (y * row_blocks);
+
+			fetch_compress_block(ctx, image, swizzle, x, y, z, blk);
+
+			physical_compressed_block& pcb = refined_pcb[refined_count];
+			compress_block(ctx, ctx.config, image, blk, pcb, temp_buffers);
+
+			if (temp_buffers.candidates.candidates[0].error < ctx.progressive_errors[block_index])
+			{
+				refined_index[refined_count] = block_index;
+				refined_count++;
+			}
+		}
+
+		ctx.manage_refine.complete_task_assignment(count, commit_refined);
+	}
+}
+
+/**
+ * @brief Get the number of blocks in an image.
+ *
+ * @param ctx     The compressor context.
+ * @param image   The input image.
+ *
+ * @return The number of blocks.
+ */
+static unsigned int get_block_count(
+	const astcenc_context& ctx,
+	const astcenc_image& image
+) {
+	unsigned int block_x = ctx.config.block_x;
+	unsigned int block_y = ctx.config.block_y;
+	unsigned int block_z = ctx.config.block_z;
+
+	unsigned int xblocks = (image.dim_x + block_x - 1) / block_x;
+	unsigned int yblocks = (image.dim_y + block_y - 1) / block_y;
+	unsigned int zblocks = (image.dim_z + block_z - 1) / block_z;
+
+	return xblocks * yblocks * zblocks;
+}
+
+/**
+ * @brief Validate the arguments of an image compression call.
+ *
+ * @param ctx            The compressor context.
+ * @param image          The input image.
+ * @param swizzle        The input swizzle.
+ * @param data_len       The length of the output data array.
+ * @param thread_index   The thread index.
+ *
+ * @return Return @c ASTCENC_SUCCESS if validated, otherwise an error on failure.
+ */
+static astcenc_error validate_compress_image(
+	const astcenc_context& ctx,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	if (ctx.config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	astcenc_error status = validate_compression_swizzle(swizzle);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if (thread_index >= ctx.thread_count)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// Check we have enough output space (16 bytes per block)
+	size_t size_needed = get_block_count(ctx, image) * 16;
+	if (data_len < size_needed)
+	{
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
+
+	return ASTCENC_SUCCESS;
+}
+
+/**
+ * @brief Test if a config needs the input image averages and variances.
+ *
+ * @param config   The compressor configuration.
+ *
+ * @return Return @c true if the statistics are needed, @c false otherwise.
+ */
+static bool needs_image_statistics(
+	const astcenc_config& config
+) {
+	return config.v_rgb_mean != 0.0f || config.v_rgb_stdev != 0.0f ||
+	       config.v_a_mean != 0.0f || config.v_a_stdev != 0.0f ||
+	       config.a_scale_radius != 0;
+}
+
+/**
+ * @brief Allocate the input image averages and variances, and set up their computation.
+ *
+ * @param[out] ctx       The compressor context.
+ * @param      image     The input image.
+ * @param      swizzle   The input swizzle.
+ *
+ * @return The number of tasks in the processing stage.
+ */
+static unsigned int init_image_statistics(
+	astcenc_context& ctx,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle
+) {
+	// Perform memory allocations for the destination buffers
+	size_t texel_count = static_cast<size_t>(image.dim_x) * image.dim_y * image.dim_z;
+	ctx.input_averages = new vfloat4[texel_count];
+	ctx.input_variances = new vfloat4[texel_count];
+	ctx.input_alpha_averages = new float[texel_count];
+
+	return init_compute_averages_and_variances(
+		image, ctx.config.v_rgb_power, ctx.config.v_a_power,
+		ctx.config.v_rgba_radius, ctx.config.a_scale_radius, swizzle,
+		ctx.avg_var_preprocess_args);
+}
+
+/**
+ * @brief Compute the input image averages and variances, if needed by the config.
+ *
+ * This must be called by all threads; it returns once the statistics are available.
+ *
+ * @param[out] ctx       The compressor context.
+ * @param      image     The input image.
+ * @param      swizzle   The input swizzle.
+ */
+static void prepare_image_statistics(
+	astcenc_context& ctx,
+	const astcenc_image& image,
+	const astcenc_swizzle& swizzle
+) {
+	if (needs_image_statistics(ctx.config))
+	{
+		// First thread to enter will do setup, other threads will subsequently
+		// enter the critical section but simply skip over the initialization
+		auto init_avg_var = [&ctx, &image, &swizzle]() {
+			return init_image_statistics(ctx, image, swizzle);
+		};
+
+		// Only the first thread actually runs the initializer
+		ctx.manage_avg_var.init(init_avg_var);
+
+		// All threads will enter this function and dynamically grab work
+		compute_averages_and_variances(ctx, ctx.avg_var_preprocess_args);
+	}
+
+	// Wait for compute_averages_and_variances to complete before compressing
+	ctx.manage_avg_var.wait();
+}
+
+/**
+ * @brief Free the input image averages and variances.
+ *
+ * @param[out] ctx   The compressor context.
+ */
+static void free_image_statistics(
+	astcenc_context& ctx
+) {
+	delete[] ctx.input_averages;
+	ctx.input_averages = nullptr;
+
+	delete[] ctx.input_variances;
+	ctx.input_variances = nullptr;
+
+	delete[] ctx.input_alpha_averages;
+	ctx.input_alpha_averages = nullptr;
+}
+
+#endif
+
+/* See header for documentation. */
+astcenc_error astcenc_compress_image(
+	astcenc_context* ctx,
+	astcenc_image* imagep,
+	const astcenc_swizzle* swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+	return astcenc_compress_image_candidates(
+	    ctx, imagep, swizzle, data_out, data_len, nullptr, 0, 0, thread_index);
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_compress_image_candidates(
+	astcenc_context* ctx,
+	astcenc_image* imagep,
+	const astcenc_swizzle* swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	astcenc_block_candidate* candidates_out,
+	size_t candidates_len,
+	unsigned int candidate_limit,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)imagep;
+	(void)swizzle;
+	(void)data_out;
+	(void)data_len;
+	(void)candidates_out;
+	(void)candidates_len;
+	(void)candidate_limit;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+	astcenc_image& image = *imagep;
+
+	status = validate_compress_image(*ctx, image, *swizzle, data_len, thread_index);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	// Check we have enough candidate output space, if requested
+	if (candidate_limit > ASTCENC_MAX_BLOCK_CANDIDATES)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	size_t candidates_needed = get_block_count(*ctx, image) * candidate_limit;
+	if (candidate_limit && (!candidates_out || candidates_len < candidates_needed))
+	{
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
+
+	// If context thread count is one then implicitly reset
+	if (ctx->thread_count == 1)
+	{
+		astcenc_compress_reset(ctx);
+	}
+
+	prepare_image_statistics(*ctx, image, *swizzle);
+
+	compress_image(*ctx, ctx->config, thread_index, image, *swizzle, data_out,
+	               candidates_out, candidate_limit, nullptr, nullptr);
+
+	// Wait for compress to complete before freeing memory
+	ctx->manage_compress.wait();
+
+	auto term_compress = [ctx]() {
+		free_image_statistics(*ctx);
+	};
+
+	// Only the first thread to arrive actually runs the term
+	ctx->manage_compress.term(term_compress);
+
+	return ASTCENC_SUCCESS;
+#endif
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_compress_image_progressive(
+	astcenc_context* ctx,
+	astcenc_image* imagep,
+	const astcenc_swizzle* swizzle,
+	uint8_t* data_out,
+	size_t data_len,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)imagep;
+	(void)swizzle;
+	(void)data_out;
+	(void)data_len;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+	astcenc_image& image = *imagep;
+
+	status = validate_compress_image(*ctx, image, *swizzle, data_len, thread_index);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	// If context thread count is one then implicitly reset
+	if (ctx->thread_count == 1)
+	{
+		astcenc_compress_reset(ctx);
+	}
+
+	prepare_image_statistics(*ctx, image, *swizzle);
+
+	// Allocate the progressive state before the initial pass, which would otherwise initialize
+	// the compression stage itself
+	unsigned int block_count = get_block_count(*ctx, image);
+	auto init_progressive = [ctx, block_count]() {
+		ctx->progressive_errors = new float[block_count];
+		ctx->progressive_targets = new float[block_count];
+		ctx->progressive_order = new unsigned int[block_count];
+		return block_count;
+	};
+
+	ctx->manage_compress.init(init_progressive);
+
+	compress_image(*ctx, ctx->progressive_config, thread_index, image, *swizzle, data_out,
+	               nullptr, 0, ctx->progressive_errors, ctx->progressive_targets);
+
+	// Wait for the initial pass to complete before refining
+	ctx->manage_compress.wait();
+
+	refine_image(*ctx, thread_index, image, *swizzle, data_out);
+
+	// Wait for refinement to complete before freeing memory
+	ctx->manage_refine.wait();
+
+	auto term_progressive = [ctx]() {
+		free_image_statistics(*ctx);
+
+		delete[] ctx->progressive_errors;
+		ctx->progressive_errors = nullptr;
+
+		delete[] ctx->progressive_targets;
+		ctx->progressive_targets = nullptr;
+
+		delete[] ctx->progressive_order;
+		ctx->progressive_order = nullptr;
+	};
+
+	// Only the first thread to arrive actually runs the term
+	ctx->manage_refine.term(term_progressive);
+
+	return ASTCENC_SUCCESS;
+#endif
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_compress_image_multi(
+	astcenc_context** contexts,
+	unsigned int context_count,
+	astcenc_image* imagep,
+	const astcenc_swizzle* swizzle,
+	uint8_t** data_out,
+	const size_t* data_len,
+	unsigned int thread_index
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)contexts;
+	(void)context_count;
+	(void)imagep;
+	(void)swizzle;
+	(void)data_out;
+	(void)data_len;
+	(void)thread_index;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+	astcenc_image& image = *imagep;
+
+	if (!contexts || !data_out || !data_len || context_count == 0)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// All contexts must be able to share the statistics computed by the first context
+	astcenc_context* base = contexts[0];
+	for (unsigned int i = 0; i < context_count; i++)
+	{
+		const astcenc_context& ctx = *contexts[i];
+		status = validate_compress_image(ctx, image, *swizzle, data_len[i], thread_index);
+		if (status != ASTCENC_SUCCESS)
+		{
+			return status;
+		}
+
+		if (ctx.thread_count != base->thread_count ||
+		    ctx.config.v_rgba_radius != base->config.v_rgba_radius ||
+		    ctx.config.v_rgb_power != base->config.v_rgb_power ||
+		    ctx.config.v_a_power != base->config.v_a_power ||
+		    ctx.config.a_scale_radius != base->config.a_scale_radius ||
+		    needs_image_statistics(ctx.config) != needs_image_statistics(base->config))
+		{
+			return ASTCENC_ERR_BAD_PARAM;
+		}
+	}
+
+	// If context thread count is one then implicitly reset
+	if (base->thread_count == 1)
+	{
+		for (unsigned int i = 0; i < context_count; i++)
+		{
+			astcenc_compress_reset(contexts[i]);
+		}
+	}
+
+	prepare_image_statistics(*base, image, *swizzle);
+
+	for (unsigned int i = 0; i < context_count; i++)
+	{
+		astcenc_context* ctx = contexts[i];
+
+		// Other contexts borrow the statistics of the first context; this uses no tasks, so the
+		// stage completes as soon as the first thread to arrive has run the initializer
+		if (i != 0)
+		{
+			auto init_borrow = [ctx, base]() {
+				ctx->input_averages = base->input_averages;
+				ctx->input_variances = base->input_variances;
+				ctx->input_alpha_averages = base->input_alpha_averages;
+				return 0u;
+			};
+
+			ctx->manage_avg_var.init(init_borrow);
+		}
+
+		compress_image(*ctx, ctx->config, thread_index, image, *swizzle, data_out[i],
+		               nullptr, 0, nullptr, nullptr);
+
+		// Wait for compress to complete before starting the next context, so all threads stay
+		// together and the statistics are not freed while in use
+		ctx->manage_compress.wait();
+	}
+
+	auto term_compress = [contexts, context_count, base]() {
+		for (unsigned int i = 1; i < context_count; i++)
+		{
+			contexts[i]->input_averages = nullptr;
+			contexts[i]->input_variances = nullptr;
+			contexts[i]->input_alpha_averages = nullptr;
+		}
+
+		free_image_statistics(*base);
+	};
+
+	// Only the first thread to arrive actually runs the term
+	base->manage_compress.term(term_compress);
+
+	return ASTCENC_SUCCESS;
+#endif
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_compress_begin(
+	astcenc_context* ctx,
+	const astcenc_image* imagep,
+	const astcenc_swizzle* swizzle,
+	uint8_t* data_out,
+	size_t data_len
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)imagep;
+	(void)swizzle;
+	(void)data_out;
+	(void)data_len;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	astcenc_error status;
+	const astcenc_image& image = *imagep;
+
+	status = validate_compress_image(*ctx, image, *swizzle, data_len, 0);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	// RDO tasks wait for the tasks of the previous block row, which a job scheduler may suspend
+	if (ctx->config.rdo_lambda > 0.0f)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	astcenc_compress_reset(ctx);
+
+	ctx->job_swizzle = *swizzle;
+	ctx->job_data_out = data_out;
+
+	// The averages and variances stage is initialized up front so that tasks can be run by any
+	// thread; it has no tasks if the config does not need the statistics
+	unsigned int avg_var_tasks = 0;
+	if (needs_image_statistics(ctx->config))
+	{
+		avg_var_tasks = init_image_statistics(*ctx, image, *swizzle);
+
+		// Working memory for the tasks is allocated once per job for each scratch pool buffer
+		const avg_var_args& ag = ctx->avg_var_preprocess_args;
+		ctx->job_work_memory = new vfloat4[ag.work_memory_size * ctx->thread_count];
+		ctx->job_int_work_memory = new vint4[ag.int_work_memory_size * ctx->thread_count];
+	}
+
+	ctx->manage_avg_var.init(avg_var_tasks);
+
+	// Publish the job last, so any thread that sees the image also sees the rest of the job state
+	ctx->job_image.store(imagep);
+
+	return ASTCENC_SUCCESS;
+#endif
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_compress_run_task(
+	astcenc_context* ctx,
+	int* job_complete
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	(void)job_complete;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	if (ctx->config.flags & ASTCENC_FLG_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	if (!job_complete)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// Register the call before checking for an active job. The end of a job clears the image
+	// before waiting for active calls to return, so either this call sees no job or the end of
+	// the job waits for this call. Both use sequentially consistent ordering for this.
+	ctx->job_active_calls.fetch_add(1);
+	const astcenc_image* imagep = ctx->job_image.load();
+
+	// A call with no active job, e.g. racing the end of the job, has nothing left to do
+	if (!imagep)
+	{
+		*job_complete = 1;
+		ctx->job_active_calls.fetch_sub(1, std::memory_order_release);
+		return ASTCENC_SUCCESS;
+	}
+
+	*job_complete = 0;
+
+	// If all scratch buffers are in use the job is already running at full width
+	unsigned int buffer_index;
+	if (!ctx->scratch_pool.checkout(buffer_index))
+	{
+		ctx->job_active_calls.fetch_sub(1, std::memory_order_release);
+		return ASTCENC_SUCCESS;
+	}
+
+	auto& temp_buffers = ctx->working_buffers[buffer_index];
+	const astcenc_image& image = *imagep;
+
+	// Compression can only start once all of the averages and variances are available
+	const avg_var_args& ag = ctx->avg_var_preprocess_args;
+	vfloat4* work_memory = nullptr;
+	vint4* int_work_memory = nullptr;
+	if (ctx->job_work_memory)
+	{
+		work_memory = ctx->job_work_memory + ag.work_memory_size * buffer_index;
+		int_work_memory = ctx->job_int_work_memory + ag.int_work_memory_size * buffer_index;
+	}
+
+	if (!compute_averages_and_variances_task(*ctx, ag, work_memory, int_work_memory) &&
+	    ctx->manage_avg_var.is_complete())
+	{
+		if (!compress_image_task(*ctx, ctx->config, temp_buffers, image, ctx->job_swizzle,
+		                         ctx->job_data_out, nullptr, 0, nullptr, nullptr))
+		{
+			*job_complete = ctx->manage_compress.is_complete() ? 1 : 0;
+		}
+	}
+
+	ctx->scratch_pool.checkin(buffer_index);
+	ctx->job_active_calls.fetch_sub(1, std::memory_order_release);
+	return ASTCENC_SUCCESS;
+#endif
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_compress_end(
+	astcenc_context* ctx
+) {
+#if defined(ASTCENC_DECOMPRESS_ONLY)
+	(void)ctx;
+	return ASTCENC_ERR_BAD_CONTEXT;
+#else
+	if (!ctx->job_image.load(std::memory_order_relaxed))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// Help run any remaining tasks, then wait for tasks still running on other threads
+	int job_complete = 0;
+	while (!job_complete)
+	{
+		astcenc_error status = astcenc_compress_run_task(ctx, &job_complete);
+		if (status != ASTCENC_SUCCESS)
+		{
+			return status;
+		}
 
-	// Wait for compress to complete before freeing memory
-	ctx->manage_compress.wait();
+		if (!job_complete)
+		{
+			std::this_thread::yield();
+		}
+	}
 
-	auto term_compress = [ctx]() {
-		delete[] ctx->input_averages;
-		ctx->input_averages = nullptr;
+	// Retire the job, and then wait for calls that started before it was retired to return their
+	// scratch buffers before the shared job state is freed
+	ctx->job_image.store(nullptr);
+	while (ctx->job_active_calls.load() != 0)
+	{
+		std::this_thread::yield();
+	}
 
-		delete[] ctx->input_variances;
-		ctx->input_variances = nullptr;
+	free_image_statistics(*ctx);
+	ctx->job_data_out = nullptr;
 
-		delete[] ctx->input_alpha_averages;
-		ctx->input_alpha_averages = nullptr;
-	};
+	delete[] ctx->job_work_memory;
+	ctx->job_work_memory = nullptr;
 
-	// Only the first thread to arrive actually runs the term
-	ctx->manage_compress.term(term_compress);
+	delete[] ctx->job_int_work_memory;
+	ctx->job_int_work_memory = nullptr;
 
 	return ASTCENC_SUCCESS;
 #endif
@@ -1092,10 +2178,44 @@ astcenc_error astcenc_compress_reset(
 
 	ctx->manage_avg_var.reset();
 	ctx->manage_compress.reset();
+	ctx->manage_refine.reset();
 	return ASTCENC_SUCCESS;
 #endif
 }
 
+/**
+ * @brief Test if an encoded block is a void-extent block.
+ *
+ * @param block   The encoded block data.
+ *
+ * @return True if the block is a void-extent block.
+ */
+static bool is_void_extent_block(
+	const uint8_t* block
+) {
+	return ((block[0] | (block[1] << 8)) & 0x1FF) == 0x1FC;
+}
+
+/**
+ * @brief Get the decode cache entry for an encoded block.
+ *
+ * @param block   The encoded block data.
+ *
+ * @return The cache entry index.
+ */
+static unsigned int get_decode_cache_entry(
+	const uint8_t* block
+) {
+	static_assert(DECODE_CACHE_ENTRIES == 64, "Cache hash assumes a 64 entry cache");
+
+	uint64_t lo, hi;
+	std::memcpy(&lo, block, 8);
+	std::memcpy(&hi, block + 8, 8);
+
+	uint64_t hash = (lo ^ (hi * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+	return static_cast<unsigned int>(hash >> 58);
+}
+
 /* See header for documentation. */
 astcenc_error astcenc_decompress_image(
 	astcenc_context* ctx,
@@ -1146,6 +2266,14 @@ astcenc_error astcenc_decompress_image(
 		astcenc_decompress_reset(ctx);
 	}
 
+	// Cached blocks are stored in the output format, so are only valid for this call
+	decode_cache* cache = nullptr;
+	if (ctx->decode_caches)
+	{
+		cache = ctx->decode_caches + thread_index;
+		std::fill_n(cache->valid, DECODE_CACHE_ENTRIES, false);
+	}
+
 	// Only the first thread actually runs the initializer
 	ctx->manage_decompress.init(zblocks * yblocks * xblocks);
 
@@ -1172,14 +2300,55 @@ astcenc_error astcenc_decompress_image(
 			physical_compressed_block pcb = *(const physical_compressed_block*)bp;
 			symbolic_compressed_block scb;
 
+			unsigned int xpos = x * block_x;
+			unsigned int ypos = y * block_y;
+			unsigned int zpos = z * block_z;
+
+			// Constant color blocks can skip the texel decode and just fill the footprint
+			if (is_void_extent_block(bp))
+			{
+				physical_to_symbolic(*ctx->bsd, pcb, scb);
+				if (scb.block_type != SYM_BTYPE_ERROR)
+				{
+					vfloat4 color = decode_constant_block_color(ctx->config.profile, scb);
+					fill_image_block(image_out, color, *ctx->bsd, xpos, ypos, zpos, *swizzle);
+					continue;
+				}
+			}
+
+			// Repeated blocks can be copied from the cache, if the footprint is inside the image
+			bool use_cache = cache &&
+			                 (xpos + block_x <= image_out.dim_x) &&
+			                 (ypos + block_y <= image_out.dim_y) &&
+			                 (zpos + block_z <= image_out.dim_z);
+
+			unsigned int entry = 0;
+			if (use_cache)
+			{
+				entry = get_decode_cache_entry(bp);
+				uint8_t* texels = cache->texels + entry * cache->texels_stride;
+				if (cache->valid[entry] && !std::memcmp(cache->keys[entry], bp, 16))
+				{
+					restore_image_block_texels(image_out, *ctx->bsd, xpos, ypos, zpos, texels);
+					continue;
+				}
+			}
+
 			physical_to_symbolic(*ctx->bsd, pcb, scb);
 
 			decompress_symbolic_block(ctx->config.profile, *ctx->bsd,
-			                          x * block_x, y * block_y, z * block_z,
-			                          scb, blk);
+			                          xpos, ypos, zpos, scb, blk);
 
 			write_image_block(image_out, blk, *ctx->bsd,
-			                 x * block_x, y * block_y, z * block_z, *swizzle);
+			                 xpos, ypos, zpos, *swizzle);
+
+			if (use_cache)
+			{
+				uint8_t* texels = cache->texels + entry * cache->texels_stride;
+				save_image_block_texels(image_out, *ctx->bsd, xpos, ypos, zpos, texels);
+				std::memcpy(cache->keys[entry], bp, 16);
+				cache->valid[entry] = true;
+			}
 		}
 
 		ctx->manage_decompress.complete_task_assignment(count);
@@ -1196,6 +2365,283 @@ astcenc_error astcenc_decompress_reset(
 	return ASTCENC_SUCCESS;
 }
 
+/**
+ * @brief Test if a block needs an HDR profile to decode.
+ *
+ * LDR profiles decode FLOAT16 constant color blocks and blocks using HDR endpoint modes as the
+ * error color.
+ *
+ * @param scb   The symbolic block header; must not be an error block.
+ *
+ * @return Return @c true if the block uses HDR features, @c false otherwise.
+ */
+static bool is_hdr_block(
+	const symbolic_compressed_block& scb
+) {
+	if (scb.block_type == SYM_BTYPE_CONST_F16)
+	{
+		return true;
+	}
+
+	if (scb.block_type == SYM_BTYPE_CONST_U16)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < scb.partition_count; i++)
+	{
+		switch (scb.color_formats[i])
+		{
+		case FMT_HDR_LUMINANCE_LARGE_RANGE:
+		case FMT_HDR_LUMINANCE_SMALL_RANGE:
+		case FMT_HDR_RGB_SCALE:
+		case FMT_HDR_RGB:
+		case FMT_HDR_RGB_LDR_ALPHA:
+		case FMT_HDR_RGBA:
+			return true;
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_validate_blocks(
+	astcenc_context* ctx,
+	const uint8_t* data,
+	size_t data_len,
+	size_t* error_blocks,
+	size_t error_blocks_len,
+	size_t* error_count,
+	unsigned int thread_index
+) {
+	if (thread_index >= ctx->thread_count)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// Self-decompress-only contexts omit legal block modes, so would report false errors
+	if (ctx->config.flags & ASTCENC_FLG_SELF_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	size_t block_count = data_len / 16;
+	if ((data_len % 16) || (block_count > std::numeric_limits<unsigned int>::max()))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// If context thread count is one then implicitly reset
+	if (ctx->thread_count == 1)
+	{
+		astcenc_validate_reset(ctx);
+	}
+
+	bool is_ldr = (ctx->config.profile == ASTCENC_PRF_LDR) ||
+	              (ctx->config.profile == ASTCENC_PRF_LDR_SRGB);
+
+	// Only the first thread actually runs the initializer
+	ctx->manage_validate.init([ctx, block_count]() {
+		ctx->validate_error_count = 0;
+		return static_cast<unsigned int>(block_count);
+	});
+
+	// All threads run this processing loop until there is no work remaining
+	while (true)
+	{
+		unsigned int count;
+		unsigned int base = ctx->manage_validate.get_task_assignment(4096, count);
+		if (!count)
+		{
+			break;
+		}
+
+		for (unsigned int i = base; i < base + count; i++)
+		{
+			physical_compressed_block pcb = *(const physical_compressed_block*)(data + i * size_t(16));
+			symbolic_compressed_block scb;
+
+			physical_to_symbolic_header(*ctx->bsd, pcb, scb);
+			if ((scb.block_type == SYM_BTYPE_ERROR) || (is_ldr && is_hdr_block(scb)))
+			{
+				size_t index = ctx->validate_error_count.fetch_add(1, std::memory_order_relaxed);
+				if (error_blocks && index < error_blocks_len)
+				{
+					error_blocks[index] = i;
+				}
+			}
+		}
+
+		ctx->manage_validate.complete_task_assignment(count);
+	}
+
+	// Wait for the other threads so the error count is the total for all blocks
+	ctx->manage_validate.wait();
+	*error_count = ctx->validate_error_count.load();
+
+	return ASTCENC_SUCCESS;
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_validate_reset(
+	astcenc_context* ctx
+) {
+	ctx->manage_validate.reset();
+	return ASTCENC_SUCCESS;
+}
+
+/**
+ * @brief Accumulate the statistics of a single block.
+ *
+ * @param      bsd     The block size information.
+ * @param      pcb     The physical compressed block.
+ * @param[out] stats   The statistics to update.
+ */
+static void accumulate_block_stats(
+	const block_size_descriptor& bsd,
+	const physical_compressed_block& pcb,
+	astcenc_block_stats& stats
+) {
+	symbolic_compressed_block scb;
+	physical_to_symbolic_header(bsd, pcb, scb);
+
+	stats.block_count++;
+	if (scb.block_type == SYM_BTYPE_ERROR)
+	{
+		stats.error_block_count++;
+		return;
+	}
+
+	if (scb.block_type == SYM_BTYPE_CONST_U16)
+	{
+		stats.constant_block_count++;
+		return;
+	}
+
+	if (scb.block_type == SYM_BTYPE_CONST_F16)
+	{
+		stats.constant_hdr_block_count++;
+		return;
+	}
+
+	const block_mode& bm = bsd.get_block_mode(scb.block_mode);
+	const decimation_info& di = bsd.get_decimation_info(bm.decimation_mode);
+
+	stats.block_modes[scb.block_mode]++;
+	stats.partition_counts[scb.partition_count - 1]++;
+	stats.color_quant_modes[scb.get_color_quant_mode()]++;
+	stats.weight_quant_modes[bm.get_weight_quant_mode()]++;
+	stats.weight_grid_sizes[di.weight_z - 1][di.weight_y - 1][di.weight_x - 1]++;
+
+	for (unsigned int i = 0; i < scb.partition_count; i++)
+	{
+		stats.color_endpoint_modes[scb.color_formats[i]]++;
+	}
+
+	if (bm.is_dual_plane)
+	{
+		stats.dual_plane_block_count++;
+		stats.dual_plane_components[scb.plane2_component]++;
+	}
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_get_block_stats(
+	astcenc_context* ctx,
+	const uint8_t* data,
+	size_t data_len,
+	astcenc_block_stats* stats,
+	unsigned int thread_index
+) {
+	if (thread_index >= ctx->thread_count)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// Self-decompress-only contexts omit legal block modes, so would report false errors
+	if (ctx->config.flags & ASTCENC_FLG_SELF_DECOMPRESS_ONLY)
+	{
+		return ASTCENC_ERR_BAD_CONTEXT;
+	}
+
+	size_t block_count = data_len / 16;
+	if ((data_len % 16) || (block_count > std::numeric_limits<unsigned int>::max()))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	// If context thread count is one then implicitly reset
+	if (ctx->thread_count == 1)
+	{
+		astcenc_get_block_stats_reset(ctx);
+	}
+
+	// Only the first thread actually runs the initializer
+	ctx->manage_block_stats.init([stats, block_count]() {
+		std::memset(stats, 0, sizeof(*stats));
+		return static_cast<unsigned int>(block_count);
+	});
+
+	// Accumulate locally, and merge into the shared result once per thread. Tasks are only marked
+	// as complete after the merge, so no thread can return before all results are merged.
+	astcenc_block_stats* local = new astcenc_block_stats;
+	std::memset(local, 0, sizeof(*local));
+
+	unsigned int done_count = 0;
+	while (true)
+	{
+		unsigned int count;
+		unsigned int base = ctx->manage_block_stats.get_task_assignment(4096, count);
+		if (!count)
+		{
+			break;
+		}
+
+		for (unsigned int i = base; i < base + count; i++)
+		{
+			physical_compressed_block pcb = *(const physical_compressed_block*)(data + i * size_t(16));
+			accumulate_block_stats(*ctx->bsd, pcb, *local);
+		}
+
+		done_count += count;
+	}
+
+	if (done_count)
+	{
+		static_assert(sizeof(astcenc_block_stats) % sizeof(uint64_t) == 0,
+		              "astcenc_block_stats must only contain uint64_t counters");
+
+		uint64_t* dst = reinterpret_cast<uint64_t*>(stats);
+		const uint64_t* src = reinterpret_cast<const uint64_t*>(local);
+
+		std::unique_lock<std::mutex> lck(ctx->block_stats_lock);
+		for (size_t i = 0; i < sizeof(astcenc_block_stats) / sizeof(uint64_t); i++)
+		{
+			dst[i] += src[i];
+		}
+		lck.unlock();
+
+		ctx->manage_block_stats.complete_task_assignment(done_count);
+	}
+
+	delete local;
+
+	// Wait for the other threads so the statistics are complete for all blocks
+	ctx->manage_block_stats.wait();
+	return ASTCENC_SUCCESS;
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_get_block_stats_reset(
+	astcenc_context* ctx
+) {
+	ctx->manage_block_stats.reset();
+	return ASTCENC_SUCCESS;
+}
+
 /* See header for documentation. */
 astcenc_error astcenc_get_block_info(
 	astcenc_context* ctx,
@@ -1244,7 +2690,7 @@ astcenc_error astcenc_get_block_info(
 
 	// Otherwise handle a full block ; known to be valid after conditions above have been checked
 	int partition_count = scb.partition_count;
-	const auto& pi = bsd.get_partition_info(partition_count, scb.partition_index);
+	const auto& pi = get_lazy_partition_info(bsd, partition_count, scb.partition_index);
 
 	const block_mode& bm = bsd.get_block_mode(scb.block_mode);
 	const decimation_info& di = *bsd.decimation_tables[bm.decimation_mode];
@@ -1315,6 +2761,68 @@ astcenc_error astcenc_get_block_info(
 #endif
 }
 
+/* See header for documentation. */
+astcenc_error astcenc_block_stream_split(
+	unsigned int block_x,
+	unsigned int block_y,
+	unsigned int block_z,
+	const uint8_t* data,
+	size_t data_len,
+	uint8_t* stream_out,
+	size_t* stream_len
+) {
+	astcenc_error status = validate_block_size(block_x, block_y, block_z);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if (!data || !stream_out || !stream_len || (data_len % 16) != 0)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	size_t block_count = data_len / 16;
+	size_t size_needed = ASTCENC_BLOCK_STREAM_HEADER_SIZE
+	                   + ASTCENC_BLOCK_STREAM_MAX_BLOCK_SIZE * block_count;
+	if (*stream_len < size_needed)
+	{
+		return ASTCENC_ERR_OUT_OF_MEM;
+	}
+
+	*stream_len = block_stream_split(block_z > 1, data, block_count, stream_out);
+	return ASTCENC_SUCCESS;
+}
+
+/* See header for documentation. */
+astcenc_error astcenc_block_stream_merge(
+	unsigned int block_x,
+	unsigned int block_y,
+	unsigned int block_z,
+	const uint8_t* stream,
+	size_t stream_len,
+	uint8_t* data_out,
+	size_t data_len
+) {
+	astcenc_error status = validate_block_size(block_x, block_y, block_z);
+	if (status != ASTCENC_SUCCESS)
+	{
+		return status;
+	}
+
+	if (!stream || !data_out || (data_len % 16) != 0)
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	if (!block_stream_merge(block_z > 1, stream, stream_len, data_len / 16, data_out))
+	{
+		return ASTCENC_ERR_BAD_PARAM;
+	}
+
+	return ASTCENC_SUCCESS;
+}
+
 /* See header for documentation. */
 const char* astcenc_get_error_string(
 	astcenc_error status
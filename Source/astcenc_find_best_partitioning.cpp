@@ -478,6 +478,170 @@ static void compute_kmeans_partition_ordering(
 	get_partition_ordering_by_mismatch_bits(mismatch_counts, partition_ordering);
 }
 
+/**
+ * @brief Compute the partitioning errors for an LDR luminance block.
+ *
+ * Luminance data is 1 dimensional, so the endpoint line always fits the data exactly and the only
+ * error is the estimate of weight quantization imprecision which scales with the line length.
+ * As luminance endpoints have no same chroma constraint both errors are the same.
+ *
+ * @param      pi                         The partition info for the current trial.
+ * @param      blk                        The image block color data to compress.
+ * @param      ewb                        The image block weighted error data.
+ * @param      weight_imprecision_estim   The squared weight quantization imprecision estimate.
+ * @param      uncor_limit                The uncorrelated error limit for early-out.
+ * @param      samec_limit                The same chroma error limit for early-out.
+ * @param[out] uncor_error                The error assuming uncorrelated endpoints.
+ * @param[out] samec_error                The error assuming same chroma endpoints.
+ */
+static void compute_partition_errors_luminance(
+	const partition_info& pi,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	float weight_imprecision_estim,
+	float uncor_limit,
+	float samec_limit,
+	float& uncor_error,
+	float& samec_error
+) {
+	unsigned int partition_count = pi.partition_count;
+	promise(partition_count > 0);
+
+	float error = 0.0f;
+	for (unsigned int i = 0; i < partition_count; i++)
+	{
+		const uint8_t *texel_indexes = pi.texels_of_partition[i];
+		unsigned int texel_count = pi.partition_texel_count[i];
+		promise(texel_count > 0);
+
+		float lowvalue = 1e10f;
+		float highvalue = -1e10f;
+		float weight_sum = 0.0f;
+
+		for (unsigned int j = 0; j < texel_count; j++)
+		{
+			unsigned int tix = texel_indexes[j];
+			float value = blk.data_r[tix];
+			lowvalue = astc::min(value, lowvalue);
+			highvalue = astc::max(value, highvalue);
+			weight_sum += ewb.texel_weight_rgb[tix];
+		}
+
+		// Luminance error applies to all three RGB channels, and texel count cancels out
+		float length = astc::max(highvalue - lowvalue, 1e-7f);
+		error += length * length * (weight_sum * 3.0f) * weight_imprecision_estim;
+
+		// The error only grows, so stop once this partitioning cannot be selected
+		if (error >= uncor_limit && error >= samec_limit)
+		{
+			break;
+		}
+	}
+
+	uncor_error = error;
+	samec_error = error;
+}
+
+/**
+ * @brief Compute the partitioning errors for an LDR luminance-alpha block.
+ *
+ * This is a specialized 2 component variant of the RGBA error estimate, using the red channel as
+ * the luminance value with its error weighted as the sum of the RGB error weights.
+ *
+ * @param      pi                         The partition info for the current trial.
+ * @param      blk                        The image block color data to compress.
+ * @param      ewb                        The image block weighted error data.
+ * @param      weight_imprecision_estim   The squared weight quantization imprecision estimate.
+ * @param      uncor_limit                The uncorrelated error limit for early-out.
+ * @param      samec_limit                The same chroma error limit for early-out.
+ * @param[out] uncor_error                The error assuming uncorrelated endpoints.
+ * @param[out] samec_error                The error assuming same chroma endpoints.
+ */
+static void compute_partition_errors_luminance_alpha(
+	const partition_info& pi,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	float weight_imprecision_estim,
+	float uncor_limit,
+	float samec_limit,
+	float& uncor_error,
+	float& samec_error
+) {
+	unsigned int partition_count = pi.partition_count;
+	promise(partition_count > 0);
+
+	partition_metrics pms[BLOCK_MAX_PARTITIONS];
+	compute_avgs_and_dirs_2_comp(pi, blk, ewb, 0, 3, pms);
+
+	uncor_error = 0.0f;
+	samec_error = 0.0f;
+
+	for (unsigned int i = 0; i < partition_count; i++)
+	{
+		const partition_metrics& pm = pms[i];
+
+		vfloat4 uncor_b = normalize_safe(pm.dir, unit2());
+		vfloat4 uncor_amod = (pm.avg - uncor_b * dot_s(pm.avg, uncor_b)) * pm.icolor_scale;
+		vfloat4 uncor_bs = uncor_b * pm.color_scale;
+		vfloat4 uncor_bis = uncor_b * pm.icolor_scale;
+
+		// Same chroma always goes though zero, so this is simpler than the others
+		vfloat4 samec_b = normalize_safe(pm.avg, unit2());
+		vfloat4 samec_bs = samec_b * pm.color_scale;
+		vfloat4 samec_bis = samec_b * pm.icolor_scale;
+
+		float uncor_loparam = 1e10f;
+		float uncor_hiparam = -1e10f;
+
+		float samec_loparam = 1e10f;
+		float samec_hiparam = -1e10f;
+
+		const uint8_t *texel_indexes = pi.texels_of_partition[i];
+		unsigned int texel_count = pi.partition_texel_count[i];
+		promise(texel_count > 0);
+
+		for (unsigned int j = 0; j < texel_count; j++)
+		{
+			unsigned int tix = texel_indexes[j];
+			vfloat4 point = vfloat2(blk.data_r[tix], blk.data_a[tix]);
+			vfloat4 ews = vfloat2(ewb.texel_weight_rgb[tix] * 3.0f, ewb.texel_weight_a[tix]);
+
+			float uncor_param = dot_s(point, uncor_bs);
+			uncor_loparam = astc::min(uncor_param, uncor_loparam);
+			uncor_hiparam = astc::max(uncor_param, uncor_hiparam);
+
+			vfloat4 uncor_dist = (uncor_amod - point) + uncor_param * uncor_bis;
+			uncor_error += dot_s(ews, uncor_dist * uncor_dist);
+
+			float samec_param = dot_s(point, samec_bs);
+			samec_loparam = astc::min(samec_param, samec_loparam);
+			samec_hiparam = astc::max(samec_param, samec_hiparam);
+
+			vfloat4 samec_dist = samec_param * samec_bis - point;
+			samec_error += dot_s(ews, samec_dist * samec_dist);
+		}
+
+		// Add an estimate of error introduced by weight quantization imprecision
+		float tpp = static_cast<float>(texel_count);
+		vfloat4 error_weights = pm.error_weight * (tpp * weight_imprecision_estim);
+
+		float uncor_line_len = astc::max(uncor_hiparam - uncor_loparam, 1e-7f);
+		float samec_line_len = astc::max(samec_hiparam - samec_loparam, 1e-7f);
+
+		vfloat4 uncor_vector = uncor_b * uncor_line_len * pm.icolor_scale;
+		vfloat4 samec_vector = samec_b * samec_line_len * pm.icolor_scale;
+
+		uncor_error += dot_s(uncor_vector * uncor_vector, error_weights);
+		samec_error += dot_s(samec_vector * samec_vector, error_weights);
+
+		// The errors only grow, so stop once this partitioning cannot be selected
+		if (uncor_error >= uncor_limit && samec_error >= samec_limit)
+		{
+			break;
+		}
+	}
+}
+
 /* See header for documentation. */
 void find_best_partition_candidates(
 	const block_size_descriptor& bsd,
@@ -486,7 +650,9 @@ void find_best_partition_candidates(
 	unsigned int partition_count,
 	unsigned int partition_search_limit,
 	unsigned int& best_partition_uncor,
-	unsigned int& best_partition_samec
+	unsigned int& best_partition_samec,
+	float& best_partition_uncor_bound,
+	float& best_partition_samec_bound
 ) {
 	// Constant used to estimate quantization error for a given partitioning; the optimal value for
 	// this depends on bitrate. These values have been determined empirically.
@@ -518,13 +684,76 @@ void find_best_partition_candidates(
 	// Partitioning errors assuming uncorrelated-chrominance endpoints
 	float uncor_best_error { ERROR_CALC_DEFAULT };
 	unsigned int uncor_best_partition { 0 };
+	float uncor_best_bound { 0.0f };
 
 	// Partitioning errors assuming same-chrominance endpoints
 	// Store two so we can always return one different to uncorr
 	float samec_best_errors[2] { ERROR_CALC_DEFAULT, ERROR_CALC_DEFAULT };
 	unsigned int samec_best_partitions[2] { 0, 0 };
+	float samec_best_bounds[2] { 0.0f, 0.0f };
+
+	bool is_luminance = blk.is_ldr_luminance();
+	bool is_luminancealpha = blk.is_ldr_luminancealpha();
+
+	if (is_luminance || is_luminancealpha)
+	{
+		for (unsigned int i = 0; i < partition_search_limit; i++)
+		{
+			unsigned int partition = partition_sequence[i];
+			const auto& pi = bsd.get_partition_info(partition_count, partition);
+
+			unsigned int bk_partition_count = pi.partition_count;
+			if (bk_partition_count < partition_count)
+			{
+				break;
+			}
+
+			float uncor_error;
+			float samec_error;
+			if (is_luminance)
+			{
+				compute_partition_errors_luminance(
+				    pi, blk, ewb, weight_imprecision_estim,
+				    uncor_best_error, samec_best_errors[1],
+				    uncor_error, samec_error);
+			}
+			else
+			{
+				compute_partition_errors_luminance_alpha(
+				    pi, blk, ewb, weight_imprecision_estim,
+				    uncor_best_error, samec_best_errors[1],
+				    uncor_error, samec_error);
+			}
+
+			// The luminance estimates have no line fit error term, so give no bound
+			float line_error = 0.0f;
+
+			if (uncor_error < uncor_best_error)
+			{
+				uncor_best_error = uncor_error;
+				uncor_best_partition = partition;
+				uncor_best_bound = line_error;
+			}
+
+			if (samec_error < samec_best_errors[0])
+			{
+				samec_best_errors[1] = samec_best_errors[0];
+				samec_best_partitions[1] = samec_best_partitions[0];
+				samec_best_bounds[1] = samec_best_bounds[0];
 
-	if (uses_alpha)
+				samec_best_errors[0] = samec_error;
+				samec_best_partitions[0] = partition;
+				samec_best_bounds[0] = line_error;
+			}
+			else if (samec_error < samec_best_errors[1])
+			{
+				samec_best_errors[1] = samec_error;
+				samec_best_partitions[1] = partition;
+				samec_best_bounds[1] = line_error;
+			}
+		}
+	}
+	else if (uses_alpha)
 	{
 		for (unsigned int i = 0; i < partition_search_limit; i++)
 		{
@@ -580,9 +809,22 @@ void find_best_partition_candidates(
 			                           samec_plines,
 			                           uncor_line_lens,
 			                           samec_line_lens,
+			                           uncor_best_error,
+			                           samec_best_errors[1],
 			                           uncor_error,
 			                           samec_error);
 
+			// A partitioning with both errors at their limits cannot be selected, and its line
+			// lengths may be incomplete, so skip the weight imprecision estimate
+			if (uncor_error >= uncor_best_error && samec_error >= samec_best_errors[1])
+			{
+				continue;
+			}
+
+			// Texels that are not on the line are always in error, so the smaller of the two line
+			// fit errors estimates the lowest error an encoding of this partitioning can achieve
+			float line_error = astc::min(uncor_error, samec_error);
+
 			// Compute an estimate of error introduced by weight quantization imprecision.
 			// This error is computed as follows, for each partition
 			//     1: compute the principal-axis vector (full length) in error-space
@@ -615,20 +857,24 @@ void find_best_partition_candidates(
 			{
 				uncor_best_error = uncor_error;
 				uncor_best_partition = partition;
+				uncor_best_bound = line_error;
 			}
 
 			if (samec_error < samec_best_errors[0])
 			{
 				samec_best_errors[1] = samec_best_errors[0];
 				samec_best_partitions[1] = samec_best_partitions[0];
+				samec_best_bounds[1] = samec_best_bounds[0];
 
 				samec_best_errors[0] = samec_error;
 				samec_best_partitions[0] = partition;
+				samec_best_bounds[0] = line_error;
 			}
 			else if (samec_error < samec_best_errors[1])
 			{
 				samec_best_errors[1] = samec_error;
 				samec_best_partitions[1] = partition;
+				samec_best_bounds[1] = line_error;
 			}
 		}
 	}
@@ -678,9 +924,22 @@ void find_best_partition_candidates(
 			                          blk,
 			                          ewb,
 			                          plines,
+			                          uncor_best_error,
+			                          samec_best_errors[1],
 			                          uncor_error,
 			                          samec_error);
 
+			// A partitioning with both errors at their limits cannot be selected, and its line
+			// lengths may be incomplete, so skip the weight imprecision estimate
+			if (uncor_error >= uncor_best_error && samec_error >= samec_best_errors[1])
+			{
+				continue;
+			}
+
+			// Texels that are not on the line are always in error, so the smaller of the two line
+			// fit errors estimates the lowest error an encoding of this partitioning can achieve
+			float line_error = astc::min(uncor_error, samec_error);
+
 			// Compute an estimate of error introduced by weight quantization imprecision.
 			// This error is computed as follows, for each partition
 			//     1: compute the principal-axis vector (full length) in error-space
@@ -718,28 +977,34 @@ void find_best_partition_candidates(
 			{
 				uncor_best_error = uncor_error;
 				uncor_best_partition = partition;
+				uncor_best_bound = line_error;
 			}
 
 			if (samec_error < samec_best_errors[0])
 			{
 				samec_best_errors[1] = samec_best_errors[0];
 				samec_best_partitions[1] = samec_best_partitions[0];
+				samec_best_bounds[1] = samec_best_bounds[0];
 
 				samec_best_errors[0] = samec_error;
 				samec_best_partitions[0] = partition;
+				samec_best_bounds[0] = line_error;
 			}
 			else if (samec_error < samec_best_errors[1])
 			{
 				samec_best_errors[1] = samec_error;
 				samec_best_partitions[1] = partition;
+				samec_best_bounds[1] = line_error;
 			}
 		}
 	}
 
 	best_partition_uncor = uncor_best_partition;
+	best_partition_uncor_bound = uncor_best_bound;
 
 	unsigned int index = samec_best_partitions[0] != uncor_best_partition ? 0 : 1;
 	best_partition_samec = samec_best_partitions[index];
+	best_partition_samec_bound = samec_best_bounds[index];
 }
 
 #endif
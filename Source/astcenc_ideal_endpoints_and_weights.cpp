@@ -29,6 +29,8 @@
 /**
  * @brief Compute the ideal endpoints and weights for 1 color component.
  *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
  * @param      bsd         The block size information.
  * @param      blk         The image block color data to compress.
  * @param      ewb         The image block weighted error data.
@@ -36,6 +38,7 @@
  * @param[out] ei          The computed ideal endpoints and weights.
  * @param      component   The color component to compute.
  */
+template<unsigned int PARTITION_COUNT>
 static void compute_ideal_colors_and_weights_1_comp(
 	const block_size_descriptor& bsd,
 	const image_block& blk,
@@ -44,9 +47,8 @@ static void compute_ideal_colors_and_weights_1_comp(
 	endpoints_and_weights& ei,
 	unsigned int component
 ) {
-	int partition_count = pi.partition_count;
+	int partition_count = PARTITION_COUNT;
 	ei.ep.partition_count = partition_count;
-	promise(partition_count > 0);
 
 	int texel_count = bsd.texel_count;
 	promise(texel_count > 0);
@@ -86,7 +88,7 @@ static void compute_ideal_colors_and_weights_1_comp(
 		if (error_weights[i] > 1e-10f)
 		{
 			float value = data_vr[i];
-			int partition = pi.partition_of_texel[i];
+			int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 
 			lowvalues[partition] = astc::min(value, lowvalues[partition]);
 			highvalues[partition] = astc::max(value, highvalues[partition]);
@@ -114,12 +116,115 @@ static void compute_ideal_colors_and_weights_1_comp(
 	}
 
 	bool is_constant_wes = true;
-	float constant_wes = partition_error_scale[pi.partition_of_texel[0]] * error_weights[0];
+	float constant_wes = partition_error_scale[get_texel_partition<PARTITION_COUNT>(pi, 0)]
+	                   * error_weights[0];
 
 	for (int i = 0; i < texel_count; i++)
 	{
 		float value = data_vr[i];
-		int partition = pi.partition_of_texel[i];
+		int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
+		value -= lowvalues[partition];
+		value *= linelengths_rcp[partition];
+		value = astc::clamp1f(value);
+
+		ei.weights[i] = value;
+		ei.weight_error_scale[i] = partition_error_scale[partition] * error_weights[i];
+		assert(!astc::isnan(ei.weight_error_scale[i]));
+
+		is_constant_wes = is_constant_wes && ei.weight_error_scale[i] == constant_wes;
+	}
+
+	// Zero initialize any SIMD over-fetch
+	int texel_count_simd = round_up_to_simd_multiple_vla(texel_count);
+	for (int i = texel_count; i < texel_count_simd; i++)
+	{
+		ei.weights[i] = 0.0f;
+		ei.weight_error_scale[i] = 0.0f;
+	}
+
+	ei.is_constant_weight_error_scale = is_constant_wes;
+}
+
+/**
+ * @brief Compute the ideal endpoints and weights for a luminance block.
+ *
+ * This is a specialized 1 component variant for grayscale blocks, used for the whole block if alpha
+ * is constant 1.0, or for the color plane of a dual plane luminance-alpha encoding. The red channel
+ * is used as the luminance value, and the error weight is the sum of the RGB weights as any
+ * luminance error is replicated into all three color channels. Alpha endpoints are left at the
+ * block alpha range.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
+ * @param      bsd   The block size information.
+ * @param      blk   The image block color data to compress.
+ * @param      ewb   The image block weighted error data.
+ * @param      pi    The partition info for the current trial.
+ * @param[out] ei    The computed ideal endpoints and weights.
+ */
+template<unsigned int PARTITION_COUNT>
+static void compute_ideal_colors_and_weights_luminance(
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	const partition_info& pi,
+	endpoints_and_weights& ei
+) {
+	int partition_count = PARTITION_COUNT;
+	ei.ep.partition_count = partition_count;
+
+	int texel_count = bsd.texel_count;
+	promise(texel_count > 0);
+
+	float lowvalues[BLOCK_MAX_PARTITIONS] { 1e10f, 1e10f, 1e10f, 1e10f };
+	float highvalues[BLOCK_MAX_PARTITIONS] { -1e10f, -1e10f, -1e10f, -1e10f };
+
+	float partition_error_scale[BLOCK_MAX_PARTITIONS];
+	float linelengths_rcp[BLOCK_MAX_PARTITIONS];
+
+	const float* error_weights = ewb.texel_weight_rgb;
+	const float* data_vr = blk.data_r;
+
+	for (int i = 0; i < texel_count; i++)
+	{
+		if (error_weights[i] > 1e-10f)
+		{
+			float value = data_vr[i];
+			int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
+
+			lowvalues[partition] = astc::min(value, lowvalues[partition]);
+			highvalues[partition] = astc::max(value, highvalues[partition]);
+		}
+	}
+
+	vmask4 lum_mask = vint4::lane_id() < vint4(3);
+	for (int i = 0; i < partition_count; i++)
+	{
+		float diff = highvalues[i] - lowvalues[i];
+
+		if (diff < 0)
+		{
+			lowvalues[i] = 0.0f;
+			highvalues[i] = 0.0f;
+		}
+
+		diff = astc::max(diff, 1e-7f);
+
+		partition_error_scale[i] = diff * diff * 3.0f;
+		linelengths_rcp[i] = 1.0f / diff;
+
+		ei.ep.endpt0[i] = select(blk.data_min, vfloat4(lowvalues[i]), lum_mask);
+		ei.ep.endpt1[i] = select(blk.data_max, vfloat4(highvalues[i]), lum_mask);
+	}
+
+	bool is_constant_wes = true;
+	float constant_wes = partition_error_scale[get_texel_partition<PARTITION_COUNT>(pi, 0)]
+	                   * error_weights[0];
+
+	for (int i = 0; i < texel_count; i++)
+	{
+		float value = data_vr[i];
+		int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 		value -= lowvalues[partition];
 		value *= linelengths_rcp[partition];
 		value = astc::clamp1f(value);
@@ -145,6 +250,11 @@ static void compute_ideal_colors_and_weights_1_comp(
 /**
  * @brief Compute the ideal endpoints and weights for 2 color components.
  *
+ * The component pair (0, 3) is treated as luminance-alpha, with the luminance endpoint value
+ * replicated into all three RGB channels.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
  * @param      bsd          The block size information.
  * @param      blk          The image block color data to compress.
  * @param      ewb          The image block weighted error data.
@@ -153,6 +263,7 @@ static void compute_ideal_colors_and_weights_1_comp(
  * @param      component1   The first color component to compute.
  * @param      component2   The second color component to compute.
  */
+template<unsigned int PARTITION_COUNT>
 static void compute_ideal_colors_and_weights_2_comp(
 	const block_size_descriptor& bsd,
 	const image_block& blk,
@@ -162,9 +273,8 @@ static void compute_ideal_colors_and_weights_2_comp(
 	int component1,
 	int component2
 ) {
-	int partition_count = pi.partition_count;
+	int partition_count = PARTITION_COUNT;
 	ei.ep.partition_count = partition_count;
-	promise(partition_count > 0);
 
 	int texel_count = bsd.texel_count;
 	promise(texel_count > 0);
@@ -174,7 +284,14 @@ static void compute_ideal_colors_and_weights_2_comp(
 	const float *error_weights;
 	const float* data_vr = nullptr;
 	const float* data_vg = nullptr;
-	if (component1 == 0 && component2 == 1)
+	if (component1 == 0 && component2 == 3)
+	{
+		// Luminance-alpha, using red as the luminance channel
+		error_weights = ewb.texel_weight;
+		data_vr = blk.data_r;
+		data_vg = blk.data_a;
+	}
+	else if (component1 == 0 && component2 == 1)
 	{
 		error_weights = ewb.texel_weight_rg;
 		data_vr = blk.data_r;
@@ -218,7 +335,7 @@ static void compute_ideal_colors_and_weights_2_comp(
 	{
 		if (error_weights[i] > 1e-10f)
 		{
-			int partition = pi.partition_of_texel[i];
+			int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 			vfloat4 point = vfloat2(data_vr[i], data_vg[i]) * pms[partition].color_scale.swz<0, 1>();
 			line2 l = lines[partition];
 			float param = dot_s(point - l.a, l.b);
@@ -264,6 +381,12 @@ static void compute_ideal_colors_and_weights_2_comp(
 
 	vmask4 comp1_mask = vint4::lane_id() == vint4(component1);
 	vmask4 comp2_mask = vint4::lane_id() == vint4(component2);
+
+	// Luminance is replicated into all three RGB channels
+	if (component1 == 0 && component2 == 3)
+	{
+		comp1_mask = vint4::lane_id() < vint4(3);
+	}
 	for (int i = 0; i < partition_count; i++)
 	{
 		vfloat4 ep0 = select(blk.data_min, vfloat4(lowvalues[i].lane<0>()), comp1_mask);
@@ -274,11 +397,12 @@ static void compute_ideal_colors_and_weights_2_comp(
 	}
 
 	bool is_constant_wes = true;
-	float constant_wes = length_squared[pi.partition_of_texel[0]] * error_weights[0];
+	float constant_wes = length_squared[get_texel_partition<PARTITION_COUNT>(pi, 0)]
+	                   * error_weights[0];
 
 	for (int i = 0; i < texel_count; i++)
 	{
-		int partition = pi.partition_of_texel[i];
+		int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 		float idx = (ei.weights[i] - lowparam[partition]) * scale[partition];
 		idx = astc::clamp1f(idx);
 
@@ -303,6 +427,8 @@ static void compute_ideal_colors_and_weights_2_comp(
 /**
  * @brief Compute the ideal endpoints and weights for 3 color components.
  *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
  * @param      bsd                 The block size information.
  * @param      blk                 The image block color data to compress.
  * @param      ewb                 The image block weighted error data.
@@ -310,6 +436,7 @@ static void compute_ideal_colors_and_weights_2_comp(
  * @param[out] ei                  The computed ideal endpoints and weights.
  * @param      omitted_component   The color component excluded from the calculation.
  */
+template<unsigned int PARTITION_COUNT>
 static void compute_ideal_colors_and_weights_3_comp(
 	const block_size_descriptor& bsd,
 	const image_block& blk,
@@ -318,9 +445,8 @@ static void compute_ideal_colors_and_weights_3_comp(
 	endpoints_and_weights& ei,
 	unsigned int omitted_component
 ) {
-	unsigned int partition_count = pi.partition_count;
+	unsigned int partition_count = PARTITION_COUNT;
 	ei.ep.partition_count = partition_count;
-	promise(partition_count > 0);
 
 	unsigned int texel_count = bsd.texel_count;
 	promise(texel_count > 0);
@@ -385,7 +511,7 @@ static void compute_ideal_colors_and_weights_3_comp(
 	{
 		if (error_weights[i] > 1e-10f)
 		{
-			int partition = pi.partition_of_texel[i];
+			int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 			vfloat4 point = vfloat3(data_vr[i], data_vg[i], data_vb[i]) * pms[partition].color_scale;
 			line3 l = lines[partition];
 			float param = dot3_s(point - l.a, l.b);
@@ -449,11 +575,12 @@ static void compute_ideal_colors_and_weights_3_comp(
 
 
 	bool is_constant_wes = true;
-	float constant_wes = length_squared[pi.partition_of_texel[0]] * error_weights[0];
+	float constant_wes = length_squared[get_texel_partition<PARTITION_COUNT>(pi, 0)]
+	                   * error_weights[0];
 
 	for (unsigned int i = 0; i < texel_count; i++)
 	{
-		int partition = pi.partition_of_texel[i];
+		int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 		float idx = (ei.weights[i] - lowparam[partition]) * scale[partition];
 		idx = astc::clamp1f(idx);
 
@@ -478,12 +605,15 @@ static void compute_ideal_colors_and_weights_3_comp(
 /**
  * @brief Compute the ideal endpoints and weights for 4 color components.
  *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
  * @param      bsd                 The block size information.
  * @param      blk                 The image block color data to compress.
  * @param      ewb                 The image block weighted error data.
  * @param      pi                  The partition info for the current trial.
  * @param[out] ei                  The computed ideal endpoints and weights.
  */
+template<unsigned int PARTITION_COUNT>
 static void compute_ideal_colors_and_weights_4_comp(
 	const block_size_descriptor& bsd,
 	const image_block& blk,
@@ -493,11 +623,10 @@ static void compute_ideal_colors_and_weights_4_comp(
 ) {
 	const float *error_weights = ewb.texel_weight;
 
-	int partition_count = pi.partition_count;
+	int partition_count = PARTITION_COUNT;
 
 	int texel_count= bsd.texel_count;
 	promise(texel_count > 0);
-	promise(partition_count > 0);
 
 	float lowparam[BLOCK_MAX_PARTITIONS] { 1e10f, 1e10f, 1e10f, 1e10f };
 	float highparam[BLOCK_MAX_PARTITIONS] { -1e10f, -1e10f, -1e10f, -1e10f };
@@ -528,7 +657,7 @@ static void compute_ideal_colors_and_weights_4_comp(
 	{
 		if (error_weights[i] > 1e-10f)
 		{
-			int partition = pi.partition_of_texel[i];
+			int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 
 			vfloat4 point = blk.texel(i) * pms[partition].color_scale;
 			line4 l = lines[partition];
@@ -569,11 +698,12 @@ static void compute_ideal_colors_and_weights_4_comp(
 	}
 
 	bool is_constant_wes = true;
-	float constant_wes = length_squared[pi.partition_of_texel[0]] * error_weights[0];
+	float constant_wes = length_squared[get_texel_partition<PARTITION_COUNT>(pi, 0)]
+	                   * error_weights[0];
 
 	for (int i = 0; i < texel_count; i++)
 	{
-		int partition = pi.partition_of_texel[i];
+		int partition = get_texel_partition<PARTITION_COUNT>(pi, i);
 		float idx = (ei.weights[i] - lowparam[partition]) * scale[partition];
 		idx = astc::clamp1f(idx);
 
@@ -595,8 +725,19 @@ static void compute_ideal_colors_and_weights_4_comp(
 	ei.is_constant_weight_error_scale = is_constant_wes;
 }
 
-/* See header for documentation. */
-void compute_ideal_colors_and_weights_1plane(
+/**
+ * @brief Compute the ideal endpoints and weights for a 1 plane trial with a known partition count.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
+ * @param      bsd   The block size information.
+ * @param      blk   The image block color data to compress.
+ * @param      ewb   The image block weighted error data.
+ * @param      pi    The partition info for the current trial.
+ * @param[out] ei    The computed ideal endpoints and weights.
+ */
+template<unsigned int PARTITION_COUNT>
+static void compute_ideal_colors_and_weights_1plane_partitions(
 	const block_size_descriptor& bsd,
 	const image_block& blk,
 	const error_weight_block& ewb,
@@ -605,13 +746,48 @@ void compute_ideal_colors_and_weights_1plane(
 ) {
 	bool uses_alpha = !blk.is_constant_channel(3);
 
-	if (uses_alpha)
+	if (blk.is_ldr_luminance())
 	{
-		compute_ideal_colors_and_weights_4_comp(bsd, blk, ewb, pi, ei);
+		compute_ideal_colors_and_weights_luminance<PARTITION_COUNT>(bsd, blk, ewb, pi, ei);
+	}
+	else if (blk.is_ldr_luminancealpha())
+	{
+		compute_ideal_colors_and_weights_2_comp<PARTITION_COUNT>(bsd, blk, ewb, pi, ei, 0, 3);
+	}
+	else if (uses_alpha)
+	{
+		compute_ideal_colors_and_weights_4_comp<PARTITION_COUNT>(bsd, blk, ewb, pi, ei);
 	}
 	else
 	{
-		compute_ideal_colors_and_weights_3_comp(bsd, blk, ewb,  pi, ei, 3);
+		compute_ideal_colors_and_weights_3_comp<PARTITION_COUNT>(bsd, blk, ewb, pi, ei, 3);
+	}
+}
+
+/* See header for documentation. */
+void compute_ideal_colors_and_weights_1plane(
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	const partition_info& pi,
+	endpoints_and_weights& ei
+) {
+	// Dispatch once per trial to kernels specialized for the partition count
+	switch (pi.partition_count)
+	{
+	case 1:
+		compute_ideal_colors_and_weights_1plane_partitions<1>(bsd, blk, ewb, pi, ei);
+		break;
+	case 2:
+		compute_ideal_colors_and_weights_1plane_partitions<2>(bsd, blk, ewb, pi, ei);
+		break;
+	case 3:
+		compute_ideal_colors_and_weights_1plane_partitions<3>(bsd, blk, ewb, pi, ei);
+		break;
+	default:
+		assert(pi.partition_count == 4);
+		compute_ideal_colors_and_weights_1plane_partitions<4>(bsd, blk, ewb, pi, ei);
+		break;
 	}
 }
 
@@ -633,97 +809,140 @@ void compute_ideal_colors_and_weights_2planes(
 	case 0: // Separate weights for red
 		if (uses_alpha)
 		{
-			compute_ideal_colors_and_weights_3_comp(bsd, blk, ewb, pi, ei1, 0);
+			compute_ideal_colors_and_weights_3_comp<1>(bsd, blk, ewb, pi, ei1, 0);
 		}
 		else
 		{
-			compute_ideal_colors_and_weights_2_comp(bsd, blk, ewb, pi, ei1, 1, 2);
+			compute_ideal_colors_and_weights_2_comp<1>(bsd, blk, ewb, pi, ei1, 1, 2);
 		}
-		compute_ideal_colors_and_weights_1_comp(bsd, blk, ewb, pi, ei2, 0);
+		compute_ideal_colors_and_weights_1_comp<1>(bsd, blk, ewb, pi, ei2, 0);
 		break;
 
 	case 1: // Separate weights for green
 		if (uses_alpha)
 		{
-			compute_ideal_colors_and_weights_3_comp(bsd,blk, ewb,  pi, ei1, 1);
+			compute_ideal_colors_and_weights_3_comp<1>(bsd,blk, ewb,  pi, ei1, 1);
 		}
 		else
 		{
-			compute_ideal_colors_and_weights_2_comp(bsd, blk, ewb, pi, ei1, 0, 2);
+			compute_ideal_colors_and_weights_2_comp<1>(bsd, blk, ewb, pi, ei1, 0, 2);
 		}
-		compute_ideal_colors_and_weights_1_comp(bsd, blk, ewb, pi, ei2, 1);
+		compute_ideal_colors_and_weights_1_comp<1>(bsd, blk, ewb, pi, ei2, 1);
 		break;
 
 	case 2: // Separate weights for blue
 		if (uses_alpha)
 		{
-			compute_ideal_colors_and_weights_3_comp(bsd, blk, ewb, pi, ei1, 2);
+			compute_ideal_colors_and_weights_3_comp<1>(bsd, blk, ewb, pi, ei1, 2);
 		}
 		else
 		{
-			compute_ideal_colors_and_weights_2_comp(bsd, blk, ewb, pi, ei1, 0, 1);
+			compute_ideal_colors_and_weights_2_comp<1>(bsd, blk, ewb, pi, ei1, 0, 1);
 		}
-		compute_ideal_colors_and_weights_1_comp(bsd, blk, ewb, pi, ei2, 2);
+		compute_ideal_colors_and_weights_1_comp<1>(bsd, blk, ewb, pi, ei2, 2);
 		break;
 
 	default: // Separate weights for alpha
 		assert(uses_alpha);
-		compute_ideal_colors_and_weights_3_comp(bsd, blk, ewb, pi, ei1, 3);
-		compute_ideal_colors_and_weights_1_comp(bsd, blk, ewb, pi, ei2, 3);
+		if (blk.is_ldr_luminancealpha())
+		{
+			compute_ideal_colors_and_weights_luminance<1>(bsd, blk, ewb, pi, ei1);
+		}
+		else
+		{
+			compute_ideal_colors_and_weights_3_comp<1>(bsd, blk, ewb, pi, ei1, 3);
+		}
+		compute_ideal_colors_and_weights_1_comp<1>(bsd, blk, ewb, pi, ei2, 3);
 		break;
 	}
 }
 
 /* See header for documentation. */
-float compute_error_of_weight_set_1plane(
+void compute_error_of_weight_sets_1plane(
 	const endpoints_and_weights& eai,
 	const decimation_info& di,
-	const float* dec_weight_quant_uvalue
+	unsigned int weight_set_count,
+	const float* const* dec_weight_quant_uvalues,
+	float* errors
 ) {
-	vfloat4 error_summav = vfloat4::zero();
-	float error_summa = 0.0f;
-	unsigned int texel_count = di.texel_count;
+	assert(weight_set_count <= WEIGHTS_QUANT_LEVELS);
+	promise(weight_set_count > 0);
+
+	vfloat4 error_summav[WEIGHTS_QUANT_LEVELS];
+	for (unsigned int j = 0; j < weight_set_count; j++)
+	{
+		error_summav[j] = vfloat4::zero();
+	}
 
+	unsigned int texel_count = di.texel_count;
 	bool is_decimated = di.texel_count != di.weight_count;
 
-	// Process SIMD-width chunks, safe to over-fetch - the extra space is zero initialized
+	// Process SIMD-width chunks, safe to over-fetch - the extra space is zero initialized. The
+	// decimation tables and ideal weights are loaded once per chunk and shared by all weight sets.
 	if (is_decimated)
 	{
 		for (unsigned int i = 0; i < texel_count; i += ASTCENC_SIMD_WIDTH)
 		{
-			// Compute the bilinear interpolation of the decimated weight grid
-			vfloat current_values = bilinear_infill_vla(di, dec_weight_quant_uvalue, i);
+			// Load the bilinear filter texel weight indexes in the decimated grid
+			vint weight_idx0 = vint(di.texel_weights_4t[0] + i);
+			vint weight_idx1 = vint(di.texel_weights_4t[1] + i);
+			vint weight_idx2 = vint(di.texel_weights_4t[2] + i);
+			vint weight_idx3 = vint(di.texel_weights_4t[3] + i);
+
+			// Load the weight contribution factors for each decimated weight
+			vfloat tex_weight_float0 = loada(di.texel_weights_float_4t[0] + i);
+			vfloat tex_weight_float1 = loada(di.texel_weights_float_4t[1] + i);
+			vfloat tex_weight_float2 = loada(di.texel_weights_float_4t[2] + i);
+			vfloat tex_weight_float3 = loada(di.texel_weights_float_4t[3] + i);
 
-			// Compute the error between the computed value and the ideal weight
 			vfloat actual_values = loada(eai.weights + i);
-			vfloat diff = current_values - actual_values;
 			vfloat significance = loada(eai.weight_error_scale + i);
-			vfloat error = diff * diff * significance;
 
-			haccumulate(error_summav, error);
+			for (unsigned int j = 0; j < weight_set_count; j++)
+			{
+				// Compute the bilinear interpolation of the decimated weight grid
+				const float* weights = dec_weight_quant_uvalues[j];
+				vfloat current_values = (gatherf(weights, weight_idx0) * tex_weight_float0 +
+				                         gatherf(weights, weight_idx1) * tex_weight_float1) +
+				                        (gatherf(weights, weight_idx2) * tex_weight_float2 +
+				                         gatherf(weights, weight_idx3) * tex_weight_float3);
+
+				// Compute the error between the computed value and the ideal weight
+				vfloat diff = current_values - actual_values;
+				vfloat error = diff * diff * significance;
+
+				haccumulate(error_summav[j], error);
+			}
 		}
 	}
 	else
 	{
 		for (unsigned int i = 0; i < texel_count; i += ASTCENC_SIMD_WIDTH)
 		{
-			// Load the weight set directly, without interpolation
-			vfloat current_values = loada(dec_weight_quant_uvalue + i);
-
-			// Compute the error between the computed value and the ideal weight
 			vfloat actual_values = loada(eai.weights + i);
-			vfloat diff = current_values - actual_values;
 			vfloat significance = loada(eai.weight_error_scale + i);
-			vfloat error = diff * diff * significance;
 
-			haccumulate(error_summav, error);
+			for (unsigned int j = 0; j < weight_set_count; j++)
+			{
+				// Load the weight set directly, without interpolation
+				vfloat current_values = loada(dec_weight_quant_uvalues[j] + i);
+
+				// Compute the error between the computed value and the ideal weight
+				vfloat diff = current_values - actual_values;
+				vfloat error = diff * diff * significance;
+
+				haccumulate(error_summav[j], error);
+			}
 		}
 	}
 
-	// Resolve the final scalar accumulator sum
-	haccumulate(error_summa, error_summav);
-
-	return error_summa;
+	// Resolve the final scalar accumulator sums
+	for (unsigned int j = 0; j < weight_set_count; j++)
+	{
+		float error_summa = 0.0f;
+		haccumulate(error_summa, error_summav[j]);
+		errors[j] = error_summa;
+	}
 }
 
 /* See header for documentation. */
@@ -1097,8 +1316,15 @@ static inline vfloat4 compute_rgbo_vector(
 	               dot_s(mat3, vect));
 }
 
-/* See header for documentation. */
-void recompute_ideal_colors_1plane(
+/**
+ * @brief Recompute the endpoint colors for a 1 plane weight set with a known partition count.
+ *
+ * @tparam PARTITION_COUNT   The number of partitions in @c pi.
+ *
+ * See @c recompute_ideal_colors_1plane() for the parameter documentation.
+ */
+template<unsigned int PARTITION_COUNT>
+static void recompute_ideal_colors_1plane_partitions(
 	const image_block& blk,
 	const error_weight_block& ewb,
 	const partition_info& pi,
@@ -1110,11 +1336,9 @@ void recompute_ideal_colors_1plane(
 	vfloat4 rgbo_vectors[BLOCK_MAX_PARTITIONS]
 ) {
 	int weight_count = di.weight_count;
-	int partition_count = pi.partition_count;
 	bool is_decimated = di.weight_count != di.texel_count;
 
 	promise(weight_count > 0);
-	promise(partition_count > 0);
 
 	const quantization_and_transfer_table& qat = quant_and_xfer_tables[weight_quant_mode];
 
@@ -1124,18 +1348,17 @@ void recompute_ideal_colors_1plane(
 		dec_weight_quant_uvalue[i] = qat.unquantized_value[dec_weights_quant_pvalue[i]] * (1.0f / 64.0f);
 	}
 
-	for (int i = 0; i < partition_count; i++)
+	for (unsigned int i = 0; i < PARTITION_COUNT; i++)
 	{
 		vfloat4 rgba_sum(1e-17f);
 		vfloat4 rgba_weight_sum(1e-17f);
 
 		unsigned int texel_count = pi.partition_texel_count[i];
-		const uint8_t *texel_indexes = pi.texels_of_partition[i];
 
 		promise(texel_count > 0);
 		for (unsigned int j = 0; j < texel_count; j++)
 		{
-			unsigned int tix = texel_indexes[j];
+			unsigned int tix = get_partition_texel<PARTITION_COUNT>(pi, i, j);
 
 			vfloat4 rgba = blk.texel(tix);
 			vfloat4 error_weight = ewb.error_weights[tix];
@@ -1167,7 +1390,7 @@ void recompute_ideal_colors_1plane(
 
 		for (unsigned int j = 0; j < texel_count; j++)
 		{
-			unsigned int tix = texel_indexes[j];
+			unsigned int tix = get_partition_texel<PARTITION_COUNT>(pi, i, j);
 
 			vfloat4 rgba = blk.texel(tix);
 			vfloat4 color_weight = ewb.error_weights[tix];
@@ -1309,6 +1532,44 @@ void recompute_ideal_colors_1plane(
 	}
 }
 
+/* See header for documentation. */
+void recompute_ideal_colors_1plane(
+	const image_block& blk,
+	const error_weight_block& ewb,
+	const partition_info& pi,
+	const decimation_info& di,
+	int weight_quant_mode,
+	const uint8_t* dec_weights_quant_pvalue,
+	endpoints& ep,
+	vfloat4 rgbs_vectors[BLOCK_MAX_PARTITIONS],
+	vfloat4 rgbo_vectors[BLOCK_MAX_PARTITIONS]
+) {
+	switch (pi.partition_count)
+	{
+	case 1:
+		recompute_ideal_colors_1plane_partitions<1>(blk, ewb, pi, di, weight_quant_mode,
+		                                            dec_weights_quant_pvalue, ep,
+		                                            rgbs_vectors, rgbo_vectors);
+		break;
+	case 2:
+		recompute_ideal_colors_1plane_partitions<2>(blk, ewb, pi, di, weight_quant_mode,
+		                                            dec_weights_quant_pvalue, ep,
+		                                            rgbs_vectors, rgbo_vectors);
+		break;
+	case 3:
+		recompute_ideal_colors_1plane_partitions<3>(blk, ewb, pi, di, weight_quant_mode,
+		                                            dec_weights_quant_pvalue, ep,
+		                                            rgbs_vectors, rgbo_vectors);
+		break;
+	default:
+		assert(pi.partition_count == 4);
+		recompute_ideal_colors_1plane_partitions<4>(blk, ewb, pi, di, weight_quant_mode,
+		                                            dec_weights_quant_pvalue, ep,
+		                                            rgbs_vectors, rgbo_vectors);
+		break;
+	}
+}
+
 /* See header for documentation. */
 void recompute_ideal_colors_2planes(
 	const image_block& blk,
@@ -263,6 +263,43 @@ void fetch_image_block(
 	blk.grayscale = grayscale;
 }
 
+/**
+ * @brief Apply a non-identity output swizzle to a decoded texel.
+ *
+ * @param color     The decoded texel color.
+ * @param swz       The swizzle to apply on store.
+ * @param needs_z   True if any swizzle uses Z reconstruct.
+ *
+ * @return The swizzled texel color.
+ */
+static vfloat4 swizzle_output_texel(
+	vfloat4 color,
+	const astcenc_swizzle& swz,
+	bool needs_z
+) {
+	float data[7];
+	data[ASTCENC_SWZ_0] = 0.0f;
+	data[ASTCENC_SWZ_1] = 1.0f;
+	data[ASTCENC_SWZ_R] = color.lane<0>();
+	data[ASTCENC_SWZ_G] = color.lane<1>();
+	data[ASTCENC_SWZ_B] = color.lane<2>();
+	data[ASTCENC_SWZ_A] = color.lane<3>();
+
+	if (needs_z)
+	{
+		float xN = (data[0] * 2.0f) - 1.0f;
+		float yN = (data[3] * 2.0f) - 1.0f;
+		float zN = 1.0f - xN * xN - yN * yN;
+		if (zN < 0.0f)
+		{
+			zN = 0.0f;
+		}
+		data[ASTCENC_SWZ_Z] = (astc::sqrt(zN) * 0.5f) + 0.5f;
+	}
+
+	return vfloat4(data[swz.r], data[swz.g], data[swz.b], data[swz.a]);
+}
+
 /* See header for documentation. */
 void write_image_block(
 	astcenc_image& img,
@@ -288,10 +325,6 @@ void write_image_block(
 	unsigned int z_start = zpos;
 	unsigned int z_end = std::min(zsize, zpos + bsd.zdim);
 
-	float data[7];
-	data[ASTCENC_SWZ_0] = 0.0f;
-	data[ASTCENC_SWZ_1] = 1.0f;
-
 	// True if any non-identity swizzle
 	bool needs_swz = (swz.r != ASTCENC_SWZ_R) || (swz.g != ASTCENC_SWZ_G) ||
 	                 (swz.b != ASTCENC_SWZ_B) || (swz.a != ASTCENC_SWZ_A);
@@ -321,24 +354,7 @@ void write_image_block(
 					}
 					else if (needs_swz)
 					{
-						data[ASTCENC_SWZ_R] = blk.data_r[idx];
-						data[ASTCENC_SWZ_G] = blk.data_g[idx];
-						data[ASTCENC_SWZ_B] = blk.data_b[idx];
-						data[ASTCENC_SWZ_A] = blk.data_a[idx];
-
-						if (needs_z)
-						{
-							float xcoord = (data[0] * 2.0f) - 1.0f;
-							float ycoord = (data[3] * 2.0f) - 1.0f;
-							float zcoord = 1.0f - xcoord * xcoord - ycoord * ycoord;
-							if (zcoord < 0.0f)
-							{
-								zcoord = 0.0f;
-							}
-							data[ASTCENC_SWZ_Z] = (astc::sqrt(zcoord) * 0.5f) + 0.5f;
-						}
-
-						vfloat4 color = vfloat4(data[swz.r], data[swz.g], data[swz.b], data[swz.a]);
+						vfloat4 color = swizzle_output_texel(blk.texel(idx), swz, needs_z);
 						colori = float_to_int_rtn(min(color, 1.0f) * 255.0f);
 					}
 					else
@@ -376,24 +392,7 @@ void write_image_block(
 					}
 					else if (needs_swz)
 					{
-						data[ASTCENC_SWZ_R] = blk.data_r[idx];
-						data[ASTCENC_SWZ_G] = blk.data_g[idx];
-						data[ASTCENC_SWZ_B] = blk.data_b[idx];
-						data[ASTCENC_SWZ_A] = blk.data_a[idx];
-
-						if (needs_z)
-						{
-							float xN = (data[0] * 2.0f) - 1.0f;
-							float yN = (data[3] * 2.0f) - 1.0f;
-							float zN = 1.0f - xN * xN - yN * yN;
-							if (zN < 0.0f)
-							{
-								zN = 0.0f;
-							}
-							data[ASTCENC_SWZ_Z] = (astc::sqrt(zN) * 0.5f) + 0.5f;
-						}
-
-						vfloat4 colorf(data[swz.r], data[swz.g], data[swz.b], data[swz.a]);
+						vfloat4 colorf = swizzle_output_texel(blk.texel(idx), swz, needs_z);
 						color = float_to_float16(colorf);
 					}
 					else
@@ -435,24 +434,7 @@ void write_image_block(
 					}
 					else if (needs_swz)
 					{
-						data[ASTCENC_SWZ_R] = color.lane<0>();
-						data[ASTCENC_SWZ_G] = color.lane<1>();
-						data[ASTCENC_SWZ_B] = color.lane<2>();
-						data[ASTCENC_SWZ_A] = color.lane<3>();
-
-						if (needs_z)
-						{
-							float xN = (data[0] * 2.0f) - 1.0f;
-							float yN = (data[3] * 2.0f) - 1.0f;
-							float zN = 1.0f - xN * xN - yN * yN;
-							if (zN < 0.0f)
-							{
-								zN = 0.0f;
-							}
-							data[ASTCENC_SWZ_Z] = (astc::sqrt(zN) * 0.5f) + 0.5f;
-						}
-
-						color = vfloat4(data[swz.r], data[swz.g], data[swz.b], data[swz.a]);
+						color = swizzle_output_texel(color, swz, needs_z);
 					}
 
 					store(color, data32 + (4 * xsize * y) + (4 * x    ));
@@ -465,3 +447,156 @@ void write_image_block(
 		}
 	}
 }
+
+/* See header for documentation. */
+void fill_image_block(
+	astcenc_image& img,
+	vfloat4 color,
+	const block_size_descriptor& bsd,
+	unsigned int xpos,
+	unsigned int ypos,
+	unsigned int zpos,
+	const astcenc_swizzle& swz
+) {
+	unsigned int xsize = img.dim_x;
+
+	unsigned int x_end = std::min(img.dim_x, xpos + bsd.xdim);
+	unsigned int y_end = std::min(img.dim_y, ypos + bsd.ydim);
+	unsigned int z_end = std::min(img.dim_z, zpos + bsd.zdim);
+
+	// Convert the color once, matching the per-texel conversion in write_image_block()
+	bool needs_swz = (swz.r != ASTCENC_SWZ_R) || (swz.g != ASTCENC_SWZ_G) ||
+	                 (swz.b != ASTCENC_SWZ_B) || (swz.a != ASTCENC_SWZ_A);
+
+	bool needs_z = (swz.r == ASTCENC_SWZ_Z) || (swz.g == ASTCENC_SWZ_Z) ||
+	               (swz.b == ASTCENC_SWZ_Z) || (swz.a == ASTCENC_SWZ_Z);
+
+	if (needs_swz)
+	{
+		color = swizzle_output_texel(color, swz, needs_z);
+	}
+
+	if (img.data_type == ASTCENC_TYPE_U8)
+	{
+		vint4 colori = pack_low_bytes(float_to_int_rtn(min(color, 1.0f) * 255.0f));
+
+		for (unsigned int z = zpos; z < z_end; z++)
+		{
+			uint8_t* data8 = static_cast<uint8_t*>(img.data[z]);
+			for (unsigned int y = ypos; y < y_end; y++)
+			{
+				for (unsigned int x = xpos; x < x_end; x++)
+				{
+					store_nbytes(colori, data8 + (4 * xsize * y) + (4 * x));
+				}
+			}
+		}
+	}
+	else if (img.data_type == ASTCENC_TYPE_F16)
+	{
+		vint4 colori = float_to_float16(color);
+		uint16_t texel[4] {
+			static_cast<uint16_t>(colori.lane<0>()),
+			static_cast<uint16_t>(colori.lane<1>()),
+			static_cast<uint16_t>(colori.lane<2>()),
+			static_cast<uint16_t>(colori.lane<3>())
+		};
+
+		for (unsigned int z = zpos; z < z_end; z++)
+		{
+			uint16_t* data16 = static_cast<uint16_t*>(img.data[z]);
+			for (unsigned int y = ypos; y < y_end; y++)
+			{
+				for (unsigned int x = xpos; x < x_end; x++)
+				{
+					std::memcpy(data16 + (4 * xsize * y) + (4 * x), texel, sizeof(texel));
+				}
+			}
+		}
+	}
+	else // if (img.data_type == ASTCENC_TYPE_F32)
+	{
+		assert(img.data_type == ASTCENC_TYPE_F32);
+
+		for (unsigned int z = zpos; z < z_end; z++)
+		{
+			float* data32 = static_cast<float*>(img.data[z]);
+			for (unsigned int y = ypos; y < y_end; y++)
+			{
+				for (unsigned int x = xpos; x < x_end; x++)
+				{
+					store(color, data32 + (4 * xsize * y) + (4 * x));
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Get the size of a texel in an image, in bytes.
+ *
+ * @param img   The image.
+ *
+ * @return The texel size.
+ */
+static size_t get_texel_size(
+	const astcenc_image& img
+) {
+	switch (img.data_type)
+	{
+	case ASTCENC_TYPE_U8:
+		return 4;
+	case ASTCENC_TYPE_F16:
+		return 8;
+	default:
+		return 16;
+	}
+}
+
+/* See header for documentation. */
+void save_image_block_texels(
+	const astcenc_image& img,
+	const block_size_descriptor& bsd,
+	unsigned int xpos,
+	unsigned int ypos,
+	unsigned int zpos,
+	uint8_t* texels
+) {
+	size_t texel_size = get_texel_size(img);
+	size_t row_size = bsd.xdim * texel_size;
+	size_t row_stride = img.dim_x * texel_size;
+
+	for (unsigned int z = 0; z < bsd.zdim; z++)
+	{
+		const uint8_t* plane = static_cast<const uint8_t*>(img.data[zpos + z]);
+		for (unsigned int y = 0; y < bsd.ydim; y++)
+		{
+			std::memcpy(texels, plane + (ypos + y) * row_stride + xpos * texel_size, row_size);
+			texels += row_size;
+		}
+	}
+}
+
+/* See header for documentation. */
+void restore_image_block_texels(
+	astcenc_image& img,
+	const block_size_descriptor& bsd,
+	unsigned int xpos,
+	unsigned int ypos,
+	unsigned int zpos,
+	const uint8_t* texels
+) {
+	size_t texel_size = get_texel_size(img);
+	size_t row_size = bsd.xdim * texel_size;
+	size_t row_stride = img.dim_x * texel_size;
+
+	for (unsigned int z = 0; z < bsd.zdim; z++)
+	{
+		uint8_t* plane = static_cast<uint8_t*>(img.data[zpos + z]);
+		for (unsigned int y = 0; y < bsd.ydim; y++)
+		{
+			std::memcpy(plane + (ypos + y) * row_stride + xpos * texel_size, texels, row_size);
+			texels += row_size;
+		}
+	}
+}
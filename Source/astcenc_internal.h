@@ -111,6 +111,9 @@ static constexpr unsigned int WEIGHTS_MAX_BLOCK_MODES { 2048 };
 /** @brief The number of weight grid decimation modes suported by the ASTC format. */
 static constexpr unsigned int WEIGHTS_MAX_DECIMATION_MODES { 87 };
 
+/** @brief The number of weight quantization levels suported by the ASTC format. */
+static constexpr unsigned int WEIGHTS_QUANT_LEVELS { 12 };
+
 /** @brief The high default error used to initialize error trackers. */
 static constexpr float ERROR_CALC_DEFAULT { 1e30f };
 
@@ -224,6 +227,12 @@ private:
 	/** @brief Number of tasks that need to be processed. */
 	unsigned int m_task_count;
 
+	/** @brief Progress callback, or @c nullptr if progress is not reported. */
+	astcenc_progress_callback m_callback;
+
+	/** @brief The last progress value reported to the callback. */
+	float m_callback_last_value;
+
 public:
 	/** @brief Create a new ParallelManager. */
 	ParallelManager()
@@ -244,6 +253,8 @@ public:
 		m_start_count = 0;
 		m_done_count = 0;
 		m_task_count = 0;
+		m_callback = nullptr;
+		m_callback_last_value = 0.0f;
 	}
 
 	/**
@@ -254,13 +265,17 @@ public:
 	 *
 	 * @param init_func   Callable which executes the stage initialization. It must return the
 	 *                    total number of tasks in the stage.
+	 * @param callback    Optional callback to report the percentage of completed tasks.
 	 */
-	void init(std::function<unsigned int(void)> init_func)
-	{
+	void init(
+		std::function<unsigned int(void)> init_func,
+		astcenc_progress_callback callback = nullptr
+	) {
 		std::lock_guard<std::mutex> lck(m_lock);
 		if (!m_init_done)
 		{
 			m_task_count = init_func();
+			m_callback = callback;
 			m_init_done = true;
 		}
 	}
@@ -312,14 +327,35 @@ public:
 	 * Mark @c count tasks as complete. This will notify all threads blocked on @c wait() if this
 	 * completes the processing of the stage.
 	 *
-	 * @param count   The number of completed tasks.
+	 * @param count         The number of completed tasks.
+	 * @param commit_func   Optional callable which publishes the task results. It is run while
+	 *                      holding the lock that also serializes calls to the progress callback.
 	 */
-	void complete_task_assignment(unsigned int count)
-	{
+	void complete_task_assignment(
+		unsigned int count,
+		const std::function<void(void)>& commit_func = nullptr
+	) {
 		// Note: m_done_count cannot use an atomic without the mutex; this has a race between the
 		// update here and the wait() for other threads
 		std::unique_lock<std::mutex> lck(m_lock);
+		if (commit_func)
+		{
+			commit_func();
+		}
+
 		this->m_done_count += count;
+
+		// Report progress in steps of at least one percent, and always report completion
+		if (m_callback)
+		{
+			float value = (static_cast<float>(m_done_count) / static_cast<float>(m_task_count)) * 100.0f;
+			if ((value - m_callback_last_value) >= 1.0f || m_done_count == m_task_count)
+			{
+				m_callback_last_value = value;
+				m_callback(value);
+			}
+		}
+
 		if (m_done_count == m_task_count)
 		{
 			lck.unlock();
@@ -336,6 +372,17 @@ public:
 		m_complete.wait(lck, [this]{ return m_done_count == m_task_count; });
 	}
 
+	/**
+	 * @brief Test if stage processing has completed, without blocking.
+	 *
+	 * @return Return @c true if the stage has been initialized and all tasks have completed.
+	 */
+	bool is_complete()
+	{
+		std::lock_guard<std::mutex> lck(m_lock);
+		return m_init_done && (m_done_count == m_task_count);
+	}
+
 	/**
 	 * @brief Trigger the pipeline stage term step.
 	 *
@@ -356,6 +403,92 @@ public:
 	}
 };
 
+/**
+ * @brief A pool of scratch buffer indices that can be checked out by any thread.
+ *
+ * This allows callers that are not bound to a fixed thread index, such as a host job system, to
+ * share the per-thread scratch buffers of a context. The pool size bounds the number of threads
+ * that can work concurrently.
+ */
+class ScratchPool
+{
+private:
+	/** @brief Lock used for critical section synchronization. */
+	std::mutex m_lock;
+
+	/** @brief The stack of free buffer indices. */
+	unsigned int* m_free;
+
+	/** @brief The number of entries in @c m_free. */
+	unsigned int m_free_count;
+
+public:
+	/** @brief Create a new, empty ScratchPool. */
+	ScratchPool()
+	{
+		m_free = nullptr;
+		m_free_count = 0;
+	}
+
+	/** @brief Destroy a ScratchPool. */
+	~ScratchPool()
+	{
+		delete[] m_free;
+	}
+
+	ScratchPool(const ScratchPool&) = delete;
+	ScratchPool& operator=(const ScratchPool&) = delete;
+
+	/**
+	 * @brief Initialize the pool, with all buffers free.
+	 *
+	 * @param count   The number of buffers in the pool.
+	 */
+	void init(unsigned int count)
+	{
+		std::lock_guard<std::mutex> lck(m_lock);
+		delete[] m_free;
+		m_free = new unsigned int[count];
+		m_free_count = count;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			m_free[i] = count - 1 - i;
+		}
+	}
+
+	/**
+	 * @brief Check out a buffer index.
+	 *
+	 * @param[out] index   The checked out buffer index.
+	 *
+	 * @return Return @c true if a buffer was checked out, @c false if all buffers are in use.
+	 */
+	bool checkout(unsigned int& index)
+	{
+		std::lock_guard<std::mutex> lck(m_lock);
+		if (!m_free_count)
+		{
+			return false;
+		}
+
+		m_free_count--;
+		index = m_free[m_free_count];
+		return true;
+	}
+
+	/**
+	 * @brief Return a buffer index to the pool.
+	 *
+	 * @param index   The buffer index to return.
+	 */
+	void checkin(unsigned int index)
+	{
+		std::lock_guard<std::mutex> lck(m_lock);
+		m_free[m_free_count] = index;
+		m_free_count++;
+	}
+};
+
 /* ============================================================================
   Commonly used data structures
 ============================================================================ */
@@ -529,6 +662,48 @@ struct partition_info
 	uint64_t coverage_bitmaps[BLOCK_MAX_PARTITIONS];
 };
 
+/**
+ * @brief Get a texel of a partition, for a partition count specialized kernel.
+ *
+ * Kernels that process each partition of a block can be templated on the partition count, so that
+ * partition loops have a compile-time trip count. The texel list of a single partition block is the
+ * identity, so single partition kernels skip the partition indirection entirely.
+ *
+ * @tparam PARTITION_COUNT   The partition count of the kernel.
+ *
+ * @param pi          The partition info.
+ * @param partition   The partition index.
+ * @param index       The index of the texel in the partition texel list.
+ *
+ * @return The texel index in the block.
+ */
+template<unsigned int PARTITION_COUNT>
+static inline unsigned int get_partition_texel(
+	const partition_info& pi,
+	unsigned int partition,
+	unsigned int index
+) {
+	return PARTITION_COUNT == 1 ? index : pi.texels_of_partition[partition][index];
+}
+
+/**
+ * @brief Get the partition of a texel, for a partition count specialized kernel.
+ *
+ * @tparam PARTITION_COUNT   The partition count of the kernel.
+ *
+ * @param pi      The partition info.
+ * @param texel   The texel index in the block.
+ *
+ * @return The partition index.
+ */
+template<unsigned int PARTITION_COUNT>
+static inline unsigned int get_texel_partition(
+	const partition_info& pi,
+	unsigned int texel
+) {
+	return PARTITION_COUNT == 1 ? 0 : pi.partition_of_texel[texel];
+}
+
 /**
  * @brief The weight grid information for a single decimation pattern.
  *
@@ -702,9 +877,20 @@ struct block_size_descriptor
 	/** @brief The active block modes, stored in low indices. */
 	block_mode block_modes[WEIGHTS_MAX_BLOCK_MODES];
 
-	/** @brief The partition tables for all of the possible partitions. */
+	/**
+	 * @brief The partition tables for all of the possible partitions.
+	 *
+	 * If @c partition_build_state is not @c nullptr the multi-partition entries are built on first
+	 * use, and must be accessed via @c get_lazy_partition_info().
+	 */
 	partition_info partitions[(3 * BLOCK_MAX_PARTITIONINGS) + 1];
 
+	/**
+	 * @brief The build state of each multi-partition table entry, or @c nullptr if all entries
+	 * were built up front.
+	 */
+	std::atomic<uint8_t>* partition_build_state;
+
 	/** @brief The active texels for k-means partition selection. */
 	uint8_t kmeans_texels[BLOCK_MAX_KMEANS_TEXELS];
 
@@ -922,6 +1108,31 @@ struct image_block
 		              (this->data_max.lane<3>() == default_alpha);
 		return this->grayscale && !alpha1;
 	}
+
+	/**
+	 * @brief Test if this block is an LDR luminance block with constant 1.0 alpha.
+	 *
+	 * Blocks passing this test can use the dedicated 1 component compression pipeline.
+	 *
+	 * @return @c true if the block is an LDR luminance block , @c false otherwise.
+	 */
+	inline bool is_ldr_luminance() const
+	{
+		return !this->rgb_lns[0] && !this->alpha_lns[0] && this->is_luminance();
+	}
+
+	/**
+	 * @brief Test if this block is an LDR luminance block with variable alpha.
+	 *
+	 * Blocks passing this test can use the dedicated 2 component compression pipeline. This is
+	 * the common case for normal maps, which are stored with an X+Y swizzle such as "rrrg".
+	 *
+	 * @return @c true if the block is an LDR luminance + alpha block , @c false otherwise.
+	 */
+	inline bool is_ldr_luminancealpha() const
+	{
+		return !this->rgb_lns[0] && !this->alpha_lns[0] && this->is_luminancealpha();
+	}
 };
 
 /**
@@ -953,6 +1164,17 @@ struct image_block
  */
 struct error_weight_block
 {
+	/**
+	 * @brief True if every texel in the block uses the same error weight.
+	 *
+	 * When set, @c uniform_error_weight holds the shared weight and hot kernels use it directly
+	 * instead of loading the per-texel weight arrays.
+	 */
+	bool is_uniform;
+
+	/** @brief The shared per component error weight, only valid if @c is_uniform is true. */
+	vfloat4 uniform_error_weight;
+
 	/** @brief Block error weighted RGBA sum for whole block / 1 partition. */
 	vfloat4 block_error_weighted_rgba_sum;
 
@@ -1060,6 +1282,21 @@ struct encoding_choice_errors
 	bool can_blue_contract;
 };
 
+/**
+ * @brief The lowest error distinct encodings found for a block, sorted by increasing error.
+ */
+struct block_candidate_list
+{
+	/** @brief The number of candidates to keep, or zero if candidate collection is disabled. */
+	unsigned int limit;
+
+	/** @brief The number of valid candidates. */
+	unsigned int count;
+
+	/** @brief The candidate encodings. */
+	astcenc_block_candidate candidates[ASTCENC_MAX_BLOCK_CANDIDATES];
+};
+
 /**
  * @brief Preallocated working buffers, allocated per thread during context creation.
  */
@@ -1080,6 +1317,9 @@ struct alignas(ASTCENC_VECALIGN) compression_working_buffers
 	/** @brief The error weight block for the current thread. */
 	error_weight_block ewb;
 
+	/** @brief The error weight sum of the last block compressed, or zero for a constant block. */
+	float error_weight_sum;
+
 	/**
 	 * @brief Decimated ideal weight values.
 	 *
@@ -1107,6 +1347,9 @@ struct alignas(ASTCENC_VECALIGN) compression_working_buffers
 	 * For two plane encodings, second plane weights start at @c WEIGHTS_PLANE2_OFFSET offsets.
 	 */
 	alignas(ASTCENC_VECALIGN) uint8_t dec_weights_quant_pvalue[WEIGHTS_MAX_BLOCK_MODES * BLOCK_MAX_WEIGHTS];
+
+	/** @brief The candidate encodings found for the current block. */
+	block_candidate_list candidates;
 };
 
 /**
@@ -1235,6 +1478,14 @@ struct physical_compressed_block
 };
 
 
+/**
+ * @brief The largest kernel radius supported by the integer U8 averages and variances path.
+ *
+ * The squared value sums for a kernel footprint must fit in a signed 32-bit integer, so the
+ * kernel dimension must be less than sqrt(2^31 / 255^2) = 181 texels.
+ */
+static constexpr unsigned int INT_PATH_MAX_RADIUS { 90 };
+
 /**
  * @brief Parameter structure for @c compute_pixel_region_variance().
  *
@@ -1284,6 +1535,9 @@ struct pixel_region_variance_args
 
 	/** @brief The working memory buffer. */
 	vfloat4 *work_memory;
+
+	/** @brief The working memory buffer for the integer U8 path. */
+	vint4 *int_work_memory;
 };
 
 /**
@@ -1312,6 +1566,12 @@ struct avg_var_args
 
 	/** @brief The working block memory size. */
 	unsigned int work_memory_size;
+
+	/** @brief Should the exact integer path for U8 images be used? */
+	bool use_int_path;
+
+	/** @brief The integer path working memory size. */
+	unsigned int int_work_memory_size;
 };
 
 #if defined(ASTCENC_DIAGNOSTICS)
@@ -1319,6 +1579,36 @@ struct avg_var_args
 class TraceLog;
 #endif
 
+/* See compress_block_trial_group() for details. */
+struct block_search_state;
+
+/**
+ * @brief The number of entries in each decompressor repeated block cache.
+ */
+static constexpr unsigned int DECODE_CACHE_ENTRIES { 64 };
+
+/**
+ * @brief A per-thread cache of recently decoded blocks, for @c ASTCENC_FLG_USE_DECODE_CACHE.
+ *
+ * The cache is direct mapped, keyed on the encoded block data, and stores the decoded texels in
+ * the output image data type. Entries are only valid for a single decompression call, as the
+ * output data type and swizzle may change between calls.
+ */
+struct decode_cache
+{
+	/** @brief The encoded block data for each entry. */
+	uint8_t keys[DECODE_CACHE_ENTRIES][16];
+
+	/** @brief True if the entry contains a decoded block. */
+	bool valid[DECODE_CACHE_ENTRIES];
+
+	/** @brief The decoded texels for each entry, sized for the largest output data type. */
+	uint8_t* texels;
+
+	/** @brief The stride between entries in @c texels, in bytes. */
+	size_t texels_stride;
+};
+
 /**
  * @brief The astcenc compression context.
  */
@@ -1359,16 +1649,119 @@ struct astcenc_context
 	/** @brief The per-texel deblocking weights for the current block size. */
 	float deblock_weights[BLOCK_MAX_TEXELS];
 
+	/**
+	 * @brief True if the config gives every in-image texel the same error weight.
+	 *
+	 * This is the case for LDR compression with no variance, alpha, or deblock weighting.
+	 */
+	bool uniform_error_weights;
+
 	/** @brief The parallel manager for averages and variances computation. */
 	ParallelManager manage_avg_var;
 
 	/** @brief The parallel manager for compression. */
 	ParallelManager manage_compress;
+
+	/**
+	 * @brief The configuration used for the initial pass of progressive compression.
+	 *
+	 * This is the context configuration with the search tuning of the fastest preset.
+	 */
+	astcenc_config progressive_config;
+
+	/** @brief The per-block error after the initial pass of progressive compression. */
+	float* progressive_errors;
+
+	/** @brief The per-block error target of the context config, used to skip refinement. */
+	float* progressive_targets;
+
+	/** @brief The block indices for the refinement pass, ordered by decreasing error. */
+	unsigned int* progressive_order;
+
+	/** @brief The parallel manager for the refinement pass of progressive compression. */
+	ParallelManager manage_refine;
+
+	/** @brief The scratch buffer pool for job based compression. */
+	ScratchPool scratch_pool;
+
+	/**
+	 * @brief The input image for job based compression, or @c nullptr if no job is active.
+	 *
+	 * This is published with release semantics after the other job state has been set up.
+	 */
+	std::atomic<const astcenc_image*> job_image;
+
+	/** @brief The number of job based compression task calls currently in flight. */
+	std::atomic<unsigned int> job_active_calls;
+
+	/** @brief The input swizzle for job based compression. */
+	astcenc_swizzle job_swizzle;
+
+	/** @brief The output array for job based compression. */
+	uint8_t* job_data_out;
+
+	/**
+	 * @brief The averages and variances working memory for job based compression.
+	 *
+	 * There is one region of @c avg_var_args::work_memory_size entries per scratch pool buffer.
+	 */
+	vfloat4* job_work_memory;
+
+	/**
+	 * @brief The averages and variances integer working memory for job based compression.
+	 *
+	 * There is one region of @c avg_var_args::int_work_memory_size entries per scratch pool buffer.
+	 */
+	vint4* job_int_work_memory;
+
+	/**
+	 * @brief The block search states for intra-block parallelism.
+	 *
+	 * There is one state per block for images small enough to use intra-block parallelism, or
+	 * @c nullptr for single threaded and decompression only contexts.
+	 */
+	block_search_state* block_search;
+
+	/**
+	 * @brief The number of blocks in each block row that have a final RDO encoding.
+	 *
+	 * RDO uses the final encodings of the blocks to the left and above as context, so each block
+	 * waits for them to be written. There is one entry per row of blocks in the image.
+	 */
+	std::atomic<unsigned int>* rdo_row_progress;
+
+	/** @brief The number of entries allocated in @c rdo_row_progress. */
+	unsigned int rdo_row_capacity;
+
+	/** @brief The lock for waiting on @c rdo_row_progress. */
+	std::mutex rdo_row_lock;
+
+	/** @brief The condition signaled when @c rdo_row_progress is updated. */
+	std::condition_variable rdo_row_updated;
 #endif
 
 	/** @brief The parallel manager for decompression. */
 	ParallelManager manage_decompress;
 
+	/** @brief The parallel manager for validation. */
+	ParallelManager manage_validate;
+
+	/** @brief The number of error blocks found by validation. */
+	std::atomic<size_t> validate_error_count;
+
+	/** @brief The parallel manager for block statistics queries. */
+	ParallelManager manage_block_stats;
+
+	/** @brief Lock used to merge per-thread block statistics. */
+	std::mutex block_stats_lock;
+
+	/**
+	 * @brief The repeated block caches for decompression, one per thread (see @c thread_count).
+	 *
+	 * This is @c nullptr unless the context was created with @c ASTCENC_FLG_USE_DECODE_CACHE.
+	 */
+	decode_cache* decode_caches;
+
 #if defined(ASTCENC_DIAGNOSTICS)
 	/**
 	 * @brief The diagnostic trace logger.
@@ -1394,9 +1787,10 @@ struct astcenc_context
  * @param      x_texels         The number of texels in the block X dimension.
  * @param      y_texels         The number of texels in the block Y dimension.
  * @param      z_texels         The number of texels in the block Z dimension.
- * @param      can_omit_modes   Can we discard modes that astcenc won't use, even if legal?
- * @param      mode_cutoff      The block mode percentile cutoff [0-1].
- * @param[out] bsd              The descriptor to initialize.
+ * @param      can_omit_modes    Can we discard modes that astcenc won't use, even if legal?
+ * @param      mode_cutoff       The block mode percentile cutoff [0-1].
+ * @param      lazy_partitions   Build partition tables on first use, for decompression only use.
+ * @param[out] bsd               The descriptor to initialize.
  */
 void init_block_size_descriptor(
 	unsigned int x_texels,
@@ -1404,6 +1798,7 @@ void init_block_size_descriptor(
 	unsigned int z_texels,
 	bool can_omit_modes,
 	float mode_cutoff,
+	bool lazy_partitions,
 	block_size_descriptor& bsd);
 
 /**
@@ -1420,10 +1815,32 @@ void term_block_size_descriptor(
  * Note the @c bsd descriptor must be initialized by calling @c init_block_size_descriptor() before
  * calling this function.
  *
- * @param[out] bsd   The block size information structure to populate.
+ * Lazy tables only build the single partition entry up front. The other entries are built on first
+ * use by @c get_lazy_partition_info(), and do not have duplicate partitionings removed, so they
+ * are only suitable for decompression.
+ *
+ * @param[out] bsd    The block size information structure to populate.
+ * @param      lazy   Build the multi-partition entries on first use.
  */
 void init_partition_tables(
-	block_size_descriptor& bsd);
+	block_size_descriptor& bsd,
+	bool lazy);
+
+/**
+ * @brief Get a partition info structure, building it first if the tables are lazy.
+ *
+ * This is safe to call concurrently from multiple threads.
+ *
+ * @param bsd               The block size information.
+ * @param partition_count   The number of partitions we want the info for.
+ * @param index             The partition seed (between 0 and 1023).
+ *
+ * @return The partition info structure.
+ */
+const partition_info& get_lazy_partition_info(
+	const block_size_descriptor& bsd,
+	unsigned int partition_count,
+	unsigned int index);
 
 /**
  * @brief Get the percentile table for 2D block modes.
@@ -1461,6 +1878,21 @@ bool is_legal_3d_block_size(
 	unsigned int ydim,
 	unsigned int zdim);
 
+/**
+ * @brief Get the number of weight bits used by an encoded block mode.
+ *
+ * Note that this only checks that the block mode is legal in isolation; it does not check that the
+ * weight grid fits in any specific block footprint.
+ *
+ * @param is_3d        True if the block mode is for a 3D block size.
+ * @param block_mode   The encoded 11-bit block mode.
+ *
+ * @return The number of weight bits, or zero if the block mode is reserved or a void-extent.
+ */
+unsigned int get_block_mode_weight_bits(
+	bool is_3d,
+	unsigned int block_mode);
+
 /* ============================================================================
   Functionality for managing BISE quantization and unquantization.
 ============================================================================ */
@@ -1548,6 +1980,9 @@ unsigned int get_ise_sequence_bitcount(
 /**
  * @brief Compute averages and dominant directions for each partition in a 2 component texture.
  *
+ * The component pair (0, 3) is treated as luminance-alpha, with the red channel used as the
+ * luminance value and the luminance error weighted as the sum of the RGB error weights.
+ *
  * @param      pi           The partition info for the current trial.
  * @param      blk          The image block color data to be compressed.
  * @param      ewb          The image block weighted error data.
@@ -1626,12 +2061,16 @@ void compute_avgs_and_dirs_4_comp(
  * is used to assess the error from using an uncorrelated color representation. The other line goes
  * through (0,0,0) and is used to assess the error from using an RGBS color representation.
  *
- * This function computes the squared error when using these two representations.
+ * This function computes the squared error when using these two representations. The errors only
+ * grow with each partition, so the computation stops early once both errors reach their limits;
+ * the returned errors and line lengths are then incomplete.
  *
  * @param         pi              The partition info for the current trial.
  * @param         blk             The image block color data to be compressed.
  * @param         ewb             The image block weighted error data.
  * @param[in,out] plines          Processed line inputs, and line length outputs.
+ * @param         uncor_limit     The uncorrelated error limit for early-out.
+ * @param         samec_limit     The same chroma error limit for early-out.
  * @param[out]    uncor_error     The cumulative error for using the uncorrelated line.
  * @param[out]    samec_error     The cumulative error for using the same chroma line.
  */
@@ -1640,6 +2079,8 @@ void compute_error_squared_rgb(
 	const image_block& blk,
 	const error_weight_block& ewb,
 	partition_lines3 plines[BLOCK_MAX_PARTITIONS],
+	float uncor_limit,
+	float samec_limit,
 	float& uncor_error,
 	float& samec_error);
 
@@ -1651,7 +2092,9 @@ void compute_error_squared_rgb(
  * is used to assess the error from using an uncorrelated color representation. The other line goes
  * through (0,0,0,1) and is used to assess the error from using an RGBS color representation.
  *
- * This function computes the squared error when using these two representations.
+ * This function computes the squared error when using these two representations. The errors only
+ * grow with each partition, so the computation stops early once both errors reach their limits;
+ * the returned errors and line lengths are then incomplete.
  *
  * @param      pi              The partition info for the current trial.
  * @param      blk             The image block color data to be compressed.
@@ -1660,6 +2103,8 @@ void compute_error_squared_rgb(
  * @param      samec_plines    Processed same chroma partition lines for each partition.
  * @param[out] uncor_lengths   The length of each components deviation from the line.
  * @param[out] samec_lengths   The length of each components deviation from the line.
+ * @param      uncor_limit     The uncorrelated error limit for early-out.
+ * @param      samec_limit     The same chroma error limit for early-out.
  * @param[out] uncor_error     The cumulative error for using the uncorrelated line.
  * @param[out] samec_error     The cumulative error for using the same chroma line.
  */
@@ -1671,6 +2116,8 @@ void compute_error_squared_rgba(
 	const processed_line4 samec_plines[BLOCK_MAX_PARTITIONS],
 	float uncor_lengths[BLOCK_MAX_PARTITIONS],
 	float samec_lengths[BLOCK_MAX_PARTITIONS],
+	float uncor_limit,
+	float samec_limit,
 	float& uncor_error,
 	float& samec_error);
 
@@ -1680,6 +2127,9 @@ void compute_error_squared_rgba(
  * On return @c best_partition_uncor contains the best partition  assuming data has uncorrelated
  * chroma, @c best_partition_samec contains the best partition assuming data has corelated chroma.
  *
+ * The bounds estimate the lowest error that an encoding of each partitioning can achieve, ignoring
+ * quantization. They are zero if no estimate is available.
+ *
  * @param      bsd                        The block size information.
  * @param      blk                        The image block color data to compress.
  * @param      ewb                        The image block weighted error data.
@@ -1687,6 +2137,8 @@ void compute_error_squared_rgba(
  * @param      partition_search_limit     The number of candidate partition encodings to trial.
  * @param[out] best_partition_uncor       The best partition for uncorrelated chroma.
  * @param[out] best_partition_samec       The best partition for correlated chroma.
+ * @param[out] best_partition_uncor_bound The line fit error estimate for @c best_partition_uncor.
+ * @param[out] best_partition_samec_bound The line fit error estimate for @c best_partition_samec.
  */
 void find_best_partition_candidates(
 	const block_size_descriptor& bsd,
@@ -1695,7 +2147,9 @@ void find_best_partition_candidates(
 	unsigned int partition_count,
 	unsigned int partition_search_limit,
 	unsigned int& best_partition_uncor,
-	unsigned int& best_partition_samec);
+	unsigned int& best_partition_samec,
+	float& best_partition_uncor_bound,
+	float& best_partition_samec_bound);
 
 /* ============================================================================
   Functionality for managing images and image related data.
@@ -1745,6 +2199,26 @@ void compute_averages_and_variances(
 	astcenc_context& ctx,
 	const avg_var_args& ag);
 
+/**
+ * @brief Run one task of the regional averages and variances computation.
+ *
+ * This function can be called by multiple threads, but only after a single thread calls the setup
+ * function @c init_compute_averages_and_variances(). Each concurrent caller must provide its own
+ * working memory, sized using @c ag.work_memory_size and @c ag.int_work_memory_size.
+ *
+ * @param[out] ctx               The context.
+ * @param      ag                The average and variance arguments created during setup.
+ * @param[out] work_memory       The working memory for the floating point path.
+ * @param[out] int_work_memory   The working memory for the integer path.
+ *
+ * @return Return @c true if a task was run, @c false if there are no tasks remaining.
+ */
+bool compute_averages_and_variances_task(
+	astcenc_context& ctx,
+	const avg_var_args& ag,
+	vfloat4* work_memory,
+	vint4* int_work_memory);
+
 /**
  * @brief Fetch a single image block from the input image
  *
@@ -1787,6 +2261,68 @@ void write_image_block(
 	unsigned int zpos,
 	const astcenc_swizzle& swz);
 
+/**
+ * @brief Write a single constant color image block to the output image.
+ *
+ * The output is identical to @c write_image_block() for a block where every texel is @c color.
+ *
+ * @param[out] img     The output image data.
+ * @param      color   The block color.
+ * @param      bsd     The block size information.
+ * @param      xpos    The block X coordinate in the output image.
+ * @param      ypos    The block Y coordinate in the output image.
+ * @param      zpos    The block Z coordinate in the output image.
+ * @param      swz     The swizzle to apply on store.
+ */
+void fill_image_block(
+	astcenc_image& img,
+	vfloat4 color,
+	const block_size_descriptor& bsd,
+	unsigned int xpos,
+	unsigned int ypos,
+	unsigned int zpos,
+	const astcenc_swizzle& swz);
+
+/**
+ * @brief Copy the texels of a block footprint out of an image, in the image data type.
+ *
+ * The footprint must be entirely inside the image.
+ *
+ * @param      img      The image data.
+ * @param      bsd      The block size information.
+ * @param      xpos     The block X coordinate in the image.
+ * @param      ypos     The block Y coordinate in the image.
+ * @param      zpos     The block Z coordinate in the image.
+ * @param[out] texels   The output texels, packed in footprint order.
+ */
+void save_image_block_texels(
+	const astcenc_image& img,
+	const block_size_descriptor& bsd,
+	unsigned int xpos,
+	unsigned int ypos,
+	unsigned int zpos,
+	uint8_t* texels);
+
+/**
+ * @brief Copy the texels of a block footprint into an image, in the image data type.
+ *
+ * The footprint must be entirely inside the image.
+ *
+ * @param[out] img      The image data.
+ * @param      bsd      The block size information.
+ * @param      xpos     The block X coordinate in the image.
+ * @param      ypos     The block Y coordinate in the image.
+ * @param      zpos     The block Z coordinate in the image.
+ * @param      texels   The texels, packed in footprint order.
+ */
+void restore_image_block_texels(
+	astcenc_image& img,
+	const block_size_descriptor& bsd,
+	unsigned int xpos,
+	unsigned int ypos,
+	unsigned int zpos,
+	const uint8_t* texels);
+
 /* ============================================================================
   Functionality for computing endpoint colors and weights for a block.
 ============================================================================ */
@@ -1938,22 +2474,27 @@ static inline vfloat bilinear_infill_vla(
 }
 
 /**
- * @brief Compute the error of a decimated weight set for 1 plane.
+ * @brief Compute the errors of a group of decimated weight sets for 1 plane.
  *
  * After computing ideal weights for the case with one weight per texel, we want to compute the
  * error for decimated weight grids where weights are stored at a lower resolution. This function
  * computes the error of the reduced grid, compared to the full grid.
  *
- * @param eai                       The ideal weights for the full grid.
- * @param di                        The selected weight decimation.
- * @param dec_weight_quant_uvalue   The quantized weights for the decimated grid.
+ * All of the weight sets must use the same decimation, typically one per weight quantization
+ * level, so they are processed together in a single pass over the decimation tables.
  *
- * @return The accumulated error.
+ * @param      eai                        The ideal weights for the full grid.
+ * @param      di                         The selected weight decimation.
+ * @param      weight_set_count           The number of weight sets, up to WEIGHTS_QUANT_LEVELS.
+ * @param      dec_weight_quant_uvalues   The quantized weights for each decimated grid.
+ * @param[out] errors                     The accumulated error for each weight set.
  */
-float compute_error_of_weight_set_1plane(
+void compute_error_of_weight_sets_1plane(
 	const endpoints_and_weights& eai,
 	const decimation_info& di,
-	const float* dec_weight_quant_uvalue);
+	unsigned int weight_set_count,
+	const float* const* dec_weight_quant_uvalues,
+	float* errors);
 
 /**
  * @brief Compute the error of a decimated weight set for 2 planes.
@@ -2060,6 +2601,7 @@ void unpack_weights(
  * @param      qwt_bitcounts                 Bit counts for different quantization methods.
  * @param      qwt_errors                    Errors for different quantization methods.
  * @param      tune_candidate_limit          The max number of candidates to return, may be less.
+ * @param      is_normal_map                 @c true if compressing with @c ASTCENC_FLG_MAP_NORMAL.
  * @param[out] partition_format_specifiers   The best formats per partition.
  * @param[out] block_mode                    The best packed block mode indexes.
  * @param[out] quant_level                   The best color quant level.
@@ -2076,6 +2618,7 @@ unsigned int compute_ideal_endpoint_formats(
 	const int* qwt_bitcounts,
 	const float* qwt_errors,
 	unsigned int tune_candidate_limit,
+	bool is_normal_map,
 	int partition_format_specifiers[TUNE_MAX_TRIAL_CANDIDATES][BLOCK_MAX_PARTITIONS],
 	int block_mode[TUNE_MAX_TRIAL_CANDIDATES],
 	quant_method quant_level[TUNE_MAX_TRIAL_CANDIDATES],
@@ -2206,7 +2749,14 @@ void compute_angular_endpoints_2planes(
 /**
  * @brief Compress an image block into a physical block.
  *
- * @param      ctx      The compressor context and configuration.
+ * If @c tmpbuf.candidates.limit is non-zero the lowest error distinct encodings evaluated during
+ * the search are also returned in @c tmpbuf.candidates.
+ *
+ * The search is controlled by the tuning parameters in @c config, which is normally the context
+ * configuration, but may be a cheaper configuration for the same profile and block size.
+ *
+ * @param      ctx      The compressor context.
+ * @param      config   The compressor configuration to use for the search.
  * @param      image    The input image information.
  * @param      blk      The image block color data to compress.
  * @param[out] pcb      The physical compressed block output.
@@ -2214,11 +2764,151 @@ void compute_angular_endpoints_2planes(
  */
 void compress_block(
 	const astcenc_context& ctx,
+	const astcenc_config& config,
 	const astcenc_image& image,
 	const image_block& blk,
 	physical_compressed_block& pcb,
 	compression_working_buffers& tmpbuf);
 
+/**
+ * @brief Get the error threshold below which a block encoding is good enough to stop searching.
+ *
+ * @param config             The compressor configuration.
+ * @param blk                The image block color data to compress.
+ * @param error_weight_sum   The sum of the block error weights.
+ *
+ * @return The error threshold.
+ */
+float get_block_error_threshold(
+	const astcenc_config& config,
+	const image_block& blk,
+	float error_weight_sum);
+
+/**
+ * @brief The number of trial groups a block search is split into for intra-block parallelism.
+ *
+ * Group 0 runs the 1 partition trials, with 1 and 2 planes of weights, and group N runs the N+1
+ * partition trials.
+ */
+static constexpr unsigned int BLOCK_SEARCH_GROUPS { BLOCK_MAX_PARTITIONS };
+
+/**
+ * @brief Images with this many blocks or fewer use intra-block parallelism.
+ *
+ * Intra-block parallelism is only used with more than one thread, as the search path changes the
+ * compressed output and single threaded compression must match sequential compression.
+ */
+static constexpr unsigned int INTRA_BLOCK_MAX_BLOCKS { 64 };
+
+/**
+ * @brief The shared search state of a block compressed using intra-block parallelism.
+ */
+struct block_search_state
+{
+	/** @brief The index of the lowest trial group that hit the quality target. */
+	std::atomic<unsigned int> first_hit_group;
+
+	/** @brief The number of trial groups that have not completed. */
+	std::atomic<unsigned int> groups_remaining;
+
+	/** @brief The best encoding found by each trial group. */
+	symbolic_compressed_block group_scb[BLOCK_SEARCH_GROUPS];
+
+	/** @brief The best 1 plane error found by each trial group, used for the partition early-out. */
+	float group_best_errorval[BLOCK_SEARCH_GROUPS];
+
+	/** @brief Did each trial group hit the quality target? */
+	bool group_hit[BLOCK_SEARCH_GROUPS];
+
+	/** @brief Has each trial group completed? Set with release semantics after the group results. */
+	std::atomic<bool> group_done[BLOCK_SEARCH_GROUPS];
+
+	/** @brief Lock guarding the preparation of the shared error weight data. */
+	std::mutex prepare_lock;
+
+	/** @brief Has the shared error weight data been prepared? Guarded by @c prepare_lock. */
+	bool prepared;
+
+	/** @brief The error weight block, prepared once and shared by all trial groups. */
+	error_weight_block ewb;
+
+	/** @brief The error threshold of the block, prepared once and shared by all trial groups. */
+	float error_threshold;
+
+	/**
+	 * @brief Reset the state for a new block.
+	 */
+	void reset()
+	{
+		prepared = false;
+		first_hit_group.store(BLOCK_SEARCH_GROUPS, std::memory_order_relaxed);
+		groups_remaining.store(BLOCK_SEARCH_GROUPS, std::memory_order_relaxed);
+		for (unsigned int i = 0; i < BLOCK_SEARCH_GROUPS; i++)
+		{
+			group_done[i].store(false, std::memory_order_relaxed);
+		}
+	}
+};
+
+/**
+ * @brief Run one trial group of the search for a block using intra-block parallelism.
+ *
+ * Each group of a block can run on a different thread. The first group to run prepares the error
+ * weight data that all groups of the block share. Each group publishes its results as soon as it
+ * completes, and a running group stops between trials once the published results of the lower
+ * groups show that the single-threaded search order would never reach it. Groups that the search
+ * order does reach never stop early, so the final encoding is independent of thread timing.
+ *
+ * @param         ctx      The compressor context.
+ * @param         config   The compressor configuration to use for the search.
+ * @param         image    The input image information.
+ * @param         blk      The image block color data to compress.
+ * @param         group    The trial group index [0..BLOCK_SEARCH_GROUPS-1].
+ * @param[in,out] state    The shared search state for this block.
+ * @param[out]    tmpbuf   Preallocated scratch buffers for the compressor.
+ */
+void compress_block_trial_group(
+	const astcenc_context& ctx,
+	const astcenc_config& config,
+	const astcenc_image& image,
+	const image_block& blk,
+	unsigned int group,
+	block_search_state& state,
+	compression_working_buffers& tmpbuf);
+
+/**
+ * @brief Pick the final encoding for a block once all of its trial groups have completed.
+ *
+ * This replays the quality target and partition count early-outs of @c compress_block() over the
+ * group results, so only groups that the single-threaded search order would run contribute. The
+ * result is not bit-identical to @c compress_block(), as each group starts its trials without the
+ * best error of the lower groups, but it only depends on the image and the configuration.
+ *
+ * @param      config   The compressor configuration used for the search.
+ * @param      bsd      The block size information.
+ * @param      blk      The image block color data to compress.
+ * @param      state    The shared search state for this block.
+ * @param[out] pcb      The physical compressed block output.
+ */
+void finish_block_search(
+	const astcenc_config& config,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const block_search_state& state,
+	physical_compressed_block& pcb);
+
+/**
+ * @brief Decode the color of a constant color symbolic block.
+ *
+ * @param decode_mode   The decode mode (LDR, HDR, etc).
+ * @param scb           The symbolic compressed encoding; must be a constant color block.
+ *
+ * @return The decoded color, as used for every texel in the block.
+ */
+vfloat4 decode_constant_block_color(
+	astcenc_profile decode_mode,
+	const symbolic_compressed_block& scb);
+
 /**
  * @brief Decompress a symbolic block in to an image block.
  *
@@ -2238,26 +2928,76 @@ void decompress_symbolic_block(
 	const symbolic_compressed_block& scb,
 	image_block& blk);
 
+/**
+ * @brief The maximum number of neighboring blocks used as history for RDO block selection.
+ */
+static constexpr unsigned int RDO_MAX_HISTORY_BLOCKS { 8 };
+
+/**
+ * @brief The maximum number of blocks to the left of the current block in the RDO history.
+ */
+static constexpr unsigned int RDO_MAX_LEFT_BLOCKS { 5 };
+
+/**
+ * @brief The number of candidate encodings to collect per block for RDO block selection.
+ */
+static constexpr unsigned int RDO_CANDIDATE_LIMIT { 8 };
+
+/**
+ * @brief Select the encoding for a block that minimizes the rate-distortion cost.
+ *
+ * Candidates are the encodings collected in @c tmpbuf.candidates by @c compress_block(), the
+ * encodings of the blocks in the history, and for the first @c neighbor_count history blocks the
+ * encodings that reuse either the endpoints or the weights of that block. Rate is estimated as the
+ * cost of storing the encoding with an LZ-style compressor that can reference the history. The
+ * selected encoding replaces the contents of @c pcb.
+ *
+ * The history must only depend on the position of the block in the image, and not on the order
+ * blocks are processed in, so that the output does not depend on the thread count.
+ *
+ * @param         ctx              The compressor context and configuration.
+ * @param         blk              The image block color data to compress.
+ * @param         tmpbuf           The compressor scratch buffers used for this block.
+ * @param         history          The neighboring physical blocks, closest first.
+ * @param         history_count    The number of blocks in @c history.
+ * @param         neighbor_count   The number of blocks at the start of @c history to try reusing
+ *                                 the endpoints and weights of.
+ * @param[in,out] pcb              The physical compressed block output.
+ */
+void rate_distortion_select_block(
+	const astcenc_context& ctx,
+	const image_block& blk,
+	const compression_working_buffers& tmpbuf,
+	const uint8_t* history,
+	unsigned int history_count,
+	unsigned int neighbor_count,
+	physical_compressed_block& pcb);
+
 /**
  * @brief Compute the error between a symbolic block and the original input data.
  *
  * In RGBM mode this will reject blocks that attempt to encode a zero M value.
  *
- * @param config   The compressor config.
- * @param bsd      The block size information.
- * @param scb      The symbolic compressed encoding.
- * @param blk      The original image block color data.
- * @param ewb      The error weight block data.
+ * The error is accumulated a SIMD vector of texels at a time, and the computation may stop early
+ * once the running total exceeds @c error_limit, as the caller will reject the encoding anyway.
  *
- * @return Returns the computed error, or a negative value if the encoding
- *         should be rejected for any reason.
+ * @param config        The compressor config.
+ * @param bsd           The block size information.
+ * @param scb           The symbolic compressed encoding.
+ * @param blk           The original image block color data.
+ * @param ewb           The error weight block data.
+ * @param error_limit   The error above which the computation may return a partial error.
+ *
+ * @return Returns the computed error, a partial error greater than @c error_limit, or a negative
+ *         value if the encoding should be rejected for any reason.
  */
 float compute_symbolic_block_difference(
 	const astcenc_config& config,
 	const block_size_descriptor& bsd,
 	const symbolic_compressed_block& scb,
 	const image_block& blk,
-	const error_weight_block& ewb) ;
+	const error_weight_block& ewb,
+	float error_limit);
 
 /**
  * @brief Convert a symbolic representation into a binary physical encoding.
@@ -2274,6 +3014,22 @@ void symbolic_to_physical(
 	const symbolic_compressed_block& scb,
 	physical_compressed_block& pcb);
 
+/**
+ * @brief Convert the header of a binary physical encoding into a symbolic representation.
+ *
+ * This decodes and validates the block mode, partitioning, and color endpoint formats, but does not
+ * unpack the weights or the color endpoint values. This function can cope with arbitrary input
+ * data; output blocks will be flagged as an error block if the encoding is invalid.
+ *
+ * @param      bsd   The block size information.
+ * @param      pcb   The binary encoded data.
+ * @param[out] scb   The output symbolic representation.
+ */
+void physical_to_symbolic_header(
+	const block_size_descriptor& bsd,
+	const physical_compressed_block& pcb,
+	symbolic_compressed_block& scb);
+
 /**
  * @brief Convert a binary physical encoding into a symbolic representation.
  *
@@ -2289,6 +3045,45 @@ void physical_to_symbolic(
 	const physical_compressed_block& pcb,
 	symbolic_compressed_block& scb);
 
+/**
+ * @brief Split an array of physical blocks into separate field streams.
+ *
+ * The output is a 16 byte header, storing the byte length of each stream as a little-endian
+ * 32-bit value, followed by the mode, partition index, endpoint, and weight streams.
+ *
+ * @param      is_3d         True if the blocks use a 3D block size.
+ * @param      data          The physical blocks.
+ * @param      block_count   The number of blocks in @c data.
+ * @param[out] stream        The output buffer, which must be at least
+ *                           @c ASTCENC_BLOCK_STREAM_HEADER_SIZE bytes, plus
+ *                           @c ASTCENC_BLOCK_STREAM_MAX_BLOCK_SIZE bytes per block.
+ *
+ * @return The number of bytes written to @c stream.
+ */
+size_t block_stream_split(
+	bool is_3d,
+	const uint8_t* data,
+	size_t block_count,
+	uint8_t* stream);
+
+/**
+ * @brief Reassemble an array of physical blocks from separate field streams.
+ *
+ * @param      is_3d         True if the blocks use a 3D block size.
+ * @param      stream        The split streams, as written by @c block_stream_split().
+ * @param      stream_len    The length of @c stream in bytes.
+ * @param      block_count   The number of blocks to reassemble.
+ * @param[out] data          The output physical blocks.
+ *
+ * @return True on success, false if the streams are truncated or corrupt.
+ */
+bool block_stream_merge(
+	bool is_3d,
+	const uint8_t* stream,
+	size_t stream_len,
+	size_t block_count,
+	uint8_t* data);
+
 /* ============================================================================
 Platform-specific functions.
 ============================================================================ */
@@ -21,6 +21,8 @@
 
 #include "astcenc_internal.h"
 
+#include <thread>
+
 /**
  * @brief Generate a canonical representation of a partition pattern.
  *
@@ -356,9 +358,20 @@ static void generate_one_partition_info_entry(
 	}
 }
 
+/**
+ * @brief Lazy partition table entry build states.
+ */
+enum partition_build_state : uint8_t
+{
+	PARTITION_NOT_BUILT = 0,
+	PARTITION_BUILDING = 1,
+	PARTITION_BUILT = 2
+};
+
 /* See header for documentation. */
 void init_partition_tables(
-	block_size_descriptor& bsd
+	block_size_descriptor& bsd,
+	bool lazy
 ) {
 	partition_info *par_tab2 = bsd.partitions;
 	partition_info *par_tab3 = par_tab2 + BLOCK_MAX_PARTITIONINGS;
@@ -366,6 +379,19 @@ void init_partition_tables(
 	partition_info *par_tab1 = par_tab4 + BLOCK_MAX_PARTITIONINGS;
 
 	generate_one_partition_info_entry(bsd, 1, 0, *par_tab1);
+
+	bsd.partition_build_state = nullptr;
+	if (lazy)
+	{
+		bsd.partition_build_state = new std::atomic<uint8_t>[3 * BLOCK_MAX_PARTITIONINGS];
+		for (unsigned int i = 0; i < 3 * BLOCK_MAX_PARTITIONINGS; i++)
+		{
+			bsd.partition_build_state[i].store(PARTITION_NOT_BUILT, std::memory_order_relaxed);
+		}
+
+		return;
+	}
+
 	for (int i = 0; i < 1024; i++)
 	{
 		generate_one_partition_info_entry(bsd, 2, i, par_tab2[i]);
@@ -377,3 +403,41 @@ void init_partition_tables(
 	remove_duplicate_partitionings(bsd.texel_count, par_tab3);
 	remove_duplicate_partitionings(bsd.texel_count, par_tab4);
 }
+
+/* See header for documentation. */
+const partition_info& get_lazy_partition_info(
+	const block_size_descriptor& bsd,
+	unsigned int partition_count,
+	unsigned int index
+) {
+	const partition_info& pi = bsd.get_partition_info(partition_count, index);
+	if (!bsd.partition_build_state || partition_count == 1)
+	{
+		return pi;
+	}
+
+	std::atomic<uint8_t>& state = bsd.partition_build_state[(partition_count - 2) * BLOCK_MAX_PARTITIONINGS + index];
+	if (state.load(std::memory_order_acquire) == PARTITION_BUILT)
+	{
+		return pi;
+	}
+
+	// The first thread to use an entry builds it; any others wait for it to finish
+	uint8_t expected = PARTITION_NOT_BUILT;
+	if (state.compare_exchange_strong(expected, PARTITION_BUILDING, std::memory_order_acquire))
+	{
+		// Lazy entries are owned by the table rather than the const descriptor users
+		partition_info& mpi = const_cast<partition_info&>(pi);
+		generate_one_partition_info_entry(bsd, partition_count, index, mpi);
+		state.store(PARTITION_BUILT, std::memory_order_release);
+	}
+	else
+	{
+		while (state.load(std::memory_order_acquire) != PARTITION_BUILT)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	return pi;
+}
@@ -47,6 +47,33 @@
 
 #include <assert.h>
 
+/**
+ * @brief The baseline quantization error for each color quant level, for a full 16-bit range.
+ */
+static const float baseline_quant_error[21] {
+	(65536.0f * 65536.0f / 18.0f),				// 2 values, 1 step
+	(65536.0f * 65536.0f / 18.0f) / (2 * 2),	// 3 values, 2 steps
+	(65536.0f * 65536.0f / 18.0f) / (3 * 3),	// 4 values, 3 steps
+	(65536.0f * 65536.0f / 18.0f) / (4 * 4),	// 5 values
+	(65536.0f * 65536.0f / 18.0f) / (5 * 5),
+	(65536.0f * 65536.0f / 18.0f) / (7 * 7),
+	(65536.0f * 65536.0f / 18.0f) / (9 * 9),
+	(65536.0f * 65536.0f / 18.0f) / (11 * 11),
+	(65536.0f * 65536.0f / 18.0f) / (15 * 15),
+	(65536.0f * 65536.0f / 18.0f) / (19 * 19),
+	(65536.0f * 65536.0f / 18.0f) / (23 * 23),
+	(65536.0f * 65536.0f / 18.0f) / (31 * 31),
+	(65536.0f * 65536.0f / 18.0f) / (39 * 39),
+	(65536.0f * 65536.0f / 18.0f) / (47 * 47),
+	(65536.0f * 65536.0f / 18.0f) / (63 * 63),
+	(65536.0f * 65536.0f / 18.0f) / (79 * 79),
+	(65536.0f * 65536.0f / 18.0f) / (95 * 95),
+	(65536.0f * 65536.0f / 18.0f) / (127 * 127),
+	(65536.0f * 65536.0f / 18.0f) / (159 * 159),
+	(65536.0f * 65536.0f / 18.0f) / (191 * 191),
+	(65536.0f * 65536.0f / 18.0f) / (255 * 255)
+};
+
 /**
  * @brief Compute cumulative error weight of each partition.
  *
@@ -293,6 +320,67 @@ static void compute_encoding_choice_errors(
 	}
 }
 
+/**
+ * @brief For a given partitioning of an LDR luminance-alpha block determine endpoint encode errors.
+ *
+ * This is a specialized variant of @c compute_encoding_choice_errors() for luminance-alpha blocks.
+ * The color data lies on the gray axis, so both the same chroma and the luminance line fit the RGB
+ * data exactly and the only encoding choice error that needs computing is the cost of discarding
+ * alpha.
+ *
+ * @param      blk   The image block.
+ * @param      pi    The partition info data.
+ * @param      ewb   The error weight block.
+ * @param      ep    The idealized endpoints.
+ * @param[out] eci   The resulting encoding choice error metrics.
+ */
+static void compute_encoding_choice_errors_luminance_alpha(
+	const image_block& blk,
+	const partition_info& pi,
+	const error_weight_block& ewb,
+	const endpoints& ep,
+	encoding_choice_errors eci[BLOCK_MAX_PARTITIONS]
+) {
+	int partition_count = pi.partition_count;
+	promise(partition_count > 0);
+
+	float default_alpha = blk.get_default_alpha();
+
+	for (int i = 0; i < partition_count; i++)
+	{
+		float alpha_drop_error = 0.0f;
+
+		int texels_in_partition = pi.partition_texel_count[i];
+		promise(texels_in_partition > 0);
+
+		for (int j = 0; j < texels_in_partition; j++)
+		{
+			int tix = pi.texels_of_partition[i][j];
+			float omalpha = blk.data_a[tix] - default_alpha;
+			alpha_drop_error += omalpha * omalpha * ewb.texel_weight_a[tix];
+		}
+
+		// Determine if we can offset encode RGB lanes
+		vfloat4 endpt0 = ep.endpt0[i];
+		vfloat4 endpt1 = ep.endpt1[i];
+		float endpt_diff = astc::fabs(endpt1.lane<0>() - endpt0.lane<0>());
+		bool can_offset_encode = endpt_diff < (0.12f * 65535.0f);
+
+		// Determine if we can blue contract encode RGB lanes; R == B so this is a simple range test
+		bool can_blue_contract = (endpt0.lane<0>() > (0.01f * 65535.0f)) &&
+		                         (endpt0.lane<0>() < (0.99f * 65535.0f)) &&
+		                         (endpt1.lane<0>() > (0.01f * 65535.0f)) &&
+		                         (endpt1.lane<0>() < (0.99f * 65535.0f));
+
+		eci[i].rgb_scale_error = 0.0f;
+		eci[i].rgb_luma_error = 0.0f;
+		eci[i].luminance_error = 0.0f;
+		eci[i].alpha_drop_error = alpha_drop_error * 3.0f;
+		eci[i].can_offset_encode = can_offset_encode;
+		eci[i].can_blue_contract = can_blue_contract;
+	}
+}
+
 /**
  * @brief For a given partition compute the error for every endpoint integer count and quant level.
  *
@@ -319,30 +407,6 @@ static void compute_color_error_for_every_integer_count_and_quant_level(
 ) {
 	int partition_size = pi.partition_texel_count[partition_index];
 
-	static const float baseline_quant_error[21] {
-		(65536.0f * 65536.0f / 18.0f),				// 2 values, 1 step
-		(65536.0f * 65536.0f / 18.0f) / (2 * 2),	// 3 values, 2 steps
-		(65536.0f * 65536.0f / 18.0f) / (3 * 3),	// 4 values, 3 steps
-		(65536.0f * 65536.0f / 18.0f) / (4 * 4),	// 5 values
-		(65536.0f * 65536.0f / 18.0f) / (5 * 5),
-		(65536.0f * 65536.0f / 18.0f) / (7 * 7),
-		(65536.0f * 65536.0f / 18.0f) / (9 * 9),
-		(65536.0f * 65536.0f / 18.0f) / (11 * 11),
-		(65536.0f * 65536.0f / 18.0f) / (15 * 15),
-		(65536.0f * 65536.0f / 18.0f) / (19 * 19),
-		(65536.0f * 65536.0f / 18.0f) / (23 * 23),
-		(65536.0f * 65536.0f / 18.0f) / (31 * 31),
-		(65536.0f * 65536.0f / 18.0f) / (39 * 39),
-		(65536.0f * 65536.0f / 18.0f) / (47 * 47),
-		(65536.0f * 65536.0f / 18.0f) / (63 * 63),
-		(65536.0f * 65536.0f / 18.0f) / (79 * 79),
-		(65536.0f * 65536.0f / 18.0f) / (95 * 95),
-		(65536.0f * 65536.0f / 18.0f) / (127 * 127),
-		(65536.0f * 65536.0f / 18.0f) / (159 * 159),
-		(65536.0f * 65536.0f / 18.0f) / (191 * 191),
-		(65536.0f * 65536.0f / 18.0f) / (255 * 255)
-	};
-
 	vfloat4 ep0 = ep.endpt0[partition_index];
 	vfloat4 ep1 = ep.endpt1[partition_index];
 
@@ -661,6 +725,162 @@ static void compute_color_error_for_every_integer_count_and_quant_level(
 	}
 }
 
+/**
+ * @brief For a luminance partition compute the error for every endpoint integer count and quant level.
+ *
+ * This is a specialized variant of @c compute_color_error_for_every_integer_count_and_quant_level()
+ * for LDR luminance blocks with constant 1.0 alpha, which only allows the L+L endpoint format. All
+ * other encoding choice errors are zero for these blocks, so only the quantization and range
+ * errors need computing.
+ *
+ * @param      partition_index    The partition index.
+ * @param      pi                 The partition info.
+ * @param      ep                 The idealized endpoints.
+ * @param      error_weight       The resulting encoding choice error metrics.
+ * @param[out] best_error         The best error for each integer count and quant level.
+ * @param[out] format_of_choice   The preferred endpoint format for each integer count and quant level.
+ */
+static void compute_color_error_for_every_integer_count_and_quant_level_luminance(
+	int partition_index,
+	const partition_info& pi,
+	const endpoints& ep,
+	vfloat4 error_weight,
+	float best_error[21][4],
+	int format_of_choice[21][4]
+) {
+	int partition_size = pi.partition_texel_count[partition_index];
+
+	vfloat4 ep0 = ep.endpt0[partition_index];
+	vfloat4 ep1 = ep.endpt1[partition_index];
+
+	// It is possible to get endpoint colors significantly outside [0,upper-limit] even if the
+	// input data are safely contained in [0,upper-limit]; we need to add an error term for this
+	vfloat4 ep0_range_error_high = max(ep0 - 65535.0f, 0.0f);
+	vfloat4 ep1_range_error_high = max(ep1 - 65535.0f, 0.0f);
+
+	vfloat4 ep0_range_error_low = min(ep0, 0.0f);
+	vfloat4 ep1_range_error_low = min(ep1, 0.0f);
+
+	vfloat4 sum_range_error =
+		(ep0_range_error_low * ep0_range_error_low) +
+		(ep1_range_error_low * ep1_range_error_low) +
+		(ep0_range_error_high * ep0_range_error_high) +
+		(ep1_range_error_high * ep1_range_error_high);
+
+	float rgb_range_error = dot3_s(sum_range_error, error_weight)
+	                      * 0.5f * static_cast<float>(partition_size);
+
+	float base_quant_error_rgb = hadd_rgb_s(error_weight) * static_cast<float>(partition_size);
+
+	for (int i = 0; i < 21; i++)
+	{
+		best_error[i][3] = ERROR_CALC_DEFAULT;
+		best_error[i][2] = ERROR_CALC_DEFAULT;
+		best_error[i][1] = ERROR_CALC_DEFAULT;
+		best_error[i][0] = ERROR_CALC_DEFAULT;
+
+		format_of_choice[i][3] = FMT_RGBA;
+		format_of_choice[i][2] = FMT_RGB;
+		format_of_choice[i][1] = FMT_LUMINANCE_ALPHA;
+		format_of_choice[i][0] = FMT_LUMINANCE;
+
+		if (i < 4)
+		{
+			continue;
+		}
+
+		// 2 integers can encode as L+L
+		best_error[i][0] = base_quant_error_rgb * baseline_quant_error[i]
+		                 + rgb_range_error;
+	}
+}
+
+/**
+ * @brief For a normal map partition compute the error for every endpoint integer count and quant level.
+ *
+ * This is a specialized variant of @c compute_color_error_for_every_integer_count_and_quant_level()
+ * for LDR luminance-alpha blocks compressed with @c ASTCENC_FLG_MAP_NORMAL, which only allows the
+ * endpoint formats that store both normal components: LA+LA, and RGBA+RGBA with the luminance
+ * replicated into RGB. The RGBA format is kept because offset and blue-contract encoding give it
+ * more precision than LA+LA for blocks with a small range.
+ *
+ * @param      partition_index    The partition index.
+ * @param      pi                 The partition info.
+ * @param      eci                The encoding choice error metrics.
+ * @param      ep                 The idealized endpoints.
+ * @param      error_weight       The resulting encoding choice error metrics.
+ * @param[out] best_error         The best error for each integer count and quant level.
+ * @param[out] format_of_choice   The preferred endpoint format for each integer count and quant level.
+ */
+static void compute_color_error_for_every_integer_count_and_quant_level_normal_xy(
+	int partition_index,
+	const partition_info& pi,
+	const encoding_choice_errors& eci,
+	const endpoints& ep,
+	vfloat4 error_weight,
+	float best_error[21][4],
+	int format_of_choice[21][4]
+) {
+	int partition_size = pi.partition_texel_count[partition_index];
+
+	vfloat4 ep0 = ep.endpt0[partition_index];
+	vfloat4 ep1 = ep.endpt1[partition_index];
+
+	// It is possible to get endpoint colors significantly outside [0,upper-limit] even if the
+	// input data are safely contained in [0,upper-limit]; we need to add an error term for this
+	vfloat4 ep0_range_error_high = max(ep0 - 65535.0f, 0.0f);
+	vfloat4 ep1_range_error_high = max(ep1 - 65535.0f, 0.0f);
+
+	vfloat4 ep0_range_error_low = min(ep0, 0.0f);
+	vfloat4 ep1_range_error_low = min(ep1, 0.0f);
+
+	vfloat4 sum_range_error =
+		(ep0_range_error_low * ep0_range_error_low) +
+		(ep1_range_error_low * ep1_range_error_low) +
+		(ep0_range_error_high * ep0_range_error_high) +
+		(ep1_range_error_high * ep1_range_error_high);
+
+	float range_error = dot_s(sum_range_error, error_weight)
+	                  * 0.5f * static_cast<float>(partition_size);
+
+	float base_quant_error = hadd_s(error_weight) * static_cast<float>(partition_size);
+
+	float error_scale_bc = eci.can_blue_contract ? 0.625f : 1.0f;
+	float error_scale_oe = eci.can_offset_encode ? 0.5f : 1.0f;
+
+	for (int i = 0; i < 21; i++)
+	{
+		best_error[i][3] = ERROR_CALC_DEFAULT;
+		best_error[i][2] = ERROR_CALC_DEFAULT;
+		best_error[i][1] = ERROR_CALC_DEFAULT;
+		best_error[i][0] = ERROR_CALC_DEFAULT;
+
+		format_of_choice[i][3] = FMT_RGBA;
+		format_of_choice[i][2] = FMT_RGB;
+		format_of_choice[i][1] = FMT_LUMINANCE_ALPHA;
+		format_of_choice[i][0] = FMT_LUMINANCE;
+
+		if (i < 4)
+		{
+			continue;
+		}
+
+		// Offset encoding not possible at higher quant levels
+		if (i == 19)
+		{
+			error_scale_oe = 1.0f;
+		}
+
+		float quant_error = base_quant_error * baseline_quant_error[i];
+
+		// 8 integers can encode as RGBA+RGBA, with the luminance replicated into RGB
+		best_error[i][3] = quant_error * error_scale_bc * error_scale_oe + range_error;
+
+		// 4 integers can encode as LA+LA
+		best_error[i][1] = quant_error + range_error;
+	}
+}
+
 /**
  * @brief For one partition compute the best format and quantization for a given bit count.
  *
@@ -1100,6 +1320,7 @@ unsigned int compute_ideal_endpoint_formats(
 	const int* qwt_bitcounts,
 	const float* qwt_errors,
 	unsigned int tune_candidate_limit,
+	bool is_normal_map,
 	// output data
 	int partition_format_specifiers[TUNE_MAX_TRIAL_CANDIDATES][BLOCK_MAX_PARTITIONS],
 	int block_mode[TUNE_MAX_TRIAL_CANDIDATES],
@@ -1116,8 +1337,20 @@ unsigned int compute_ideal_endpoint_formats(
 
 	// Compute the errors that result from various encoding choices (such as using luminance instead
 	// of RGB, discarding Alpha, using RGB-scale in place of two separate RGB endpoints and so on)
+	// LDR luminance blocks are restricted to the L+L endpoint format, so skip this entirely
+	bool is_luminance = blk.is_ldr_luminance();
+	bool is_luminancealpha = blk.is_ldr_luminancealpha();
+	bool is_normal_xy = is_normal_map && is_luminancealpha;
+
 	encoding_choice_errors eci[BLOCK_MAX_PARTITIONS];
-	compute_encoding_choice_errors(bsd, blk, pi, ewb, ep, eci);
+	if (is_luminancealpha)
+	{
+		compute_encoding_choice_errors_luminance_alpha(blk, pi, ewb, ep, eci);
+	}
+	else if (!is_luminance)
+	{
+		compute_encoding_choice_errors(bsd, blk, pi, ewb, ep, eci);
+	}
 
 	// For each partition, compute the error weights to apply for that partition
 	vfloat4 error_weights[BLOCK_MAX_PARTITIONS];
@@ -1128,10 +1361,23 @@ unsigned int compute_ideal_endpoint_formats(
 	int format_of_choice[BLOCK_MAX_PARTITIONS][21][4];
 	for (int i = 0; i < partition_count; i++)
 	{
-		compute_color_error_for_every_integer_count_and_quant_level(
-		    encode_hdr_rgb, encode_hdr_alpha, i,
-		    pi, eci[i], ep, error_weights[i], best_error[i],
-		    format_of_choice[i]);
+		if (is_luminance)
+		{
+			compute_color_error_for_every_integer_count_and_quant_level_luminance(
+			    i, pi, ep, error_weights[i], best_error[i], format_of_choice[i]);
+		}
+		else if (is_normal_xy)
+		{
+			compute_color_error_for_every_integer_count_and_quant_level_normal_xy(
+			    i, pi, eci[i], ep, error_weights[i], best_error[i], format_of_choice[i]);
+		}
+		else
+		{
+			compute_color_error_for_every_integer_count_and_quant_level(
+			    encode_hdr_rgb, encode_hdr_alpha, i,
+			    pi, eci[i], ep, error_weights[i], best_error[i],
+			    format_of_choice[i]);
+		}
 	}
 
 	alignas(ASTCENC_VECALIGN) float errors_of_best_combination[WEIGHTS_MAX_BLOCK_MODES];
@@ -0,0 +1,459 @@
+// SPDX-License-Identifier: Apache-2.0
+// ----------------------------------------------------------------------------
+// Copyright 2021 Arm Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy
+// of the License at:
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+// ----------------------------------------------------------------------------
+
+#if !defined(ASTCENC_DECOMPRESS_ONLY)
+
+/**
+ * @brief Functions for rate-distortion optimized block selection.
+ *
+ * Compressed ASTC data is normally packed with a general purpose LZ-style lossless compressor for
+ * storage and distribution. Encodings picked purely for minimum error look close to random to these
+ * compressors, so this module picks among the candidate encodings found by the compressor search,
+ * the encodings of neighboring blocks, and encodings that reuse the endpoints or the weights of the
+ * blocks to the left and above, to minimize the rate-distortion cost:
+ *
+ *     J = D + lambda * R
+ *
+ * ... where D is the per-texel error of the encoding, and R is an estimate of the number of bits
+ * needed to store the encoding given the neighboring blocks as an LZ dictionary.
+ *
+ * Reusing endpoints keeps the block mode, partitioning, and color bits of the neighbor, and refits
+ * the weights, so the low bits of the encoding match the neighbor. Reusing weights keeps the block
+ * mode, partitioning, and weight bits, and refits the endpoint colors, so the high bits match.
+ */
+
+#include "astcenc_internal.h"
+
+#include <cstring>
+
+/**
+ * @brief The estimated cost of an LZ match, in bits.
+ */
+static constexpr float RDO_MATCH_BITS { 16.0f };
+
+/**
+ * @brief The minimum length of a byte run that is worth coding as an LZ match.
+ */
+static constexpr unsigned int RDO_MIN_MATCH_BYTES { 3 };
+
+/**
+ * @brief Estimate the cost of storing a block given a history of neighboring blocks.
+ *
+ * This is a simple model of an LZ compressor. Bytes are either coded as 8-bit literals, or as part
+ * of a match against the same byte position in a previous block. As ASTC blocks are 16 byte
+ * aligned matches at the same position are the common case for real-world LZ compressors.
+ *
+ * @param block           The physical block to cost.
+ * @param history         The neighboring physical blocks.
+ * @param history_count   The number of blocks in @c history.
+ *
+ * @return The estimated cost in bits.
+ */
+static float estimate_block_bits(
+	const uint8_t* block,
+	const uint8_t* history,
+	unsigned int history_count
+) {
+	float best_bits = 128.0f;
+
+	for (unsigned int i = 0; i < history_count; i++)
+	{
+		const uint8_t* ref = history + 16 * i;
+
+		float bits = 0.0f;
+		unsigned int run = 0;
+		for (unsigned int j = 0; j < 16; j++)
+		{
+			if (block[j] == ref[j])
+			{
+				run++;
+				continue;
+			}
+
+			bits += (run >= RDO_MIN_MATCH_BYTES) ? RDO_MATCH_BITS : 8.0f * static_cast<float>(run);
+			bits += 8.0f;
+			run = 0;
+		}
+
+		bits += (run >= RDO_MIN_MATCH_BYTES) ? RDO_MATCH_BITS : 8.0f * static_cast<float>(run);
+		best_bits = astc::min(bits, best_bits);
+	}
+
+	return best_bits;
+}
+
+/**
+ * @brief Get the error weight of a texel.
+ *
+ * @param ewb     The error weight block data.
+ * @param texel   The texel index.
+ *
+ * @return The per component error weight.
+ */
+static vfloat4 get_texel_error_weight(
+	const error_weight_block& ewb,
+	unsigned int texel
+) {
+	return ewb.is_uniform ? ewb.uniform_error_weight : ewb.error_weights[texel];
+}
+
+/**
+ * @brief Compute the error between a UNORM16 constant color block and the original input data.
+ *
+ * @param bsd   The block size information.
+ * @param scb   The symbolic compressed encoding.
+ * @param blk   The original image block color data.
+ * @param ewb   The error weight block data.
+ *
+ * @return The computed error.
+ */
+static float compute_constant_block_difference(
+	const block_size_descriptor& bsd,
+	const symbolic_compressed_block& scb,
+	const image_block& blk,
+	const error_weight_block& ewb
+) {
+	vfloat4 color = int_to_float(vint4(scb.constant_color));
+
+	vfloat4 summav = vfloat4::zero();
+	for (unsigned int i = 0; i < bsd.texel_count; i++)
+	{
+		vfloat4 diff = blk.texel(i) - color;
+		summav += diff * diff * get_texel_error_weight(ewb, i);
+	}
+
+	return hadd_s(summav);
+}
+
+/**
+ * @brief Refit the weights of a single plane encoding to a block, keeping its endpoints.
+ *
+ * Each texel is projected onto the decoded endpoint line of its partition, and the resulting ideal
+ * weights are decimated and quantized using the block mode of the encoding.
+ *
+ * @param         profile   The color profile.
+ * @param         bsd       The block size information.
+ * @param         blk       The image block color data to compress.
+ * @param         ewb       The error weight block data.
+ * @param[in,out] scb       The symbolic encoding to refit.
+ *
+ * @return @c true if the encoding was refit, @c false if the encoding is not supported.
+ */
+static bool refit_weights_for_endpoints(
+	astcenc_profile profile,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	symbolic_compressed_block& scb
+) {
+	const block_mode& bm = bsd.get_block_mode(scb.block_mode);
+	if (bm.is_dual_plane)
+	{
+		return false;
+	}
+
+	const auto& pi = bsd.get_partition_info(scb.partition_count, scb.partition_index);
+	const auto& di = bsd.get_decimation_info(bm.decimation_mode);
+
+	vfloat4 endpt0[BLOCK_MAX_PARTITIONS];
+	vfloat4 endpt_delta[BLOCK_MAX_PARTITIONS];
+	for (unsigned int i = 0; i < scb.partition_count; i++)
+	{
+		bool rgb_hdr;
+		bool alpha_hdr;
+		vint4 ep0;
+		vint4 ep1;
+		unpack_color_endpoints(profile, scb.color_formats[i], scb.get_color_quant_mode(),
+		                       scb.color_values[i], rgb_hdr, alpha_hdr, ep0, ep1);
+
+		endpt0[i] = int_to_float(ep0);
+		endpt_delta[i] = int_to_float(ep1) - endpt0[i];
+	}
+
+	endpoints_and_weights ei;
+	ei.is_constant_weight_error_scale = false;
+	ei.ep.partition_count = scb.partition_count;
+
+	unsigned int texel_count = bsd.texel_count;
+	for (unsigned int i = 0; i < texel_count; i++)
+	{
+		unsigned int partition = pi.partition_of_texel[i];
+		vfloat4 weight = get_texel_error_weight(ewb, i);
+		vfloat4 delta = endpt_delta[partition];
+
+		float length_squared = hadd_s(delta * delta * weight);
+		float param = 0.0f;
+		if (length_squared > 1e-10f)
+		{
+			param = hadd_s((blk.texel(i) - endpt0[partition]) * delta * weight) / length_squared;
+		}
+
+		ei.weights[i] = astc::clamp1f(param);
+		ei.weight_error_scale[i] = length_squared;
+	}
+
+	// Zero initialize any SIMD over-fetch
+	unsigned int texel_count_simd = round_up_to_simd_multiple_vla(texel_count);
+	for (unsigned int i = texel_count; i < texel_count_simd; i++)
+	{
+		ei.weights[i] = 0.0f;
+		ei.weight_error_scale[i] = 0.0f;
+	}
+
+	endpoints_and_weights eix;
+	alignas(ASTCENC_VECALIGN) float dec_weights_ideal_value[BLOCK_MAX_WEIGHTS];
+	alignas(ASTCENC_VECALIGN) float dec_weights_ideal_sig[BLOCK_MAX_WEIGHTS];
+	alignas(ASTCENC_VECALIGN) float dec_weights_quant_uvalue[BLOCK_MAX_WEIGHTS];
+	alignas(ASTCENC_VECALIGN) uint8_t dec_weights_quant_pvalue[BLOCK_MAX_WEIGHTS];
+
+	compute_ideal_weights_for_decimation(ei, eix, di, dec_weights_ideal_value, dec_weights_ideal_sig);
+	compute_quantized_weights_for_decimation(di, 0.0f, 1.0f, dec_weights_ideal_value,
+	                                         dec_weights_quant_uvalue, dec_weights_quant_pvalue,
+	                                         bm.get_weight_quant_mode());
+
+	std::memcpy(scb.weights, dec_weights_quant_pvalue, di.weight_count);
+	return true;
+}
+
+/**
+ * @brief Refit the endpoints of a single plane encoding to a block, keeping its weights.
+ *
+ * The endpoints are requantized using the endpoint formats and quantization of the encoding. The
+ * refit fails if the packed endpoints need a format with a different size, as the encoding would no
+ * longer have the same number of color bits.
+ *
+ * @param         profile   The color profile.
+ * @param         bsd       The block size information.
+ * @param         blk       The image block color data to compress.
+ * @param         ewb       The error weight block data.
+ * @param[in,out] scb       The symbolic encoding to refit.
+ *
+ * @return @c true if the encoding was refit, @c false if the encoding is not supported.
+ */
+static bool refit_endpoints_for_weights(
+	astcenc_profile profile,
+	const block_size_descriptor& bsd,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	symbolic_compressed_block& scb
+) {
+	const block_mode& bm = bsd.get_block_mode(scb.block_mode);
+	if (bm.is_dual_plane)
+	{
+		return false;
+	}
+
+	unsigned int partition_count = scb.partition_count;
+	const auto& pi = bsd.get_partition_info(partition_count, scb.partition_index);
+	const auto& di = bsd.get_decimation_info(bm.decimation_mode);
+
+	// The current endpoints are the fallback for partitions with degenerate weights
+	endpoints ep;
+	ep.partition_count = partition_count;
+	for (unsigned int i = 0; i < partition_count; i++)
+	{
+		bool rgb_hdr;
+		bool alpha_hdr;
+		vint4 ep0;
+		vint4 ep1;
+		unpack_color_endpoints(profile, scb.color_formats[i], scb.get_color_quant_mode(),
+		                       scb.color_values[i], rgb_hdr, alpha_hdr, ep0, ep1);
+
+		ep.endpt0[i] = int_to_float(ep0);
+		ep.endpt1[i] = int_to_float(ep1);
+	}
+
+	alignas(ASTCENC_VECALIGN) uint8_t weights[BLOCK_MAX_WEIGHTS];
+	std::memcpy(weights, scb.weights, BLOCK_MAX_WEIGHTS);
+
+	vfloat4 rgbs_colors[BLOCK_MAX_PARTITIONS];
+	vfloat4 rgbo_colors[BLOCK_MAX_PARTITIONS];
+	recompute_ideal_colors_1plane(blk, ewb, pi, di, bm.get_weight_quant_mode(), weights, ep,
+	                              rgbs_colors, rgbo_colors);
+
+	for (unsigned int i = 0; i < partition_count; i++)
+	{
+		uint8_t format = pack_color_endpoints(ep.endpt0[i], ep.endpt1[i],
+		                                      rgbs_colors[i], rgbo_colors[i],
+		                                      scb.color_formats[i], scb.color_values[i],
+		                                      scb.get_color_quant_mode());
+
+		// The format class sets the number of color integers, which must not change
+		if ((format >> 2) != (scb.color_formats[i] >> 2))
+		{
+			return false;
+		}
+
+		scb.color_formats[i] = format;
+	}
+
+	// Matched formats are only stored once, so must all still match
+	if (scb.color_formats_matched)
+	{
+		for (unsigned int i = 1; i < partition_count; i++)
+		{
+			if (scb.color_formats[i] != scb.color_formats[0])
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Compute the error of an encoding of a block.
+ *
+ * @param ctx   The compressor context and configuration.
+ * @param blk   The image block color data to compress.
+ * @param ewb   The error weight block data.
+ * @param scb   The symbolic encoding.
+ *
+ * @return The error, or a negative value if the encoding is not usable.
+ */
+static float compute_encoding_error(
+	const astcenc_context& ctx,
+	const image_block& blk,
+	const error_weight_block& ewb,
+	const symbolic_compressed_block& scb
+) {
+	float error;
+	if (scb.block_type == SYM_BTYPE_NONCONST)
+	{
+		error = compute_symbolic_block_difference(ctx.config, *ctx.bsd, scb, blk, ewb,
+		                                          ERROR_CALC_DEFAULT);
+	}
+	else if (scb.block_type == SYM_BTYPE_CONST_U16)
+	{
+		error = compute_constant_block_difference(*ctx.bsd, scb, blk, ewb);
+	}
+	else
+	{
+		return -1.0f;
+	}
+
+	if (error >= ERROR_CALC_DEFAULT)
+	{
+		return -1.0f;
+	}
+
+	return error;
+}
+
+/* See header for documentation. */
+void rate_distortion_select_block(
+	const astcenc_context& ctx,
+	const image_block& blk,
+	const compression_working_buffers& tmpbuf,
+	const uint8_t* history,
+	unsigned int history_count,
+	unsigned int neighbor_count,
+	physical_compressed_block& pcb
+) {
+	const block_size_descriptor& bsd = *ctx.bsd;
+	const block_candidate_list& list = tmpbuf.candidates;
+	const error_weight_block& ewb = tmpbuf.ewb;
+
+	// Constant color blocks are already cheap to store, and skip the error weight setup
+	if (all(blk.data_min == blk.data_max) || list.count == 0)
+	{
+		return;
+	}
+
+	// Normalize the error to a per-texel error in 8-bit units so lambda is independent of the
+	// block size
+	float dist_scale = (255.0f * 255.0f) / (65535.0f * 65535.0f * static_cast<float>(bsd.texel_count));
+	float lambda = ctx.config.rdo_lambda;
+
+	physical_compressed_block best_pcb = pcb;
+	float best_cost = list.candidates[0].error * dist_scale
+	                + lambda * estimate_block_bits(pcb.data, history, history_count);
+
+	// Trial the other candidates found by the compressor search
+	for (unsigned int i = 1; i < list.count; i++)
+	{
+		const astcenc_block_candidate& cand = list.candidates[i];
+		float cost = cand.error * dist_scale
+		           + lambda * estimate_block_bits(cand.data, history, history_count);
+		if (cost < best_cost)
+		{
+			best_cost = cost;
+			std::memcpy(best_pcb.data, cand.data, 16);
+		}
+	}
+
+	for (unsigned int i = 0; i < history_count; i++)
+	{
+		physical_compressed_block ref_pcb;
+		std::memcpy(ref_pcb.data, history + 16 * i, 16);
+
+		symbolic_compressed_block ref_scb;
+		physical_to_symbolic(bsd, ref_pcb, ref_scb);
+
+		// Trial reusing the encoding of a neighboring block; this is nearly free to store
+		float error = compute_encoding_error(ctx, blk, ewb, ref_scb);
+		if (error >= 0.0f)
+		{
+			float cost = error * dist_scale + lambda * RDO_MATCH_BITS;
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_pcb = ref_pcb;
+			}
+		}
+
+		if (i >= neighbor_count || ref_scb.block_type != SYM_BTYPE_NONCONST)
+		{
+			continue;
+		}
+
+		// Trial reusing the endpoints, and then the weights, of the direct neighbors
+		for (unsigned int reuse = 0; reuse < 2; reuse++)
+		{
+			symbolic_compressed_block scb = ref_scb;
+			bool valid = (reuse == 0)
+			           ? refit_weights_for_endpoints(ctx.config.profile, bsd, blk, ewb, scb)
+			           : refit_endpoints_for_weights(ctx.config.profile, bsd, blk, ewb, scb);
+			if (!valid)
+			{
+				continue;
+			}
+
+			error = compute_encoding_error(ctx, blk, ewb, scb);
+			if (error < 0.0f)
+			{
+				continue;
+			}
+
+			physical_compressed_block trial_pcb;
+			symbolic_to_physical(bsd, scb, trial_pcb);
+
+			float cost = error * dist_scale
+			           + lambda * estimate_block_bits(trial_pcb.data, history, history_count);
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_pcb = trial_pcb;
+			}
+		}
+	}
+
+	pcb = best_pcb;
+}
+
+#endif
@@ -264,13 +264,11 @@ void symbolic_to_physical(
 }
 
 /* See header for documentation. */
-void physical_to_symbolic(
+void physical_to_symbolic_header(
 	const block_size_descriptor& bsd,
 	const physical_compressed_block& pcb,
 	symbolic_compressed_block& scb
 ) {
-	uint8_t bswapped[16];
-
 	scb.block_type = SYM_BTYPE_NONCONST;
 
 	// Extract header fields
@@ -362,30 +360,10 @@ void physical_to_symbolic(
 	scb.block_mode = static_cast<uint16_t>(block_mode);
 	scb.partition_count = static_cast<uint8_t>(partition_count);
 
-	for (int i = 0; i < 16; i++)
-	{
-		bswapped[i] = static_cast<uint8_t>(bitrev8(pcb.data[15 - i]));
-	}
-
 	int bits_for_weights = get_ise_sequence_bitcount(real_weight_count, weight_quant_method);
 
 	int below_weights_pos = 128 - bits_for_weights;
 
-	if (is_dual_plane)
-	{
-		uint8_t indices[64];
-		decode_ise(weight_quant_method, real_weight_count, bswapped, indices, 0);
-		for (int i = 0; i < weight_count; i++)
-		{
-			scb.weights[i] = indices[2 * i];
-			scb.weights[i + WEIGHTS_PLANE2_OFFSET] = indices[2 * i + 1];
-		}
-	}
-	else
-	{
-		decode_ise(weight_quant_method, weight_count, bswapped, scb.weights, 0);
-	}
-
 	if (is_dual_plane && partition_count == 4)
 	{
 		scb.block_type = SYM_BTYPE_ERROR;
@@ -478,25 +456,77 @@ void physical_to_symbolic(
 		return;
 	}
 
-	// Unpack the integer color values and assign to endpoints
 	scb.quant_mode = (quant_method)color_quant_level;
+
+	// Fetch component for second-plane in the case of dual plane of weights.
+	if (is_dual_plane)
+	{
+		scb.plane2_component = static_cast<int8_t>(read_bits(2, below_weights_pos - 2, pcb.data));
+	}
+}
+
+/* See header for documentation. */
+void physical_to_symbolic(
+	const block_size_descriptor& bsd,
+	const physical_compressed_block& pcb,
+	symbolic_compressed_block& scb
+) {
+	physical_to_symbolic_header(bsd, pcb, scb);
+	if (scb.block_type != SYM_BTYPE_NONCONST)
+	{
+		return;
+	}
+
+	const auto& bm = bsd.get_block_mode(scb.block_mode);
+	const auto& di = bsd.get_decimation_info(bm.decimation_mode);
+
+	int weight_count = di.weight_count;
+	quant_method weight_quant_method = (quant_method)bm.quant_mode;
+	int is_dual_plane = bm.is_dual_plane;
+
+	int real_weight_count = is_dual_plane ? 2 * weight_count : weight_count;
+
+	// Unpack the weights, which are stored bit-reversed from the top of the block
+	uint8_t bswapped[16];
+	for (int i = 0; i < 16; i++)
+	{
+		bswapped[i] = static_cast<uint8_t>(bitrev8(pcb.data[15 - i]));
+	}
+
+	if (is_dual_plane)
+	{
+		uint8_t indices[64];
+		decode_ise(weight_quant_method, real_weight_count, bswapped, indices, 0);
+		for (int i = 0; i < weight_count; i++)
+		{
+			scb.weights[i] = indices[2 * i];
+			scb.weights[i + WEIGHTS_PLANE2_OFFSET] = indices[2 * i + 1];
+		}
+	}
+	else
+	{
+		decode_ise(weight_quant_method, weight_count, bswapped, scb.weights, 0);
+	}
+
+	// Unpack the integer color values and assign to endpoints
+	int partition_count = scb.partition_count;
+	int color_integer_count = 0;
+	for (int i = 0; i < partition_count; i++)
+	{
+		color_integer_count += 2 * (scb.color_formats[i] >> 2) + 2;
+	}
+
 	uint8_t values_to_decode[32];
-	decode_ise((quant_method)color_quant_level, color_integer_count, pcb.data, values_to_decode, (partition_count == 1 ? 17 : 19 + PARTITION_INDEX_BITS));
+	decode_ise(scb.get_color_quant_mode(), color_integer_count, pcb.data, values_to_decode, (partition_count == 1 ? 17 : 19 + PARTITION_INDEX_BITS));
 
 	int valuecount_to_decode = 0;
 	for (int i = 0; i < partition_count; i++)
 	{
-		int vals = 2 * (color_formats[i] >> 2) + 2;
+		int vals = 2 * (scb.color_formats[i] >> 2) + 2;
 		for (int j = 0; j < vals; j++)
 		{
 			scb.color_values[i][j] = values_to_decode[j + valuecount_to_decode];
 		}
 		valuecount_to_decode += vals;
 	}
-
-	// Fetch component for second-plane in the case of dual plane of weights.
-	if (is_dual_plane)
-	{
-		scb.plane2_component = static_cast<int8_t>(read_bits(2, below_weights_pos - 2, pcb.data));
-	}
 }
@@ -431,25 +431,12 @@ static ASTCENC_SIMD_INLINE vint4 unorm16_to_sf16(vint4 p)
 	vmask4 is_one = p == vint4(0xFFFF);
 	vmask4 is_small = p < vint4(4);
 
-	// Manually inline clz() on Visual Studio to avoid release build codegen bug
-	// see https://github.com/ARM-software/astc-encoder/issues/259
-#if !defined(__clang__) && defined(_MSC_VER)
-	vint4 a = (~lsr<8>(p)) & p;
-	a = float_as_int(int_to_float(a));
-	a = vint4(127 + 31) - lsr<23>(a);
-	vint4 lz = clamp(0, 32, a) - 16;
-#else
-	vint4 lz = clz(p) - 16;
-#endif
-
-	p = p * two_to_the_n(lz + 1);
-	p = p & vint4(0xFFFF);
-
-	p = lsr<6>(p);
-
-	p = p | lsl<10>(vint4(14) - lz);
+	// A 16-bit integer converts to float exactly, so the float exponent gives the position of the
+	// leading one and the mantissa holds the bits below it. Truncating the mantissa to 10 bits and
+	// rebiasing the exponent gives the float16 encoding of p / 65536, without needing a clz().
+	vint4 r = lsr<13>(float_as_int(int_to_float(p))) - vint4(128 << 10);
 
-	vint4 r = select(p, fp16_one, is_one);
+	r = select(r, fp16_one, is_one);
 	r = select(r, fp16_small, is_small);
 	return r;
 }
@@ -462,13 +449,14 @@ static ASTCENC_SIMD_INLINE vint4 lns_to_sf16(vint4 p)
 	vint4 mc = p & 0x7FF;
 	vint4 ec = lsr<11>(p);
 
-	vint4 mc_512 = mc * 3;
+	// Multiplies are written as shifts and adds, as SSE2 has no 32-bit vector multiply
+	vint4 mc_512 = lsl<1>(mc) + mc;
 	vmask4 mask_512 = mc < vint4(512);
 
-	vint4 mc_1536 = mc * 4 - 512;
+	vint4 mc_1536 = lsl<2>(mc) - 512;
 	vmask4 mask_1536 = mc < vint4(1536);
 
-	vint4 mc_else = mc * 5 - 2048;
+	vint4 mc_else = lsl<2>(mc) + mc - 2048;
 
 	vint4 mt = mc_else;
 	mt = select(mt, mc_1536, mask_1536);
@@ -478,6 +466,25 @@ static ASTCENC_SIMD_INLINE vint4 lns_to_sf16(vint4 p)
 	return min(res, vint4(0x7BFF));
 }
 
+/**
+ * @brief Convert a non-negative finite float16 in the range [0, 0x7BFF] to float.
+ *
+ * The UNORM16 and LNS decode paths only generate values in this range, so on targets without
+ * native float16 conversion the sign, infinity, and NaN handling of the generic conversion can be
+ * skipped and the conversion implemented with a few integer operations.
+ */
+static ASTCENC_SIMD_INLINE vfloat4 finite_float16_to_float(vint4 p)
+{
+#if ASTCENC_F16C >= 1 || ASTCENC_NEON != 0
+	return float16_to_float(p);
+#else
+	// Normal values just need the exponent rebiasing; denormals are an exactly scaled integer
+	vfloat4 normal = int_as_float(lsl<13>(p) + vint4((127 - 15) << 23));
+	vfloat4 denormal = int_to_float(p) * (1.0f / 16777216.0f);
+	return select(normal, denormal, p < vint4(0x400));
+#endif
+}
+
 /**
  * @brief Extract mantissa and exponent of a float value.
  *
@@ -965,71 +965,94 @@ ASTCENC_SIMD_INLINE vfloat4 int_to_float(vint4 a)
 }
 
 /**
- * @brief Return a float16 value for a float vector, using round-to-nearest.
+ * @brief Return a float value as an integer bit pattern (i.e. no conversion).
+ *
+ * It is a common trick to convert floats into integer bit patterns, perform
+ * some bit hackery based on knowledge they are IEEE 754 layout, and then
+ * convert them back again. This is the first half of that flip.
  */
-ASTCENC_SIMD_INLINE vint4 float_to_float16(vfloat4 a)
+ASTCENC_SIMD_INLINE vint4 float_as_int(vfloat4 a)
 {
-	return vint4(
-		float_to_sf16(a.lane<0>()),
-		float_to_sf16(a.lane<1>()),
-		float_to_sf16(a.lane<2>()),
-		float_to_sf16(a.lane<3>()));
+	vint4 r;
+	memcpy(r.m, a.m, 4 * 4);
+	return r;
 }
 
 /**
- * @brief Return a float16 value for a float scalar, using round-to-nearest.
+ * @brief Return a integer value as a float bit pattern (i.e. no conversion).
+ *
+ * It is a common trick to convert floats into integer bit patterns, perform
+ * some bit hackery based on knowledge they are IEEE 754 layout, and then
+ * convert them back again. This is the second half of that flip.
  */
-static inline uint16_t float_to_float16(float a)
+ASTCENC_SIMD_INLINE vfloat4 int_as_float(vint4 a)
 {
-	return float_to_sf16(a);
+	vfloat4 r;
+	memcpy(r.m, a.m, 4 * 4);
+	return r;
 }
 
 /**
- * @brief Return a float value for a float16 vector.
+ * @brief Return a float16 value for a float vector, using round-to-nearest.
  */
-ASTCENC_SIMD_INLINE vfloat4 float16_to_float(vint4 a)
+ASTCENC_SIMD_INLINE vint4 float_to_float16(vfloat4 a)
 {
-	return vfloat4(
-		sf16_to_float(a.lane<0>()),
-		sf16_to_float(a.lane<1>()),
-		sf16_to_float(a.lane<2>()),
-		sf16_to_float(a.lane<3>()));
+	vint4 bits = float_as_int(a);
+	vint4 sign = lsr<16>(bits) & vint4(0x8000);
+	vint4 absv = bits & vint4(0x7FFFFFFF);
+
+	// Normal results rebias the exponent and round the mantissa to nearest even
+	vint4 normal = lsr<13>(absv + vint4(static_cast<int>(0xC8000FFF)) + (lsr<13>(absv) & vint4(1)));
+
+	// Denormal results are rounded by the FPU; adding 0.5 scales the ULP to the fp16 denormal ULP
+	vint4 denormal = float_as_int(int_as_float(absv) + vfloat4(0.5f)) - vint4(0x3F000000);
+
+	// NaNs keep the top mantissa bits, and are quietened
+	vint4 nan = (lsr<13>(absv) & vint4(0x3FF)) | vint4(0x7E00);
+
+	vint4 r = select(normal, denormal, absv < vint4(0x38800000));
+	r = select(r, vint4(0x7C00), absv > vint4(0x477FFFFF));
+	r = select(r, nan, absv > vint4(0x7F800000));
+	return r | sign;
 }
 
 /**
- * @brief Return a float value for a float16 scalar.
+ * @brief Return a float16 value for a float scalar, using round-to-nearest.
  */
-ASTCENC_SIMD_INLINE float float16_to_float(uint16_t a)
+static inline uint16_t float_to_float16(float a)
 {
-	return sf16_to_float(a);
+	return static_cast<uint16_t>(float_to_float16(vfloat4(a)).lane<0>());
 }
 
 /**
- * @brief Return a float value as an integer bit pattern (i.e. no conversion).
- *
- * It is a common trick to convert floats into integer bit patterns, perform
- * some bit hackery based on knowledge they are IEEE 754 layout, and then
- * convert them back again. This is the first half of that flip.
+ * @brief Return a float value for a float16 vector.
  */
-ASTCENC_SIMD_INLINE vint4 float_as_int(vfloat4 a)
+ASTCENC_SIMD_INLINE vfloat4 float16_to_float(vint4 a)
 {
-	vint4 r;
-	memcpy(r.m, a.m, 4 * 4);
-	return r;
+	vint4 sign = lsl<16>(a & vint4(0x8000));
+	vint4 mag = a & vint4(0x7FFF);
+
+	// Normal values just need the exponent rebiasing
+	vint4 normal = lsl<13>(mag) + vint4((127 - 15) << 23);
+
+	// Denormal values are an exactly scaled integer
+	vint4 denormal = float_as_int(int_to_float(mag) * vfloat4(1.0f / 16777216.0f));
+
+	// Infinities and NaNs keep the mantissa, and NaNs are quietened
+	vint4 infnan = lsl<13>(mag) | vint4(0x7F800000);
+	infnan = select(infnan, infnan | vint4(0x400000), mag > vint4(0x7C00));
+
+	vint4 r = select(normal, denormal, mag < vint4(0x400));
+	r = select(r, infnan, mag > vint4(0x7BFF));
+	return int_as_float(r | sign);
 }
 
 /**
- * @brief Return a integer value as a float bit pattern (i.e. no conversion).
- *
- * It is a common trick to convert floats into integer bit patterns, perform
- * some bit hackery based on knowledge they are IEEE 754 layout, and then
- * convert them back again. This is the second half of that flip.
+ * @brief Return a float value for a float16 scalar.
  */
-ASTCENC_SIMD_INLINE vfloat4 int_as_float(vint4 a)
+ASTCENC_SIMD_INLINE float float16_to_float(uint16_t a)
 {
-	vfloat4 r;
-	memcpy(r.m, a.m, 4 * 4);
-	return r;
+	return float16_to_float(vint4(a)).lane<0>();
 }
 
 #endif // #ifndef ASTC_VECMATHLIB_NONE_4_H_INCLUDED
@@ -940,11 +940,24 @@ ASTCENC_SIMD_INLINE vint4 float_to_float16(vfloat4 a)
 	__m128i f16 = _mm_cvtepu16_epi32(packedf16);
 	return vint4(f16);
 #else
-	return vint4(
-		float_to_sf16(a.lane<0>()),
-		float_to_sf16(a.lane<1>()),
-		float_to_sf16(a.lane<2>()),
-		float_to_sf16(a.lane<3>()));
+	vint4 bits(_mm_castps_si128(a.m));
+	vint4 sign = lsr<16>(bits) & vint4(0x8000);
+	vint4 absv = bits & vint4(0x7FFFFFFF);
+
+	// Normal results rebias the exponent and round the mantissa to nearest even
+	vint4 normal = lsr<13>(absv + vint4(static_cast<int>(0xC8000FFF)) + (lsr<13>(absv) & vint4(1)));
+
+	// Denormal results are rounded by the FPU; adding 0.5 scales the ULP to the fp16 denormal ULP
+	__m128 denormalf = _mm_add_ps(_mm_castsi128_ps(absv.m), _mm_set1_ps(0.5f));
+	vint4 denormal = vint4(_mm_castps_si128(denormalf)) - vint4(0x3F000000);
+
+	// NaNs keep the top mantissa bits, and are quietened
+	vint4 nan = (lsr<13>(absv) & vint4(0x3FF)) | vint4(0x7E00);
+
+	vint4 r = select(normal, denormal, absv < vint4(0x38800000));
+	r = select(r, vint4(0x7C00), absv > vint4(0x477FFFFF));
+	r = select(r, nan, absv > vint4(0x7F800000));
+	return r | sign;
 #endif
 }
 
@@ -957,7 +970,7 @@ static inline uint16_t float_to_float16(float a)
 	__m128i f16 = _mm_cvtps_ph(_mm_set1_ps(a), 0);
 	return  (uint16_t)_mm_cvtsi128_si32(f16);
 #else
-	return float_to_sf16(a);
+	return static_cast<uint16_t>(float_to_float16(vfloat4(a)).lane<0>());
 #endif
 }
 
@@ -971,11 +984,23 @@ ASTCENC_SIMD_INLINE vfloat4 float16_to_float(vint4 a)
 	__m128 f32 = _mm_cvtph_ps(packed);
 	return vfloat4(f32);
 #else
-	return vfloat4(
-		sf16_to_float(a.lane<0>()),
-		sf16_to_float(a.lane<1>()),
-		sf16_to_float(a.lane<2>()),
-		sf16_to_float(a.lane<3>()));
+	vint4 sign = lsl<16>(a & vint4(0x8000));
+	vint4 mag = a & vint4(0x7FFF);
+
+	// Normal values just need the exponent rebiasing
+	vint4 normal = lsl<13>(mag) + vint4((127 - 15) << 23);
+
+	// Denormal values are an exactly scaled integer
+	vfloat4 denormalf = int_to_float(mag) * vfloat4(1.0f / 16777216.0f);
+	vint4 denormal(_mm_castps_si128(denormalf.m));
+
+	// Infinities and NaNs keep the mantissa, and NaNs are quietened
+	vint4 infnan = lsl<13>(mag) | vint4(0x7F800000);
+	infnan = select(infnan, infnan | vint4(0x400000), mag > vint4(0x7C00));
+
+	vint4 r = select(normal, denormal, mag < vint4(0x400));
+	r = select(r, infnan, mag > vint4(0x7BFF));
+	return vfloat4(_mm_castsi128_ps((r | sign).m));
 #endif
 }
 
@@ -989,7 +1014,7 @@ ASTCENC_SIMD_INLINE float float16_to_float(uint16_t a)
 	__m128 f32 = _mm_cvtph_ps(packed);
 	return _mm_cvtss_f32(f32);
 #else
-	return sf16_to_float(a);
+	return float16_to_float(vint4(a)).lane<0>();
 #endif
 }
 
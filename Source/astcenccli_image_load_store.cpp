@@ -25,6 +25,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <iterator>
+#include <vector>
 
 #include "astcenccli_internal.h"
 
@@ -2318,6 +2320,8 @@ struct astc_header
 
 static const uint32_t ASTC_MAGIC_ID = 0x5CA1AB13;
 
+static const uint32_t ASTC_SPLIT_MAGIC_ID = 0x5CA1AB14;
+
 static unsigned int unpack_bytes(
 	uint8_t a,
 	uint8_t b,
@@ -2352,7 +2356,7 @@ int load_cimage(
 	}
 
 	unsigned int magicval = unpack_bytes(hdr.magic[0], hdr.magic[1], hdr.magic[2], hdr.magic[3]);
-	if (magicval != ASTC_MAGIC_ID)
+	if (magicval != ASTC_MAGIC_ID && magicval != ASTC_SPLIT_MAGIC_ID)
 	{
 		printf("ERROR: File not recognized '%s'\n", filename);
 		return 1;
@@ -2380,11 +2384,29 @@ int load_cimage(
 	size_t data_size = xblocks * yblocks * zblocks * 16;
 	uint8_t *buffer = new uint8_t[data_size];
 
-	file.read((char*)buffer, data_size);
-	if (!file)
+	if (magicval == ASTC_SPLIT_MAGIC_ID)
 	{
-		printf("ERROR: File read failed '%s'\n", filename);
-		return 1;
+		// Split block streams fill the rest of the file
+		std::vector<uint8_t> stream((std::istreambuf_iterator<char>(file)),
+		                            std::istreambuf_iterator<char>());
+
+		astcenc_error status = astcenc_block_stream_merge(
+		    block_x, block_y, block_z, stream.data(), stream.size(), buffer, data_size);
+		if (status != ASTCENC_SUCCESS)
+		{
+			printf("ERROR: File corrupt '%s'\n", filename);
+			delete[] buffer;
+			return 1;
+		}
+	}
+	else
+	{
+		file.read((char*)buffer, data_size);
+		if (!file)
+		{
+			printf("ERROR: File read failed '%s'\n", filename);
+			return 1;
+		}
 	}
 
 	img.data = buffer;
@@ -2402,13 +2424,16 @@ int load_cimage(
 // TODO: Return a bool?
 int store_cimage(
 	const astc_compressed_image& img,
-	const char* filename
+	const char* filename,
+	bool split_streams
 ) {
+	uint32_t magic = split_streams ? ASTC_SPLIT_MAGIC_ID : ASTC_MAGIC_ID;
+
 	astc_header hdr;
-	hdr.magic[0] =  ASTC_MAGIC_ID        & 0xFF;
-	hdr.magic[1] = (ASTC_MAGIC_ID >>  8) & 0xFF;
-	hdr.magic[2] = (ASTC_MAGIC_ID >> 16) & 0xFF;
-	hdr.magic[3] = (ASTC_MAGIC_ID >> 24) & 0xFF;
+	hdr.magic[0] =  magic        & 0xFF;
+	hdr.magic[1] = (magic >>  8) & 0xFF;
+	hdr.magic[2] = (magic >> 16) & 0xFF;
+	hdr.magic[3] = (magic >> 24) & 0xFF;
 
 	hdr.block_x = static_cast<uint8_t>(img.block_x);
 	hdr.block_y = static_cast<uint8_t>(img.block_y);
@@ -2434,6 +2459,27 @@ int store_cimage(
 	}
 
 	file.write((char*)&hdr, sizeof(astc_header));
-	file.write((char*)img.data, img.data_len);
+
+	if (split_streams)
+	{
+		size_t stream_len = ASTCENC_BLOCK_STREAM_HEADER_SIZE
+		                  + ASTCENC_BLOCK_STREAM_MAX_BLOCK_SIZE * (img.data_len / 16);
+		std::vector<uint8_t> stream(stream_len);
+
+		astcenc_error status = astcenc_block_stream_split(
+		    img.block_x, img.block_y, img.block_z, img.data, img.data_len, stream.data(), &stream_len);
+		if (status != ASTCENC_SUCCESS)
+		{
+			printf("ERROR: Block stream split failed: %s\n", astcenc_get_error_string(status));
+			return 1;
+		}
+
+		file.write((char*)stream.data(), stream_len);
+	}
+	else
+	{
+		file.write((char*)img.data, img.data_len);
+	}
+
 	return 0;
 }
@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
 
 #include "astcenc.h"
 #include "astcenc_mathlib.h"
@@ -88,6 +89,12 @@ struct cli_config_options
 
 	/** @brief The  post-decode swizzle. */
 	astcenc_swizzle swz_decode;
+
+	/** @brief The CPUs to pin worker threads to, assigned round-robin; empty if not pinned. */
+	std::vector<int> pin_cpus;
+
+	/** @brief The number of times to run the decompression pass; only the fastest is timed. */
+	unsigned int decode_repeats;
 };
 
 /**
@@ -171,7 +178,7 @@ int determine_image_components(
 	const astcenc_image* img);
 
 /**
- * @brief Load a compressed .astc image.
+ * @brief Load a compressed .astc or .astcs image.
  *
  * @param filename   The file to load.
  * @param img        The image to populate with loaded data.
@@ -183,16 +190,18 @@ int load_cimage(
 	astc_compressed_image& img);
 
 /**
- * @brief Store a compressed .astc image.
+ * @brief Store a compressed .astc or .astcs image.
  *
- * @param img        The image to store.
- * @param filename   The file to save.
+ * @param img             The image to store.
+ * @param filename        The file to save.
+ * @param split_streams   Store the blocks as split block streams, rather than as raw blocks.
  *
  * @return Non-zero on error, zero on success.
  */
 int store_cimage(
 	const astc_compressed_image& img,
-	const char* filename);
+	const char* filename,
+	bool split_streams);
 
 /**
  * @brief Load a compressed .ktx image.
@@ -329,26 +338,45 @@ void compute_error_metrics(
 double get_time();
 
 /**
- * @brief Get the number of CPU cores.
+ * @brief Get the number of CPU cores available to this process.
+ *
+ * This is the number of online CPU cores, limited by the process affinity mask and, on Linux, by
+ * any cgroup v1 or v2 CPU bandwidth quota applied to the process.
  *
- * @return The number of online or onlineable CPU cores in the system.
+ * @return The number of CPU cores available.
  */
 int get_cpu_count();
 
+/**
+ * @brief Get the upper limit of the CPU indices that threads can be pinned to.
+ *
+ * @return The limit; valid CPU indices are less than this.
+ */
+int get_cpu_index_limit();
+
 /**
  * @brief Launch N worker threads and wait for them to complete.
  *
  * All threads run the same thread function, and have the same thread payload, but are given a
  * unique thread ID (0 .. N-1) as a parameter to the run function to allow thread-specific behavior.
  *
+ * Threads can optionally be pinned to specific CPUs, which is currently supported on Linux and
+ * Windows. Thread N is pinned to CPU @c pin_cpus[N % pin_cpus.size()]. Pinned single threaded
+ * workloads still run on a worker thread, so the affinity of the calling thread is never changed.
+ *
 |* @param thread_count The number of threads to spawn.
  * @param func         The function to execute. Must have the signature:
  *                     void (int thread_count, int thread_id, void* payload)
  * @param payload      Pointer to an opaque thread payload object.
+ * @param pin_cpus     The CPUs to pin threads to, or empty to not pin threads.
+ *
+ * @return @c false if any thread could not be pinned, @c true otherwise. Threads that can not be
+ *         pinned still run the thread function, but with the default affinity.
  */
-void launch_threads(
+bool launch_threads(
 	int thread_count,
 	void (*func)(int, int, void*),
-	void *payload);
+	void *payload,
+	const std::vector<int>& pin_cpus = std::vector<int>());
 
 #endif
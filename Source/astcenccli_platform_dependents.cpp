@@ -21,7 +21,7 @@
  * This module contains functions with strongly OS-dependent implementations:
  *
  *  * CPU count queries
- *  * Threading
+ *  * Threading and thread affinity
  *  * Time
  *
  * In addition to the basic thread abstraction (which is native pthreads on
@@ -32,6 +32,9 @@
 
 #include "astcenccli_internal.h"
 
+#include <cstring>
+#include <string>
+
 /* ============================================================================
    Platform code for Windows using the Win32 APIs.
 ============================================================================ */
@@ -78,7 +81,52 @@ int get_cpu_count()
 {
 	SYSTEM_INFO sysinfo;
 	GetSystemInfo(&sysinfo);
-	return sysinfo.dwNumberOfProcessors;
+	int cpu_count = static_cast<int>(sysinfo.dwNumberOfProcessors);
+
+	// Respect the process affinity mask; this only covers the current processor group
+	DWORD_PTR process_mask;
+	DWORD_PTR system_mask;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+	{
+		int mask_count = 0;
+		for (; process_mask; process_mask &= process_mask - 1)
+		{
+			mask_count++;
+		}
+
+		if (mask_count > 0)
+		{
+			cpu_count = astc::min(cpu_count, mask_count);
+		}
+	}
+
+	return cpu_count;
+}
+
+/* See header for documentation */
+int get_cpu_index_limit()
+{
+	// Affinity masks only cover the current processor group
+	return static_cast<int>(sizeof(DWORD_PTR) * 8);
+}
+
+/**
+ * @brief Pin the calling thread to a single CPU.
+ *
+ * @param cpu   The CPU index.
+ *
+ * @return @c true if the thread was pinned, @c false otherwise.
+ */
+static bool pin_current_thread(
+	int cpu
+) {
+	if (cpu < 0 || cpu >= get_cpu_index_limit())
+	{
+		return false;
+	}
+
+	DWORD_PTR mask = static_cast<DWORD_PTR>(1) << cpu;
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
 }
 
 /* See header for documentation */
@@ -100,12 +148,298 @@ double get_time()
 #include <sys/time.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <sched.h>
+
+/**
+ * @brief Read the first line of a small text file.
+ *
+ * @param      path   The file path.
+ * @param[out] line   The line, without trailing newline.
+ *
+ * @return @c true if the line was read, @c false otherwise.
+ */
+static bool read_first_line(
+	const std::string& path,
+	std::string& line
+) {
+	FILE* file = fopen(path.c_str(), "r");
+	if (!file)
+	{
+		return false;
+	}
+
+	char buffer[256];
+	bool ok = fgets(buffer, sizeof(buffer), file) != nullptr;
+	fclose(file);
+	if (!ok)
+	{
+		return false;
+	}
+
+	line = buffer;
+	while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+	{
+		line.pop_back();
+	}
+
+	return true;
+}
+
+/**
+ * @brief Convert a CPU quota into a CPU count, rounding up.
+ *
+ * @param quota    The quota per period, or <= 0 if unlimited.
+ * @param period   The period.
+ *
+ * @return The CPU count, or 0 if unlimited.
+ */
+static int quota_to_cpu_count(
+	long long quota,
+	long long period
+) {
+	if (quota <= 0 || period <= 0)
+	{
+		return 0;
+	}
+
+	return static_cast<int>(astc::max((quota + period - 1) / period, 1LL));
+}
+
+/**
+ * @brief Get the CPU count allowed by a cgroup and all of its ancestors.
+ *
+ * A quota on any ancestor cgroup also limits the process, so the tightest quota on the path from
+ * the cgroup of the process to the hierarchy root is used.
+ *
+ * @param root         The hierarchy mount point.
+ * @param path         The cgroup path of the process in the hierarchy.
+ * @param read_quota   Callable returning the CPU count of a cgroup directory, 0 if unlimited, or a
+ *                     negative value if the directory has no quota files.
+ *
+ * @return The CPU count, 0 if unlimited, or a negative value if no quota files were found.
+ */
+template<typename F>
+static int get_hierarchy_cpu_count(
+	const std::string& root,
+	std::string path,
+	F read_quota
+) {
+	int cpu_count = -1;
+	while (true)
+	{
+		int count = read_quota(root + path);
+		if (count > 0)
+		{
+			cpu_count = (cpu_count > 0) ? astc::min(cpu_count, count) : count;
+		}
+		else if (count == 0 && cpu_count < 0)
+		{
+			cpu_count = 0;
+		}
+
+		// Walk up to the parent cgroup, stopping after the hierarchy root
+		if (path.empty() || path == "/")
+		{
+			break;
+		}
+
+		size_t sep = path.rfind('/');
+		path = (sep == std::string::npos) ? std::string() : path.substr(0, sep);
+	}
+
+	return cpu_count;
+}
+
+/**
+ * @brief Get the CPU count allowed by the cgroup CPU bandwidth quota of this process.
+ *
+ * Both cgroup v2 (unified) and cgroup v1 hierarchies are supported. The cgroup of the process is
+ * looked up in @c /proc/self/cgroup, and quotas on its ancestors up to the hierarchy root are also
+ * applied. Containers with a cgroup namespace see their own cgroup as the hierarchy root.
+ *
+ * @return The CPU count, or 0 if no quota is set.
+ */
+static int get_cgroup_cpu_count()
+{
+	std::string v2_path;
+	std::string v1_path;
+
+	FILE* file = fopen("/proc/self/cgroup", "r");
+	if (file)
+	{
+		char buffer[512];
+		while (fgets(buffer, sizeof(buffer), file))
+		{
+			// Lines are "<hierarchy>:<controller list>:<path>"
+			std::string line(buffer);
+			size_t sep1 = line.find(':');
+			size_t sep2 = line.find(':', sep1 + 1);
+			if (sep1 == std::string::npos || sep2 == std::string::npos)
+			{
+				continue;
+			}
+
+			std::string controllers = "," + line.substr(sep1 + 1, sep2 - sep1 - 1) + ",";
+			std::string path = line.substr(sep2 + 1);
+			while (!path.empty() && (path.back() == '\n' || path.back() == '\r'))
+			{
+				path.pop_back();
+			}
+
+			if (line.compare(0, sep1, "0") == 0 && controllers == ",,")
+			{
+				v2_path = path;
+			}
+			else if (controllers.find(",cpu,") != std::string::npos)
+			{
+				v1_path = path;
+			}
+		}
+
+		fclose(file);
+	}
+
+	// cgroup v2 stores "<quota> <period>", where quota may be "max"
+	auto read_v2_quota = [](const std::string& base) {
+		std::string line;
+		if (!read_first_line(base + "/cpu.max", line))
+		{
+			return -1;
+		}
+
+		long long quota = 0;
+		long long period = 0;
+		if (sscanf(line.c_str(), "%lld %lld", &quota, &period) != 2)
+		{
+			return 0;
+		}
+
+		return quota_to_cpu_count(quota, period);
+	};
+
+	const char* v2_dirs[] { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" };
+	for (const char* dir : v2_dirs)
+	{
+		int cpu_count = get_hierarchy_cpu_count(dir, v2_path, read_v2_quota);
+		if (cpu_count >= 0)
+		{
+			return cpu_count;
+		}
+	}
+
+	// cgroup v1 stores the quota and period in separate files, with a quota of -1 if unlimited
+	auto read_v1_quota = [](const std::string& base) {
+		std::string line;
+		std::string period_line;
+		if (!read_first_line(base + "/cpu.cfs_quota_us", line) ||
+		    !read_first_line(base + "/cpu.cfs_period_us", period_line))
+		{
+			return -1;
+		}
+
+		return quota_to_cpu_count(atoll(line.c_str()), atoll(period_line.c_str()));
+	};
+
+	const char* v1_dirs[] { "/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct" };
+	for (const char* dir : v1_dirs)
+	{
+		int cpu_count = get_hierarchy_cpu_count(dir, v1_path, read_v1_quota);
+		if (cpu_count >= 0)
+		{
+			return cpu_count;
+		}
+	}
+
+	return 0;
+}
+
+/* See header for documentation */
+int get_cpu_count()
+{
+	int cpu_count = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+
+	// Respect the process affinity mask, e.g. when run under taskset or a container cpuset
+	cpu_set_t cpus;
+	if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0)
+	{
+		int affinity_count = CPU_COUNT(&cpus);
+		if (affinity_count > 0)
+		{
+			cpu_count = astc::min(cpu_count, affinity_count);
+		}
+	}
+
+	// Respect a cgroup CPU quota, which throttles the process if exceeded
+	int quota_count = get_cgroup_cpu_count();
+	if (quota_count > 0)
+	{
+		cpu_count = astc::min(cpu_count, quota_count);
+	}
+
+	return astc::max(cpu_count, 1);
+}
+
+/* See header for documentation */
+int get_cpu_index_limit()
+{
+	return CPU_SETSIZE;
+}
+
+/**
+ * @brief Pin the calling thread to a single CPU.
+ *
+ * @param cpu   The CPU index.
+ *
+ * @return @c true if the thread was pinned, @c false otherwise.
+ */
+static bool pin_current_thread(
+	int cpu
+) {
+	if (cpu < 0 || cpu >= get_cpu_index_limit())
+	{
+		return false;
+	}
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+#else
+
 /* See header for documentation */
 int get_cpu_count()
 {
 	return static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
 }
 
+/* See header for documentation */
+int get_cpu_index_limit()
+{
+	// Thread affinity is not supported, so use a nominal limit that keeps CPU lists bounded
+	return 1024;
+}
+
+/**
+ * @brief Pin the calling thread to a single CPU.
+ *
+ * Thread affinity is not supported on this platform.
+ *
+ * @param cpu   The CPU index.
+ *
+ * @return Always returns @c false.
+ */
+static bool pin_current_thread(
+	int cpu
+) {
+	(void)cpu;
+	return false;
+}
+
+#endif
+
 /* See header for documentation */
 double get_time()
 {
@@ -131,6 +465,10 @@ struct launch_desc
 	void (*func)(int, int, void*);
 	/** @brief The user thread payload. */
 	void* payload;
+	/** @brief The CPU to pin the thread to, or -1 if not pinned. */
+	int pin_cpu;
+	/** @brief Set by the thread if it could not be pinned to @c pin_cpu. */
+	bool pin_failed;
 };
 
 /**
@@ -145,23 +483,32 @@ static void* launch_threads_helper(
 	void *p
 ) {
 	launch_desc* ltd = (launch_desc*)p;
+	if (ltd->pin_cpu >= 0)
+	{
+		ltd->pin_failed = !pin_current_thread(ltd->pin_cpu);
+	}
+
 	ltd->func(ltd->thread_count, ltd->thread_id, ltd->payload);
 	return nullptr;
 }
 
 /* See header for documentation */
-void launch_threads(
+bool launch_threads(
 	int thread_count,
 	void (*func)(int, int, void*),
-	void *payload
+	void *payload,
+	const std::vector<int>& pin_cpus
 ) {
-	// Directly execute single threaded workloads on this thread
-	if (thread_count <= 1)
+	// Directly execute single threaded workloads on this thread, unless pinned as pinning would
+	// change the affinity of the calling thread
+	if (thread_count <= 1 && pin_cpus.empty())
 	{
 		func(1, 0, payload);
-		return;
+		return true;
 	}
 
+	thread_count = astc::max(thread_count, 1);
+
 	// Otherwise spawn worker threads
 	launch_desc *thread_descs = new launch_desc[thread_count];
 	for (int i = 0; i < thread_count; i++)
@@ -170,16 +517,21 @@ void launch_threads(
 		thread_descs[i].thread_id = i;
 		thread_descs[i].payload = payload;
 		thread_descs[i].func = func;
+		thread_descs[i].pin_cpu = pin_cpus.empty() ? -1 : pin_cpus[i % pin_cpus.size()];
+		thread_descs[i].pin_failed = false;
 
 		pthread_create(&(thread_descs[i].thread_handle), nullptr,
 		               launch_threads_helper, (void*)&(thread_descs[i]));
 	}
 
 	// ... and then wait for them to complete
+	bool all_pinned = true;
 	for (int i = 0; i < thread_count; i++)
 	{
 		pthread_join(thread_descs[i].thread_handle, nullptr);
+		all_pinned = all_pinned && !thread_descs[i].pin_failed;
 	}
 
 	delete[] thread_descs;
+	return all_pinned;
 }
@@ -23,6 +23,8 @@
 #include "astcenccli_internal.h"
 
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <sstream>
@@ -133,11 +135,12 @@ static const mode_entry modes[] {
  */
 struct compression_workload
 {
-	astcenc_context* context;
+	astcenc_context** contexts;
+	unsigned int context_count;
 	astcenc_image* image;
 	astcenc_swizzle swizzle;
-	uint8_t* data_out;
-	size_t data_len;
+	uint8_t** data_out;
+	size_t* data_len;
 	astcenc_error error;
 };
 
@@ -181,6 +184,91 @@ static bool ends_with(
 	       (0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix));
 }
 
+/**
+ * @brief Parse a CPU index from a CPU list.
+ *
+ * @param      str     The string to parse from.
+ * @param[out] end     The first character after the CPU index.
+ * @param[out] cpu     The parsed CPU index.
+ *
+ * @return @c true if a CPU index in the range supported by the platform was parsed.
+ */
+static bool parse_cpu_index(
+	const char* str,
+	const char*& end,
+	int& cpu
+) {
+	// Only accept plain decimal digits; strtol would also accept whitespace and signs
+	if (*str < '0' || *str > '9')
+	{
+		return false;
+	}
+
+	char* str_end;
+	errno = 0;
+	long value = strtol(str, &str_end, 10);
+	if (errno != 0 || value >= static_cast<long>(get_cpu_index_limit()))
+	{
+		return false;
+	}
+
+	end = str_end;
+	cpu = static_cast<int>(value);
+	return true;
+}
+
+/**
+ * @brief Parse a CPU list, such as "0,2,4-7".
+ *
+ * CPU indices must be less than the platform limit returned by @c get_cpu_index_limit(), and
+ * ranges must not be reversed.
+ *
+ * @param      list   The CPU list string.
+ * @param[out] cpus   The parsed CPU indices, in list order.
+ *
+ * @return @c true if the list was valid, @c false otherwise.
+ */
+static bool parse_cpu_list(
+	const char* list,
+	std::vector<int>& cpus
+) {
+	cpus.clear();
+
+	std::istringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ','))
+	{
+		const char* str = item.c_str();
+		int first;
+		int last;
+		if (!parse_cpu_index(str, str, first))
+		{
+			return false;
+		}
+
+		last = first;
+		if (*str == '-')
+		{
+			if (!parse_cpu_index(str + 1, str, last) || last < first)
+			{
+				return false;
+			}
+		}
+
+		if (*str != '\0')
+		{
+			return false;
+		}
+
+		for (int cpu = first; cpu <= last; cpu++)
+		{
+			cpus.push_back(cpu);
+		}
+	}
+
+	return !cpus.empty();
+}
+
 /**
  * @brief Runner callback function for a compression worker thread.
  *
@@ -196,8 +284,8 @@ static void compression_workload_runner(
 	(void)thread_count;
 
 	compression_workload* work = static_cast<compression_workload*>(payload);
-	astcenc_error error = astcenc_compress_image(
-	                       work->context, work->image, &work->swizzle,
+	astcenc_error error = astcenc_compress_image_multi(
+	                       work->contexts, work->context_count, work->image, &work->swizzle,
 	                       work->data_out, work->data_len, thread_id);
 
 	// This is a racy update, so which error gets returned is a random, but it
@@ -265,6 +353,62 @@ static std::string get_slice_filename(
 	return name;
 }
 
+/**
+ * @brief Split a comma separated list of block sizes.
+ *
+ * @param list   The block size list, e.g. "4x4,6x6,8x8".
+ *
+ * @return The block sizes, unparsed.
+ */
+static std::vector<std::string> split_block_sizes(
+	const std::string& list
+) {
+	std::vector<std::string> block_sizes;
+
+	size_t start = 0;
+	while (true)
+	{
+		size_t sep = list.find(',', start);
+		block_sizes.push_back(list.substr(start, sep - start));
+		if (sep == std::string::npos)
+		{
+			break;
+		}
+
+		start = sep + 1;
+	}
+
+	return block_sizes;
+}
+
+/**
+ * @brief Get the output filename for one block size of a multi-block-size compression.
+ *
+ * The block size is inserted before the file extension, e.g. "out.astc" becomes "out_6x6.astc",
+ * or appended if the filename has no extension.
+ *
+ * @param basename     The filename given on the command line.
+ * @param block_size   The block size string.
+ *
+ * @return The filename for this block size.
+ */
+static std::string get_block_size_filename(
+	const std::string& basename,
+	const std::string& block_size
+) {
+	// Ignore dots in directory names
+	size_t sep = basename.find_last_of('.');
+	size_t dir_sep = basename.find_last_of("/\\");
+	if (sep == std::string::npos || (dir_sep != std::string::npos && sep < dir_sep))
+	{
+		return basename + "_" + block_size;
+	}
+
+	std::string base = basename.substr(0, sep);
+	std::string ext = basename.substr(sep);
+	return base + "_" + block_size + ext;
+}
+
 /**
  * @brief Load a non-astc image file from memory.
  *
@@ -444,6 +588,7 @@ static int parse_commandline_options(
  * @param      operation    Codec operation mode.
  * @param[out] profile      Codec color profile.
  * @param      comp_image   Compressed image if a decompress operation.
+ * @param      block_size   Block size string if a compress operation.
  * @param[out] preprocess   Image preprocess operation.
  * @param[out] config       Codec configuration.
  *
@@ -455,6 +600,7 @@ static int init_astcenc_config(
 	astcenc_profile profile,
 	astcenc_operation operation,
 	astc_compressed_image& comp_image,
+	const char* block_size,
 	astcenc_preprocess& preprocess,
 	astcenc_config& config
 ) {
@@ -485,12 +631,12 @@ static int init_astcenc_config(
 		}
 
 		int cnt2D, cnt3D;
-		int dimensions = sscanf(argv[4], "%ux%u%nx%u%n",
+		int dimensions = sscanf(block_size, "%ux%u%nx%u%n",
 		                        &block_x, &block_y, &cnt2D, &block_z, &cnt3D);
 		// Character after the last match should be a NUL
-		if (!(((dimensions == 2) && !argv[4][cnt2D]) || ((dimensions == 3) && !argv[4][cnt3D])))
+		if (!(((dimensions == 2) && !block_size[cnt2D]) || ((dimensions == 3) && !block_size[cnt3D])))
 		{
-			printf("ERROR: Block size '%s' is invalid\n", argv[4]);
+			printf("ERROR: Block size '%s' is invalid\n", block_size);
 			return 1;
 		}
 
@@ -979,6 +1125,17 @@ static int edit_astcenc_config(
 
 			config.tune_candidate_limit = atoi(argv[argidx - 1]);
 		}
+		else if (!strcmp(argv[argidx], "-rdolambda"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -rdolambda switch with no argument\n");
+				return 1;
+			}
+
+			config.rdo_lambda = static_cast<float>(atof(argv[argidx - 1]));
+		}
 		else if (!strcmp(argv[argidx], "-j"))
 		{
 			argidx += 2;
@@ -990,6 +1147,39 @@ static int edit_astcenc_config(
 
 			cli_config.thread_count = atoi(argv[argidx - 1]);
 		}
+		else if (!strcmp(argv[argidx], "-decode-repeats"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -decode-repeats switch with no argument\n");
+				return 1;
+			}
+
+			int repeats = atoi(argv[argidx - 1]);
+			if (repeats < 1)
+			{
+				printf("ERROR: -decode-repeats must be at least 1\n");
+				return 1;
+			}
+
+			cli_config.decode_repeats = static_cast<unsigned int>(repeats);
+		}
+		else if (!strcmp(argv[argidx], "-pin"))
+		{
+			argidx += 2;
+			if (argidx > argc)
+			{
+				printf("ERROR: -pin switch with no argument\n");
+				return 1;
+			}
+
+			if (!parse_cpu_list(argv[argidx - 1], cli_config.pin_cpus))
+			{
+				printf("ERROR: -pin switch with invalid CPU list '%s'\n", argv[argidx - 1]);
+				return 1;
+			}
+		}
 		else if (!strcmp(argv[argidx], "-yflip"))
 		{
 			argidx++;
@@ -1155,6 +1345,11 @@ static void print_astcenc_config(
 		printf("    2 plane correlation cutoff: %g\n", (double)config.tune_2_plane_early_out_limit_correlation);
 		printf("    Block mode centile cutoff:  %g%%\n", (double)(config.tune_block_mode_limit));
 		printf("    Max refinement cutoff:      %u iterations\n", config.tune_refinement_limit);
+		if (config.rdo_lambda > 0.0f)
+		{
+			printf("    RDO lambda:                 %g\n", (double)config.rdo_lambda);
+		}
+
 		printf("    Compressor thread count:    %d\n", cli_config.thread_count);
 		printf("\n");
 	}
@@ -1445,7 +1640,7 @@ int main(
 	astc_compressed_image image_comp {};
 	if (operation & ASTCENC_STAGE_LD_COMP)
 	{
-		if (ends_with(input_filename, ".astc"))
+		if (ends_with(input_filename, ".astc") || ends_with(input_filename, ".astcs"))
 		{
 			error = load_cimage(input_filename.c_str(), image_comp);
 			if (error)
@@ -1479,25 +1674,58 @@ int main(
 		}
 	}
 
-	astcenc_config config {};
-	astcenc_preprocess preprocess;
-	error = init_astcenc_config(argc, argv, profile, operation, image_comp, preprocess, config);
-	if (error)
+	// Compression accepts a comma separated list of block sizes, producing one output per size
+	std::vector<std::string> block_sizes { "" };
+	if ((operation & ASTCENC_STAGE_COMPRESS) && argc >= 5)
 	{
-		return 1;
+		block_sizes = split_block_sizes(argv[4]);
+		if (block_sizes.size() > 1 && operation != ASTCENC_OP_COMPRESS)
+		{
+			printf("ERROR: Multiple block sizes are only supported for compression\n");
+			return 1;
+		}
+
+		// Each block size is stored to its own file, so they must not repeat
+		for (size_t i = 0; i < block_sizes.size(); i++)
+		{
+			for (size_t j = 0; j < i; j++)
+			{
+				if (block_sizes[i] == block_sizes[j])
+				{
+					printf("ERROR: Block size %s is listed more than once\n", block_sizes[i].c_str());
+					return 1;
+				}
+			}
+		}
 	}
 
 	// Initialize cli_config_options with default values
 	cli_config_options cli_config { 0, 1, false, false, -10, 10,
 		{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A },
-		{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A } };
+		{ ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A },
+		{}, 1 };
 
-	error = edit_astcenc_config(argc, argv, operation, cli_config, config);
-	if (error)
+	std::vector<astcenc_config> configs(block_sizes.size());
+	astcenc_preprocess preprocess;
+	for (size_t i = 0; i < block_sizes.size(); i++)
 	{
-		return 1;
+		error = init_astcenc_config(argc, argv, profile, operation, image_comp,
+		                            block_sizes[i].c_str(), preprocess, configs[i]);
+		if (error)
+		{
+			return 1;
+		}
+
+		error = edit_astcenc_config(argc, argv, operation, cli_config, configs[i]);
+		if (error)
+		{
+			return 1;
+		}
 	}
 
+	// The first block size is used for all single output operations
+	astcenc_config& config = configs[0];
+
 	astcenc_image* image_uncomp_in = nullptr ;
 	unsigned int image_uncomp_in_component_count = 0;
 	bool image_uncomp_in_is_hdr = false;
@@ -1506,6 +1734,7 @@ int main(
 	// TODO: Handle RAII resources so they get freed when out of scope
 	astcenc_error    codec_status;
 	astcenc_context* codec_context;
+	std::vector<astc_compressed_image> image_comps;
 
 
 	// Preflight - check we have valid extensions for storing a file
@@ -1526,20 +1755,34 @@ int main(
 		bool is_null = output_filename == "/dev/null";
 #endif
 
-		if (!(is_null || ends_with(output_filename, ".astc") || ends_with(output_filename, ".ktx")))
+		if (!(is_null || ends_with(output_filename, ".astc") ||
+		      ends_with(output_filename, ".astcs") || ends_with(output_filename, ".ktx")))
 		{
 			printf("ERROR: Unknown compressed output file type\n");
 			return 1;
 		}
+
+		// The block size is inserted into the file name, so the null device can only store one
+		if (is_null && block_sizes.size() > 1)
+		{
+			printf("ERROR: Multiple block sizes can not be written to the null device\n");
+			return 1;
+		}
 	}
 
-	codec_status = astcenc_context_alloc(&config, cli_config.thread_count, &codec_context);
-	if (codec_status != ASTCENC_SUCCESS)
+	std::vector<astcenc_context*> codec_contexts(configs.size());
+	for (size_t i = 0; i < configs.size(); i++)
 	{
-		printf("ERROR: Codec context alloc failed: %s\n", astcenc_get_error_string(codec_status));
-		return 1;
+		codec_status = astcenc_context_alloc(&configs[i], cli_config.thread_count, &codec_contexts[i]);
+		if (codec_status != ASTCENC_SUCCESS)
+		{
+			printf("ERROR: Codec context alloc failed: %s\n", astcenc_get_error_string(codec_status));
+			return 1;
+		}
 	}
 
+	codec_context = codec_contexts[0];
+
 	// Load the uncompressed input file if needed
 	if (operation & ASTCENC_STAGE_LD_NCOMP)
 	{
@@ -1619,35 +1862,49 @@ int main(
 		             (double)image_comp.dim_z;
 	}
 
+	// Set if any worker thread could not be pinned to its requested CPU
+	bool pin_failed = false;
+
 	// Compress an image
 	if (operation & ASTCENC_STAGE_COMPRESS)
 	{
-		print_astcenc_config(cli_config, config);
+		std::vector<uint8_t*> buffers(configs.size());
+		std::vector<size_t> buffer_sizes(configs.size());
+		for (size_t i = 0; i < configs.size(); i++)
+		{
+			const astcenc_config& config_i = configs[i];
+			print_astcenc_config(cli_config, config_i);
 
-		unsigned int blocks_x = (image_uncomp_in->dim_x + config.block_x - 1) / config.block_x;
-		unsigned int blocks_y = (image_uncomp_in->dim_y + config.block_y - 1) / config.block_y;
-		unsigned int blocks_z = (image_uncomp_in->dim_z + config.block_z - 1) / config.block_z;
-		size_t buffer_size = blocks_x * blocks_y * blocks_z * 16;
-		uint8_t* buffer = new uint8_t[buffer_size];
+			unsigned int blocks_x = (image_uncomp_in->dim_x + config_i.block_x - 1) / config_i.block_x;
+			unsigned int blocks_y = (image_uncomp_in->dim_y + config_i.block_y - 1) / config_i.block_y;
+			unsigned int blocks_z = (image_uncomp_in->dim_z + config_i.block_z - 1) / config_i.block_z;
+			buffer_sizes[i] = blocks_x * blocks_y * blocks_z * 16;
+			buffers[i] = new uint8_t[buffer_sizes[i]];
+		}
 
 		compression_workload work;
-		work.context = codec_context;
+		work.contexts = codec_contexts.data();
+		work.context_count = static_cast<unsigned int>(codec_contexts.size());
 		work.image = image_uncomp_in;
 		work.swizzle = cli_config.swz_encode;
-		work.data_out = buffer;
-		work.data_len = buffer_size;
+		work.data_out = buffers.data();
+		work.data_len = buffer_sizes.data();
 		work.error = ASTCENC_SUCCESS;
 
 		// Only launch worker threads for multi-threaded use - it makes basic
 		// single-threaded profiling and debugging a little less convoluted
-		if (cli_config.thread_count > 1)
+		if ((cli_config.thread_count > 1) || !cli_config.pin_cpus.empty())
 		{
-			launch_threads(cli_config.thread_count, compression_workload_runner, &work);
+			if (!launch_threads(cli_config.thread_count, compression_workload_runner, &work,
+			                    cli_config.pin_cpus))
+			{
+				pin_failed = true;
+			}
 		}
 		else
 		{
-			work.error = astcenc_compress_image(
-			    work.context, work.image, &work.swizzle,
+			work.error = astcenc_compress_image_multi(
+			    work.contexts, work.context_count, work.image, &work.swizzle,
 			    work.data_out, work.data_len, 0);
 		}
 
@@ -1657,17 +1914,25 @@ int main(
 			return 1;
 		}
 
-		image_comp.block_x = config.block_x;
-		image_comp.block_y = config.block_y;
-		image_comp.block_z = config.block_z;
-		image_comp.dim_x = image_uncomp_in->dim_x;
-		image_comp.dim_y = image_uncomp_in->dim_y;
-		image_comp.dim_z = image_uncomp_in->dim_z;
-		image_comp.data = buffer;
-		image_comp.data_len = buffer_size;
+		image_comps.resize(configs.size());
+		for (size_t i = 0; i < configs.size(); i++)
+		{
+			image_comps[i].block_x = configs[i].block_x;
+			image_comps[i].block_y = configs[i].block_y;
+			image_comps[i].block_z = configs[i].block_z;
+			image_comps[i].dim_x = image_uncomp_in->dim_x;
+			image_comps[i].dim_y = image_uncomp_in->dim_y;
+			image_comps[i].dim_z = image_uncomp_in->dim_z;
+			image_comps[i].data = buffers[i];
+			image_comps[i].data_len = buffer_sizes[i];
+		}
+
+		image_comp = image_comps[0];
 	}
 
 	// Decompress an image
+	double decode_time_total = 0.0;
+	double decode_time_best = 0.0;
 	if (operation & ASTCENC_STAGE_DECOMPRESS)
 	{
 		int out_bitness = get_output_filename_enforced_bitness(output_filename.c_str());
@@ -1688,17 +1953,46 @@ int main(
 		work.swizzle = cli_config.swz_decode;
 		work.error = ASTCENC_SUCCESS;
 
-		// Only launch worker threads for multi-threaded use - it makes basic
-		// single-threaded profiling and debugging a little less convoluted
-		if (cli_config.thread_count > 1)
-		{
-			launch_threads(cli_config.thread_count, decompression_workload_runner, &work);
-		}
-		else
+		bool use_threads = (cli_config.thread_count > 1) || !cli_config.pin_cpus.empty();
+		for (unsigned int i = 0; i < cli_config.decode_repeats; i++)
 		{
-			work.error = astcenc_decompress_image(
-			    work.context, work.data, work.data_len,
-			    work.image_out, &work.swizzle, 0);
+			double start_decode_time = get_time();
+
+			// Single-threaded decompression resets implicitly, but a worker pool must be reset
+			// before the context can be reused
+			if (i && use_threads)
+			{
+				astcenc_decompress_reset(codec_context);
+			}
+
+			// Only launch worker threads for multi-threaded use - it makes basic
+			// single-threaded profiling and debugging a little less convoluted
+			if (use_threads)
+			{
+				if (!launch_threads(cli_config.thread_count, decompression_workload_runner, &work,
+				                    cli_config.pin_cpus))
+				{
+					pin_failed = true;
+				}
+			}
+			else
+			{
+				work.error = astcenc_decompress_image(
+				    work.context, work.data, work.data_len,
+				    work.image_out, &work.swizzle, 0);
+			}
+
+			double decode_time = get_time() - start_decode_time;
+			decode_time_total += decode_time;
+			if (!i || (decode_time < decode_time_best))
+			{
+				decode_time_best = decode_time;
+			}
+
+			if (work.error != ASTCENC_SUCCESS)
+			{
+				break;
+			}
 		}
 
 		if (work.error != ASTCENC_SUCCESS)
@@ -1708,7 +2002,13 @@ int main(
 		}
 	}
 
-	double end_coding_time = get_time();
+	if (pin_failed)
+	{
+		printf("WARNING: Some threads could not be pinned to the -pin CPUs, and ran unpinned\n");
+	}
+
+	// Only the fastest decompression pass counts towards the coding time
+	double end_coding_time = get_time() - (decode_time_total - decode_time_best);
 
 	// Print metrics in comparison mode
 	if (operation & ASTCENC_STAGE_COMPARE)
@@ -1720,39 +2020,49 @@ int main(
 		    image_uncomp_in, image_decomp_out, cli_config.low_fstop, cli_config.high_fstop);
 	}
 
-	// Store compressed image
+	// Store compressed images, with the block size in the filename if there are several
 	if (operation & ASTCENC_STAGE_ST_COMP)
 	{
-		if (ends_with(output_filename, ".astc"))
+		for (size_t i = 0; i < image_comps.size(); i++)
 		{
-			error = store_cimage(image_comp, output_filename.c_str());
-			if (error)
+			std::string filename = output_filename;
+			if (image_comps.size() > 1)
 			{
-				printf ("ERROR: Failed to store compressed image\n");
-				return 1;
+				filename = get_block_size_filename(output_filename, block_sizes[i]);
 			}
-		}
-		else if (ends_with(output_filename, ".ktx"))
-		{
-			bool srgb = profile == ASTCENC_PRF_LDR_SRGB;
-			error = store_ktx_compressed_image(image_comp, output_filename.c_str(), srgb);
-			if (error)
+
+			if (ends_with(filename, ".astc") || ends_with(filename, ".astcs"))
 			{
-				printf ("ERROR: Failed to store compressed image\n");
-				return 1;
+				bool split_streams = ends_with(filename, ".astcs");
+				error = store_cimage(image_comps[i], filename.c_str(), split_streams);
+				if (error)
+				{
+					printf ("ERROR: Failed to store compressed image\n");
+					return 1;
+				}
 			}
-		}
-		else
-		{
+			else if (ends_with(filename, ".ktx"))
+			{
+				bool srgb = profile == ASTCENC_PRF_LDR_SRGB;
+				error = store_ktx_compressed_image(image_comps[i], filename.c_str(), srgb);
+				if (error)
+				{
+					printf ("ERROR: Failed to store compressed image\n");
+					return 1;
+				}
+			}
+			else
+			{
 #if defined(_WIN32)
-			bool is_null = output_filename == "NUL" || output_filename == "nul";
+				bool is_null = filename == "NUL" || filename == "nul";
 #else
-			bool is_null = output_filename == "/dev/null";
+				bool is_null = filename == "/dev/null";
 #endif
-			if (!is_null)
-			{
-				printf("ERROR: Unknown compressed output file type\n");
-				return 1;
+				if (!is_null)
+				{
+					printf("ERROR: Unknown compressed output file type\n");
+					return 1;
+				}
 			}
 		}
 	}
@@ -1780,9 +2090,17 @@ int main(
 
 	free_image(image_uncomp_in);
 	free_image(image_decomp_out);
-	astcenc_context_free(codec_context);
+	for (auto* context : codec_contexts)
+	{
+		astcenc_context_free(context);
+	}
 
+	// The first compressed output is also image_comp
 	delete[] image_comp.data;
+	for (size_t i = 1; i < image_comps.size(); i++)
+	{
+		delete[] image_comps[i].data;
+	}
 
 	if ((operation & ASTCENC_STAGE_COMPARE) || (!cli_config.silentmode))
 	{
@@ -1795,6 +2113,23 @@ int main(
 		printf("    Total time:                %8.4f s\n", end_time - start_time);
 		printf("    Coding time:               %8.4f s\n", end_coding_time - start_coding_time);
 		printf("    Coding rate:               %8.4f MT/s\n", tex_rate);
+		if (cli_config.decode_repeats > 1)
+		{
+			printf("    Decode passes:             %8u (fastest timed)\n", cli_config.decode_repeats);
+		}
+
+		printf("    Thread count:              %8d (%d CPUs available)\n",
+		       cli_config.thread_count, get_cpu_count());
+
+		if (!cli_config.pin_cpus.empty())
+		{
+			printf("    Thread CPU pinning:        ");
+			for (size_t i = 0; i < cli_config.pin_cpus.size(); i++)
+			{
+				printf(i ? ",%d" : "%d", cli_config.pin_cpus[i]);
+			}
+			printf(pin_failed ? " (failed)\n" : "\n");
+		}
 	}
 
 	return 0;
@@ -135,6 +135,15 @@ COMPRESSION
            4x4x4: 2.00 bpp       6x6x5: 0.71 bpp
            5x4x4: 1.60 bpp       6x6x6: 0.59 bpp
 
+       A comma separated list of block sizes, e.g. 4x4,6x6,8x8, can be
+       given to compress the image to several block sizes in a single run.
+       The input image is loaded and preprocessed once, and the error
+       weighting averages and variances are computed once and shared by
+       all block sizes. The block size is inserted into each output file
+       name before the file extension, e.g. out_6x6.astc, so each block
+       size can only be listed once and the output can not be discarded
+       to a null device.
+
        The quality level configures the quality-performance tradeoff for
        the compressor; more complete searches of the search space improve
        image quality at the expense of compression time. The quality level
@@ -425,6 +434,15 @@ ADVANCED COMPRESSION
        Other options
        -------------
 
+       -rdolambda <lambda>
+           Enable rate-distortion optimization, which trades image quality
+           for smaller file sizes when the compressed output is packed
+           using an LZ-style lossless compressor such as zlib or zstd.
+           Encodings for each block are chosen to minimize the squared
+           error per texel, in 8-bit units, plus <lambda> times the
+           estimated storage cost in bits. Useful values are typically
+           between 0.1 and 10. Default is 0, which disables RDO.
+
        -esw <swizzle>
            Swizzle the color components before compression. The swizzle is
            specified using a 4-character string, which defines the output
@@ -462,8 +480,26 @@ ADVANCED COMPRESSION
 
        -j <threads>
            Explicitly specify the number of threads to use in the codec. If
-           not specified, the codec will use one thread per CPU detected in
-           the system.
+           not specified, the codec will use one thread per CPU available to
+           the process, respecting the process affinity mask and any cgroup
+           CPU quota applied to the process.
+
+       -pin <cpus>
+           Pin the codec worker threads to the specified CPUs, given as a
+           comma separated list of CPU indices and ranges, e.g. "0,2,4-7".
+           Threads are assigned to the listed CPUs in order, wrapping around
+           if there are more threads than CPUs. CPU indices must be below
+           the platform affinity limit, which is CPU_SETSIZE on Linux, and
+           the pointer width in bits (32 or 64) on Windows. Pinning is
+           supported on Linux and Windows. If a thread can not be pinned,
+           for example on other platforms or because its CPU is outside of
+           the process affinity mask, a warning is printed and the thread
+           runs unpinned.
+
+       -decode-repeats <count>
+           Run the decompression pass <count> times and report the coding
+           time and coding rate of the fastest pass. This is intended for
+           benchmarking decompression, and defaults to 1.
 
        -silent
            Suppresses all non-essential diagnostic output from the codec.
@@ -535,13 +571,19 @@ COMPRESSION FILE FORMATS
        The following formats are supported as compression outputs:
 
            ASTC (*.astc)
+           ASTC split block streams (*.astcs)
            Khronos Texture KTX (*.ktx)
 
+       The ASTC split block stream format stores the same blocks as an
+       ASTC file, but separates the block fields into streams so the
+       file compresses better with general purpose lossless compressors.
+
 
 DECOMPRESSION FILE FORMATS
        The following formats are supported as decompression inputs:
 
            ASTC (*.astc)
+           ASTC split block streams (*.astcs)
            Khronos Texture KTX (*.ktx)
 
        The following formats are supported as decompression outputs:
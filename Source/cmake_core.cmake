@@ -30,6 +30,7 @@ add_library(${ASTC_TARGET}-static
     STATIC
         astcenc_averages_and_directions.cpp
         astcenc_block_sizes.cpp
+        astcenc_block_stream.cpp
         astcenc_color_quantize.cpp
         astcenc_color_unquantize.cpp
         astcenc_compress_symbolic.cpp
@@ -48,6 +49,7 @@ add_library(${ASTC_TARGET}-static
         astcenc_pick_best_endpoint_format.cpp
         astcenc_platform_isa_detection.cpp
         astcenc_quantization.cpp
+        astcenc_rate_distortion.cpp
         astcenc_symbolic_physical.cpp
         astcenc_weight_align.cpp
         astcenc_weight_quant_xfer_tables.cpp)
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# -----------------------------------------------------------------------------
+# Copyright 2021 Arm Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy
+# of the License at:
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations
+# under the License.
+# -----------------------------------------------------------------------------
+"""
+A decompression benchmarking helper. Each input image is compressed once for
+each block size, and the decompression rate of the fastest of several repeated
+decompression passes is reported. By default this uses the HDR test images, as
+HDR decompression is significantly slower than LDR decompression.
+"""
+
+import argparse
+import glob
+import os
+import re
+import subprocess as sp
+import sys
+import tempfile
+
+
+def get_coding_rate(output):
+    """
+    Get the coding rate from the codec output.
+
+    Args:
+        output (str): The codec standard output.
+
+    Returns:
+        float: The coding rate in MT/s.
+    """
+    match = re.search(r"Coding rate:\s*([0-9.]+)", output)
+    if not match:
+        raise RuntimeError("Coding rate not found in codec output")
+    return float(match.group(1))
+
+
+def parse_command_line():
+    """
+    Parse the command line.
+
+    Returns:
+        Namespace: The parsed command line container.
+    """
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument("--encoder", dest="encoder", default="./astcenc/astcenc-avx2",
+                        help="the codec binary to benchmark")
+
+    parser.add_argument("--block-sizes", dest="blockSizes", nargs="+",
+                        default=["4x4", "6x6", "8x8"], help="the block sizes to test")
+
+    parser.add_argument("--repeats", dest="repeats", type=int, default=10,
+                        help="the number of decompression passes per image")
+
+    parser.add_argument("--threads", dest="threads", type=int, default=1,
+                        help="the number of codec threads")
+
+    parser.add_argument(dest="images", nargs="*",
+                        help="the test images, defaults to the HDR test images")
+
+    args = parser.parse_args()
+    return args
+
+
+def main():
+    """
+    The main function.
+
+    Returns:
+        int: The process return code.
+    """
+    args = parse_command_line()
+
+    images = args.images
+    if not images:
+        root = os.path.join(os.path.dirname(__file__), "Images", "HDRIHaven")
+        images = sorted(glob.glob(os.path.join(root, "**", "*.hdr"), recursive=True))
+
+    repeats = max(args.repeats, 1)
+    threads = str(max(args.threads, 1))
+
+    print("Image, Block Size, Decode Rate (MT/s)")
+
+    with tempfile.TemporaryDirectory() as tempDir:
+        for image in images:
+            isHDR = os.path.splitext(image)[1] in (".hdr", ".exr")
+            mode = "h" if isHDR else "l"
+            outExt = ".exr" if isHDR else ".png"
+
+            for blockSize in args.blockSizes:
+                compPath = os.path.join(tempDir, "image.astc")
+                decompPath = os.path.join(tempDir, "image" + outExt)
+
+                command = [args.encoder, f"-c{mode}", image, compPath, blockSize,
+                           "-fast", "-silent", "-j", threads]
+                sp.run(command, check=True, stdout=sp.PIPE, universal_newlines=True)
+
+                command = [args.encoder, f"-d{mode}", compPath, decompPath,
+                           "-decode-repeats", str(repeats), "-j", threads]
+                result = sp.run(command, check=True, stdout=sp.PIPE,
+                                universal_newlines=True)
+
+                rate = get_coding_rate(result.stdout)
+                print(f"{os.path.basename(image)}, {blockSize}, {rate}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
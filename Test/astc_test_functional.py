@@ -62,6 +62,7 @@ HDR images are an 8x8 image containing 4 4x4 constant color blocks. Assuming
 
 import argparse
 import filecmp
+import lzma
 import os
 import re
 import signal
@@ -1397,6 +1398,108 @@ class CLIPTest(CLITestBase):
         # Test time should get slower with fewer threads
         self.assertGreater(testTime, refTime)
 
+    def test_thread_count_determinism(self):
+        """
+        Test that the compressed output does not depend on the thread count.
+
+        Images small enough to use intra-block parallelism with more than
+        one thread only need to match other multi-threaded runs.
+        """
+        fullFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        cropFile = self.get_tmp_image_path("LDR", "decomp")
+        Image.open(fullFile).crop((0, 0, 48, 48)).save(cropFile)
+
+        for inputFile in (fullFile, cropFile):
+            for blockSize in ("4x4", "8x8"):
+                # The cropped image uses 36 blocks at 8x8
+                isSmall = inputFile == cropFile and blockSize == "8x8"
+                refThreads = "2" if isSmall else "1"
+
+                refFile = self.get_tmp_image_path("LDR", "comp")
+                command = [
+                    self.binary, "-cl",
+                    inputFile, refFile, blockSize, "-medium"]
+                self.exec(command + ["-j", refThreads])
+
+                for threads in ("3", "300"):
+                    with self.subTest(image=inputFile, blockSize=blockSize, threads=threads):
+                        testFile = self.get_tmp_image_path("LDR", "comp")
+                        command[3] = testFile
+                        self.exec(command + ["-j", threads])
+                        self.assertTrue(filecmp.cmp(refFile, testFile, shallow=False))
+
+    def test_rdo_lambda(self):
+        """
+        Test that rate-distortion optimization reduces the packed size.
+        """
+        inputFile = self.get_tmp_image_path("LDR", "decomp")
+        fullFile = "./Test/Images/Khronos/LDR-RGB/ldr-rgb-diffuse.png"
+        Image.open(fullFile).crop((512, 512, 896, 896)).save(inputFile)
+
+        def compress(arguments, threads="1"):
+            outputFile = self.get_tmp_image_path("LDR", "comp")
+            command = [
+                self.binary, "-cl",
+                inputFile, outputFile, "6x6", "-fast", "-j", threads]
+            self.exec(command + arguments)
+            with open(outputFile, "rb") as fileHandle:
+                return fileHandle.read()
+
+        # A zero lambda disables RDO, so must match the default output
+        refData = compress([])
+        self.assertEqual(compress(["-rdolambda", "0"]), refData)
+
+        # A non-zero lambda reduces the size after lossless compression
+        rdoData = compress(["-rdolambda", "2"])
+        self.assertNotEqual(rdoData, refData)
+        self.assertLess(len(lzma.compress(rdoData)), len(lzma.compress(refData)))
+
+        # RDO uses the final neighboring blocks as context, so must not
+        # depend on the thread count
+        for threads in ("2", "300"):
+            with self.subTest(threads=threads):
+                self.assertEqual(compress(["-rdolambda", "2"], threads), rdoData)
+
+    def test_pin_cpus(self):
+        """
+        Test that valid -pin CPU lists are accepted and do not change output.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        refFile = self.get_tmp_image_path("LDR", "comp")
+        command = [self.binary, "-cl", inputFile, refFile, "4x4", "-fast"]
+        self.exec(command + ["-j", "1"])
+
+        cpuLists = ["0", "0,0", "0-0", "0-1,0"]
+        for cpuList in cpuLists:
+            for threads in ("1", "3"):
+                with self.subTest(cpus=cpuList, threads=threads):
+                    testFile = self.get_tmp_image_path("LDR", "comp")
+                    command[3] = testFile
+                    self.exec(command + ["-j", threads, "-pin", cpuList])
+                    self.assertTrue(filecmp.cmp(refFile, testFile, shallow=False))
+
+    @unittest.skipIf(not sys.platform.startswith("linux"), "Linux affinity test")
+    def test_pin_cpus_unavailable(self):
+        """
+        Test that -pin CPUs outside of the affinity mask are reported.
+        """
+        unavailable = set(range(1024)) - os.sched_getaffinity(0)
+        if not unavailable:
+            self.skipTest("All CPUs are available")
+
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        refFile = self.get_tmp_image_path("LDR", "comp")
+        command = [self.binary, "-cl", inputFile, refFile, "4x4", "-fast"]
+        self.exec(command + ["-j", "2"])
+
+        # Unpinned threads still run, so the output is unchanged
+        testFile = self.get_tmp_image_path("LDR", "comp")
+        command[3] = testFile
+        stdout = self.exec(command + ["-j", "2", "-pin", str(min(unavailable))])
+        self.assertIn("WARNING: Some threads could not be pinned", stdout)
+        self.assertIn("(failed)", stdout)
+        self.assertTrue(filecmp.cmp(refFile, testFile, shallow=False))
+
     def test_silent(self):
         """
         Test silent
@@ -1418,6 +1521,68 @@ class CLIPTest(CLITestBase):
         # somewhere ...
         self.assertLess(len(stdoutSilent), len(stdout))
 
+    def test_multiple_block_sizes(self):
+        """
+        Test that multiple block sizes match separate compressions.
+        """
+        inputFile = "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"
+        blockSizes = ["4x4", "6x5", "12x12"]
+
+        # Use a directory name with a dot to check extension handling
+        outDir = os.path.join(self.tempDir.name, "multi.dir")
+        os.mkdir(outDir)
+        outFile = os.path.join(outDir, "out.astc")
+
+        command = [
+            self.binary, "-cl",
+            inputFile, outFile, ",".join(blockSizes), "-medium"]
+        self.exec(command)
+
+        for blockSize in blockSizes:
+            with self.subTest(blockSize=blockSize):
+                refFile = self.get_tmp_image_path("LDR", "comp")
+                command = [
+                    self.binary, "-cl",
+                    inputFile, refFile, blockSize, "-medium"]
+                self.exec(command)
+
+                testFile = os.path.join(outDir, f"out_{blockSize}.astc")
+                self.assertTrue(filecmp.cmp(refFile, testFile, shallow=False))
+
+    def test_split_block_stream(self):
+        """
+        Test that split block stream output decodes to the same image.
+        """
+        for profile, inputFile in (
+                ("LDR", "./Test/Images/Small/LDR-RGBA/ldr-rgba-00.png"),
+                ("HDR", "./Test/Images/Small/HDR-RGB/hdr-rgb-00.hdr")):
+            mode = "l" if profile == "LDR" else "h"
+            for blockSize in ("4x4", "5x4", "12x12"):
+                with self.subTest(profile=profile, blockSize=blockSize):
+                    astcFile = self.get_tmp_image_path("EXP", ".astc")
+                    astcsFile = self.get_tmp_image_path("EXP", ".astcs")
+
+                    command = [
+                        self.binary, "-c" + mode,
+                        inputFile, astcFile, blockSize, "-fast"]
+                    self.exec(command)
+
+                    command[3] = astcsFile
+                    self.exec(command)
+
+                    # The split stream uses a different container
+                    self.assertFalse(filecmp.cmp(astcFile, astcsFile, shallow=False))
+
+                    refFile = self.get_tmp_image_path(profile, "decomp")
+                    command = [self.binary, "-d" + mode, astcFile, refFile]
+                    self.exec(command)
+
+                    testFile = self.get_tmp_image_path(profile, "decomp")
+                    command = [self.binary, "-d" + mode, astcsFile, testFile]
+                    self.exec(command)
+
+                    self.assertTrue(filecmp.cmp(refFile, testFile, shallow=False))
+
     def test_image_quality_stability(self):
         """
         Test that a round-trip and a file-based round-trip give same result.
@@ -2064,6 +2229,85 @@ class CLINTest(CLITestBase):
                 command[blockIndex] = badSwizzle
                 self.exec(command)
 
+    def test_cl_multiple_block_sizes_invalid(self):
+        """
+        Test -cl with multiple block sizes that can not be stored.
+        """
+        nullFile = "NUL" if sys.platform == "win32" else "/dev/null"
+        inputFile = self.get_ref_image_path("LDR", "input", "A")
+        compFile = self.get_tmp_image_path("LDR", "comp")
+
+        # Use a directory name with a dot to check extension handling
+        outDir = os.path.join(self.tempDir.name, "multi.dir")
+        os.mkdir(outDir)
+
+        badCommands = [
+            # The null device can not store one output per block size
+            [inputFile, nullFile, "4x4,6x6"],
+            # Output file names without an extension have no known type
+            [inputFile, os.path.join(self.tempDir.name, "out"), "4x4,6x6"],
+            [inputFile, os.path.join(outDir, "out"), "4x4,6x6"],
+            # Outputs for a repeated block size would overwrite each other
+            [inputFile, compFile, "4x4,6x6,4x4"],
+        ]
+
+        for badCommand in badCommands:
+            with self.subTest(command=badCommand):
+                command = [self.binary, "-cl"] + badCommand + ["-fast"]
+                self.exec(command)
+
+    def test_cl_pin_missing_args(self):
+        """
+        Test -cl with -pin and missing arguments.
+        """
+        # Build a valid command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-pin", "0"]
+
+        # Run the command, incrementally omitting arguments
+        self.exec_with_omit(command, 7)
+
+    def test_cl_pin_invalid_cpus(self):
+        """
+        Test -cl with -pin and invalid CPU lists.
+        """
+        badCPULists = [
+            "",  # Empty lists
+            ",",
+            "0,,1",
+            "-1",  # Negative indices
+            "0--1",
+            "5-2",  # Reversed ranges
+            "1-",  # Incomplete ranges
+            "-",
+            "99999999",  # Indices above any platform limit
+            "0-2000000000",
+            "0-99999999999999999999",
+            "a",  # Non-numeric indices
+            "0x1",
+            "+1",
+            " 1",
+            "1 ",
+        ]
+
+        # Build a valid base command
+        command = [
+            self.binary, "-cl",
+            self.get_ref_image_path("LDR", "input", "A"),
+            self.get_tmp_image_path("LDR", "comp"),
+            "4x4", "-fast",
+            "-pin", "0"]
+
+        cpuIndex = command.index("-pin") + 1
+        for badCPUList in badCPULists:
+            with self.subTest(cpus=badCPUList):
+                command[cpuIndex] = badCPUList
+                self.exec(command)
+
     def test_dl_dsw_missing_args(self):
         """
         Test -dl with -dsw and missing arguments.